@@ -8,6 +8,7 @@ from .branch import GENERATORS as BRANCH_GENERATORS
 from .floating_point import GENERATORS as FLOAT_GENERATORS
 from .integer import GENERATORS as INTEGER_GENERATORS
 from .memory import GENERATORS as MEMORY_GENERATORS
+from .performance import GENERATORS as PERFORMANCE_GENERATORS
 
 
 ALL_GENERATORS = (
@@ -15,4 +16,5 @@ ALL_GENERATORS = (
     *MEMORY_GENERATORS,
     *BRANCH_GENERATORS,
     *FLOAT_GENERATORS,
+    *PERFORMANCE_GENERATORS,
 )
@@ -0,0 +1,98 @@
+"""Performance-stress sequences for the cycle-accounting regression.
+
+These blocks are functionally ordinary, but each one concentrates a pipeline
+hazard so that an RTL change adding stall cycles shows up in the per-class
+CPI recorded by the harness (``+perf``).  Basic generators stress the load
+path, corner cases target the data cache and the multiply/divide unit.
+"""
+
+from .common import CACHE_SIZE, DATA_BYTES, GeneratorSpec, MEM_BASE_REG, random_register
+
+
+def _distinct_registers(rng, count):
+    chosen = []
+    for _ in range(count):
+        chosen.append(random_register(rng, exclude=chosen))
+    return chosen
+
+
+def generate_dependent_load_chain(rng, _label_id):
+    """Build a short linked list in the data area, then chase it.
+
+    Every load address is the value returned by the previous load, so the
+    loads issue strictly back to back through the load-use path.
+    """
+
+    length = rng.randint(3, 6)
+    offsets = rng.sample(range(0, 2048, 4), length + 1)
+    pointer, scratch = _distinct_registers(rng, 2)
+
+    instructions = []
+    for current, following in zip(offsets, offsets[1:]):
+        instructions.append(f"addi {scratch}, {MEM_BASE_REG}, {following}")
+        instructions.append(f"sw {scratch}, {current}({MEM_BASE_REG})")
+
+    instructions.append(f"lw {pointer}, {offsets[0]}({MEM_BASE_REG})")
+    instructions.extend(f"lw {pointer}, 0({pointer})" for _ in range(length - 1))
+    return "\n".join(instructions)
+
+
+def generate_store_load_burst(rng, _label_id):
+    """Stores immediately followed by overlapping loads of every width."""
+
+    base = rng.randrange(0, 2048 - 16, 4)
+    instructions = []
+    for index in range(rng.randint(3, 6)):
+        offset = base + 4 * (index % 4)
+        data_reg, load_reg = _distinct_registers(rng, 2)
+        load = rng.choice(("lw", "lh", "lhu", "lb", "lbu"))
+        lane = {"lw": 0, "lh": 2, "lhu": 2}.get(load, rng.randint(0, 3))
+        instructions.append(f"sw {data_reg}, {offset}({MEM_BASE_REG})")
+        instructions.append(f"{load} {load_reg}, {offset + lane}({MEM_BASE_REG})")
+    return "\n".join(instructions)
+
+
+def generate_cache_index_conflicts(rng, _label_id):
+    """Cycle through more aliasing lines than the direct-mapped cache holds.
+
+    All addresses share one cache index, so every access misses and dirty
+    lines are written back before the next refill.
+    """
+
+    index_offset = rng.randrange(0, CACHE_SIZE, 16)
+    ways = rng.randint(2, DATA_BYTES // CACHE_SIZE - 1)
+    address_reg, data_reg = _distinct_registers(rng, 2)
+
+    instructions = []
+    for _ in range(rng.randint(1, 2)):
+        for way in range(ways):
+            instructions.append(f"li {address_reg}, {index_offset + way * CACHE_SIZE}")
+            instructions.append(f"add {address_reg}, {address_reg}, {MEM_BASE_REG}")
+            if rng.random() < 0.5:
+                instructions.append(f"sw {data_reg}, 0({address_reg})")
+            instructions.append(f"lw {data_reg}, 4({address_reg})")
+    return "\n".join(instructions)
+
+
+def generate_muldiv_chain(rng, _label_id):
+    """A serial chain where each multiply/divide consumes the previous result."""
+
+    accumulator, operand = _distinct_registers(rng, 2)
+    instructions = [f"ori {operand}, {operand}, 1"]
+    for _ in range(rng.randint(6, 12)):
+        op = rng.choice(("mul", "mulh", "mulhu", "div", "divu", "rem", "remu"))
+        instructions.append(f"{op} {accumulator}, {accumulator}, {operand}")
+    return "\n".join(instructions)
+
+
+BASIC_GENERATORS = (
+    GeneratorSpec("perf", generate_dependent_load_chain),
+    GeneratorSpec("perf", generate_store_load_burst),
+)
+
+CORNER_CASE_GENERATORS = (
+    GeneratorSpec("perf", generate_cache_index_conflicts),
+    GeneratorSpec("perf", generate_muldiv_chain, required_extension="m"),
+)
+
+GENERATORS = BASIC_GENERATORS + CORNER_CASE_GENERATORS
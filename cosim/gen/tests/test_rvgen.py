@@ -13,7 +13,7 @@ RVGEN = GEN_DIR / "rvgen.py"
 sys.path.insert(0, str(GEN_DIR))
 
 import rvgen  # noqa: E402
-from instructions import branch, floating_point, integer, memory  # noqa: E402
+from instructions import branch, floating_point, integer, memory, performance  # noqa: E402
 from instructions.common import SAFE_REGS  # noqa: E402
 
 
@@ -57,7 +57,7 @@ class GeneratorArchitectureTests(unittest.TestCase):
             self.assertNotEqual(programs[0], programs[2])
 
     def test_every_family_exposes_basic_and_corner_case_generators(self):
-        for module in (integer, memory, branch, floating_point):
+        for module in (integer, memory, branch, floating_point, performance):
             self.assertTrue(module.BASIC_GENERATORS, module.__name__)
             self.assertTrue(module.CORNER_CASE_GENERATORS, module.__name__)
 
@@ -97,6 +97,14 @@ class GeneratorArchitectureTests(unittest.TestCase):
         self.assertTrue(fence_generator.is_enabled({"mem"}, {"i"}))
         self.assertTrue(fence_generator.is_enabled({"fence"}, {"i"}))
 
+    def test_dependent_load_chain_chases_its_own_pointer(self):
+        block = performance.generate_dependent_load_chain(random.Random(17), 0)
+        chase = [line for line in block.splitlines() if line.startswith("lw") and "(x31)" not in line]
+        self.assertTrue(chase)
+        for line in chase:
+            dest, source = line[3:].split(", ")
+            self.assertEqual(source, f"0({dest})")
+
     def test_each_cli_class_generates_a_program(self):
         cases = (
             ("arith", "rv32im_zba_zbs_zbb"),
@@ -104,6 +112,7 @@ class GeneratorArchitectureTests(unittest.TestCase):
             ("fence", "rv32i"),
             ("branch,ctrl", "rv32i"),
             ("float", "rv32im_zfinx"),
+            ("perf", "rv32im"),
         )
         with tempfile.TemporaryDirectory() as temp_dir:
             for index, (classes, isa) in enumerate(cases):
@@ -13,15 +13,20 @@
 //
 // ISA and privilege mode are passed from the Makefile through
 // -DCOSIM_ISA and -DCOSIM_PRIV, derived from config.mk.
-// CSR comparison is intentionally excluded.
+// CSR comparison is intentionally excluded: the DUT CSR read result is copied
+// into Spike instead. MMIO loads are replayed into Spike from the DUT events
+// (mmio_replay.h), so real firmware that touches peripherals stays in lockstep.
 // ============================================================================
 
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <sstream>
 #include <cstdint>
 #include <cstring>
 #include <vector>
 #include <deque>
+#include <map>
 #include <string>
 #include <csignal>
 
@@ -39,6 +44,7 @@
 #include "riscv/trap.h"
 
 #include "elf_loader.h"
+#include "mmio_replay.h"
 
 // ============================================================================
 //      GLOBAL STATE
@@ -48,12 +54,17 @@ static Vcosim_top      *dut = nullptr;
 static VerilatedFstC   *tfp = nullptr;
 
 static uint64_t sim_time = 0;
+static uint64_t g_cycles = 0;
 
 static bool enable_trace = true;
 
 static constexpr uint64_t HALF_PERIOD_NS = 5000;
 static constexpr uint32_t USER_BASE = 0x80000000u;
 
+// Peripheral window, see sw/lib/mmio.h. Ends well below Spike's CLINT.
+static constexpr uint32_t MMIO_BASE = 0x00004000u;
+static constexpr uint32_t MMIO_SIZE = 0x00100000u;
+
 // RVFI event generated by the RTL through DPI.
 // One event is produced for each committed instruction.
 struct RvfiEvent {
@@ -67,6 +78,7 @@ struct RvfiEvent {
     uint32_t mem_addr;    // Absolute address, as used by cpu_store/load_channel
     uint32_t mem_data;    // Source register value, later masked according to width
     uint32_t mem_width;   // 0=BYTE, 1=HALF_WORD, 2=WORD
+    uint64_t cycle;       // Clock cycle of the commit
 };
 
 static std::deque<RvfiEvent> g_events;
@@ -83,7 +95,7 @@ extern "C" void rvfi_commit(uint32_t is_exception, uint32_t pc, uint32_t info,
                             uint32_t mem_width) {
     g_events.push_back(RvfiEvent{
         is_exception != 0, pc, info, rd, rd_value,
-        is_store != 0, is_load != 0, mem_addr, mem_data, mem_width
+        is_store != 0, is_load != 0, mem_addr, mem_data, mem_width, g_cycles
     });
 }
 
@@ -108,6 +120,8 @@ static void clk_tick() {
     dump_trace();
     Verilated::timeInc(HALF_PERIOD_NS);
     sim_time += HALF_PERIOD_NS;
+
+    g_cycles++;
 }
 
 static void reset_dut() {
@@ -181,6 +195,213 @@ static void report_mismatch(uint64_t retire, const char* what,
     std::cout << "[COSIM] FAIL\n";
 }
 
+static void report_mmio(const MmioReplay& mmio) {
+    if (!mmio.loads() && !mmio.stores())
+        return;
+
+    std::cout << "[COSIM] MMIO replay: " << mmio.loads() << " loads, "
+              << mmio.stores() << " stores";
+
+    if (mmio.unmatched())
+        std::cout << ", WARN: " << mmio.unmatched() << " loads without a DUT value";
+
+    std::cout << "\n";
+}
+
+
+// ============================================================================
+//      PERFORMANCE ACCOUNTING
+// ============================================================================
+//
+// Each user retire is charged the cycles elapsed since the previous one and
+// binned by instruction class, so a stall added to one pipeline path shows up
+// as a CPI increase of that class only. With +perf=FILE the totals are written
+// as "key class retires cycles" lines; +perf_baseline=FILE compares them with
+// the lines of a previous run carrying the same key.
+
+enum PerfClass : int {
+    PERF_ALU, PERF_MULDIV, PERF_LOAD, PERF_STORE, PERF_BRANCH,
+    PERF_JUMP, PERF_FP, PERF_SYSTEM, PERF_EXCEPTION, PERF_CLASSES
+};
+
+static const char* const PERF_CLASS_NAME[PERF_CLASSES] = {
+    "alu", "muldiv", "load", "store", "branch", "jump", "fp", "system", "exception"
+};
+
+// Classes with fewer retires than this are too noisy to fail a regression.
+static constexpr uint64_t PERF_MIN_RETIRES = 32;
+
+struct PerfCounter {
+    uint64_t retires = 0;
+    uint64_t cycles  = 0;
+
+    double cpi() const { return retires ? double(cycles) / double(retires) : 0.0; }
+};
+
+struct PerfStats {
+    PerfCounter cls[PERF_CLASSES];
+    PerfCounter all;
+    uint64_t    last_cycle = 0;
+    bool        started    = false;
+};
+
+static PerfClass perf_classify(uint32_t bits) {
+    const uint32_t funct3 = (bits >> 13) & 0x7;
+
+    switch (bits & 0x3) {
+        case 0x0:   // C quadrant 0
+            if (funct3 == 0) return PERF_ALU;
+            return (funct3 & 0x4) ? PERF_STORE : PERF_LOAD;
+
+        case 0x1:   // C quadrant 1
+            if (funct3 == 1 || funct3 == 5) return PERF_JUMP;
+            if (funct3 >= 6) return PERF_BRANCH;
+            return PERF_ALU;
+
+        case 0x2:   // C quadrant 2
+            if (funct3 == 4) {
+                const uint32_t rs1 = (bits >> 7) & 0x1f;
+                const uint32_t rs2 = (bits >> 2) & 0x1f;
+
+                if (rs2 == 0 && rs1 != 0) return PERF_JUMP;
+                if (rs2 == 0) return PERF_SYSTEM;
+                return PERF_ALU;
+            }
+            if (funct3 == 0) return PERF_ALU;
+            return (funct3 & 0x4) ? PERF_STORE : PERF_LOAD;
+
+        default:
+            break;
+    }
+
+    switch (bits & 0x7f) {
+        case 0x03: case 0x07: return PERF_LOAD;
+        case 0x23: case 0x27: return PERF_STORE;
+        case 0x63:            return PERF_BRANCH;
+        case 0x67: case 0x6f: return PERF_JUMP;
+        case 0x0f: case 0x73: return PERF_SYSTEM;
+        case 0x43: case 0x47:
+        case 0x4b: case 0x4f:
+        case 0x53:            return PERF_FP;
+        case 0x33:            return ((bits >> 25) == 0x01) ? PERF_MULDIV : PERF_ALU;
+        default:              return PERF_ALU;
+    }
+}
+
+static void perf_account(PerfStats& ps, const RvfiEvent& d, uint32_t bits) {
+    // The first user retire only opens the window: its gap includes reset
+    // and the ROM stub.
+    if (!ps.started) {
+        ps.started    = true;
+        ps.last_cycle = d.cycle;
+        return;
+    }
+
+    const uint64_t gap = d.cycle - ps.last_cycle;
+    ps.last_cycle = d.cycle;
+
+    PerfCounter& c = ps.cls[d.is_exception ? PERF_EXCEPTION : perf_classify(bits)];
+    c.retires++;
+    c.cycles += gap;
+
+    ps.all.retires++;
+    ps.all.cycles += gap;
+}
+
+static void perf_report(const PerfStats& ps) {
+    std::cout << "[COSIM][PERF] " << ps.all.retires << " retires, "
+              << ps.all.cycles << " cycles, CPI " << std::fixed
+              << std::setprecision(3) << ps.all.cpi() << "\n";
+
+    for (int k = 0; k < PERF_CLASSES; k++) {
+        if (!ps.cls[k].retires)
+            continue;
+
+        std::cout << "[COSIM][PERF]   " << std::left << std::setw(10) << PERF_CLASS_NAME[k]
+                  << std::right << std::setw(10) << ps.cls[k].retires
+                  << std::setw(12) << ps.cls[k].cycles
+                  << "  CPI " << ps.cls[k].cpi() << "\n";
+    }
+
+    std::cout << std::defaultfloat;
+}
+
+static bool perf_write(const PerfStats& ps, const std::string& path, const std::string& key) {
+    std::ofstream out(path);
+
+    if (!out)
+        return false;
+
+    out << key << " all " << ps.all.retires << " " << ps.all.cycles << "\n";
+
+    for (int k = 0; k < PERF_CLASSES; k++) {
+        if (ps.cls[k].retires)
+            out << key << " " << PERF_CLASS_NAME[k] << " "
+                << ps.cls[k].retires << " " << ps.cls[k].cycles << "\n";
+    }
+
+    return true;
+}
+
+// Returns false when any class got slower than the baseline by more than
+// threshold percent. A baseline without this key only warns.
+static bool perf_check(const PerfStats& ps, const std::string& path,
+                       const std::string& key, double threshold) {
+    std::ifstream in(path);
+
+    if (!in) {
+        std::cout << "[COSIM][PERF] WARN: cannot open baseline " << path << "\n";
+        return true;
+    }
+
+    std::map<std::string, PerfCounter> base;
+    std::string line;
+
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        std::string k, cls;
+        PerfCounter c;
+
+        if (ls >> k >> cls >> c.retires >> c.cycles && k == key)
+            base[cls] = c;
+    }
+
+    if (base.empty()) {
+        std::cout << "[COSIM][PERF] WARN: no baseline entry for key " << key << "\n";
+        return true;
+    }
+
+    bool ok = true;
+
+    auto compare = [&](const char* name, const PerfCounter& now) {
+        auto it = base.find(name);
+
+        if (it == base.end() || it->second.retires < PERF_MIN_RETIRES ||
+            now.retires < PERF_MIN_RETIRES)
+            return;
+
+        const double was   = it->second.cpi();
+        const double delta = was > 0.0 ? (now.cpi() - was) * 100.0 / was : 0.0;
+
+        if (delta > threshold) {
+            ok = false;
+            std::cout << "[COSIM][PERF] REGRESSION " << name << ": CPI "
+                      << std::fixed << std::setprecision(3) << was << " -> " << now.cpi()
+                      << " (+" << std::setprecision(1) << delta << "%, threshold "
+                      << threshold << "%)\n" << std::defaultfloat;
+        }
+    };
+
+    compare("all", ps.all);
+
+    for (int k = 0; k < PERF_CLASSES; k++)
+        compare(PERF_CLASS_NAME[k], ps.cls[k]);
+
+    if (ok)
+        std::cout << "[COSIM][PERF] within " << threshold << "% of baseline (" << key << ")\n";
+
+    return ok;
+}
 
 // ============================================================================
 //      MAIN
@@ -195,6 +416,9 @@ int main(int argc, char** argv) {
     std::string boot_path = "cosim/out/boot.elf";
     uint64_t max_retire = UINT64_MAX;
 
+    std::string perf_path, perf_key, perf_baseline;
+    double perf_threshold = 5.0;
+
     for (int i = 1; i < argc; i++) {
         std::string a(argv[i]);
 
@@ -202,6 +426,15 @@ int main(int argc, char** argv) {
         else if (a.rfind("+boot=", 0) == 0)         boot_path = a.substr(6);
         else if (a == "+notrace")                   enable_trace = false;
         else if (a.rfind("+max_retire=", 0) == 0)   max_retire = std::stoull(a.substr(12));
+        else if (a.rfind("+perf=", 0) == 0)         perf_path = a.substr(6);
+        else if (a.rfind("+perf_key=", 0) == 0)     perf_key = a.substr(10);
+        else if (a.rfind("+perf_baseline=", 0) == 0) perf_baseline = a.substr(15);
+        else if (a.rfind("+perf_threshold=", 0) == 0) perf_threshold = std::stod(a.substr(16));
+    }
+
+    if (perf_key.empty()) {
+        const size_t slash = fw_path.find_last_of('/');
+        perf_key = (slash == std::string::npos) ? fw_path : fw_path.substr(slash + 1);
     }
 
     dut = new Vcosim_top;
@@ -293,6 +526,9 @@ int main(int argc, char** argv) {
     std::vector<std::pair<reg_t, abstract_mem_t*>> mems;
     mems.push_back(std::make_pair((reg_t)USER_BASE, new mem_t(256 * 1024 * 1024)));
 
+    MmioReplay* mmio = new MmioReplay(MMIO_BASE, MMIO_SIZE);
+    mems.push_back(std::make_pair((reg_t)MMIO_BASE, (abstract_mem_t*)mmio));
+
     debug_module_config_t dm_config;
     std::vector<std::pair<const device_factory_t*, std::vector<std::string>>> plugins;
     std::vector<std::string> htif_args;
@@ -349,6 +585,22 @@ int main(int argc, char** argv) {
     bool first_commit_seen = false;
     bool gpr_baseline_set  = false;
 
+    PerfStats perf;
+
+    // Report, record and check the cycle accounting. Returns false on a CPI
+    // regression against +perf_baseline.
+    auto perf_finish = [&]() -> bool {
+        perf_report(perf);
+
+        if (!perf_path.empty() && !perf_write(perf, perf_path, perf_key))
+            std::cout << "[COSIM][PERF] WARN: cannot write " << perf_path << "\n";
+
+        if (perf_baseline.empty())
+            return true;
+
+        return perf_check(perf, perf_baseline, perf_key, perf_threshold);
+    };
+
     while (retire < max_retire) {
 
         // Full architectural GPR sweep at every idle point.
@@ -468,6 +720,11 @@ int main(int argc, char** argv) {
             std::cout << "[COSIM] PASS - " << retire
                       << " instructions compared, memory verified, no mismatch.\n";
 
+            report_mmio(*mmio);
+
+            if (!perf_finish())
+                close_and_exit(5);
+
             close_and_exit((d.mem_data == 1) ? 0 : 1);
         }
 
@@ -481,11 +738,20 @@ int main(int argc, char** argv) {
             insn = p->get_mmu()->load_insn(st->pc).insn;
         } catch (...) {}
 
+        perf_account(perf, d, (uint32_t)insn.bits());
+
+        // Hand the DUT view of a peripheral read to Spike's MMIO window.
+        mmio->flush();
+        if (d.is_load && mmio->contains(d.mem_addr))
+            mmio->expect(d.mem_addr, d.rd_value);
+
         try {
             p->step(1);
         } catch (trap_t& tr) {
             // Spike raised a trap, for example mtvec with unmapped address.
             // This is acceptable only if the DUT also reported an exception.
+            // Only synchronous traps get here: interrupts are tied off in
+            // cosim_top and never injected into Spike (see README).
             if (!d.is_exception) {
                 std::cout << "\n[COSIM][MISMATCH] @retire #" << std::dec << retire
                           << " spike trap cause=0x" << std::hex << tr.cause()
@@ -573,11 +839,18 @@ int main(int argc, char** argv) {
             close_and_exit(1);
         }
 
+        // Counters, timers and implementation CSRs legitimately differ: adopt
+        // the DUT value so the difference does not propagate through rd.
+        if (d.rd != 0 && d.info == CSR_OPERATION)
+            st->XPR.write(d.rd, (reg_t)d.rd_value);
+
         retire++;
     }
 
     std::cout << "[COSIM] STOP - reached max_retire=" << std::dec << max_retire
               << " (" << retire << " compared, no mismatch).\n";
-              
-    close_and_exit(0);
+
+    report_mmio(*mmio);
+
+    close_and_exit(perf_finish() ? 0 : 5);
 }
\ No newline at end of file
@@ -13,6 +13,12 @@
 #include <vector>
 #include <utility>
 
+struct ElfSymbol {
+    std::string name;
+    uint32_t    value = 0;
+    uint32_t    size  = 0;
+};
+
 struct ElfImage {
     uint32_t entry = 0;
 
@@ -26,8 +32,21 @@ struct ElfImage {
     // Generator's data_area[] symbol
     uint32_t data_area = 0;
     uint32_t data_area_size = 0;
+
+    // STT_FUNC entries of .symtab, in file order.
+    std::vector<ElfSymbol> functions;
 };
 
+// Look up a function symbol by name. Returns nullptr when it is missing.
+inline const ElfSymbol* find_function(const ElfImage& img, const std::string& name) {
+    for (const ElfSymbol& sym : img.functions) {
+        if (sym.name == name)
+            return &sym;
+    }
+
+    return nullptr;
+}
+
 inline bool load_elf(const std::string& path, ElfImage& out) {
     FILE* f = std::fopen(path.c_str(), "rb");
 
@@ -161,6 +180,7 @@ inline bool load_elf(const std::string& path, ElfImage& out) {
                 uint32_t st_name  = u32(syme + 0);
                 uint32_t st_value = u32(syme + 4);
                 uint32_t st_size  = u32(syme + 8);
+                uint32_t st_type  = syme[12] & 0xF;
 
                 if (st_name < str_size) {
                     const char* nm = &strtab[st_name];
@@ -171,16 +191,16 @@ inline bool load_elf(const std::string& path, ElfImage& out) {
                         out.data_area      = st_value;
                         out.data_area_size = st_size;
                     }
-                }
 
-                if (out.tohost && out.data_area) {
-                    break;
+                    // STT_FUNC
+                    if (st_type == 2 && *nm) {
+                        out.functions.push_back(ElfSymbol{nm, st_value, st_size});
+                    }
                 }
             }
 
-            if (out.tohost && out.data_area) {
-                break;
-            }
+            // Only one .symtab per ELF
+            break;
         }
     }
 
@@ -0,0 +1,88 @@
+// ============================================================================
+// Pass-through MMIO window for Spike, fed from the DUT retire stream.
+//
+// Spike has no model of the SoC peripherals, so an MMIO load would either
+// fault or return a value unrelated to what the core saw. The harness queues
+// the value of every DUT load that retires inside the window with expect()
+// before stepping Spike; the load issued by that step consumes it. Stores are
+// accepted and dropped: peripheral side effects are not modelled, only the
+// store address and data coming from the core are compared.
+//
+// The device is registered as an abstract_mem_t without host contents, so
+// Spike never caches it in the TLB and every access goes through load/store.
+// ============================================================================
+
+#ifndef COSIM_MMIO_REPLAY_H
+#define COSIM_MMIO_REPLAY_H
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <ostream>
+
+#include "riscv/devices.h"
+
+class MmioReplay : public abstract_mem_t {
+public:
+    MmioReplay(uint32_t base, uint32_t size) : base_(base), size_(size) {}
+
+    bool contains(uint32_t addr) const { return addr >= base_ && addr - base_ < size_; }
+
+    // Value the DUT loaded from addr, consumed by the next Spike load there.
+    void expect(uint32_t addr, uint32_t value) { pending_.push_back(Load{addr, value}); }
+
+    // Drop values the last step did not consume (e.g. a trapped load).
+    void flush() { pending_.clear(); }
+
+    uint64_t loads()     const { return loads_; }
+    uint64_t stores()    const { return stores_; }
+    uint64_t unmatched() const { return unmatched_; }
+
+    // abstract_device_t
+    bool load(reg_t offset, size_t len, uint8_t* bytes) override {
+        const uint32_t addr = base_ + (uint32_t)offset;
+        uint32_t value = 0;
+
+        loads_++;
+
+        // The DUT reports the extended register value: its low len bytes are
+        // exactly the bytes read from the peripheral.
+        if (!pending_.empty() && pending_.front().addr == addr) {
+            value = pending_.front().value;
+            pending_.pop_front();
+        } else {
+            unmatched_++;
+        }
+
+        std::memset(bytes, 0, len);
+        std::memcpy(bytes, &value, len < sizeof(value) ? len : sizeof(value));
+        return true;
+    }
+
+    bool store(reg_t, size_t, const uint8_t*) override {
+        stores_++;
+        return true;
+    }
+
+    // abstract_mem_t
+    char* contents(reg_t) override { return nullptr; }
+    reg_t size() override { return size_; }
+    void dump(std::ostream&) override {}
+
+private:
+    struct Load {
+        uint32_t addr;
+        uint32_t value;
+    };
+
+    uint32_t base_;
+    uint32_t size_;
+
+    std::deque<Load> pending_;
+
+    uint64_t loads_     = 0;
+    uint64_t stores_    = 0;
+    uint64_t unmatched_ = 0;
+};
+
+#endif
@@ -97,16 +97,17 @@ module ethernet #(
 
     logic read_payload, read_descriptor, write_payload, write_descriptor; logic tx_idle, rx_idle, rx_error, data_ready, smii_idle;
     logic [5:0][7:0] tx_dest_address, rx_src_address; logic [1:0][7:0] tx_payload_length, rx_payload_length; logic [7:0] tx_payload, rx_payload;
-    logic tx_enable, rx_enable, ethernet_II;
+    logic tx_enable, rx_enable, ethernet_II, registers_busy;
 
     logic [4:0] smii_address; logic smii_write, smii_read, smii_done; logic [15:0] smii_data_tx, smii_data_rx;
 
     ethernet_registers #(TX_BUFFER_SIZE, RX_BUFFER_SIZE, TX_PACKETS, RX_PACKETS) registers (
-        .clk_i         ( clk_i       ),
-        .rst_n_i       ( rst_n_i     ),
-        .interrupt_o   ( interrupt_o ),
-        .ethernet_II_o ( ethernet_II ),
-        .eth_speed_o   ( eth_speed   ),
+        .clk_i         ( clk_i          ),
+        .rst_n_i       ( rst_n_i        ),
+        .interrupt_o   ( interrupt_o    ),
+        .ethernet_II_o ( ethernet_II    ),
+        .eth_speed_o   ( eth_speed      ),
+        .busy_o        ( registers_busy ),
 
         .write_address_i ( write_address_i ),
         .write_i         ( write_i         ),
@@ -169,7 +170,7 @@ module ethernet #(
         .idle_o ( smii_idle )
     );
 
-    assign busy_o = !smii_idle;
+    assign busy_o = !smii_idle | registers_busy;
 
 
 //====================================================================================
@@ -16,6 +16,7 @@ module ethernet_registers #(
     output logic interrupt_o,
     output logic ethernet_II_o,
     output eth_speed_t eth_speed_o,
+    output logic busy_o,
 
     /* Write register interface */
     input eth_registers_t write_address_i,
@@ -65,8 +66,19 @@ module ethernet_registers #(
 //      ERROR CHECK
 //====================================================================================
 
-    assign write_error_o = (write_address_i.select == MAC) & (write_address_i.registers >= ETH_RX_DESC_LOW) & (write_address_i.registers <= ETH_RX_BUFFER) & write_i;
-    assign read_error_o = (read_address_i.select == MAC) & (read_address_i.registers >= ETH_TX_DESC_LOW) & (read_address_i.registers <= ETH_TX_BUFFER) & read_i;
+    /* MAC register access, the upper part of the address must be zero except for 
+     * the payload buffers (burst access) and the payload FIFO levels */
+    logic mac_write, mac_read, illegal_write, illegal_read; 
+
+    assign mac_write = (write_address_i.select == MAC) & (write_address_i.upper_part == '0) & write_i;
+    assign mac_read = (read_address_i.select == MAC) & (read_address_i.upper_part == '0) & read_i;
+
+    assign illegal_write = (write_address_i.select == MAC) & (write_address_i.upper_part != '0) & (write_address_i.registers != ETH_TX_BUFFER) & write_i;
+    assign illegal_read = (read_address_i.select == MAC) & (read_address_i.upper_part != '0) & (read_address_i.registers != ETH_RX_BUFFER) & 
+                          !((read_address_i.registers == ETH_MAC_STATUS) & (read_address_i.upper_part == 2'b01)) & read_i;
+
+    assign write_error_o = ((write_address_i.select == MAC) & (write_address_i.registers >= ETH_RX_DESC_LOW) & (write_address_i.registers <= ETH_RX_BUFFER) & write_i) | illegal_write;
+    assign read_error_o = ((read_address_i.select == MAC) & (read_address_i.registers >= ETH_TX_DESC_LOW) & (read_address_i.registers <= ETH_TX_BUFFER) & read_i) | illegal_read;
 
 
 //====================================================================================
@@ -104,7 +116,7 @@ module ethernet_registers #(
                 status_register.RX_enable <= 1'b0;
                 status_register.speed <= MBPS10;
             end else begin 
-                if ((write_address_i.select == MAC) & (write_address_i.registers == ETH_MAC_STATUS) & write_i) begin
+                if (mac_write & (write_address_i.registers == ETH_MAC_STATUS)) begin
                     status_register.RX_enable <= write_data_i[10];
                     status_register.TX_enable <= write_data_i[11];
                     status_register.ethernet_mode <= write_data_i[12];
@@ -134,7 +146,7 @@ module ethernet_registers #(
     /* Control */
     logic tx_descl_write;
 
-    assign tx_descl_write = (write_address_i.select == MAC) & (write_address_i.registers == ETH_TX_DESC_LOW) & write_i;
+    assign tx_descl_write = mac_write & (write_address_i.registers == ETH_TX_DESC_LOW);
 
     synchronous_buffer #(TX_PACKETS, 32) TX_descriptor_low (
         .clk_i   ( clk_i   ),
@@ -160,7 +172,7 @@ module ethernet_registers #(
     /* Control */
     logic tx_desch_write;
 
-    assign tx_desch_write = (write_address_i.select == MAC) & (write_address_i.registers == ETH_TX_DESC_HIGH) & write_i;
+    assign tx_desch_write = mac_write & (write_address_i.registers == ETH_TX_DESC_HIGH);
 
     synchronous_buffer #(TX_PACKETS, 32) TX_descriptor_high (
         .clk_i   ( clk_i   ),
@@ -196,28 +208,64 @@ module ethernet_registers #(
     logic tx_buf_empty, tx_buf_full;
 
     /* Control */
-    logic tx_buf_write;
+    logic tx_buf_write, tx_buf_push, tx_buf_pop;
 
     assign tx_buf_write = (write_address_i.select == MAC) & (write_address_i.registers == ETH_TX_BUFFER) & write_i;
 
+
+    /* A burst write carries up to 4 bytes (LSB first), the first byte is pushed
+     * in the request cycle and the others one per cycle from the burst register */
+    logic [1:0] tx_burst_left; logic [2:0][7:0] tx_burst_data;
+
+        always_ff @(posedge clk_i `ifdef ASYNC or negedge rst_n_i `endif) begin
+            if (!rst_n_i) begin 
+                tx_burst_left <= '0;
+            end else if (tx_burst_left != '0) begin 
+                tx_burst_left <= tx_burst_left - 1'b1;
+                tx_burst_data <= tx_burst_data >> 8;
+            end else if (tx_buf_write) begin 
+                tx_burst_left <= write_address_i.upper_part;
+                tx_burst_data <= write_data_i[31:8];
+            end 
+        end 
+
+    /* Bytes pushed into a full buffer are dropped */
+    assign tx_buf_push = !tx_buf_full & (tx_buf_write | (tx_burst_left != '0));
+    assign tx_buf_pop = !tx_buf_empty & read_payload_i;
+
     synchronous_buffer #(TX_BUFFER_SIZE, 8) TX_payload_buffer (
         .clk_i   ( clk_i   ),
         .rst_n_i ( rst_n_i ),
 
-        .write_i ( !tx_buf_full & tx_buf_write    ),
-        .read_i  ( !tx_buf_empty & read_payload_i ),
+        .write_i ( tx_buf_push ),
+        .read_i  ( tx_buf_pop  ),
 
         .empty_o ( tx_buf_empty ),
         .full_o  ( tx_buf_full  ),
 
-        .write_data_i ( write_data_i[7:0] ),
-        .read_data_o  ( payload_o         )
+        .write_data_i ( (tx_burst_left != '0) ? tx_burst_data[0] : write_data_i[7:0] ),
+        .read_data_o  ( payload_o                                                    )
     );
 
     assign status_register.TX_payload_full = tx_buf_full;
     assign status_register.TX_payload_empty = tx_buf_empty;
 
 
+    logic [$clog2(TX_BUFFER_SIZE):0] tx_buf_level;
+
+        always_ff @(posedge clk_i `ifdef ASYNC or negedge rst_n_i `endif) begin
+            if (!rst_n_i) begin 
+                tx_buf_level <= '0;
+            end else begin 
+                case ({tx_buf_push, tx_buf_pop})
+                    2'b10: tx_buf_level <= tx_buf_level + 1'b1;
+
+                    2'b01: tx_buf_level <= tx_buf_level - 1'b1;
+                endcase 
+            end 
+        end 
+
+
 //====================================================================================
 //      RX DESCRIPTOR
 //====================================================================================
@@ -230,7 +278,7 @@ module ethernet_registers #(
     /* Control */
     logic rx_descl_read;
 
-    assign rx_descl_read = (read_address_i.select == MAC) & (read_address_i.registers == ETH_RX_DESC_LOW) & read_i;
+    assign rx_descl_read = mac_read & (read_address_i.registers == ETH_RX_DESC_LOW);
 
     synchronous_buffer #(RX_PACKETS, 32) RX_descriptor_low (
         .clk_i   ( clk_i   ),
@@ -253,7 +301,7 @@ module ethernet_registers #(
     /* Control */
     logic rx_desch_read;
 
-    assign rx_desch_read = (read_address_i.select == MAC) & (read_address_i.registers == ETH_RX_DESC_HIGH) & read_i;
+    assign rx_desch_read = mac_read & (read_address_i.registers == ETH_RX_DESC_HIGH);
 
 
     logic [63:0] data_write_rx_buf; assign data_write_rx_buf = {source_address_i, payload_length_i};
@@ -288,16 +336,52 @@ module ethernet_registers #(
     logic rx_buf_empty, rx_buf_full;
 
     /* Control */
-    logic rx_buf_read;
+    logic rx_buf_read, rx_buf_push, rx_buf_pop;
 
     assign rx_buf_read = (read_address_i.select == MAC) & (read_address_i.registers == ETH_RX_BUFFER) & read_i;
 
+
+    /* A burst read pops up to 4 bytes (LSB first), one per cycle. Since the buffer
+     * has one cycle of read latency, each byte is collected the cycle after its pop
+     * and the read is done once the last one is on the output */
+    logic rx_burst_pending, rx_burst_pop; logic [1:0] rx_burst_size, rx_burst_index; logic [31:0] rx_burst_word, rx_burst_data;
+
+        always_ff @(posedge clk_i `ifdef ASYNC or negedge rst_n_i `endif) begin
+            if (!rst_n_i) begin 
+                rx_burst_pending <= 1'b0;
+                rx_burst_size <= '0;
+                rx_burst_index <= '0;
+            end else if (rx_buf_read) begin 
+                rx_burst_pending <= 1'b1;
+                rx_burst_size <= read_address_i.upper_part;
+                rx_burst_index <= '0;
+                rx_burst_word <= '0;
+            end else if (rx_burst_pending) begin 
+                if (rx_burst_index == rx_burst_size) begin
+                    rx_burst_pending <= 1'b0;
+                end else begin
+                    rx_burst_word[rx_burst_index * 8 +: 8] <= rx_payload;
+                    rx_burst_index <= rx_burst_index + 1'b1;
+                end 
+            end 
+        end 
+
+    assign rx_burst_pop = rx_burst_pending & (rx_burst_index != rx_burst_size);
+
+        always_comb begin
+            rx_burst_data = rx_burst_word;
+            rx_burst_data[rx_burst_size * 8 +: 8] = rx_payload;
+        end
+
+    assign rx_buf_push = !rx_buf_full & write_payload_i;
+    assign rx_buf_pop = !rx_buf_empty & (rx_buf_read | rx_burst_pop);
+
     synchronous_buffer #(RX_BUFFER_SIZE, 8) RX_payload_buffer (
         .clk_i   ( clk_i   ),
         .rst_n_i ( rst_n_i ),
 
-        .write_i ( !rx_buf_full & write_payload_i ),
-        .read_i  ( !rx_buf_empty & rx_buf_read    ),
+        .write_i ( rx_buf_push ),
+        .read_i  ( rx_buf_pop  ),
 
         .empty_o ( rx_buf_empty ),
         .full_o  ( rx_buf_full  ),
@@ -310,6 +394,30 @@ module ethernet_registers #(
     assign status_register.RX_payload_empty = rx_buf_empty;
 
 
+    logic [$clog2(RX_BUFFER_SIZE):0] rx_buf_level;
+
+        always_ff @(posedge clk_i `ifdef ASYNC or negedge rst_n_i `endif) begin
+            if (!rst_n_i) begin 
+                rx_buf_level <= '0;
+            end else begin 
+                case ({rx_buf_push, rx_buf_pop})
+                    2'b10: rx_buf_level <= rx_buf_level + 1'b1;
+
+                    2'b01: rx_buf_level <= rx_buf_level - 1'b1;
+                endcase 
+            end 
+        end 
+
+
+    /* Payload FIFO levels, read to size bursts without polling every byte */
+    eth_payload_level_t payload_level;
+
+    assign payload_level.TX_payload_free = TX_BUFFER_SIZE - tx_buf_level;
+    assign payload_level.RX_payload_level = rx_buf_level;
+
+    assign busy_o = (tx_burst_left != '0) | rx_burst_pending;
+
+
 //====================================================================================
 //      INTERRUPT REGISTER
 //====================================================================================
@@ -319,7 +427,7 @@ module ethernet_registers #(
         always_ff @(posedge clk_i `ifdef ASYNC or negedge rst_n_i `endif) begin
             if (!rst_n_i) begin 
                 interrupt_register <= '0;
-            end else if ((write_address_i.select == MAC) & (write_address_i.registers == ETH_INTERRUPT) & write_i) begin 
+            end else if (mac_write & (write_address_i.registers == ETH_INTERRUPT)) begin 
                 interrupt_register <= '0;
             end else begin 
                 if (rx_error_i & status_register.interrupt_enable[3]) begin
@@ -384,16 +492,16 @@ module ethernet_registers #(
 
             if (smii_done_i) begin
                 data_o = {'0, smii_data_i};
+            end else if (rx_burst_pending) begin
+                data_o = rx_burst_data;
             end else begin 
                 case (read_address_i.registers)
-                    ETH_MAC_STATUS: data_o = {'0, status_register};
+                    ETH_MAC_STATUS: data_o = (read_address_i.upper_part == 2'b01) ? payload_level : {'0, status_register};
 
                     ETH_RX_DESC_LOW: data_o = {'0, rx_descriptor[31:0]};
 
                     ETH_RX_DESC_HIGH: data_o = {'0, rx_descriptor[63:32]};
 
-                    ETH_RX_BUFFER: data_o = {'0, rx_payload};
-
                     ETH_INTERRUPT: data_o = {'0, interrupt_register};
                 endcase 
             end 
@@ -431,7 +539,7 @@ module ethernet_registers #(
             if (!rst_n_i) begin 
                 read_delay <= 1'b0;
             end else begin 
-                read_delay <= read_i & (read_address_i.registers >= ETH_RX_DESC_LOW) & (read_address_i.registers <= ETH_RX_BUFFER);
+                read_delay <= read_i & (read_address_i.registers >= ETH_RX_DESC_LOW) & (read_address_i.registers <= ETH_RX_DESC_HIGH);
             end 
         end 
 
@@ -439,17 +547,22 @@ module ethernet_registers #(
         always_comb begin
             if (write_wait) begin
                 write_done_o = smii_done_i;
+            end else if (tx_burst_left != '0) begin
+                /* Last byte of a burst */
+                write_done_o = tx_burst_left == 2'b01;
             end else begin
-                write_done_o = (write_address_i.select == MAC) & write_i;
+                write_done_o = (write_address_i.select == MAC) & write_i & !(tx_buf_write & (write_address_i.upper_part != '0));
             end
 
             if (read_wait) begin
                 read_done_o = smii_done_i;
+            end else if (rx_burst_pending) begin
+                read_done_o = rx_burst_index == rx_burst_size;
             end else begin
-                if ((read_address_i.registers >= ETH_RX_DESC_LOW) & (read_address_i.registers <= ETH_RX_BUFFER)) begin
+                if ((read_address_i.registers >= ETH_RX_DESC_LOW) & (read_address_i.registers <= ETH_RX_DESC_HIGH)) begin
                     read_done_o = read_delay & (read_address_i.select == MAC);
                 end else begin 
-                    read_done_o = read_i & (read_address_i.select == MAC);
+                    read_done_o = read_i & (read_address_i.select == MAC) & !rx_buf_read;
                 end 
             end
         end
@@ -59,7 +59,7 @@ module sd (
     logic sd_card_detect; 
     logic sd_reset; 
     logic enable;
-    logic clock_speed;
+    logic [1:0] clock_speed;
     logic bus_width;
     logic reset_done;
 
@@ -75,11 +75,11 @@ module sd (
 
     /* Data signals */
     logic [3:0][7:0] data_tx;
-    logic data_tx_empty, data_rx_full;
+    logic data_tx_empty, data_tx_full, data_rx_full;
     logic data_buffer_tx_read, data_tx_read;
     logic [3:0][7:0] data_rx;
     logic data_buffer_rx_write;
-    logic data_idle;
+    logic data_idle, data_wait_tx;
     logic data_timeout, data_crc_error, data_error, data_timeout_ff, data_crc_error_ff, data_error_ff;
 
     /* Control from Command to Data */
@@ -141,11 +141,13 @@ module sd (
 
         .data_tx_data_o     ( data_tx              ),
         .data_tx_empty_o    ( data_tx_empty        ),
+        .data_tx_full_o     ( data_tx_full         ),
         .data_tx_read_i     ( data_buffer_tx_read  ),
         .data_rx_full_o     ( data_rx_full         ),
         .data_rx_data_i     ( data_rx              ),
         .data_rx_valid_i    ( data_buffer_rx_write ),
         .data_idle_i        ( data_idle            ),
+        .data_wait_tx_i     ( data_wait_tx         ),
         .data_timeout_i     ( data_timeout_ff      ),
         .data_crc_error_i   ( data_crc_error_ff    ),
         .data_error_i       ( data_error_ff        )
@@ -203,10 +205,17 @@ module sd (
 
     localparam FREQ_400KHZ = 125;
     localparam FREQ_25MHZ = 2;
+    localparam FREQ_50MHZ = 1;
 
     logic [7:0] divisor, counter; logic clk_previous, sd_clk;
 
-    assign divisor = clock_speed ? (FREQ_25MHZ - 1) : (FREQ_400KHZ - 1);
+    always_comb begin
+        case (clock_speed)
+            2'b00: divisor = FREQ_400KHZ - 1;
+            2'b01: divisor = FREQ_25MHZ - 1;
+            default: divisor = FREQ_50MHZ - 1;
+        endcase
+    end
 
     always_ff @(posedge clk_i) begin
         if (!rst_n_i) begin
@@ -227,9 +236,23 @@ module sd (
     end 
 
 
-    logic shift, sample;
+    /* At 400kHz and 25MHz shift follows the falling edge and sample the
+     * rising edge of the SD clock, the controllers use the lines directly.
+     *
+     * In High-Speed mode the clock period is two system cycles and the card
+     * drives the next bit up to 14ns after the rising edge:
+     *
+     *  - shift updates the FSMs one cycle before the falling edge, their
+     *    output registers change with it, half a period before the card
+     *    samples on the rising edge.
+     *
+     *  - sample comes one cycle after the rising edge, the controllers use
+     *    their input registers that hold the lines captured on it. */
+    logic shift, sample, high_speed;
+
+    assign high_speed = clock_speed[1];
 
-    assign shift = !sd_clk & clk_previous;
+    assign shift = high_speed ? (enable & !sd_clk) : (!sd_clk & clk_previous);
     assign sample = sd_clk & !clk_previous;
 
     assign sd_clk_o = sd_clk;
@@ -317,6 +340,8 @@ module sd (
         .shift_i  ( shift  ),
         .sample_i ( sample ),
 
+        .high_speed_i ( high_speed ),
+
         .cmd_valid_i    ( send_command ),
         .cmd_number_i   ( cmd_number   ),
         .cmd_argument_i ( cmd_argument ),
@@ -351,8 +376,11 @@ module sd (
         .shift_i  ( shift  ),
         .sample_i ( sample ),
 
+        .high_speed_i ( high_speed ),
+
         .tx_data_i  ( tx_data_byte  ),
         .tx_read_o  ( data_tx_read  ),
+        .tx_ready_i ( data_tx_full  ),
 
         .rx_full_i  ( data_rx_full  ),
         .rx_data_o  ( data_received ),
@@ -366,6 +394,7 @@ module sd (
         .data_length_i ( data_length    ),
 
         .idle_o      ( data_idle      ),
+        .wait_tx_o   ( data_wait_tx   ),
         .timeout_o   ( data_timeout   ),
         .crc_error_o ( data_crc_error ),
         .error_o     ( data_error     ),
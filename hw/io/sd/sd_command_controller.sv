@@ -7,6 +7,7 @@ module sd_command_controller (
     input logic enable_i,
     input logic shift_i, /* Negedge */
     input logic sample_i, /* Posedge */
+    input logic high_speed_i, /* Use the registered input lines */
 
     /* Command Interface */
     input logic cmd_valid_i,
@@ -146,6 +147,18 @@ module sd_command_controller (
     assign idle_o = (state_CRT == IDLE);
 
 
+    /* Input SD command line, registered on every clock: in High-Speed
+     * mode on sample_i it holds the value of the SD clock rising edge */
+    logic cmd_sampled;
+
+        always_ff @(posedge clk_i) begin
+            cmd_sampled <= sd_cmd_io;
+        end
+
+    logic cmd_input;
+
+    assign cmd_input = high_speed_i ? cmd_sampled : sd_cmd_io;
+
     /* Output SD command line */
     logic tristate_enable, cmd_bit;
 
@@ -354,19 +367,19 @@ module sd_command_controller (
                     end
 
                     if (sample_i) begin
-                        if (sd_cmd_io == 1'b0) begin
+                        if (cmd_input == 1'b0) begin
                             /* Response initiated */
                             state_NXT = RESP_DIR;
 
                             /* Shift in most significant bit */
-                            resp_NXT = {resp_CRT[6:0], sd_cmd_io};
+                            resp_NXT = {resp_CRT[6:0], cmd_input};
 
                             timeout_reset = 1'b1;
                             bit_increment = 1'b1;
 
                             /* Start computing CRC7 */
                             crc7_compute = 1'b1;
-                            crc7_data = sd_cmd_io;
+                            crc7_data = cmd_input;
                         end
                     end
                 end
@@ -381,12 +394,12 @@ module sd_command_controller (
                         state_NXT = rcv136_CRT ? RCV136 : RCV48;
 
                         /* Shift in most significant bit */
-                        resp_NXT = {resp_CRT[6:0], sd_cmd_io};
+                        resp_NXT = {resp_CRT[6:0], cmd_input};
 
                         bit_increment = 1'b1;
 
                         crc7_compute = 1'b1;
-                        crc7_data = sd_cmd_io;
+                        crc7_data = cmd_input;
                     end
                 end
 
@@ -398,16 +411,16 @@ module sd_command_controller (
 
                     if (sample_i) begin
                         /* Shift in most significant bit */
-                        resp_NXT = {resp_CRT[6:0], sd_cmd_io};
+                        resp_NXT = {resp_CRT[6:0], cmd_input};
 
                         /* Keep shifting in this register and validate it at the end */
-                        crc7_NXT = {crc7_CRT[5:0], sd_cmd_io};
+                        crc7_NXT = {crc7_CRT[5:0], cmd_input};
 
                         bit_increment = 1'b1;
 
                         /* Don't compute CRC on CRC reception */
                         crc7_compute = bit_counter < 'd40;
-                        crc7_data = sd_cmd_io;
+                        crc7_data = cmd_input;
 
                         /* Once 8 bits have been received write the byte */
                         if (bit_counter[2:0] == 3'd7) begin
@@ -440,15 +453,15 @@ module sd_command_controller (
 
                     if (sample_i) begin
                         /* Shift in most significant bit */
-                        resp_NXT = {resp_CRT[6:0], sd_cmd_io};
+                        resp_NXT = {resp_CRT[6:0], cmd_input};
 
                         bit_increment = 1'b1;
 
                         crc7_compute = (bit_counter < 'd128) & (bit_counter >= 'd8);
-                        crc7_data = sd_cmd_io;
+                        crc7_data = cmd_input;
 
                         if ((bit_counter >= 8'd128) && (bit_counter <  8'd135)) begin
-                            crc7_NXT = {crc7_CRT[5:0], sd_cmd_io};
+                            crc7_NXT = {crc7_CRT[5:0], cmd_input};
                         end
 
 
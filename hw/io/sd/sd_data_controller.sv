@@ -7,10 +7,12 @@ module sd_data_controller (
     input logic enable_i,
     input logic shift_i, /* Negedge */
     input logic sample_i, /* Posedge */
+    input logic high_speed_i, /* Use the registered input lines */
 
     /* Data Interface */
     input logic [7:0] tx_data_i,
     output logic tx_read_o,
+    input logic tx_ready_i, /* A whole block is buffered */
     
     input logic rx_full_i,
     output logic [7:0] rx_data_o,
@@ -26,6 +28,7 @@ module sd_data_controller (
 
     /* Status */
     output logic idle_o,
+    output logic wait_tx_o,
     output logic timeout_o,
     output logic crc_error_o, 
     output logic error_o, 
@@ -146,6 +149,21 @@ module sd_data_controller (
 
     assign idle_o = (state_CRT == IDLE);
 
+    /* Write stalled until the next block is buffered */
+    assign wait_tx_o = (state_CRT == WAIT_TX) & !tx_ready_i;
+
+    /* Input SD data lines, registered on every clock: in High-Speed
+     * mode on sample_i they hold the value of the SD clock rising edge */
+    logic [3:0] data_sampled;
+
+        always_ff @(posedge clk_i) begin
+            data_sampled <= sd_data_io;
+        end
+
+    logic [3:0] data_input;
+
+    assign data_input = high_speed_i ? data_sampled : sd_data_io;
+
     /* Output SD data line */
     logic tristate_enable; logic [3:0] data_line;
 
@@ -205,21 +223,21 @@ module sd_data_controller (
                     /* Wait for the data to be received (start bit) */
                     if (sample_i) begin
                         if (wide_bus_i) begin
-                            if (sd_data_io == '0) begin
+                            if (data_input == '0) begin
                                 state_NXT = RCV_DATA;
 
                                 timeout_reset = 1'b1;
 
-                                crc16_data = sd_data_io;
+                                crc16_data = data_input;
                                 crc16_compute = 1'b1;
                             end
                         end else begin
-                            if (sd_data_io[0] == 1'b0) begin
+                            if (data_input[0] == 1'b0) begin
                                 state_NXT = RCV_DATA;
 
                                 timeout_reset = 1'b1;
 
-                                crc16_data = sd_data_io;
+                                crc16_data = data_input;
                                 crc16_compute = 1'b1;
                             end
                         end
@@ -244,7 +262,7 @@ module sd_data_controller (
                     if (sample_i) begin
                         if (wide_bus_i) begin
                             /* Shift nibble in */
-                            data_NXT = {data_CRT[3:0], sd_data_io};
+                            data_NXT = {data_CRT[3:0], data_input};
 
                             if (bit_counter == ((data_length_CRT / 4) - 1)) begin
                                 state_NXT = RCV_CRC;
@@ -259,7 +277,7 @@ module sd_data_controller (
                             end
                         end else begin
                             /* Shift bit in */
-                            data_NXT = {data_CRT[6:0], sd_data_io[0]};
+                            data_NXT = {data_CRT[6:0], data_input[0]};
 
                             if (bit_counter == data_length_CRT - 1'b1) begin
                                 state_NXT = RCV_CRC;
@@ -273,7 +291,7 @@ module sd_data_controller (
                             end
                         end
 
-                        crc16_data = sd_data_io;
+                        crc16_data = data_input;
                         crc16_compute = 1'b1;
 
                         bit_increment = 1'b1;
@@ -290,11 +308,11 @@ module sd_data_controller (
                         if (wide_bus_i) begin
                             /* Shift nibble in */
                             for (int i = 0; i < 4; ++i) begin
-                                crc16_wide_NXT[i] = {crc16_wide_CRT[i][14:0], sd_data_io[i]};
+                                crc16_wide_NXT[i] = {crc16_wide_CRT[i][14:0], data_input[i]};
                             end
                         end else begin
                             /* Shift bit in */
-                            crc16_NXT = {crc16_CRT[14:0], sd_data_io[0]};
+                            crc16_NXT = {crc16_CRT[14:0], data_input[0]};
                         end
 
                         bit_increment = 1'b1;
@@ -336,7 +354,10 @@ module sd_data_controller (
                 end
 
                 WAIT_TX: begin
-                    if (shift_i) begin
+                    /* The host can delay the start bit of a block as long as 
+                     * it needs, start only once the whole block is buffered 
+                     * so that a slow producer never underruns the transfer */
+                    if (shift_i & tx_ready_i) begin
                         /* Wait for the clock pulse to send the data */
                         state_NXT = START_BIT;
 
@@ -507,7 +528,7 @@ module sd_data_controller (
                 end
 
                 WAIT_TOKEN: begin
-                    if (sample_i & !sd_data_io[0]) begin
+                    if (sample_i & !data_input[0]) begin
                         data_NXT = '0;
 
                         bit_reset = 1'b1;
@@ -528,7 +549,7 @@ module sd_data_controller (
                     tristate_enable = 1'b0;
 
                     if (sample_i) begin
-                        data_NXT = {data_CRT[6:0], sd_data_io[0]};
+                        data_NXT = {data_CRT[6:0], data_input[0]};
 
                         /* We already stored the first token bit in WAIT_TOKEN (1'b0).
                          * Now we need 4 more samples. At bit_counter == 3, data_NXT[4:0] contains:
@@ -556,7 +577,7 @@ module sd_data_controller (
                     /* Wait for the card to send stop bit */
                     if (sample_i) begin
                         /* Wait until the card is not busy anymore (bit is high) */
-                        if (sd_data_io[0] == 1'b1) begin
+                        if (data_input[0] == 1'b1) begin
                             state_NXT = burst_i ? RECOVERY_CYCLE : IDLE;
 
                             timeout_reset = 1'b1;
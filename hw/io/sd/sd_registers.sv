@@ -30,7 +30,7 @@ module sd_registers #(
     input logic reset_done_i,
     output logic reset_card_o,
     output logic enable_o,
-    output logic clock_speed_o,
+    output logic [1:0] clock_speed_o,
     output logic bus_width_o,
 
     /* Command FSM */
@@ -47,11 +47,13 @@ module sd_registers #(
     /* Data FSM */
     output logic [31:0] data_tx_data_o,
     output logic data_tx_empty_o,
+    output logic data_tx_full_o,
     input logic data_tx_read_i,
     output logic data_rx_full_o,
     input logic [31:0] data_rx_data_i,
     input logic data_rx_valid_i,
     input logic data_idle_i,
+    input logic data_wait_tx_i,
     input logic data_timeout_i,
     input logic data_crc_error_i,
     input logic data_error_i
@@ -90,7 +92,7 @@ module sd_registers #(
                 control_register.enable <= 1'b0;
 
                 /* 400kHz and 1 bit bus width */
-                control_register.clock_speed <= 1'b0;
+                control_register.clock_speed <= '0;
                 control_register.bus_width <= 1'b0;
 
                 control_register.flush_tx <= 1'b0;
@@ -191,6 +193,7 @@ module sd_registers #(
 
                     /* Data Status */
                     status_register.data_idle <= data_idle_i;
+                    status_register.data_wait_tx <= data_wait_tx_i;
 
                     if (data_crc_error_i) begin
                         status_register.data_crc_error <= 1'b1;
@@ -342,6 +345,7 @@ module sd_registers #(
     );
 
     assign data_tx_empty_o = tx_buffer_empty;
+    assign data_tx_full_o = tx_buffer_full;
 
 
 //====================================================================================
@@ -30,7 +30,11 @@ package ethernet_pkg;
         /* Select registers of PHY or MAC */
         logic select;
 
-        /* Upper part of register address (used in PHY) */
+        /* Upper part of register address (used in PHY). On the MAC payload buffers
+         * it selects the number of bytes moved minus one (burst access), on the MAC
+         * status register a value of 1 reads the payload FIFO levels. The size is
+         * in the address because reads carry no byte enable, writes use the same
+         * encoding so the MAC doesn't need the bus write strobe */
         logic [1:0] upper_part;
         
         /* Lower part of register address (used in PHY and MAC) */
@@ -70,6 +74,15 @@ package ethernet_pkg;
     } eth_status_t;
 
 
+    typedef struct packed {
+        /* Bytes waiting in the RX payload FIFO */
+        logic [15:0] RX_payload_level;
+
+        /* Free entries in the TX payload FIFO */
+        logic [15:0] TX_payload_free;
+    } eth_payload_level_t;
+
+
     typedef struct packed {
         /* 48 bit MAC address */
         logic [5:0][7:0] mac_address;
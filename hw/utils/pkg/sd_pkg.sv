@@ -23,7 +23,7 @@ package sd_pkg;
         /* Flush TX Buffer */
         logic flush_tx;
 
-        logic clock_speed; /* 0 = 400kHz, 1 = 25MHz */
+        logic [1:0] clock_speed; /* 0 = 400kHz, 1 = 25MHz, 2 = 50MHz */
         logic bus_width;   /* 0 = 1 bit, 1 = 4 bit  */
 
         /* Activate CMD FSM */
@@ -35,6 +35,9 @@ package sd_pkg;
 
     /* SD Status Register */
     typedef struct packed {
+        /* Write waiting for the next block in the TX buffer */
+        logic data_wait_tx;
+
         logic card_detected;
 
         logic tx_buffer_empty;
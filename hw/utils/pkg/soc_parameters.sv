@@ -128,7 +128,7 @@ package soc_parameters;
     localparam ETH_TX_PACKETS = 16;
 
     /* Memory mapped registers */
-    localparam ETH_DEVICE_SPACE = 40;
+    localparam ETH_DEVICE_SPACE = 64;
 
     /* Ethernet MAC MMIO address */
     localparam ETH_BASE_ADDRESS = SPI_BASE_ADDRESS + 2**13;
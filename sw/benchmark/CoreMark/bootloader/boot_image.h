@@ -0,0 +1,56 @@
+#ifndef BOOT_IMAGE_H
+#define BOOT_IMAGE_H
+
+#include <inttypes.h>
+
+/*
+ *  SD boot image layout, produced by tools/mkimage.py from the application
+ *  ELF. Block 0 holds the header, every loadable segment starts on its own
+ *  block boundary so it can be streamed with a multi-block read straight to
+ *  its load address. All fields are little endian.
+ *
+ *  A segment is stored LZ4 compressed (block format, sw/lib/LZ4.h) when its
+ *  stored size is smaller than its size.
+ *
+ *  CRC32 is the IEEE 802.3 / zlib one (reflected, polynomial 0xEDB88320).
+ */
+
+#define BOOT_IMAGE_MAGIC     0x544F425A     /* "ZBOT" */
+#define BOOT_IMAGE_VERSION   2
+#define BOOT_MAX_SEGMENTS    24
+
+struct bootSegment_s {
+    /* Destination in DDR, word aligned */
+    uint32_t loadAddress;
+
+    /* Bytes loaded (the ELF file size, BSS is cleared by the application) */
+    uint32_t size;
+
+    /* First block of the segment, relative to the header block */
+    uint32_t block;
+
+    /* Bytes stored in the image, less than size if compressed */
+    uint32_t storedSize;
+
+    /* CRC32 of the segment bytes (uncompressed) */
+    uint32_t crc32;
+};
+
+struct bootHeader_s {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t segmentCount;
+    uint32_t entry;
+
+    /* Reserved, must be zero */
+    uint32_t flags;
+
+    struct bootSegment_s segment[BOOT_MAX_SEGMENTS];
+
+    /* CRC32 of every byte above */
+    uint32_t headerCrc;
+};
+
+static_assert(sizeof(struct bootHeader_s) <= 512, "boot header must fit a block");
+
+#endif
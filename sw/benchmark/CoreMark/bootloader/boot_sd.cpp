@@ -1,12 +1,17 @@
 #include "../../../lib/driver/SD.h"
 #include "../../../lib/driver/UART.h"
+#include "../../../lib/LZ4.h"
+
+#include "boot_image.h"
 
 #define IMG_BLK_START  0x2000       /* Start SD block */
-#ifndef IMG_BLOCKS
-#define IMG_BLOCKS     64           /* Default: 32 KiB application image */
-#endif
-#define DDR_ENTRY      0x80000000
-#define DDR_PACE_CYCLES 2048
+#define DDR_BASE       0x80000000
+#define DDR_END        0x88000000   /* Application stack top */
+#define BURST_BLOCKS   128          /* Blocks per CMD18 burst (64 KiB, one progress dot) */
+
+static void sendString(UART& uart, const char* string) {
+    for (const char *c = string; *c != '\0'; ++c) { uart.sendByte((uint8_t) *c); }
+}
 
 static void sendHexNibble(UART& uart, uint8_t value) {
     value &= 0x0F;
@@ -19,6 +24,87 @@ static void sendHexWord(UART& uart, uint32_t value) {
     }
 }
 
+static void bootFail(UART& uart, const char* message) {
+    sendString(uart, message);
+
+    while (1) {  }
+}
+
+/* CRC32 (zlib), a nibble table keeps the ROM footprint at 64 bytes */
+static uint32_t crc32(const uint8_t* data, uint32_t length) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < length; ++i) {
+        crc = (crc >> 4) ^ table[(crc ^ data[i]) & 0x0F];
+        crc = (crc >> 4) ^ table[(crc ^ (data[i] >> 4)) & 0x0F];
+    }
+
+    return ~crc;
+}
+
+/* SDHC = block address, SDSC = byte address */
+static uint32_t cardAddress(uint32_t block, bool highCap) {
+    return highCap ? (IMG_BLK_START + block) : ((IMG_BLK_START + block) * 512);
+}
+
+static uint32_t readCycles() {
+    uint32_t cycles;
+
+    asm volatile ("csrr %0, mcycle" : "=r" (cycles));
+
+    return cycles;
+}
+
+/* Stream the whole blocks with CMD18 directly to the destination, the last
+ * partial block goes through a buffer so nothing past the size is written */
+static bool loadBlocks(SD& card, UART& uart, uint32_t* destination, uint32_t block, uint32_t size, bool highCap) {
+    SD::errorType_e err = SD::NO_ERROR;
+
+    uint32_t blocks = size / 512;
+
+    while (blocks != 0) {
+        uint32_t burst = (blocks < BURST_BLOCKS) ? blocks : BURST_BLOCKS;
+
+        card.readBurst(cardAddress(block, highCap), burst, destination, nullptr, err);
+
+        if (err != SD::NO_ERROR) {
+            return false;
+        }
+
+        destination += burst * 128;
+        block += burst;
+        blocks -= burst;
+
+        uart.sendByte('.');
+    }
+
+    uint32_t tail = size % 512;
+
+    if (tail != 0) {
+        uint32_t buffer[128];
+
+        card.readBlock(cardAddress(block, highCap), buffer, nullptr, err);
+
+        if (err != SD::NO_ERROR) {
+            return false;
+        }
+
+        const uint8_t* source = (const uint8_t *) buffer;
+        uint8_t* bytes = (uint8_t *) destination;
+
+        for (uint32_t i = 0; i < tail; ++i) {
+            bytes[i] = source[i];
+        }
+    }
+
+    return true;
+}
+
 extern "C" void boot_sd() {
     /* UART for logging */
     UART uart(0);
@@ -33,7 +119,8 @@ extern "C" void boot_sd() {
 
     SD card;
 
-    card.init(SD::CLK_25MHZ, SD::BUS_WIDE, cmd8, highCap, err);
+    /* Falls back to 25 MHz if the card doesn't support High-Speed or the switch fails */
+    card.init(SD::CLK_50MHZ, SD::BUS_WIDE, cmd8, highCap, err);
 
     if (err == SD::NO_CARD) {
         const char msg_init_fail[] = "[BOOT] No card detected!\r\n";
@@ -86,40 +173,90 @@ extern "C" void boot_sd() {
         for (const char *c = msg_cap; *c != '\0'; ++c) { uart.sendByte((uint8_t) *c); }
     }
 
-    /* DDR */
-    volatile uint32_t* ddr = (volatile uint32_t*) DDR_ENTRY;
+    /* Image header */
+    union {
+        uint32_t words[128];
+        struct bootHeader_s fields;
+    } header;
+
+    err = SD::NO_ERROR;
+    card.readBlock(cardAddress(0, highCap), header.words, nullptr, err);
+
+    if (err != SD::NO_ERROR) {
+        bootFail(uart, "[BOOT] Fail reading image header\r\n");
+    }
+
+    if (header.fields.magic != BOOT_IMAGE_MAGIC || header.fields.version != BOOT_IMAGE_VERSION) {
+        bootFail(uart, "[BOOT] No boot image (build it with tools/mkimage.py)\r\n");
+    }
 
-    /* Build address, SDHC = block address, SDSC = byte address */
-    uint32_t addr = highCap ? IMG_BLK_START : (IMG_BLK_START * 512);
+    if (header.fields.segmentCount > BOOT_MAX_SEGMENTS ||
+        crc32((const uint8_t *) &header.fields, sizeof(struct bootHeader_s) - 4) != header.fields.headerCrc) {
+        bootFail(uart, "[BOOT] Corrupted image header\r\n");
+    }
 
+    uint32_t startCycles = readCycles();
 
-    const char msg_load[] = "[BOOT] Loading";
-    for (const char *c = msg_load; *c != '\0'; ++c) { uart.sendByte((uint8_t) *c); }
+    for (int i = 0; i < header.fields.segmentCount; ++i) {
+        const struct bootSegment_s& segment = header.fields.segment[i];
 
-    for (int blk = 0; blk < IMG_BLOCKS; ++blk) {
-        err = SD::NO_ERROR;
+        sendString(uart, "[BOOT] Loading 0x");
+        sendHexWord(uart, segment.size);
+        sendString(uart, " bytes @ 0x");
+        sendHexWord(uart, segment.loadAddress);
 
-        uint32_t blkAddr = highCap ? (addr + blk) : (addr + (blk * 512));
-        card.readBlock(blkAddr, (uint32_t *) &ddr[128 * blk], nullptr, err);
+        if ((segment.loadAddress & 3) != 0 || segment.loadAddress < DDR_BASE || segment.size > (DDR_END - segment.loadAddress) ||
+            segment.storedSize > segment.size) {
+            bootFail(uart, "\r\n[BOOT] Invalid segment!\r\n");
+        }
 
-        if (err != SD::NO_ERROR) {
-            const char msg_fail_blk[] = "\n[BOOT] Fail reading block\r\n";
-            for (const char *c = msg_fail_blk; *c != '\0'; ++c) { uart.sendByte((uint8_t) *c); }
+        if (segment.storedSize == segment.size) {
+            if (!loadBlocks(card, uart, (uint32_t *) segment.loadAddress, segment.block, segment.size, highCap)) {
+                bootFail(uart, "\r\n[BOOT] Fail reading segment\r\n");
+            }
+        } else {
+            /* The SD FIFO has no flow control, the CPU can't expand the data while a
+             * burst is running: stage the compressed blocks at the top of DDR first */
+            uint32_t stagingSize = (segment.storedSize + 511) & ~511;
+            uint32_t staging = DDR_END - stagingSize;
 
-            while (1) {  }
+            if (staging < segment.loadAddress + segment.size) {
+                bootFail(uart, "\r\n[BOOT] No room to stage compressed segment!\r\n");
+            }
+
+            if (!loadBlocks(card, uart, (uint32_t *) staging, segment.block, stagingSize, highCap)) {
+                bootFail(uart, "\r\n[BOOT] Fail reading segment\r\n");
+            }
+
+            int32_t expanded = LZ4::decompress((const uint8_t *) staging, segment.storedSize, (uint8_t *) segment.loadAddress, segment.size);
+
+            if (expanded != (int32_t) segment.size) {
+                bootFail(uart, "\r\n[BOOT] Corrupted compressed segment!\r\n");
+            }
+
+            sendString(uart, " LZ4");
         }
 
-        if ((blk & 7) == 7) { uart.sendByte('.'); }
+        if (crc32((const uint8_t *) segment.loadAddress, segment.size) != segment.crc32) {
+            bootFail(uart, "\r\n[BOOT] Segment CRC mismatch!\r\n");
+        }
+
+        sendString(uart, " OK\r\n");
     }
 
-    uart.sendByte('\r');
-    uart.sendByte('\n');
+    /* Load, decompression and CRC, UART logging included */
+    uint32_t loadCycles = readCycles() - startCycles;
+
+    sendString(uart, "[BOOT] Loaded in 0x");
+    sendHexWord(uart, loadCycles);
+    sendString(uart, " cycles\r\n");
 
-    const char msg_boot_end[] = "[BOOT] Image loaded! Jumping to CoreMark benchmark...\r\n";
-    for (const char *c = msg_boot_end; *c != '\0'; ++c) { uart.sendByte((uint8_t) *c); }
+    sendString(uart, "[BOOT] Image verified! Jumping to 0x");
+    sendHexWord(uart, header.fields.entry);
+    sendString(uart, "\r\n");
 
     /* Write back dirty cache lines, invalidate both caches, then transfer
      * control without executing any further C code. */
-    asm volatile ("fence rw, rw\n\tjr %0" :: "r" (DDR_ENTRY) : "memory");
+    asm volatile ("fence rw, rw\n\tjr %0" :: "r" (header.fields.entry) : "memory");
     __builtin_unreachable();
 };
\ No newline at end of file
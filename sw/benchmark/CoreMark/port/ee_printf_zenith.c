@@ -20,6 +20,8 @@ limitations under the License.
 #include <stdarg.h>
 #include <stdint.h>
 
+#include "Format.h"
+
 #define ZEROPAD   (1 << 0) /* Pad with zero */
 #define SIGN      (1 << 1) /* Unsigned/signed long */
 #define PLUS      (1 << 2) /* Show plus */
@@ -96,16 +98,49 @@ number(char *str, long num, int base, int size, int precision, int type)
             size--;
     }
 
-    i = 0;
+    /* Digits in tmp, most significant first */
+    if (base == 10)
+        i = formatUnsigned32(tmp, (unsigned long)num);
+    else if ((base & (base - 1)) == 0)
+    {
+        /* Power of two: shifts, no division */
+        int           shift = 0;
+        unsigned long rest  = (unsigned long)num;
+
+        while ((1 << shift) < base)
+            shift++;
 
-    if (num == 0)
-        tmp[i++] = '0';
+        i = 0;
+        do
+        {
+            ++i;
+            rest >>= shift;
+        } while (rest != 0);
+
+        rest = (unsigned long)num;
+        for (int j = i - 1; j >= 0; j--)
+        {
+            tmp[j] = dig[rest & (base - 1)];
+            rest >>= shift;
+        }
+    }
     else
     {
-        while (num != 0)
+        unsigned long rest = (unsigned long)num;
+        int           j;
+
+        i = 0;
+        do
         {
-            tmp[i++] = dig[((unsigned long)num) % (unsigned)base];
-            num      = ((unsigned long)num) / (unsigned)base;
+            tmp[i++] = dig[rest % (unsigned)base];
+            rest /= (unsigned)base;
+        } while (rest != 0);
+
+        for (j = 0; j < i / 2; j++)
+        {
+            char swap      = tmp[j];
+            tmp[j]         = tmp[i - 1 - j];
+            tmp[i - 1 - j] = swap;
         }
     }
 
@@ -134,8 +169,8 @@ number(char *str, long num, int base, int size, int precision, int type)
             *str++ = c;
     while (i < precision--)
         *str++ = '0';
-    while (i-- > 0)
-        *str++ = tmp[i];
+    for (int j = 0; j < i; j++)
+        *str++ = tmp[j];
     while (size-- > 0)
         *str++ = ' ';
 
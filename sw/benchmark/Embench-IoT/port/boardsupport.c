@@ -2,6 +2,8 @@
 #include <stdarg.h>
 #include "boardsupport.h"
 
+#include "../../../lib/platform.h"
+
 volatile uint64_t embench_start_cycle = 0;
 volatile uint64_t embench_stop_cycle  = 0;
 volatile uint64_t embench_cycles      = 0;
@@ -19,6 +21,23 @@ static void uart_putc(char c) {
     *txbuf = c;
 }
 
+/* Wait for the last byte to leave the line, the run can be stopped right after */
+static void uart_flush(void) {
+    volatile struct uartCtrlStatus_s* status = (volatile struct uartCtrlStatus_s*) (UART_BASE);
+
+    while (!status->emptyTX) {
+        /* wait */
+    }
+
+    /* One frame for the shift register, every iteration takes at least
+     * one clock cycle */
+    uint32_t frameCycles = UART_FRAME_BITS * 16 * (status->clockDivider + 1);
+
+    for (volatile uint32_t i = 0; i < frameCycles; ++i) {
+        /* wait */
+    }
+}
+
 static void uart_puts(const char* s) {
     while (*s) {
         if (*s == '\n') {
@@ -111,5 +130,7 @@ void stop_trigger(void) {
     uart_puts("         ENDING BENCHMARK\n"            );
     uart_puts("===================================\n\n");
 
+    uart_flush();
+
     __asm__ volatile ("" ::: "memory");
 }
\ No newline at end of file
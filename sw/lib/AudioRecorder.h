@@ -0,0 +1,221 @@
+#ifndef AUDIO_RECORDER_H
+#define AUDIO_RECORDER_H
+
+#include <inttypes.h>
+
+#include "driver/AudioCapture.h"
+#include "driver/SD.h"
+
+#include "platform.h"
+
+
+/*
+ *  Records the AudioCapture samples straight to the SD card, the recording
+ *  length is bounded by the card and not by the memory.
+ *
+ *  Samples are packed into a ring of RECORDER_BUFFERS blocks in RAM as signed
+ *  16 bit little endian PCM (channels interleaved as they come out of the
+ *  capture buffer). Every full block is queued to an open ended CMD25 write,
+ *  the card is pre-erased with ACMD23 for the RECORDER_SEGMENT_BLOCKS of the
+ *  stream. At the end of a segment the stream is closed and the index block
+ *  (the block before the data) is updated with the number of blocks written,
+ *  a recording cut by a power loss is recovered up to the last segment.
+ *
+ *  poll() sends at most one block per call and never waits for the card to
+ *  program: the busy time after a block, a segment or the index is polled
+ *  through the TX buffer state and CMD13. The commands it issues (ACMD23,
+ *  CMD25, CMD12, CMD13, CMD24) still wait for their response, a few
+ *  microseconds at 25 MHz. It must be called from the main loop more often
+ *  than a block fills up (256 samples, ~5 ms at 48 kHz mono). The RAM ring
+ *  covers the card busy time and the segment switch.
+ */
+class AudioRecorder {
+
+public:
+
+    /* Function errors */
+    enum recorderError_e { NO_ERROR, SD_ERROR, NOT_RECORDING, ILLEGAL_ARGUMENTS, NO_INDEX };
+
+    /* Index block identifier ("ZREC") */
+    static const uint32_t INDEX_MAGIC = 0x4345525A;
+
+    /* Recording state saved in the index */
+    enum indexState_e { RECORDING = 1, CLOSED = 2 };
+
+
+    /* Index block content, little endian */
+    struct recorderIndex_s {
+        uint32_t magic;
+        uint32_t state;
+        uint32_t sampleRate;
+        uint32_t channels;
+
+        /* First data block, right after the index */
+        uint32_t firstBlock;
+
+        /* Data blocks written to the card */
+        uint32_t blocks;
+
+        /* Samples of the recording (CLOSED only), the last block is zero padded */
+        uint32_t samples;
+
+        /* Incremented at every update */
+        uint32_t sequence;
+
+        /* Sum of the previous words */
+        uint32_t checksum;
+    };
+
+    /* Recorder counters */
+    struct recorderStats_s {
+        uint32_t samples;
+        uint32_t blocks;
+
+        /* Capture buffer found full, samples may have been lost */
+        uint32_t overruns;
+
+        /* Highest number of full blocks waiting in the RAM ring */
+        uint32_t maxPending;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new AudioRecorder object.
+     *
+     * @param card An initialized SD driver.
+     * @param microphone An initialized capture unit.
+     * @param highCapacity Block addressing (SDHC / SDXC), from SD::init().
+     *
+     * @warning The object holds the RAM ring (RECORDER_BUFFERS * 0.5kB), declare it as a global!
+     */
+    AudioRecorder(SD& card, AudioCapture& microphone, bool highCapacity);
+
+
+/*****************************************************************/
+/*                           RECORDING                           */
+/*****************************************************************/
+
+    /**
+     * @brief Start the capture, the index block is written by the first calls to poll().
+     *
+     * @param indexBlock Sector of the index, the samples are written from the next one.
+     * @param sampleRate Sample rate, saved in the index.
+     * @param channels 1 or 2, saved in the index.
+     * @param error Reference to an error variable.
+     *
+     * @return The AudioRecorder object itself to chain the function call.
+     */
+    AudioRecorder& start(uint32_t indexBlock, uint32_t sampleRate, uint32_t channels, recorderError_e& error);
+
+    /**
+     * @brief Move the samples to the RAM ring and the full blocks to the card.
+     *
+     * @param error Reference to an error variable, SD_ERROR (card error or data
+     * timeout) stops the recording.
+     *
+     * @return False once the recording is over.
+     */
+    bool poll(recorderError_e& error);
+
+    /**
+     * @brief Stop the capture, write the remaining samples and close the index. Blocking.
+     *
+     * @param error Reference to an error variable.
+     *
+     * @return The AudioRecorder object itself to chain the function call.
+     */
+    AudioRecorder& stop(recorderError_e& error);
+
+    /**
+     * @brief Get the recorder counters.
+     */
+    const struct recorderStats_s& getStats();
+
+
+/*****************************************************************/
+/*                           RECOVERY                            */
+/*****************************************************************/
+
+    /**
+     * @brief Read and check an index block. The data of an index still RECORDING
+     * is valid up to index.blocks.
+     *
+     * @param indexBlock Sector of the index.
+     * @param saved The index to fill.
+     * @param error Reference to an error variable, NO_INDEX if the block is not an index.
+     *
+     * @return The AudioRecorder object itself to chain the function call.
+     *
+     * @warning Not while recording, it shares the index buffer.
+     */
+    AudioRecorder& readIndex(uint32_t indexBlock, struct recorderIndex_s& saved, recorderError_e& error);
+
+
+private:
+
+    static const uint32_t BLOCK_WORDS = 128;
+    static const uint32_t BLOCK_SAMPLES = 256;
+
+    enum state_e {
+        /* Not recording */
+        STOPPED,
+
+        /* Stream open, full blocks are queued */
+        STREAMING,
+
+        /* Waiting for the last block of the segment */
+        CLOSING,
+
+        /* Waiting for the card to finish programming */
+        PROGRAMMING,
+
+        /* Index block write in progress */
+        INDEX
+    };
+
+    /* Drain the capture buffer into the RAM ring */
+    void capture();
+
+    /* One step of the card state machine, false on SD error */
+    bool transfer();
+
+    /* Stop everything after an SD error */
+    void abort(recorderError_e& error);
+
+    /* SDHC = block address, SDSC = byte address */
+    uint32_t cardAddress(uint32_t block);
+
+
+    SD& card;
+    AudioCapture& microphone;
+    bool highCapacity;
+
+    state_e state;
+
+    /* Stop requested, close once the ring is empty */
+    bool stopping;
+
+    /* Ring of blocks: head is being filled, tail is the next one to send */
+    uint32_t ring[RECORDER_BUFFERS][BLOCK_WORDS];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t pending;
+    uint32_t fill;
+
+    /* Blocks sent in the current stream */
+    uint32_t segmentBlocks;
+
+    /* Index content, blocks are counted in stats */
+    struct recorderIndex_s index;
+
+    /* Index block buffer */
+    uint32_t indexBuffer[BLOCK_WORDS];
+
+    struct recorderStats_s stats;
+};
+
+#endif
@@ -0,0 +1,178 @@
+#ifndef BLOCK_CACHE_H
+#define BLOCK_CACHE_H
+
+#include <inttypes.h>
+
+#include "driver/SD.h"
+
+#include "platform.h"
+
+
+/*
+ *  Write-back cache of 512 byte SD sectors with LRU replacement. Modified
+ *  sectors are written to the card only when they are evicted or on flush().
+ *
+ *  A miss on the sector that follows the last one accessed is a sequential
+ *  access: the missing sector and the next READ_AHEAD ones (stopping at the
+ *  first cached sector) are read with a single CMD18 burst, each block
+ *  straight into its own cache line.
+ *
+ *  Large reads that don't need to stay in the cache (file contents) go
+ *  through readBlocks(), the uncached runs are read in bursts directly into
+ *  the destination buffer.
+ *
+ *  Sector data is in card byte order, multi-byte fields of on-disk
+ *  structures are little endian like the CPU.
+ */
+class BlockCache {
+
+public:
+
+    /* Sector size */
+    static const uint32_t BLOCK_SIZE = 512;
+    static const uint32_t BLOCK_WORDS = BLOCK_SIZE / 4;
+
+    /* Number of cached sectors */
+    static const uint32_t LINES = BLOCK_CACHE_LINES;
+
+    /* Sectors read after a sequential miss, at most half of the cache */
+    static const uint32_t READ_AHEAD = (BLOCK_CACHE_READ_AHEAD < (LINES / 2)) ? BLOCK_CACHE_READ_AHEAD : (LINES / 2);
+
+
+    /* Cache counters */
+    struct cacheStats_s {
+        uint32_t hits;
+        uint32_t misses;
+
+        /* Sectors read ahead of a sequential access */
+        uint32_t readAhead;
+
+        /* Dirty sectors written to the card */
+        uint32_t writeBacks;
+
+        /* Sectors read by readBlocks() bypassing the cache */
+        uint32_t bypassed;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new BlockCache object.
+     *
+     * @param card An initialized SD driver.
+     * @param highCapacity Block addressing (SDHC / SDXC), from SD::init().
+     *
+     * @warning The object holds every cache line (LINES * ~0.5kB), declare it as a global!
+     */
+    BlockCache(SD& card, bool highCapacity);
+
+
+/*****************************************************************/
+/*                            ACCESS                             */
+/*****************************************************************/
+
+    /**
+     * @brief Get a sector, read it from the card on a miss.
+     *
+     * @param block Sector number.
+     * @param error Reference to an error variable.
+     *
+     * @return The sector data, valid until the next call to the cache. nullptr on error.
+     */
+    const uint8_t* read(uint32_t block, SD::errorType_e& error);
+
+    /**
+     * @brief Get a sector to modify, it is marked dirty and written back later.
+     *
+     * @param block Sector number.
+     * @param overwrite The whole sector will be written, skip reading it from the card.
+     * @param error Reference to an error variable.
+     *
+     * @return The sector data, valid until the next call to the cache. nullptr on error.
+     */
+    uint8_t* modify(uint32_t block, bool overwrite, SD::errorType_e& error);
+
+    /**
+     * @brief Read consecutive sectors into a buffer. Cached sectors are copied, the
+     * others are read in bursts straight into the buffer and are not cached.
+     *
+     * @param block First sector number.
+     * @param count Number of sectors.
+     * @param buffer Destination, count * 128 words.
+     * @param error Reference to an error variable.
+     *
+     * @return The BlockCache object itself to chain the function call.
+     */
+    BlockCache& readBlocks(uint32_t block, uint32_t count, uint32_t* buffer, SD::errorType_e& error);
+
+
+/*****************************************************************/
+/*                          MAINTENANCE                          */
+/*****************************************************************/
+
+    /**
+     * @brief Write every dirty sector to the card.
+     *
+     * @param error Reference to an error variable.
+     *
+     * @return The BlockCache object itself to chain the function call.
+     */
+    BlockCache& flush(SD::errorType_e& error);
+
+    /**
+     * @brief Drop every sector, dirty ones included (card changed).
+     *
+     * @return The BlockCache object itself to chain the function call.
+     */
+    BlockCache& invalidate();
+
+    /**
+     * @brief Get the cache counters.
+     */
+    const struct cacheStats_s& getStats();
+
+
+private:
+
+    struct cacheLine_s {
+        uint32_t block;
+        uint32_t lastUse;
+        bool valid;
+        bool dirty;
+
+        uint32_t data[BLOCK_WORDS];
+    };
+
+    /* Line holding a sector, nullptr if not cached */
+    struct cacheLine_s* lookup(uint32_t block);
+
+    /* Least recently used line not in the exclusion list, written back if dirty */
+    struct cacheLine_s* evict(struct cacheLine_s* const* excluded, uint32_t excludedCount, SD::errorType_e& error);
+
+    /* Load a missing sector, with read ahead if the access is sequential */
+    struct cacheLine_s* fill(uint32_t block, SD::errorType_e& error);
+
+    void writeBack(struct cacheLine_s* line, SD::errorType_e& error);
+
+    /* SDHC = block address, SDSC = byte address */
+    uint32_t cardAddress(uint32_t block);
+
+
+    SD& card;
+    bool highCapacity;
+
+    struct cacheLine_s lines[LINES];
+
+    /* Access counter for the LRU replacement */
+    uint32_t useCounter;
+
+    /* Last sector accessed, to detect sequential accesses */
+    uint32_t lastBlock;
+
+    struct cacheStats_s stats;
+};
+
+#endif
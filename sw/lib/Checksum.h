@@ -0,0 +1,123 @@
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <inttypes.h>
+
+
+/*
+ *  Internet checksum (RFC 1071) helpers. Sums are computed on 16 bit words
+ *  in memory order, the one's complement sum is byte order independent so
+ *  the result can be stored as is in a network header. Values coming from
+ *  host integers must be converted to network order before being added.
+ *
+ *  Partial sums are kept in 32 bits and folded only when the checksum is
+ *  produced, so a constant part (e.g. a header template) is summed once and
+ *  the per packet fields are added on top.
+ */
+class Checksum {
+
+public:
+
+    /**
+     * @brief Add an array of bytes to a running sum, 4 bytes per step if the
+     * array is word aligned.
+     *
+     * @param data The bytes to add.
+     * @param length The number of bytes.
+     * @param sum The running sum.
+     *
+     * @return The new running sum (not folded).
+     */
+    static inline uint32_t add(const void* data, uint32_t length, uint32_t sum = 0) {
+        const uint8_t* bytes = (const uint8_t *) data;
+        uint64_t accumulator = sum;
+
+        if (((uintptr_t) bytes & 3) == 0) {
+            for (; length >= 4; length -= 4, bytes += 4) {
+                accumulator += *((const uint32_t *) bytes);
+            }
+        }
+
+        for (; length >= 2; length -= 2, bytes += 2) {
+            accumulator += bytes[0] | (bytes[1] << 8);
+        }
+
+        /* Odd byte is the first byte of a zero padded word */
+        if (length != 0) {
+            accumulator += bytes[0];
+        }
+
+        /* End around carry */
+        while ((accumulator >> 32) != 0) {
+            accumulator = (accumulator & 0xFFFFFFFF) + (accumulator >> 32);
+        }
+
+        return (uint32_t) accumulator;
+    };
+
+    /**
+     * @brief Add a 16 bit value (already in network order) to a running sum.
+     *
+     * @return The new running sum (not folded).
+     */
+    static inline uint32_t add16(uint16_t value, uint32_t sum) {
+        uint32_t result = sum + value;
+
+        return result + (result < sum);
+    };
+
+    /**
+     * @brief Combine the sum of a block that starts at a given offset of the
+     * packet with the sum of the bytes before it.
+     *
+     * @param sum The running sum of the preceding bytes.
+     * @param blockSum The sum of the block computed on its own.
+     * @param offset The offset of the block in the packet.
+     *
+     * @return The new running sum (not folded).
+     */
+    static inline uint32_t combine(uint32_t sum, uint32_t blockSum, uint32_t offset) {
+        uint16_t block = fold(blockSum);
+
+        /* A block at an odd offset has its bytes in the opposite word lanes */
+        if (offset & 1) {
+            block = (block << 8) | (block >> 8);
+        }
+
+        return add16(block, sum);
+    };
+
+    /**
+     * @brief Fold a running sum into 16 bits.
+     */
+    static inline uint16_t fold(uint32_t sum) {
+        sum = (sum & 0xFFFF) + (sum >> 16);
+        sum = (sum & 0xFFFF) + (sum >> 16);
+
+        return (uint16_t) sum;
+    };
+
+    /**
+     * @brief Produce the checksum field from a running sum.
+     */
+    static inline uint16_t finish(uint32_t sum) {
+        return (uint16_t) ~fold(sum);
+    };
+
+    /**
+     * @brief Update a checksum after a 16 bit field changed (RFC 1624, eqn. 3).
+     *
+     * @param checksum The current checksum field.
+     * @param oldValue The old field value.
+     * @param newValue The new field value.
+     *
+     * @return The new checksum field.
+     */
+    static inline uint16_t update(uint16_t checksum, uint16_t oldValue, uint16_t newValue) {
+        uint32_t sum = add16((uint16_t) ~checksum, (uint16_t) ~oldValue);
+
+        return finish(add16(newValue, sum));
+    };
+};
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef FAT32_H
+#define FAT32_H
+
+#include <inttypes.h>
+
+#include "BlockCache.h"
+
+
+/*
+ *  Read-only FAT32 filesystem on top of the SD block cache, for cards
+ *  formatted by a PC: first FAT32 partition of an MBR card or a whole card
+ *  FAT32 volume (no partition table). Long file names are matched in ASCII,
+ *  the comparison is case insensitive.
+ *
+ *  File data doesn't go through the cache: read() follows the cluster chain
+ *  ahead of the current position, merges the clusters that are contiguous on
+ *  the card and reads every run with a single multi-block command straight
+ *  into the destination buffer. Only the unaligned head and tail of a read
+ *  and the FAT / directory sectors use the cache (and its read ahead).
+ *
+ *  Not supported: writing, exFAT / FAT12 / FAT16, GPT cards.
+ */
+class FAT32 {
+
+public:
+
+    /* Function errors */
+    enum fatError_e { NO_ERROR, IO_ERROR, NO_FILESYSTEM, NOT_FOUND, NOT_A_FILE, NOT_A_DIRECTORY, TOO_LARGE, CORRUPTED };
+
+    /* Longest file name kept (longer ones are truncated) */
+    static const uint32_t MAX_NAME = 255;
+
+    /* Directory entry attributes */
+    static const uint8_t ATTR_READ_ONLY = 0x01;
+    static const uint8_t ATTR_HIDDEN = 0x02;
+    static const uint8_t ATTR_SYSTEM = 0x04;
+    static const uint8_t ATTR_VOLUME_ID = 0x08;
+    static const uint8_t ATTR_DIRECTORY = 0x10;
+    static const uint8_t ATTR_ARCHIVE = 0x20;
+
+
+    /* Open file or directory, the position is kept here */
+    struct fatFile_s {
+        uint32_t firstCluster;
+        uint32_t size;
+        bool directory;
+
+        /* Byte offset of the next read */
+        uint32_t position;
+
+        /* Cluster holding the position and its index in the chain */
+        uint32_t cluster;
+        uint32_t clusterIndex;
+    };
+
+    /* Directory listing entry */
+    struct fatEntry_s {
+        char name[MAX_NAME + 1];
+        uint32_t size;
+        uint32_t firstCluster;
+        uint8_t attributes;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new FAT32 object, mount() must be called next.
+     *
+     * @param cache Block cache of the SD card.
+     */
+    FAT32(BlockCache& cache);
+
+
+/*****************************************************************/
+/*                            VOLUME                             */
+/*****************************************************************/
+
+    /**
+     * @brief Find the FAT32 volume of the card and read its parameters.
+     *
+     * @param error Reference to an error variable.
+     *
+     * @return The FAT32 object itself to chain the function call.
+     */
+    FAT32& mount(fatError_e& error);
+
+    /**
+     * @brief Get the cluster size in bytes.
+     */
+    uint32_t getClusterSize();
+
+
+/*****************************************************************/
+/*                             FILES                             */
+/*****************************************************************/
+
+    /**
+     * @brief Open a file or a directory.
+     *
+     * @param path Absolute path, '/' separated ("/audio/wave.bin"), "/" is the root directory.
+     * @param file The file to initialize.
+     * @param error Reference to an error variable.
+     *
+     * @return The FAT32 object itself to chain the function call.
+     */
+    FAT32& open(const char* path, struct fatFile_s& file, fatError_e& error);
+
+    /**
+     * @brief Read from the current position of a file.
+     *
+     * @param file An open file.
+     * @param buffer Destination, word aligned for the burst reads.
+     * @param size Bytes to read.
+     * @param error Reference to an error variable.
+     *
+     * @return The number of bytes read, less than size at the end of the file.
+     */
+    uint32_t read(struct fatFile_s& file, void* buffer, uint32_t size, fatError_e& error);
+
+    /**
+     * @brief Set the position of the next read, past the end it is clamped to the size.
+     *
+     * @param file An open file.
+     * @param position Byte offset from the start of the file.
+     *
+     * @return The FAT32 object itself to chain the function call.
+     */
+    FAT32& seek(struct fatFile_s& file, uint32_t position);
+
+    /**
+     * @brief Read a whole file.
+     *
+     * @param path Absolute path of the file.
+     * @param buffer Destination, word aligned.
+     * @param capacity Size of the destination, a larger file is an error.
+     * @param error Reference to an error variable.
+     *
+     * @return The file size.
+     */
+    uint32_t load(const char* path, void* buffer, uint32_t capacity, fatError_e& error);
+
+
+/*****************************************************************/
+/*                          DIRECTORIES                          */
+/*****************************************************************/
+
+    /**
+     * @brief Get the next entry of a directory ("." and ".." included).
+     *
+     * @param directory An open directory.
+     * @param entry The entry to fill.
+     * @param error Reference to an error variable.
+     *
+     * @return False at the end of the directory or on error.
+     */
+    bool nextEntry(struct fatFile_s& directory, struct fatEntry_s& entry, fatError_e& error);
+
+
+private:
+
+    /* Next cluster in the chain, 0 at the end, CORRUPTED on a free / bad / out of range entry */
+    uint32_t nextCluster(uint32_t cluster, fatError_e& error);
+
+    /* Walk the chain up to the cluster holding the position, false if the chain ends before */
+    bool locate(struct fatFile_s& file, fatError_e& error);
+
+    /* First sector of a cluster */
+    uint32_t clusterSector(uint32_t cluster);
+
+    /* Check and read a FAT32 boot sector */
+    bool readBootSector(uint32_t block, fatError_e& error);
+
+    /* Cached sector, IO_ERROR if it can't be read */
+    const uint8_t* sector(uint32_t block, fatError_e& error);
+
+
+    BlockCache& cache;
+
+    bool mounted;
+
+    /* Volume geometry, in sectors */
+    uint32_t fatStart;
+    uint32_t dataStart;
+    uint32_t clusterCount;
+    uint32_t rootCluster;
+
+    /* Cluster size = 1 << clusterShift sectors */
+    uint32_t clusterShift;
+};
+
+#endif
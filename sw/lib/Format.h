@@ -0,0 +1,295 @@
+#ifndef FORMAT_H
+#define FORMAT_H
+
+#include <inttypes.h>
+
+
+/*
+ *  Number to text conversion shared by Serial_IO and the CoreMark ee_printf
+ *  port, the header is plain C so both can include it.
+ *
+ *  Only 32 bit arithmetic is used: divisions by a constant compile to a
+ *  mulhu and a shift (no divider, no libgcc __udivdi3 / __umoddi3 call) and
+ *  the digits are produced two at a time from a 200 byte table. Numbers wider
+ *  than 32 bits are split in 4 digit chunks with a long division on 16 bit
+ *  limbs, the float integer part up to 2^128 included.
+ *
+ *  The float printer is exact: the fraction is scaled by 10^precision in 64
+ *  bits (a 24 bit significand by at most 10^9) and rounded half to even on
+ *  the remainder, as printf("%.*f") does.
+ *
+ *  Every function writes the characters (no terminator) and returns their
+ *  number.
+ */
+
+/* Buffer sizes */
+#define FORMAT_UINT32_SIZE 10
+#define FORMAT_UINT64_SIZE 20
+
+/* Sign, 39 integer digits, dot and FORMAT_MAX_PRECISION digits */
+#define FORMAT_FLOAT_SIZE 50
+
+/* Higher float precisions are clamped */
+#define FORMAT_MAX_PRECISION 9
+
+
+static const char FORMAT_DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const uint32_t FORMAT_POWERS_10[10] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+
+/****************************************************************/
+/*                           INTEGERS                           */
+/****************************************************************/
+
+/**
+ * @brief Write exactly count digits of value (count >= digits of value),
+ * leading zeros included.
+ */
+static inline void formatDigits(char* buffer, uint32_t value, uint32_t count) {
+    char* end = buffer + count;
+
+    while (end - buffer >= 2) {
+        uint32_t pair = value % 100;
+
+        value /= 100;
+        end -= 2;
+
+        end[0] = FORMAT_DIGIT_PAIRS[pair * 2];
+        end[1] = FORMAT_DIGIT_PAIRS[pair * 2 + 1];
+    }
+
+    if (end != buffer) {
+        *buffer = (char) ('0' + value);
+    }
+}
+
+
+/**
+ * @brief Write a 32 bit unsigned number in decimal.
+ *
+ * @param buffer At least FORMAT_UINT32_SIZE characters.
+ * @param value Number to write.
+ *
+ * @return The number of characters written.
+ */
+static inline uint32_t formatUnsigned32(char* buffer, uint32_t value) {
+    uint32_t count = 1;
+
+    while (count < 10 && value >= FORMAT_POWERS_10[count]) {
+        ++count;
+    }
+
+    formatDigits(buffer, value, count);
+
+    return count;
+}
+
+
+/**
+ * @brief Divide a number stored in 16 bit limbs (most significant first) by
+ * 10000 in place, every step fits 32 bits.
+ *
+ * @return The remainder.
+ */
+static inline uint32_t formatDivideLimbs(uint16_t* limbs, uint32_t count) {
+    uint32_t remainder = 0;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t current = (remainder << 16) | limbs[i];
+        uint32_t quotient = current / 10000;
+
+        limbs[i] = (uint16_t) quotient;
+        remainder = current - (quotient * 10000);
+    }
+
+    return remainder;
+}
+
+
+/**
+ * @brief Write a number of up to 8 limbs (128 bits) in decimal, the limbs are
+ * destroyed.
+ *
+ * @return The number of characters written.
+ */
+static inline uint32_t formatLimbs(char* buffer, uint16_t* limbs, uint32_t count) {
+    /* 4 digit chunks, least significant first */
+    uint32_t chunks[10];
+    uint32_t chunkCount = 0;
+
+    while (count != 0 && limbs[0] == 0) {
+        ++limbs;
+        --count;
+    }
+
+    do {
+        chunks[chunkCount++] = formatDivideLimbs(limbs, count);
+
+        while (count != 0 && limbs[0] == 0) {
+            ++limbs;
+            --count;
+        }
+    } while (count != 0);
+
+    uint32_t length = formatUnsigned32(buffer, chunks[--chunkCount]);
+
+    while (chunkCount != 0) {
+        formatDigits(buffer + length, chunks[--chunkCount], 4);
+
+        length += 4;
+    }
+
+    return length;
+}
+
+
+/**
+ * @brief Write a 64 bit unsigned number in decimal, the 32 bit path is taken
+ * when the upper word is zero.
+ *
+ * @param buffer At least FORMAT_UINT64_SIZE characters.
+ * @param value Number to write.
+ *
+ * @return The number of characters written.
+ */
+static inline uint32_t formatUnsigned64(char* buffer, uint64_t value) {
+    uint32_t high = (uint32_t) (value >> 32);
+    uint32_t low = (uint32_t) value;
+
+    if (high == 0) {
+        return formatUnsigned32(buffer, low);
+    }
+
+    uint16_t limbs[4] = { (uint16_t) (high >> 16), (uint16_t) high, (uint16_t) (low >> 16), (uint16_t) low };
+
+    return formatLimbs(buffer, limbs, 4);
+}
+
+
+/****************************************************************/
+/*                        FLOATING POINT                        */
+/****************************************************************/
+
+/**
+ * @brief Write a float with a fixed number of digits after the dot, correctly
+ * rounded (half to even). NaN and infinities are written as "nan", "inf"
+ * and "-inf".
+ *
+ * @param buffer At least FORMAT_FLOAT_SIZE characters.
+ * @param value Number to write.
+ * @param precision Digits after the dot, at most FORMAT_MAX_PRECISION.
+ *
+ * @return The number of characters written.
+ */
+static inline uint32_t formatFloat(char* buffer, float value, uint32_t precision) {
+    union { float number; uint32_t bits; } raw;
+    uint32_t length = 0;
+
+    raw.number = value;
+
+    uint32_t exponentField = (raw.bits >> 23) & 0xFF;
+    uint32_t significand = raw.bits & 0x007FFFFF;
+
+    if (exponentField == 0xFF && significand != 0) {
+        buffer[0] = 'n'; buffer[1] = 'a'; buffer[2] = 'n';
+
+        return 3;
+    }
+
+    if (raw.bits >> 31) {
+        buffer[length++] = '-';
+    }
+
+    if (exponentField == 0xFF) {
+        buffer[length++] = 'i'; buffer[length++] = 'n'; buffer[length++] = 'f';
+
+        return length;
+    }
+
+    if (precision > FORMAT_MAX_PRECISION) {
+        precision = FORMAT_MAX_PRECISION;
+    }
+
+    /* value = significand * 2^exponent */
+    int32_t exponent;
+
+    if (exponentField == 0) {
+        exponent = -149;
+    } else {
+        significand |= 0x00800000;
+        exponent = (int32_t) exponentField - 150;
+    }
+
+    uint32_t fraction = 0;
+
+    if (exponent > 8) {
+        /* Integer above 2^32, no fraction: shift into 5 words then 16 bit limbs */
+        uint32_t words[5] = { 0, 0, 0, 0, 0 };
+        uint32_t shift = (uint32_t) exponent & 31;
+
+        words[exponent >> 5] = significand << shift;
+        words[(exponent >> 5) + 1] = shift ? (significand >> (32 - shift)) : 0;
+
+        uint16_t limbs[8];
+
+        for (uint32_t i = 0; i < 8; ++i) {
+            uint32_t word = words[3 - (i / 2)];
+
+            limbs[i] = (uint16_t) ((i & 1) ? word : (word >> 16));
+        }
+
+        length += formatLimbs(buffer + length, limbs, 8);
+    } else {
+        uint32_t integer;
+
+        if (exponent >= 0) {
+            integer = significand << exponent;
+        } else {
+            uint32_t shift = (uint32_t) -exponent;
+            uint32_t fractionBits = (shift < 32) ? (significand & ((1u << shift) - 1)) : significand;
+
+            integer = (shift < 32) ? (significand >> shift) : 0;
+
+            /* fractionBits / 2^shift * 10^precision, below 2^54 */
+            uint64_t scaled = (uint64_t) fractionBits * FORMAT_POWERS_10[precision];
+
+            /* Beyond 63 bits the remainder is below half: round down */
+            if (shift < 64) {
+                uint64_t remainder = scaled & ((1ull << shift) - 1);
+                uint64_t half = 1ull << (shift - 1);
+
+                fraction = (uint32_t) (scaled >> shift);
+
+                /* Ties go to the even last digit, the integer one without fraction digits */
+                uint32_t odd = (precision == 0) ? (integer & 1) : (fraction & 1);
+
+                if (remainder > half || (remainder == half && odd)) {
+                    if (++fraction == FORMAT_POWERS_10[precision]) {
+                        fraction = 0;
+                        ++integer;
+                    }
+                }
+            }
+        }
+
+        length += formatUnsigned32(buffer + length, integer);
+    }
+
+    if (precision != 0) {
+        buffer[length++] = '.';
+
+        formatDigits(buffer + length, fraction, precision);
+
+        length += precision;
+    }
+
+    return length;
+}
+
+#endif
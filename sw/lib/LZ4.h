@@ -0,0 +1,122 @@
+#ifndef LZ4_H
+#define LZ4_H
+
+#include <inttypes.h>
+
+
+/*
+ *  LZ4 block format decoder (no frame header, no checksum). The decoder is
+ *  small enough to run from the boot ROM and checks every length against the
+ *  source and destination bounds, a corrupted block can't write outside the
+ *  destination buffer.
+ *
+ *  A block is a list of sequences: a token (literal length : 4, match length
+ *  - 4 : 4), the extra literal length bytes, the literals, a 16 bit little
+ *  endian match offset and the extra match length bytes. The last sequence
+ *  has literals only.
+ */
+class LZ4 {
+
+public:
+
+    /**
+     * @brief Decompress an LZ4 block.
+     *
+     * @param source The compressed block.
+     * @param sourceSize The compressed block size.
+     * @param destination The output buffer.
+     * @param capacity The output buffer size.
+     *
+     * @return The number of bytes written, -1 if the block is malformed or doesn't fit.
+     */
+    static inline int32_t decompress(const uint8_t* source, uint32_t sourceSize, uint8_t* destination, uint32_t capacity) {
+        const uint8_t* input = source;
+        const uint8_t* inputEnd = source + sourceSize;
+
+        uint8_t* output = destination;
+        uint8_t* outputEnd = destination + capacity;
+
+        while (input < inputEnd) {
+            uint32_t token = *input++;
+
+            /* Literals */
+            uint32_t length = token >> 4;
+
+            if (length == 15 && !extendLength(input, inputEnd, length)) {
+                return -1;
+            }
+
+            if (length > (uint32_t) (inputEnd - input) || length > (uint32_t) (outputEnd - output)) {
+                return -1;
+            }
+
+            for (uint32_t i = 0; i < length; ++i) {
+                output[i] = input[i];
+            }
+
+            input += length;
+            output += length;
+
+            /* The last sequence ends after the literals */
+            if (input == inputEnd) {
+                break;
+            }
+
+            /* Match */
+            if ((inputEnd - input) < 2) {
+                return -1;
+            }
+
+            uint32_t offset = input[0] | (input[1] << 8);
+            input += 2;
+
+            if (offset == 0 || offset > (uint32_t) (output - destination)) {
+                return -1;
+            }
+
+            length = token & 0x0F;
+
+            if (length == 15 && !extendLength(input, inputEnd, length)) {
+                return -1;
+            }
+
+            length += 4;
+
+            if (length > (uint32_t) (outputEnd - output)) {
+                return -1;
+            }
+
+            /* The match can overlap the bytes being written (offset < length) */
+            const uint8_t* match = output - offset;
+
+            for (uint32_t i = 0; i < length; ++i) {
+                output[i] = match[i];
+            }
+
+            output += length;
+        }
+
+        return output - destination;
+    };
+
+
+private:
+
+    /* Add the extra length bytes, a byte of 255 means another byte follows */
+    static inline bool extendLength(const uint8_t*& input, const uint8_t* inputEnd, uint32_t& length) {
+        uint8_t value;
+
+        do {
+            if (input == inputEnd) {
+                return false;
+            }
+
+            value = *input++;
+            length += value;
+        } while (value == 255);
+
+        return true;
+    };
+};
+
+#endif
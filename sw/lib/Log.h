@@ -0,0 +1,141 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <inttypes.h>
+#include <type_traits>
+
+#include "Serial_IO.h"
+
+#include "platform.h"
+
+
+/*
+ *  Tokenized logging: the format string never reaches the UART. LOG() puts it
+ *  in the .zlog section (not loaded, every linker script of the repository
+ *  has the rule) and only stores a record in a RAM ring: a header word (string
+ *  offset in .zlog and number of argument words) followed by the raw
+ *  arguments. flush() sends the queued records through Serial_IO, tools/log
+ *  expands them back to text with the ELF (also done live by the Verilator
+ *  testbench, see sw/test/tests/log).
+ *
+ *  The format characters are the Serial_IO::printf ones: %d %u %c (32 bit),
+ *  %l (64 bit), %x %b with the b / h / d size suffixes (%xd and %bd take 64
+ *  bit arguments) and %.Nf (the value is sent as a float). Strings (%s) can't
+ *  be deferred. Every record is printed on its own line.
+ *
+ *  On the wire a record is LOG_MARKER followed by the header and argument
+ *  words (little endian), so it can be mixed with plain Serial_IO text.
+ *
+ *  A record costs a few stores and no formatting. The ring has a single
+ *  producer: log from the main loop, or only from interrupt handlers.
+ */
+#define LOG(format, ...) do { \
+    static const char logFormat[] __attribute__((section(".zlog"), used)) = format; \
+    Log::record((uint32_t) (uintptr_t) logFormat, ##__VA_ARGS__); \
+} while (0)
+
+
+class Log {
+
+public:
+
+    /* First byte of every record on the wire, never part of ASCII text */
+    static const uint8_t LOG_MARKER = 0xFE;
+
+    /* Header string offset of the "records dropped" record, one argument */
+    static const uint32_t DROPPED_ID = 0xFFFFFF;
+
+    /* Ring size in words */
+    static const uint32_t RING_WORDS = LOG_RING_WORDS;
+
+    static_assert((RING_WORDS & (RING_WORDS - 1)) == 0, "LOG_RING_WORDS must be a power of 2");
+
+
+/****************************************************************/
+/*                           RECORD                             */
+/****************************************************************/
+
+    /**
+     * @brief Queue a record, use the LOG() macro instead. The record is dropped
+     * (and counted) when the ring is full.
+     *
+     * @param id Address of the format string in .zlog.
+     * @param args Integers, floating point numbers or pointers.
+     */
+    template<typename... Args> static void record(uint32_t id, Args... args) {
+        constexpr uint32_t words = (0 + ... + argumentWords<Args>());
+
+        static_assert(words < 256, "Too many LOG arguments");
+
+        if ((RING_WORDS - (head - tail)) < (words + 1)) {
+            ++dropped;
+
+            return;
+        }
+
+        uint32_t index = head;
+
+        ring[index++ & (RING_WORDS - 1)] = (words << 24) | (id & DROPPED_ID);
+
+        (put(index, args), ...);
+
+        /* Publish the record once it is complete */
+        head = index;
+    };
+
+
+/****************************************************************/
+/*                            OUTPUT                            */
+/****************************************************************/
+
+    /**
+     * @brief Send every queued record through Serial_IO, followed by a record
+     * with the number of records dropped since the last flush (if any).
+     */
+    static void flush();
+
+    /**
+     * @brief Number of words waiting in the ring.
+     */
+    static uint32_t pending();
+
+
+private:
+
+    /* Words of a record argument */
+    template<typename Type> static constexpr uint32_t argumentWords() {
+        return (std::is_integral<Type>::value && sizeof(Type) == 8) ? 2 : 1;
+    };
+
+    template<typename Type> static void put(uint32_t& index, Type value) {
+        if constexpr (std::is_floating_point<Type>::value) {
+            union { float number; uint32_t bits; } single;
+
+            single.number = (float) value;
+
+            ring[index++ & (RING_WORDS - 1)] = single.bits;
+        } else if constexpr (std::is_pointer<Type>::value) {
+            ring[index++ & (RING_WORDS - 1)] = (uint32_t) (uintptr_t) value;
+        } else if constexpr (sizeof(Type) == 8) {
+            uint64_t wide = (uint64_t) value;
+
+            ring[index++ & (RING_WORDS - 1)] = (uint32_t) wide;
+            ring[index++ & (RING_WORDS - 1)] = (uint32_t) (wide >> 32);
+        } else {
+            ring[index++ & (RING_WORDS - 1)] = (uint32_t) value;
+        }
+    };
+
+    /* Send a header or argument word */
+    static void sendWord(uint32_t word);
+
+
+    /* Free running indices: head is written by record(), tail by flush() */
+    static volatile uint32_t ring[RING_WORDS];
+    static volatile uint32_t head;
+    static volatile uint32_t tail;
+
+    static volatile uint32_t dropped;
+};
+
+#endif
@@ -0,0 +1,317 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <inttypes.h>
+
+#include "driver/Ethernet.h"
+#include "driver/EthernetRX.h"
+#include "driver/Timer.h"
+
+#include "Checksum.h"
+#include "platform.h"
+
+
+/*
+ *  Minimal UDP / IPv4 / ARP / ICMP echo stack on top of the Ethernet driver
+ *  in Ethernet II mode, frames are received through EthernetRX.
+ *
+ *  Transmission is zero copy: the headers are built in a small buffer that
+ *  is chained in front of the application segments, every segment is copied
+ *  once, directly into the MAC payload buffer. The application can chain its
+ *  own headers in front of the payload in the same way.
+ *
+ *  The IPv4 header checksum starts from the sum of the constant fields
+ *  computed once, only the per packet fields are added. The UDP checksum is
+ *  optional in IPv4 and disabled by default on transmission; echo replies
+ *  are built in place by updating the received checksum (RFC 1624).
+ *
+ *  Not supported: IP options on transmission, fragmentation (fragments are
+ *  dropped), ARP cache aging.
+ */
+class Network {
+
+public:
+
+    /* Function errors */
+    enum netError_e { NO_ERROR, ARP_PENDING, NO_SOCKET, LENGTH_EXCEEDED, TX_ERROR };
+
+    /* EtherTypes */
+    static const uint16_t ETHERTYPE_IPV4 = 0x0800;
+    static const uint16_t ETHERTYPE_ARP = 0x0806;
+
+    /* IP protocols */
+    static const uint8_t PROTOCOL_ICMP = 1;
+    static const uint8_t PROTOCOL_UDP = 17;
+
+    /* Headers size */
+    static const uint32_t IPV4_HEADER_SIZE = 20;
+    static const uint32_t UDP_HEADER_SIZE = 8;
+
+    /* Largest UDP payload without fragmentation */
+    static const uint32_t MAX_UDP_PAYLOAD = Ethernet::MAX_PAYLOAD_LENGTH - IPV4_HEADER_SIZE - UDP_HEADER_SIZE;
+
+    /* Table sizes */
+    static const uint32_t ARP_CACHE_SIZE = 4;
+
+    /* Timer counts between two ARP requests for the same address */
+    static const uint64_t ARP_RETRY = NET_ARP_RETRY;
+    static const uint32_t MAX_SOCKETS = 4;
+
+    /* IPv4 broadcast address */
+    static const uint32_t BROADCAST = 0xFFFFFFFF;
+
+
+    /* IPv4 header (network order, the buffers are word aligned) */
+    struct ipv4Header_s {
+        uint8_t versionIHL;
+        uint8_t typeOfService;
+        uint16_t totalLength;
+        uint16_t identification;
+        uint16_t fragment;
+        uint8_t timeToLive;
+        uint8_t protocol;
+        uint16_t checksum;
+        uint32_t source;
+        uint32_t destination;
+    };
+
+    /* UDP header (network order) */
+    struct udpHeader_s {
+        uint16_t sourcePort;
+        uint16_t destinationPort;
+        uint16_t length;
+        uint16_t checksum;
+    };
+
+    /* ICMP echo header (network order) */
+    struct icmpEcho_s {
+        uint8_t type;
+        uint8_t code;
+        uint16_t checksum;
+        uint16_t identifier;
+        uint16_t sequence;
+    };
+
+    /* ARP packet for Ethernet / IPv4, addresses are byte arrays since they are not aligned */
+    struct arpPacket_s {
+        uint16_t hardwareType;
+        uint16_t protocolType;
+        uint8_t hardwareLength;
+        uint8_t protocolLength;
+        uint16_t operation;
+        uint8_t senderMac[6];
+        uint8_t senderIp[4];
+        uint8_t targetMac[6];
+        uint8_t targetIp[4];
+    };
+
+
+    /**
+     * @brief Called for every UDP datagram received on a bound port.
+     *
+     * @param payload The datagram payload, valid only during the call.
+     * @param length The payload length.
+     * @param sourceIp The sender IPv4 address (host order).
+     * @param sourcePort The sender port (host order).
+     * @param context The pointer passed to bind().
+     */
+    typedef void (*udpHandler_t)(const uint8_t* payload, uint32_t length, uint32_t sourceIp, uint16_t sourcePort, void* context);
+
+
+    /* Stack counters */
+    struct netStats_s {
+        uint32_t arpRequests;
+        uint32_t arpReplies;
+        uint32_t echoReplies;
+        uint32_t udpReceived;
+        uint32_t udpSent;
+
+        /* Frames not addressed to us, malformed or with a bad checksum */
+        uint32_t dropped;
+    };
+
+
+    /**
+     * @brief Build an IPv4 address in host order.
+     */
+    static constexpr uint32_t ipAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+        return ((uint32_t) a << 24) | ((uint32_t) b << 16) | ((uint32_t) c << 8) | d;
+    };
+
+    /* Host / network order conversion */
+    static inline uint16_t swap16(uint16_t value) { return __builtin_bswap16(value); };
+    static inline uint32_t swap32(uint32_t value) { return __builtin_bswap32(value); };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new Network object. The Ethernet driver must be initialized
+     * in Ethernet II mode and the receiver enabled.
+     *
+     * @param ethernet The Ethernet driver.
+     * @param receiver The interrupt driven receiver.
+     * @param timer A running timer, only read to pace the ARP requests.
+     * @param address The IPv4 address of the SoC (host order).
+     * @param netmask The subnet mask (host order).
+     * @param gateway Router for addresses outside the subnet, 0 if none (host order).
+     */
+    Network(Ethernet& ethernet, EthernetRX& receiver, Timer& timer, uint32_t address, uint32_t netmask, uint32_t gateway = 0);
+
+
+/*****************************************************************/
+/*                            SOCKETS                            */
+/*****************************************************************/
+
+    /**
+     * @brief Deliver the UDP datagrams sent to a local port to a handler.
+     *
+     * @param port Local port (host order).
+     * @param handler Function called from poll().
+     * @param context Pointer passed back to the handler.
+     * @param error Reference to an error variable.
+     *
+     * @return The Network object itself to chain the function call.
+     */
+    Network& bind(uint16_t port, udpHandler_t handler, void* context, netError_e& error);
+
+    /**
+     * @brief Stop receiving on a local port.
+     *
+     * @param port Local port (host order).
+     *
+     * @return The Network object itself to chain the function call.
+     */
+    Network& unbind(uint16_t port);
+
+    /**
+     * @brief Send a UDP datagram whose payload is a chain of segments, the segments
+     * are not copied. If the destination MAC is unknown ARP_PENDING is returned and
+     * an ARP request is sent, at most one every ARP_RETRY counts however often the
+     * call is retried. Retry after poll() processed the reply.
+     *
+     * @param destination Destination IPv4 address (host order).
+     * @param destinationPort Destination port (host order).
+     * @param sourcePort Source port (host order).
+     * @param payload The first payload segment.
+     * @param error Reference to an error variable.
+     *
+     * @return The Network object itself to chain the function call.
+     */
+    Network& sendTo(uint32_t destination, uint16_t destinationPort, uint16_t sourcePort, const struct Ethernet::bufferChain_s* payload, netError_e& error);
+
+    /**
+     * @brief Send a UDP datagram from a single buffer.
+     *
+     * @return The Network object itself to chain the function call.
+     */
+    Network& sendTo(uint32_t destination, uint16_t destinationPort, uint16_t sourcePort, const uint8_t* payload, uint32_t length, netError_e& error);
+
+    /**
+     * @brief Compute the UDP checksum of the transmitted datagrams.
+     *
+     * @param enable Enable or disable the checksum (disabled by default).
+     *
+     * @return The Network object itself to chain the function call.
+     */
+    Network& setChecksumTX(bool enable);
+
+
+/*****************************************************************/
+/*                          PROCESSING                           */
+/*****************************************************************/
+
+    /**
+     * @brief Process every frame queued by the receiver: answer ARP requests and
+     * echo requests, update the ARP cache and call the UDP handlers.
+     *
+     * @return The number of frames processed.
+     */
+    uint32_t poll();
+
+    /**
+     * @brief Look up the MAC address of an IPv4 address on the link. On a miss an
+     * ARP request is sent, unless one for the same address was sent less than
+     * ARP_RETRY counts ago.
+     *
+     * @param address The IPv4 address (host order).
+     * @param mac Filled with the MAC address on a hit.
+     *
+     * @return True if the address is in the cache.
+     */
+    bool resolve(uint32_t address, struct Ethernet::macAddr_s& mac);
+
+    /**
+     * @brief Get the stack counters.
+     */
+    const struct netStats_s& getStats();
+
+
+private:
+
+    struct arpEntry_s {
+        uint32_t address;
+        struct Ethernet::macAddr_s mac;
+        bool valid;
+
+        /* Request sent at timer count requested and not answered yet */
+        bool pending;
+        uint64_t requested;
+    };
+
+    struct socket_s {
+        uint16_t port;
+        udpHandler_t handler;
+        void* context;
+    };
+
+    void handleArp(const struct EthernetRX::rxFrame_s* frame);
+    void handleIpv4(struct EthernetRX::rxFrame_s* frame);
+    void handleIcmp(struct EthernetRX::rxFrame_s* frame, uint32_t headerLength);
+    void handleUdp(const struct EthernetRX::rxFrame_s* frame, uint32_t headerLength);
+
+    void sendArp(uint16_t operation, const uint8_t* targetMac, uint32_t targetIp);
+    void learn(uint32_t address, const uint8_t* wireMac);
+
+    /* Resolved or pending entry of an address, nullptr if none */
+    struct arpEntry_s* findArp(uint32_t address);
+
+    /* Take the oldest entry for a new address */
+    struct arpEntry_s* replaceArp(uint32_t address);
+
+    /* MAC address as sent on the wire (first byte first) */
+    void toWire(const struct Ethernet::macAddr_s& mac, uint8_t* wire);
+    void fromWire(const uint8_t* wire, struct Ethernet::macAddr_s& mac);
+
+
+    Ethernet& ethernet;
+    EthernetRX& receiver;
+    Timer& timer;
+
+    /* Host order */
+    uint32_t address;
+    uint32_t netmask;
+    uint32_t gateway;
+
+    struct Ethernet::macAddr_s mac;
+
+    /* Sum of the IPv4 header fields that never change */
+    uint32_t ipv4TemplateSum;
+
+    uint16_t identification;
+    bool checksumTX;
+
+    struct arpEntry_s arpCache[ARP_CACHE_SIZE];
+    uint32_t arpNext;
+
+    struct socket_s sockets[MAX_SOCKETS];
+
+    struct netStats_s stats;
+
+    /* IPv4 + UDP headers of the datagram being sent */
+    uint32_t txHeader[(IPV4_HEADER_SIZE + UDP_HEADER_SIZE) / 4];
+};
+
+#endif
@@ -7,10 +7,15 @@
 
 #include "driver/UART.h"
 
+#include "Format.h"
+
 #include "mmio.h"
 #include "platform.h"
 
 
+/* Only known through a pointer: a program that polls the UART doesn't link the rings */
+class UARTBuffer;
+
 class Serial_IO {
 
 public: 
@@ -25,6 +30,18 @@ private:
     static volatile uint8_t* bufferTX;
     static volatile uint8_t* bufferRX;
 
+    /* Interrupt driven rings, nullptr to poll the UART */
+    static UARTBuffer* buffer;
+
+    /* Ring accessors, set together with the buffer by setBuffer() */
+    static uint32_t (*bufferWrite)(UARTBuffer* rings, const uint8_t* data, uint32_t size);
+    static uint32_t (*bufferRead)(UARTBuffer* rings, uint8_t* data, uint32_t size);
+    static void (*bufferFlush)(UARTBuffer* rings);
+
+    /* Send / receive through the rings or the UART registers */
+    static void send(const char* data, uint32_t size);
+    static char receive();
+
 
 public: 
 
@@ -38,6 +55,21 @@ public:
     static void init(uint32_t baudRate = 115200, bool parityEnable = true, UART::parityMode_e parityMode = UART::EVEN, 
                      UART::stopBits_e stopBits = UART::STOP1, UART::dataLenght_e dataBits = UART::BIT8);
 
+    /**
+     * @brief Send and receive through interrupt driven rings: writes only wait when the
+     * TX ring is full instead of for every byte once the hardware buffer is full.
+     * 
+     * @param uartBuffer Rings of the DEBUG_UART, nullptr to go back to polling.
+     *
+     * @note Defined in driver/UARTBuffer.h.
+     */
+    static void setBuffer(UARTBuffer* uartBuffer);
+
+    /**
+     * @brief Wait until every byte has been sent (before a reset or at the end of a benchmark).
+     */
+    static void flush();
+
 
 /****************************************************************/
 /*                      OUTPUT METHODS                          */
@@ -106,10 +138,10 @@ public:
 
     /**
      * @brief Write a floating point number with a specified number of
-     * digits.
+     * digits, correctly rounded.
      * 
      * @param num Number to display.
-     * @param digits Digits after the dot.
+     * @param digits Digits after the dot (at most FORMAT_MAX_PRECISION).
      * 
      */
     static void write(float num, uint32_t digits);
@@ -155,7 +187,8 @@ public:
      * 
      */
     template<typename Type> static void writeD(Type number, bool isSigned) {
-        char buffer[40];
+        char buffer[FORMAT_UINT64_SIZE + 1];
+        uint32_t size = 0;
 
         /* To account for overflows during negations */
         uint64_t number64 = number;
@@ -164,30 +197,14 @@ public:
             /* If negative the number is in two complement */
             number64 = -number64;
 
-            /* Print a minus */
-            write('-');
+            buffer[size++] = '-';
         } 
 
-
-        uint32_t size = 0;
-
-        do {
-            /* Extract the first digit and convert it to character */
-            char digit = (char) ((number64 % 10) + '0');
-
-            /* Shift (in decimal base) to the right by 1 */
-            number64 /= 10;
-
-            /* Save the digit into the string and increment the index */
-            buffer[size++] = digit;
-        } while (number64 != 0);
-
-        /* Reverse the array */
-        for (int i = 0; i < size / 2; ++i) {
-            uint32_t swap = buffer[size - 1 - i];
-
-            buffer[size - 1 - i] = buffer[i];
-            buffer[i] = swap;
+        /* Types up to 32 bits never need the 64 bit path */
+        if (sizeof(Type) <= 4) {
+            size += formatUnsigned32(buffer + size, (uint32_t) number64);
+        } else {
+            size += formatUnsigned64(buffer + size, number64);
         }
 
         write(buffer, size);
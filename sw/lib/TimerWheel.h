@@ -0,0 +1,245 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <inttypes.h>
+
+#include "driver/Timer.h"
+
+#include "platform.h"
+
+
+/*
+ *  Software timers multiplexed on one hardware Timer, without a periodic
+ *  tick: the timer counts freely and its threshold always holds the earliest
+ *  deadline, the interrupt handler runs the expired callbacks and programs
+ *  the next one.
+ *
+ *  The timers are kept in a hierarchical wheel of LEVELS x 32 slots of
+ *  intrusive lists. Deadlines are divided in ticks of 2^TICK_SHIFT counts:
+ *  level 0 holds the timers of the current 32 tick window, level N those
+ *  due in a later 32^N tick window, and a slot is moved (cascaded) to the
+ *  lower levels when time reaches it. A 32 bit map of the occupied slots
+ *  per level finds the next slot without scanning, so start and cancel are
+ *  O(1) and empty ticks are skipped in one step. Deadlines beyond the
+ *  wheel range (2^(LEVELS x 5) ticks) wait in an overflow list, inserted
+ *  again each time the current tick enters a new range.
+ *
+ *  The callbacks run at their exact deadline (timer counts, not ticks), in
+ *  interrupt context: they may start and cancel timers, themselves
+ *  included. A periodic timer is rescheduled before its callback runs,
+ *  without drift; periods missed while interrupts were masked run back to
+ *  back.
+ *
+ *  The hardware interrupt fires when the count equals the threshold: a
+ *  deadline already behind the count is programmed a few counts ahead
+ *  instead, and the threshold is checked after every write.
+ */
+class TimerWheel {
+
+public:
+
+    /* Wheel geometry */
+    static const uint32_t LEVELS = TIMER_WHEEL_LEVELS;
+    static const uint32_t SLOT_BITS = 5;
+    static const uint32_t SLOTS = 1 << SLOT_BITS;
+    static const uint32_t TICK_SHIFT = TIMER_WHEEL_TICK_SHIFT;
+
+    static_assert((LEVELS > 0) && ((LEVELS * SLOT_BITS) + TICK_SHIFT < 64), "TIMER_WHEEL_LEVELS too large");
+
+    /* Minimum distance between the count and a new threshold */
+    static const uint32_t ARM_LEAD = 64;
+
+
+    struct wheelTimer_s;
+
+    /**
+     * @brief Called from the interrupt handler when a timer expires.
+     *
+     * @param timer The expired timer, a periodic one is already rescheduled.
+     */
+    typedef void (*wheelCallback_t)(struct wheelTimer_s* timer);
+
+
+    /* Software timer, owned by the wheel while active */
+    struct wheelTimer_s {
+        /* Set by the application before start() */
+        wheelCallback_t callback;
+        void* context;
+
+        /* Absolute deadline and period (0 for one shot) in timer counts */
+        uint64_t expires;
+        uint64_t period;
+
+        /* Slot list links, link is nullptr when the timer is not active: zero
+         * initialize the timer before its first start() */
+        struct wheelTimer_s* next;
+        struct wheelTimer_s** link;
+        uint32_t index;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new TimerWheel object: the timer is reset, started in
+     * FREE_RUNNING mode and its interrupt enabled, it stays enabled.
+     *
+     * @param timer The hardware timer, it belongs to the wheel from now on.
+     */
+    TimerWheel(Timer& timer);
+
+    /**
+     * @brief Destroy the TimerWheel object, disable the timer interrupt.
+     */
+    ~TimerWheel();
+
+
+/*****************************************************************/
+/*                            TIMERS                             */
+/*****************************************************************/
+
+    /**
+     * @brief Start a timer, an active one is restarted.
+     *
+     * @param timer Timer with callback and context set, it must stay valid until
+     * it expires (one shot) or is cancelled.
+     * @param delay Counts from now to the first expiration.
+     * @param period Counts between the expirations, 0 for a one shot timer.
+     *
+     * @return TimerWheel& to chain the function call.
+     */
+    TimerWheel& start(struct wheelTimer_s* timer, uint64_t delay, uint64_t period = 0);
+
+    /**
+     * @brief Start a timer at an absolute deadline, an active one is restarted.
+     * A deadline in the past expires immediately.
+     *
+     * @param deadline Timer count of the first expiration.
+     * @param period Counts between the expirations, 0 for a one shot timer.
+     *
+     * @return TimerWheel& to chain the function call.
+     */
+    TimerWheel& startAt(struct wheelTimer_s* timer, uint64_t deadline, uint64_t period = 0);
+
+    /**
+     * @brief Stop a timer in O(1), from the application or a callback.
+     *
+     * @return True if the timer was active.
+     */
+    bool cancel(struct wheelTimer_s* timer);
+
+    /**
+     * @brief Check if a timer is waiting for its deadline.
+     */
+    inline bool isActive(const struct wheelTimer_s* timer) const {
+        return timer->link != nullptr;
+    };
+
+
+/*****************************************************************/
+/*                             TIME                              */
+/*****************************************************************/
+
+    /**
+     * @brief Read the timer count (the two halves are read consistently).
+     */
+    uint64_t now();
+
+    /**
+     * @brief Earliest deadline of the active timers, TIMER_MAX_TIME if none.
+     */
+    uint64_t nextDeadline();
+
+    /**
+     * @brief Convert microseconds and milliseconds to timer counts.
+     */
+    static constexpr uint64_t micros(uint64_t us) {
+        return us * (SYSTEM_FREQUENCY / 1'000'000);
+    };
+
+    static constexpr uint64_t millis(uint64_t ms) {
+        return ms * (SYSTEM_FREQUENCY / 1000);
+    };
+
+
+/*****************************************************************/
+/*                           INTERRUPT                           */
+/*****************************************************************/
+
+    /**
+     * @brief Run the expired callbacks and program the next deadline. Call it
+     * from the trap handler when the timer interrupt is pending.
+     *
+     * @return The number of callbacks run.
+     */
+    uint32_t interruptHandler();
+
+
+/*****************************************************************/
+/*                             SLEEP                             */
+/*****************************************************************/
+
+    /**
+     * @brief Sleep (wfi) until the next interrupt: at the latest the next
+     * deadline, or forever without active timers and other interrupts.
+     */
+    void idle();
+
+    /**
+     * @brief Sleep for a number of counts, the other timers keep running
+     * (replaces the busy waiting Timer::delay()). Not from a callback.
+     *
+     * @param counts Counts to wait.
+     *
+     * @return TimerWheel& to chain the function call.
+     */
+    TimerWheel& sleep(uint64_t counts);
+
+
+private:
+
+    /* Enter a wheel update, nested. The interrupt handler leaves the wheel
+     * alone while the application is in one. */
+    void lock();
+
+    /* Leave it, the outermost level programs the next deadline */
+    void unlock();
+
+    /* Put a timer in the slot of its deadline, relative to the current tick */
+    void insert(struct wheelTimer_s* timer);
+
+    /* Remove an active timer from its slot */
+    void unlink(struct wheelTimer_s* timer);
+
+    /* First occupied slot and the tick it starts at, false if the wheel is empty */
+    bool nextSlot(uint32_t& index, uint64_t& tick);
+
+    /* Cascade the slots and run the timers due at count */
+    uint32_t advance(uint64_t count);
+
+    /* Earliest deadline, TIMER_MAX_TIME if none */
+    uint64_t earliest();
+
+    /* Program the threshold with the next deadline */
+    void arm();
+
+
+    Timer& timer;
+
+    /* List of the timers beyond the wheel range, after the slot lists */
+    static const uint32_t OVERFLOW_LIST = LEVELS * SLOTS;
+
+    /* Slot lists and their occupancy, one word per level */
+    struct wheelTimer_s* slots[OVERFLOW_LIST + 1];
+    uint32_t occupied[LEVELS];
+
+    /* Every tick before this one has been processed */
+    uint64_t current;
+
+    /* lock() nesting, non zero while the wheel is being changed */
+    volatile uint32_t depth;
+};
+
+#endif
@@ -25,6 +25,15 @@ public:
     /* MAC Address */
     struct macAddr_s { uint8_t byte[6]; };
 
+    /* Payload segment, a frame is sent from a chain of segments without copying them */
+    struct bufferChain_s {
+        const uint8_t* data;
+        uint32_t length;
+
+        /* Next segment, nullptr for the last one */
+        const struct bufferChain_s* next;
+    };
+
     /* Interrupt event */
     enum ethEvent_e {
         /* External PHY interrupt */
@@ -113,6 +122,20 @@ public:
     };
 
 
+    /* Payload FIFO levels register fields */
+    union macPayloadLevel_s {
+        struct fields {
+            /* Free bytes in the TX payload buffer */
+            unsigned int freeTX : 16;
+
+            /* Bytes waiting in the RX payload buffer */
+            unsigned int pendingRX : 16;
+        } fields;
+
+        uint32_t raw;
+    };
+
+
     enum ethDuplex_e { HALF_DUPLEX, FULL_DUPLEX }; 
 
     /* PHY Basic Control Register fields */
@@ -428,6 +451,9 @@ public:
     /* Interrupt pending register */
     volatile uint32_t* const macInterrupt;
 
+    /* Payload FIFO levels */
+    volatile uint32_t* const macPayloadLevel;
+
 
 
     inline uint16_t readPHYRegister(uint8_t regAddr) {
@@ -438,6 +464,15 @@ public:
         *(ethBaseAddress + regAddr) = data;
     };
 
+    /* Payload buffers moving 1 to 4 bytes (LSB first) in a single access */
+    inline volatile uint32_t* macTxBurst(uint32_t bytes) {
+        return ethBaseAddress + 35 + ((bytes - 1) << 3);
+    };
+
+    inline volatile uint32_t* macRxBurst(uint32_t bytes) {
+        return ethBaseAddress + 38 + ((bytes - 1) << 3);
+    };
+
 
 /****************************************************************/
 /*                         CONSTRUCTORS                         */
@@ -563,6 +598,20 @@ public:
      */
     bool isFullPayloadRX();
 
+    /**
+     * @brief Read the number of free bytes in the TX payload buffer.
+     * 
+     * @return The free space in the TX payload buffer.
+     */
+    uint32_t getFreePayloadTX();
+
+    /**
+     * @brief Read the number of bytes waiting in the RX payload buffer.
+     * 
+     * @return The level of the RX payload buffer.
+     */
+    uint32_t getPendingPayloadRX();
+
     /**
      * @brief Check if the TX packet descriptor buffer register is empty.
      * 
@@ -675,6 +724,19 @@ public:
      */
     Ethernet& sendFrame(const uint8_t* packet, uint32_t length, struct macAddr_s destMac, uint16_t type, ethError_e& error);
 
+    /**
+     * @brief Send an Ethernet II frame whose payload is the concatenation of a chain of
+     * segments, each one is copied directly into the MAC payload buffer.
+     * 
+     * @param chain The first segment of the payload.
+     * @param destMac The destination MAC address.
+     * @param type Payload packet identification.
+     * @param error Pointer to an error variable.
+     * 
+     * @return The Ethernet object itself to chain the function call.
+     */
+    Ethernet& sendFrame(const struct bufferChain_s* chain, struct macAddr_s destMac, uint16_t type, ethError_e& error);
+
     /**
      * @brief Receive (IEEE 802.3) the payload received plus 4 bytes of CRC.
      * 
@@ -690,6 +752,38 @@ public:
      */
     Ethernet& receiveFrame(uint8_t* buffer, uint32_t length, uint16_t* type, ethError_e& error);
 
+    /**
+     * @brief Copy bytes into the TX payload buffer, 4 bytes per access. The free space 
+     * is checked once per burst, a tail shorter than 4 bytes is moved in one access.
+     * 
+     * @param data An array of bytes to send.
+     * @param length The number of bytes.
+     * 
+     * @return The Ethernet object itself to chain the function call.
+     */
+    Ethernet& writePayloadTX(const uint8_t* data, uint32_t length);
+
+    /**
+     * @brief Copy bytes out of the RX payload buffer, 4 bytes per access.
+     * 
+     * @param data An array of bytes to fill.
+     * @param length The number of bytes.
+     * 
+     * @warning The bytes must be already in the buffer (e.g. after the RX done event)!
+     * 
+     * @return The Ethernet object itself to chain the function call.
+     */
+    Ethernet& readPayloadRX(uint8_t* data, uint32_t length);
+
+    /**
+     * @brief Discard bytes from the RX payload buffer, 4 bytes per access.
+     * 
+     * @param length The number of bytes.
+     * 
+     * @return The Ethernet object itself to chain the function call.
+     */
+    Ethernet& skipPayloadRX(uint32_t length);
+
     /**
      * @brief Get the packet received descriptor containing the source MAC address and
      * the payload length
@@ -0,0 +1,191 @@
+#ifndef ETHERNET_RX_H
+#define ETHERNET_RX_H
+
+#include <inttypes.h>
+
+#include "../platform.h"
+#include "Ethernet.h"
+
+
+/*
+ *  Interrupt driven receiver for the Ethernet MAC. On every RX_DONE interrupt
+ *  all the frames queued in the MAC (descriptor plus payload) are copied into
+ *  fixed size buffers taken from a preallocated pool and pushed in a ring for
+ *  the application, so bursts of back-to-back frames do not overflow the MAC
+ *  packet buffer while the CPU is busy elsewhere.
+ *
+ *  The interrupt handler is the only producer of the ready ring and the only
+ *  consumer of the free ring, the application is the other end of both: the
+ *  rings are single producer / single consumer and need no lock or interrupt
+ *  masking. If the pool is empty the frame is discarded from the MAC and
+ *  counted as dropped.
+ */
+class EthernetRX {
+
+public:
+
+    /* Number of frame buffers */
+    static const uint32_t POOL_SIZE = ETH_RX_POOL_SIZE;
+
+    static_assert((POOL_SIZE & (POOL_SIZE - 1)) == 0, "ETH_RX_POOL_SIZE must be a power of 2");
+    static_assert(POOL_SIZE <= 256, "ETH_RX_POOL_SIZE must fit the ring indexes");
+
+    /* Payload bytes stored in a buffer: payload plus CRC */
+    static const uint32_t FRAME_SIZE = Ethernet::MAX_PAYLOAD_LENGTH + 4;
+
+
+    /* Received frame */
+    struct rxFrame_s {
+        /* Source MAC address and length / type as read from the MAC */
+        union Ethernet::macDescriptor_s descriptor;
+
+        /* Payload length without padding and CRC */
+        uint16_t length;
+
+        /* Bytes stored in payload (padding and CRC included) */
+        uint16_t size;
+
+        /* EtherType (Ethernet II mode only) */
+        uint16_t etherType;
+
+        /* An RX error was signaled while this frame was the last one received */
+        bool error;
+
+        /* Payload followed by the CRC */
+        uint8_t payload[FRAME_SIZE] __attribute__((aligned(4)));
+    };
+
+
+    /* Receiver counters */
+    struct rxStats_s {
+        /* Frames queued to the application */
+        volatile uint32_t received;
+
+        /* Frames discarded because the pool was empty */
+        volatile uint32_t dropped;
+
+        /* Frames with a length that does not fit a buffer */
+        volatile uint32_t malformed;
+
+        /* RX error events signaled by the MAC */
+        volatile uint32_t errors;
+
+        /* Interrupts that found the MAC packet buffer full (frames may be lost) */
+        volatile uint32_t overflows;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new EthernetRX object, all the buffers are placed in the
+     * free pool. The MAC interrupts are not enabled until enable() is called.
+     *
+     * @param ethernet An initialized Ethernet driver.
+     *
+     * @warning The object holds the whole pool (POOL_SIZE * ~1.5kB), declare it as a global!
+     */
+    EthernetRX(Ethernet& ethernet);
+
+    /**
+     * @brief Destroy the EthernetRX object, disable RX interrupts.
+     */
+    ~EthernetRX();
+
+
+/*****************************************************************/
+/*                         CONFIGURATION                         */
+/*****************************************************************/
+
+    /**
+     * @brief Enable or disable the RX_DONE and RX_ERROR interrupts of the MAC.
+     *
+     * @param enable Enable or disable interrupt driven reception.
+     *
+     * @return The EthernetRX object itself to chain the function call.
+     */
+    EthernetRX& enable(bool enable);
+
+    /**
+     * @brief Drain every frame queued in the MAC into the ring. Call it from the
+     * trap handler when the Ethernet interrupt is pending.
+     *
+     * @warning The MAC interrupt register is cleared, other events are returned
+     * to the caller!
+     *
+     * @return The MAC interrupt pending bits read on entry (Ethernet::ethEvent_e).
+     */
+    uint32_t interruptHandler();
+
+
+/*****************************************************************/
+/*                          RECEPTION                            */
+/*****************************************************************/
+
+    /**
+     * @brief Take the oldest received frame, non blocking.
+     *
+     * @return A pointer to the frame or nullptr if no frame is ready.
+     */
+    struct rxFrame_s* receive();
+
+    /**
+     * @brief Give a frame obtained from receive() back to the pool.
+     *
+     * @param frame The frame to release.
+     *
+     * @return The EthernetRX object itself to chain the function call.
+     */
+    EthernetRX& release(struct rxFrame_s* frame);
+
+    /**
+     * @brief Number of frames ready for the application.
+     *
+     * @return The number of queued frames.
+     */
+    uint32_t pending();
+
+    /**
+     * @brief Get the receiver counters.
+     *
+     * @return The counters updated by the interrupt handler.
+     */
+    const struct rxStats_s& getStats();
+
+
+private:
+
+    /* Single producer / single consumer ring of buffer indexes */
+    struct indexRing_s {
+        /* Written only by the producer */
+        volatile uint32_t head;
+
+        /* Written only by the consumer */
+        volatile uint32_t tail;
+
+        uint8_t slot[POOL_SIZE];
+    };
+
+    static bool push(struct indexRing_s& ring, uint8_t index);
+    static bool pop(struct indexRing_s& ring, uint8_t& index);
+
+    /* Copy a single frame from the MAC, false if the frame was discarded */
+    bool drainFrame(bool ethernetII, bool rxError);
+
+
+    Ethernet& ethernet;
+
+    /* Buffers owned by the interrupt handler */
+    struct indexRing_s freeRing;
+
+    /* Frames owned by the application */
+    struct indexRing_s readyRing;
+
+    struct rxStats_s stats;
+
+    struct rxFrame_s pool[POOL_SIZE];
+};
+
+#endif
@@ -23,7 +23,7 @@ public:
     enum busWidth_e { BUS_NARROW, BUS_WIDE };
     
     /* SD Clock speed */
-    enum clockSpeed_e { CLK_400KHZ, CLK_25MHZ };
+    enum clockSpeed_e { CLK_400KHZ, CLK_25MHZ, CLK_50MHZ };
 
     /* Error type */
     enum errorType_e { NO_ERROR, CMD_TIMEOUT, CMD_CRC_ERR, DAT_TIMEOUT, DAT_CRC_ERR, DAT_ERR, CARD_ERR, NO_CARD };
@@ -83,7 +83,7 @@ public:
 
         /* Set the clock speed, a sequence of commands must 
          * be issued before changing this configuration */
-        unsigned int clockSpeed : 1;
+        unsigned int clockSpeed : 2;
 
         /* Flush TX Buffer after a fault */
         unsigned int flushTX : 1;
@@ -94,7 +94,7 @@ public:
         /* Send a physical reset signal of 1ms to the SD card */
         unsigned int resetCard : 1;
 
-        unsigned int padding : 18;
+        unsigned int padding : 17;
     };
 
     struct sdStatus_s {
@@ -125,7 +125,10 @@ public:
         /* Card is inserted in the slot */
         unsigned int cardDetected : 1;
 
-        unsigned int padding : 7;
+        /* Write waiting for the next block to be in the TX Buffer */
+        unsigned int dataWaitTX : 1;
+
+        unsigned int padding : 6;
     };
 
     struct sdInterruptStatus_s {
@@ -212,6 +215,12 @@ public:
 
     SD& setClockSpeed(clockSpeed_e speed);
 
+    /* Switch the card to High-Speed mode with CMD6 and the bus to 50 MHz, the
+     * card must be in transfer state. CARD_ERR if the card doesn't support it */
+    SD& setHighSpeed(errorType_e& error);
+
+    clockSpeed_e getClockSpeed();
+
     SD& setBusWidth(busWidth_e width, errorType_e& error);
 
     SD& setInterruptEnable(bool enable, uint32_t position);
@@ -254,9 +263,35 @@ public:
 
     SD& readBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* burstRead, uint8_t* responseBuffer,  errorType_e& error);
 
+    /* Same as above but each block is stored in its own buffer of the list */
+    SD& readBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* const* blockList, uint8_t* responseBuffer,  errorType_e& error);
+
     SD& writeBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* burstWrite, uint8_t* responseBuffer,  errorType_e& error);
 
 
+/*****************************************************************/
+/*                        STREAM TRANSFER                        */
+/*****************************************************************/
+
+    /* Open ended write (CMD25), the blocks are queued one by one with writeStreamBlock() 
+     * and the card waits for them. preEraseBlocks is sent with ACMD23 (0 to skip it) */
+    SD& startWriteStream(uint32_t baseAddress, uint32_t preEraseBlocks, uint8_t* responseBuffer, errorType_e& error);
+
+    /* Queue the next block of the stream without waiting, false if the TX buffer 
+     * still holds the previous one or on error (DAT_TIMEOUT if the card stayed busy) */
+    bool writeStreamBlock(const uint32_t* block, errorType_e& error);
+
+    /* Wait for the queued blocks and end the stream (CMD12), the card programming
+     * time after it is not waited: poll CMD13 until the card is back in TRAN */
+    SD& stopWriteStream(errorType_e& error);
+
+    /* Single block write (CMD24) that doesn't wait for the transfer, poll isWriteDone() */
+    SD& startWriteBlock(uint32_t blockAddress, const uint32_t* blockWrite, uint8_t* responseBuffer, errorType_e& error);
+
+    /* Every queued block has been written, also true on error (the TX buffer is flushed) */
+    bool isWriteDone(errorType_e& error);
+
+
 /*****************************************************************/
 /*                             FLUSH                             */
 /*****************************************************************/
@@ -278,6 +313,9 @@ public:
 
     SD& readOCR(uint8_t* ocrBuffer, errorType_e& error);    // 4 bytes
 
+    /* CMD6 SWITCH_FUNC status, MSB-first */
+    SD& readSwitchStatus(uint32_t argument, uint8_t* statusBuffer, errorType_e& error);    // 64 bytes
+
 
 /*****************************************************************/
 /*                              BOOT                             */
@@ -0,0 +1,195 @@
+#ifndef SD_QUEUE_H
+#define SD_QUEUE_H
+
+#include <inttypes.h>
+
+#include "../platform.h"
+#include "SD.h"
+
+
+/*
+ *  Asynchronous block I/O on top of the SD driver. Requests are queued by the
+ *  application and executed one after the other, the data FIFOs are serviced
+ *  from the SD interrupt so the CPU is free while the card is busy (access
+ *  time, data transfer, programming). Only the command / response exchange
+ *  of each transfer (a few microseconds) is still polled.
+ *
+ *  Consecutive requests in the same direction on adjacent blocks are merged
+ *  in a single CMD18 / CMD25 burst, up to MAX_BURST blocks. A larger request
+ *  is split in commands of MAX_BURST blocks.
+ *
+ *  The controller FIFOs hold exactly one block and the card can't be paused:
+ *  during a multi-block read the handler must start draining a full FIFO
+ *  before the first word of the next block arrives (~1 us at 25 MHz wide
+ *  bus). With long interrupt latencies set SD_QUEUE_MAX_BURST to 1, every
+ *  block is then a single block command and has no timing constraint.
+ *
+ *  The application is the only producer of the queue and the interrupt
+ *  handler the only consumer: submit() must not be called from an interrupt
+ *  (completion callbacks included).
+ */
+class SDQueue {
+
+public:
+
+    /* Number of queued requests */
+    static const uint32_t QUEUE_SIZE = SD_QUEUE_SIZE;
+
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "SD_QUEUE_SIZE must be a power of 2");
+
+    /* Maximum blocks of a command, larger requests are split */
+    static const uint32_t MAX_BURST = SD_QUEUE_MAX_BURST;
+
+
+    struct sdRequest_s;
+
+    /**
+     * @brief Called from the interrupt handler when a request completes.
+     *
+     * @param request The completed request, error and done are valid.
+     */
+    typedef void (*sdCallback_t)(struct sdRequest_s* request);
+
+
+    /* Block I/O request, owned by the queue from submit() until done is set */
+    struct sdRequest_s {
+        /* Transfer direction */
+        bool write;
+
+        /* First block number */
+        uint32_t block;
+
+        /* Number of blocks, at least one */
+        uint32_t count;
+
+        /* Data, count * 128 words */
+        uint32_t* buffer;
+
+        /* Optional completion callback and its user data */
+        sdCallback_t callback;
+        void* context;
+
+        /* Set by the queue */
+        volatile bool done;
+        volatile SD::errorType_e error;
+    };
+
+
+    /* Queue counters */
+    struct sdQueueStats_s {
+        /* Completed requests and blocks */
+        volatile uint32_t requests;
+        volatile uint32_t blocks;
+
+        /* Read / write commands issued */
+        volatile uint32_t commands;
+
+        /* Requests that joined the burst of a previous one */
+        volatile uint32_t merged;
+
+        /* Requests completed with an error */
+        volatile uint32_t errors;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new SDQueue object.
+     *
+     * @param card An initialized SD driver.
+     * @param highCapacity Block addressing (SDHC / SDXC), from SD::init().
+     */
+    SDQueue(SD& card, bool highCapacity);
+
+    /**
+     * @brief Destroy the SDQueue object, disable the SD interrupts.
+     */
+    ~SDQueue();
+
+
+/*****************************************************************/
+/*                           REQUESTS                            */
+/*****************************************************************/
+
+    /**
+     * @brief Queue a request, the transfer starts immediately if the queue is idle.
+     *
+     * @param request The request, it must stay valid until done is set.
+     *
+     * @return False if the queue is full or the request has no block.
+     */
+    bool submit(struct sdRequest_s* request);
+
+    /**
+     * @brief Service the SD FIFOs and start the next transfer. Call it from the
+     * trap handler when the SD interrupt is pending.
+     *
+     * @return The SD event bits read on entry (SD::sdInterruptStatus_s).
+     */
+    uint32_t interruptHandler();
+
+    /**
+     * @brief Number of requests not completed yet.
+     */
+    uint32_t pending();
+
+    /**
+     * @brief Check if every request has completed.
+     */
+    bool isIdle();
+
+    /**
+     * @brief Get the queue counters.
+     */
+    const struct sdQueueStats_s& getStats();
+
+
+private:
+
+    /* Start the transfer of the requests at the tail of the queue */
+    void start();
+
+    /* Complete the requests of the active transfer and start the next one */
+    void complete(SD::errorType_e error);
+
+    /* Buffer of the next block of the active transfer */
+    uint32_t* nextBlock();
+
+    /* Sticky data errors of the controller, cleared when read */
+    SD::errorType_e dataError();
+
+    uint32_t cardAddress(uint32_t block);
+
+
+    SD& card;
+    bool highCapacity;
+
+    /* Requests, written by the application at head and retired by the handler at tail */
+    struct sdRequest_s* ring[QUEUE_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+
+    /* A transfer is in progress */
+    volatile bool active;
+
+    /* Active transfer: first requests of the ring merged in a single command,
+     * requests is 0 when the command is only a part of the first one */
+    bool write;
+    uint32_t requests;
+    uint32_t blocks;
+
+    /* Blocks moved through the FIFO */
+    uint32_t transferred;
+
+    /* Position of the next block, requestBlock is kept from one command to the
+     * next one of a split request */
+    uint32_t requestIndex;
+    uint32_t requestBlock;
+
+    struct sdQueueStats_s stats;
+};
+
+#endif
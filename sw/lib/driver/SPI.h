@@ -4,12 +4,20 @@
 #include <inttypes.h>
 
 #include "../mmio.h"
+#include "../platform.h"
 
 class SPI {
 
 public:
 
     enum spiError_e { NO_ERROR, ILLEGAL_CLOCK, INDEX_OUT_OF_RANGE, RECEIVE_SIZE_ERROR };
+
+    /* Depth of the TX and RX buffers */
+    static const uint32_t BUFFER_SIZE = SPI_BUFFER_SIZE;
+
+    /* Byte sent when there is no TX data */
+    static const uint8_t DUMMY_BYTE = 0xFF;
+
     /* Bit sent first */
     enum bitOrder_e { MSB_FIRST, LSB_FIRST };
 
@@ -224,13 +232,32 @@ public:
      * and retrieve the received bytes. Warning! The function is blocking, so it won't return until 
      * the transaction ends!
      * 
-     * @param txBuf Buffer containing data to send.
-     * @param rxBuf Buffer that will contain the read data at the end of the transaction.
+     * The TX buffer is refilled and the RX buffer drained as their levels permit, the size is not
+     * limited by the hardware buffers and the chip select stays low for the whole stream as long
+     * as the CPU refills faster than a byte time (16 cycles at the highest SCLK).
+     * 
+     * @param txBuf Buffer containing data to send, nullptr to send DUMMY_BYTE.
+     * @param rxBuf Buffer that will contain the read data at the end of the transaction, nullptr to discard it.
      * @param size Transaction size.
      * 
      * @return The SPI object itself to chain the function call.
      */
-    SPI& exchangeStream(uint8_t* txBuf, uint8_t* rxBuf, uint32_t size);
+    SPI& exchangeStream(const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size);
+
+    /**
+     * @brief Command followed by data in the same chip select window (e.g. a memory read: opcode
+     * and address, then the data bytes). The bytes received during the command are discarded.
+     * Blocking, streamed like exchangeStream().
+     * 
+     * @param command Command bytes.
+     * @param commandSize Number of command bytes.
+     * @param txBuf Data to send after the command, nullptr to send DUMMY_BYTE.
+     * @param rxBuf Data received after the command, nullptr to discard it.
+     * @param size Number of data bytes.
+     * 
+     * @return The SPI object itself to chain the function call.
+     */
+    SPI& transaction(const uint8_t* command, uint32_t commandSize, const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size);
 
     /**
      * @brief Primitive type transaction: send a number of bytes based on the primitive type passed, 
@@ -273,6 +300,9 @@ public:
 
 private: 
 
+    /* Stream engine of exchangeStream() and transaction() */
+    void stream(const uint8_t* command, uint32_t commandSize, const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size);
+
     /**
      * @brief Extract bytes from a primitive type.
      * 
@@ -0,0 +1,223 @@
+#ifndef SPI_FLASH_H
+#define SPI_FLASH_H
+
+#include <inttypes.h>
+
+#include "../platform.h"
+#include "SPI.h"
+
+
+/*
+ *  SPI NOR flash (W25Q, MX25L, IS25LP command set, 3 byte addresses) on top of
+ *  the SPI driver. The SPI device must be initialized by the application in
+ *  MODE0 or MODE3, MSB first.
+ *
+ *  Reads are a single Fast Read (0x0B) command of any size: SPI::transaction()
+ *  streams the TX and RX buffers, the chip select stays low and the device
+ *  increments the address by itself.
+ *
+ *  Program and erase don't wait for the device: the command is sent and the
+ *  driver only remembers that the flash is busy. The next operation polls the
+ *  status register first, so a sector erase runs in the background until the
+ *  flash is used again (isBusy() checks it without blocking). program() splits
+ *  the data at page boundaries and prepares every page (its command and, with
+ *  a fill callback, its data) while the previous one is being programmed.
+ *
+ *  Programming only clears bits: the sectors must be erased first.
+ */
+class SPIFlash {
+
+public:
+
+    /* Program and erase units */
+    static const uint32_t PAGE_SIZE = 256;
+    static const uint32_t SECTOR_SIZE = 4096;
+
+    /* Status polls before a busy device is reported, longer than a sector erase */
+    static const uint32_t BUSY_POLLS = 1000000;
+
+    /* Error type */
+    enum flashError_e { NO_ERROR, NOT_DETECTED, OUT_OF_RANGE, WRITE_PROTECTED, TIMEOUT };
+
+    /* JEDEC identification */
+    struct flashId_s {
+        uint8_t manufacturer;
+        uint8_t memoryType;
+
+        /* Size is 2^capacity bytes */
+        uint8_t capacity;
+    };
+
+
+    /**
+     * @brief Produce the data of a page program.
+     *
+     * @param page Destination, size bytes.
+     * @param offset Offset of the page data from the start of the program() call.
+     * @param size Bytes to produce, at most PAGE_SIZE.
+     * @param context User data passed to program().
+     */
+    typedef void (*flashFill_t)(uint8_t* page, uint32_t offset, uint32_t size, void* context);
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new SPIFlash object.
+     *
+     * @param spi An initialized SPI driver.
+     * @param slave Chip select of the flash.
+     */
+    SPIFlash(SPI& spi, uint32_t slave);
+
+
+/*****************************************************************/
+/*                        IDENTIFICATION                         */
+/*****************************************************************/
+
+    /**
+     * @brief Read the JEDEC ID and the device size, wait for an operation in
+     * progress (e.g. an erase started before a reset).
+     *
+     * @param error Reference to an error variable, NOT_DETECTED if nothing answers.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& init(flashError_e& error);
+
+    /**
+     * @brief JEDEC ID read by init().
+     */
+    inline struct flashId_s getId() {
+        return id;
+    };
+
+    /**
+     * @brief Size in bytes, 0 before init(). Capped to 16 MiB (3 byte addresses).
+     */
+    inline uint32_t getSize() {
+        return size;
+    };
+
+
+/*****************************************************************/
+/*                           TRANSFERS                           */
+/*****************************************************************/
+
+    /**
+     * @brief Read a region with one Fast Read command, waits for a program or
+     * erase in progress first.
+     *
+     * @param address First byte.
+     * @param buffer Destination.
+     * @param count Number of bytes, not limited by the SPI buffers.
+     * @param error Reference to an error variable.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& read(uint32_t address, uint8_t* buffer, uint32_t count, flashError_e& error);
+
+    /**
+     * @brief Program a region split in pages, returns while the last page is
+     * being programmed.
+     *
+     * @param address First byte, any alignment.
+     * @param data Source data.
+     * @param count Number of bytes.
+     * @param error Reference to an error variable.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& program(uint32_t address, const uint8_t* data, uint32_t count, flashError_e& error);
+
+    /**
+     * @brief Program a region whose data is produced page by page: the next page
+     * is filled while the previous one is being programmed.
+     *
+     * @param address First byte, any alignment.
+     * @param count Number of bytes.
+     * @param fill Called once per page before the device is polled.
+     * @param context User data of the callback.
+     * @param error Reference to an error variable.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& program(uint32_t address, uint32_t count, flashFill_t fill, void* context, flashError_e& error);
+
+    /**
+     * @brief Start the erase of the 4 KiB sector containing address and return,
+     * the erase goes on in the background.
+     *
+     * @param address Any address of the sector.
+     * @param error Reference to an error variable.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& eraseSector(uint32_t address, flashError_e& error);
+
+
+/*****************************************************************/
+/*                            STATUS                             */
+/*****************************************************************/
+
+    /**
+     * @brief Check without blocking if a program or erase is in progress, the
+     * status register is read only while the driver knows the device is busy.
+     */
+    bool isBusy();
+
+    /**
+     * @brief Wait for the program or erase in progress.
+     *
+     * @param error Reference to an error variable, TIMEOUT after BUSY_POLLS reads.
+     *
+     * @return SPIFlash& to chain the function call.
+     */
+    SPIFlash& wait(flashError_e& error);
+
+
+private:
+
+    /* Commands */
+    enum flashCommand_e : uint8_t {
+        PAGE_PROGRAM = 0x02,
+        READ_STATUS = 0x05,
+        WRITE_ENABLE = 0x06,
+        FAST_READ = 0x0B,
+        SECTOR_ERASE = 0x20,
+        JEDEC_ID = 0x9F
+    };
+
+    /* Status register 1 bits */
+    static const uint8_t STATUS_BUSY = 1 << 0;
+    static const uint8_t STATUS_WEL = 1 << 1;
+
+    /* Read the status register */
+    uint8_t readStatus();
+
+    /* Set the write enable latch, the device must be idle */
+    bool writeEnable();
+
+    /* Build an opcode and 3 address bytes command */
+    void command(uint8_t* bytes, uint8_t opcode, uint32_t address);
+
+    /* Page program engine of both program() */
+    void programPages(uint32_t address, const uint8_t* data, uint32_t count, flashFill_t fill, void* context, flashError_e& error);
+
+
+    SPI& spi;
+    uint32_t slave;
+
+    struct flashId_s id;
+    uint32_t size;
+
+    /* A program or erase was started and not seen completed yet */
+    bool busy;
+
+    /* Page filled by the callback of program() */
+    uint8_t page[PAGE_SIZE];
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef SPI_QUEUE_H
+#define SPI_QUEUE_H
+
+#include <inttypes.h>
+
+#include "../platform.h"
+#include "SPI.h"
+
+
+/*
+ *  Interrupt driven transactions on top of the SPI driver. Transactions are
+ *  queued by the application and executed one after the other, each one with
+ *  its own slave: the chip select is low from the first command byte to the
+ *  last data byte.
+ *
+ *  The transaction end interrupt fires once the TX buffer has been emptied,
+ *  the chip select is raised at the same time. A transaction is therefore
+ *  written to the TX buffer in one go and must fit it: command and data at
+ *  most SPI_BUFFER_SIZE bytes. Longer transfers go through the blocking
+ *  SPI::transaction() stream, or are split by the caller in transactions
+ *  that the device accepts (e.g. memory reads at increasing addresses).
+ *
+ *  The SPI device belongs to the queue: don't use it directly while
+ *  transactions are pending. The application is the only producer of the
+ *  queue and the interrupt handler the only consumer: submit() must not be
+ *  called from an interrupt (completion callbacks included).
+ */
+class SPIQueue {
+
+public:
+
+    /* Number of queued transactions */
+    static const uint32_t QUEUE_SIZE = SPI_QUEUE_SIZE;
+
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0, "SPI_QUEUE_SIZE must be a power of 2");
+
+
+    struct spiTransaction_s;
+
+    /**
+     * @brief Called from the interrupt handler when a transaction completes.
+     *
+     * @param transaction The completed transaction, error and done are valid.
+     */
+    typedef void (*spiCallback_t)(struct spiTransaction_s* transaction);
+
+
+    /* Chip select scoped transaction, owned by the queue from submit() until done is set */
+    struct spiTransaction_s {
+        /* Slave index, lower than SPI_SLAVES */
+        uint32_t slave;
+
+        /* Sent first, the bytes received meanwhile are discarded */
+        const uint8_t* command;
+        uint32_t commandSize;
+
+        /* Exchanged after the command: nullptr TX sends SPI::DUMMY_BYTE, nullptr RX discards */
+        const uint8_t* txData;
+        uint8_t* rxData;
+        uint32_t size;
+
+        /* Optional completion callback and its user data */
+        spiCallback_t callback;
+        void* context;
+
+        /* Set by the queue */
+        volatile bool done;
+        volatile SPI::spiError_e error;
+    };
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new SPIQueue object and enable the transaction end interrupt.
+     *
+     * @param spi An initialized SPI driver.
+     */
+    SPIQueue(SPI& spi);
+
+    /**
+     * @brief Destroy the SPIQueue object, disable the SPI interrupt.
+     */
+    ~SPIQueue();
+
+
+/*****************************************************************/
+/*                         TRANSACTIONS                          */
+/*****************************************************************/
+
+    /**
+     * @brief Queue a transaction, it starts immediately if the queue is idle.
+     *
+     * @param transaction The transaction, it must stay valid until done is set.
+     *
+     * @return False if the queue is full, the slave doesn't exist or the transaction
+     * is empty or doesn't fit the TX buffer.
+     */
+    bool submit(struct spiTransaction_s* transaction);
+
+    /**
+     * @brief Retrieve the received bytes and start the next transaction. Call it
+     * from the trap handler when the SPI interrupt is pending.
+     *
+     * @return The SPI event register read on entry.
+     */
+    uint32_t interruptHandler();
+
+    /**
+     * @brief Number of transactions not completed yet.
+     */
+    uint32_t pending();
+
+    /**
+     * @brief Check if every transaction has completed.
+     */
+    bool isIdle();
+
+
+private:
+
+    /* Select the slave of the transaction at the tail and fill the TX buffer */
+    void start();
+
+
+    SPI& spi;
+
+    /* Transactions, written by the application at head and retired by the handler at tail */
+    struct spiTransaction_s* ring[QUEUE_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+
+    /* A transaction is on the bus */
+    volatile bool active;
+};
+
+#endif
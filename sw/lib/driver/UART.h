@@ -4,6 +4,7 @@
 #include <inttypes.h>
 
 #include "../mmio.h"
+#include "../platform.h"
 
 class UART {
 
@@ -244,6 +245,21 @@ public:
      * @return The byte stored inside the RX buffer.
      */
     UART& unloadBufferRX (uint8_t* data, uint32_t size);
+
+    /**
+     * @brief Wait until the last byte has left the line: the TX buffer is empty and the
+     * frame in the shift register has been sent (UART_FRAME_BITS bit times).
+     *
+     * @param status Control and status register of the UART.
+     */
+    static inline void waitSent(volatile struct uartCtrlStatus_s* status) {
+        while (!status->emptyTX) {  }
+
+        /* Every iteration takes at least one clock cycle */
+        uint32_t frameCycles = UART_FRAME_BITS * 16 * (status->clockDivider + 1);
+
+        for (volatile uint32_t i = 0; i < frameCycles; ++i) {  }
+    }
 };
 
 #endif
\ No newline at end of file
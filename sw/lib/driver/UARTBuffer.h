@@ -0,0 +1,135 @@
+#ifndef UART_BUFFER_H
+#define UART_BUFFER_H
+
+#include <inttypes.h>
+
+#include "../platform.h"
+#include "../Serial_IO.h"
+#include "UART.h"
+
+
+/*
+ *  Interrupt driven software rings on top of a UART. write() and read() never
+ *  wait: they return the number of bytes accepted / copied.
+ *
+ *  TX: while nothing is waiting in the ring the bytes go straight to the
+ *  hardware buffer, the rest is queued and the TX_EMPTY interrupt refills
+ *  the hardware buffer (the interrupt is enabled only while the ring holds
+ *  data). RX: the DATA_RX interrupt moves every received byte to the ring,
+ *  bytes are dropped (and counted) when the ring is full.
+ *
+ *  interruptHandler() must be called from the trap handler when the UART
+ *  interrupt is pending. The application is the only producer of the TX
+ *  ring and the only consumer of the RX ring.
+ */
+class UARTBuffer {
+
+public:
+
+    /* Ring sizes in bytes */
+    static const uint32_t TX_SIZE = UART_TX_RING_SIZE;
+    static const uint32_t RX_SIZE = UART_RX_RING_SIZE;
+
+    static_assert((TX_SIZE & (TX_SIZE - 1)) == 0, "UART_TX_RING_SIZE must be a power of 2");
+    static_assert((RX_SIZE & (RX_SIZE - 1)) == 0, "UART_RX_RING_SIZE must be a power of 2");
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+    /**
+     * @brief Construct a new UARTBuffer object and enable the RX interrupt.
+     *
+     * @param uart An initialized UART, its TX_EMPTY and DATA_RX interrupts are managed by the buffer.
+     */
+    UARTBuffer(UART& uart);
+
+
+/*****************************************************************/
+/*                         COMMUNICATION                         */
+/*****************************************************************/
+
+    /**
+     * @brief Queue bytes to send, doesn't wait.
+     *
+     * @param data Bytes to send.
+     * @param size Number of bytes.
+     *
+     * @return The number of bytes accepted, less than size when the ring is full.
+     */
+    uint32_t write(const uint8_t* data, uint32_t size);
+
+    /**
+     * @brief Take the received bytes, doesn't wait.
+     *
+     * @param data Destination.
+     * @param size Maximum number of bytes.
+     *
+     * @return The number of bytes copied.
+     */
+    uint32_t read(uint8_t* data, uint32_t size);
+
+    /**
+     * @brief Number of received bytes waiting in the RX ring.
+     */
+    uint32_t available();
+
+    /**
+     * @brief Wait until every byte has been sent on the line (before a reset or at the end
+     * of a benchmark). It polls the hardware, interrupts can be disabled.
+     *
+     * @return The UARTBuffer object itself to chain the function call.
+     */
+    UARTBuffer& flush();
+
+    /**
+     * @brief Number of received bytes lost because the RX ring was full.
+     */
+    uint32_t getDropped();
+
+
+/*****************************************************************/
+/*                           INTERRUPT                           */
+/*****************************************************************/
+
+    /**
+     * @brief Move the received bytes to the RX ring and refill the hardware TX buffer.
+     * Call it from the trap handler when the UART interrupt is pending.
+     *
+     * @return The UART event bits read on entry (UART::uartEvent_e).
+     */
+    uint32_t interruptHandler();
+
+
+private:
+
+    /* Ring to hardware buffer until one of them is full, the TX interrupt is disabled once the ring is empty */
+    void fillTX();
+
+
+    UART& uart;
+
+    /* Free running indices: head is written by the producer, tail by the consumer */
+    volatile uint8_t txRing[TX_SIZE];
+    volatile uint32_t txHead;
+    volatile uint32_t txTail;
+
+    volatile uint8_t rxRing[RX_SIZE];
+    volatile uint32_t rxHead;
+    volatile uint32_t rxTail;
+
+    volatile uint32_t rxDropped;
+};
+
+
+/* Inline so that Serial_IO references the rings only in the programs that use them */
+inline void Serial_IO::setBuffer(UARTBuffer* uartBuffer) {
+    bufferWrite = [](UARTBuffer* rings, const uint8_t* data, uint32_t size) { return rings->write(data, size); };
+    bufferRead = [](UARTBuffer* rings, uint8_t* data, uint32_t size) { return rings->read(data, size); };
+    bufferFlush = [](UARTBuffer* rings) { rings->flush(); };
+
+    buffer = uartBuffer;
+};
+
+#endif
@@ -1,4 +1,4 @@
-#include <cstdint>
+#include <stdint.h>
 
 /* Frequency of the system in Hz */
 #define SYSTEM_FREQUENCY 100000000
@@ -10,6 +10,16 @@
 /* Maximum time count */
 #define TIMER_MAX_TIME UINT64_MAX
 
+/* Levels of the software timer wheel, each one has 32 slots */
+#ifndef TIMER_WHEEL_LEVELS
+#define TIMER_WHEEL_LEVELS 5
+#endif
+
+/* Timer counts per timer wheel tick (log2), 10 is about 10 us at 100 MHz */
+#ifndef TIMER_WHEEL_TICK_SHIFT
+#define TIMER_WHEEL_TICK_SHIFT 10
+#endif
+
 /* Number of GPIO groups */
 #define GPIO_GROUP_NUMBER 1
 
@@ -19,11 +29,25 @@
 /* The UART ID for debugging */
 #define DEBUG_UART 0
 
+/* Longest UART frame (start, 8 data, parity, 2 stop bits): the time the shift
+ * register needs to send the last byte once the TX buffer is empty */
+#define UART_FRAME_BITS 12
+
 /* SPI slave number */
 #ifndef SPI_SLAVES
 #define SPI_SLAVES 1
 #endif
 
+/* Depth of the SPI TX and RX buffers (SPI_*_BUFFER_SIZE in soc_parameters.sv) */
+#ifndef SPI_BUFFER_SIZE
+#define SPI_BUFFER_SIZE 512
+#endif
+
+/* Number of transactions of the SPI transaction queue (power of 2) */
+#ifndef SPI_QUEUE_SIZE
+#define SPI_QUEUE_SIZE 8
+#endif
+
 /* Size of non cachable memory */
 #define NC_MEMORY_SIZE 2048
 
@@ -31,3 +55,60 @@
 #define CUSTOM_WAVE_SIZE 2048
 
 #define DDR2_MEMORY_SIZE (1 << 27)
+
+/* Number of frame buffers of the Ethernet RX ring (power of 2) */
+#ifndef ETH_RX_POOL_SIZE
+#define ETH_RX_POOL_SIZE 8
+#endif
+
+/* Timer counts before an unanswered ARP request is sent again (100 ms) */
+#ifndef NET_ARP_RETRY
+#define NET_ARP_RETRY (SYSTEM_FREQUENCY / 10)
+#endif
+
+/* MAC address of the SoC (ETH_MAC_ADDRESS in soc_parameters.sv) */
+#define ETH_MAC_ADDRESS 0xDEADBEEF0000ULL
+
+/* Number of requests of the SD request queue (power of 2) */
+#ifndef SD_QUEUE_SIZE
+#define SD_QUEUE_SIZE 8
+#endif
+
+/* Maximum blocks of a merged SD burst, 1 disables merging */
+#ifndef SD_QUEUE_MAX_BURST
+#define SD_QUEUE_MAX_BURST 8
+#endif
+
+/* Number of 512 byte sectors of the SD block cache */
+#ifndef BLOCK_CACHE_LINES
+#define BLOCK_CACHE_LINES 16
+#endif
+
+/* Sectors read ahead on a sequential cache miss, 0 disables read ahead */
+#ifndef BLOCK_CACHE_READ_AHEAD
+#define BLOCK_CACHE_READ_AHEAD 4
+#endif
+
+/* Blocks of the audio recorder RAM ring, they absorb the SD card busy time */
+#ifndef RECORDER_BUFFERS
+#define RECORDER_BUFFERS 8
+#endif
+
+/* Blocks of a single recorder CMD25 stream, the index block is updated after each */
+#ifndef RECORDER_SEGMENT_BLOCKS
+#define RECORDER_SEGMENT_BLOCKS 2048
+#endif
+
+/* Bytes of the UARTBuffer software rings (power of 2) */
+#ifndef UART_TX_RING_SIZE
+#define UART_TX_RING_SIZE 1024
+#endif
+
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE 256
+#endif
+
+/* Words of the Log record ring (power of 2) */
+#ifndef LOG_RING_WORDS
+#define LOG_RING_WORDS 512
+#endif
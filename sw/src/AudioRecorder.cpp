@@ -0,0 +1,309 @@
+#ifndef AUDIO_RECORDER_CPP
+#define AUDIO_RECORDER_CPP
+
+#include "../lib/AudioRecorder.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+static_assert(RECORDER_BUFFERS > 1, "RECORDER_BUFFERS must be at least 2");
+static_assert(RECORDER_SEGMENT_BLOCKS > 0 && RECORDER_SEGMENT_BLOCKS <= 0x7FFFFF, "RECORDER_SEGMENT_BLOCKS must fit ACMD23");
+
+
+static uint32_t indexChecksum(const struct AudioRecorder::recorderIndex_s& index) {
+    const uint32_t* words = (const uint32_t *) &index;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < (sizeof(index) / 4) - 1; ++i) {
+        sum += words[i];
+    }
+
+    return sum;
+}
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+AudioRecorder::AudioRecorder(SD& sdCard, AudioCapture& capture, bool isHighCapacity) :
+    card(sdCard), microphone(capture), highCapacity(isHighCapacity) {
+
+    state = STOPPED;
+    stopping = false;
+
+    head = 0;
+    tail = 0;
+    pending = 0;
+    fill = 0;
+
+    segmentBlocks = 0;
+
+    index = {};
+    stats = {};
+};
+
+
+/*****************************************************************/
+/*                           RECORDING                           */
+/*****************************************************************/
+
+AudioRecorder& AudioRecorder::start(uint32_t indexBlock, uint32_t sampleRate, uint32_t channels, recorderError_e& error) {
+    if (state != STOPPED || channels == 0 || channels > 2) {
+        error = ILLEGAL_ARGUMENTS;
+
+        return *this;
+    }
+
+    head = 0;
+    tail = 0;
+    pending = 0;
+    fill = 0;
+    stopping = false;
+
+    stats = {};
+
+    index = {};
+    index.magic = INDEX_MAGIC;
+    index.sampleRate = sampleRate;
+    index.channels = channels;
+    index.firstBlock = indexBlock + 1;
+
+    /* The first index is written while the ring already fills */
+    state = PROGRAMMING;
+
+    microphone.startRecording();
+
+    return *this;
+};
+
+
+bool AudioRecorder::poll(recorderError_e& error) {
+    if (state == STOPPED) {
+        return false;
+    }
+
+    capture();
+
+    if (!transfer()) {
+        abort(error);
+
+        return false;
+    }
+
+    return state != STOPPED;
+};
+
+
+AudioRecorder& AudioRecorder::stop(recorderError_e& error) {
+    if (state == STOPPED) {
+        error = NOT_RECORDING;
+
+        return *this;
+    }
+
+    microphone.stopRecording();
+
+    /* The capture buffer keeps the samples already converted */
+    while (!microphone.isEmpty()) {
+        if (!poll(error)) {
+            return *this;
+        }
+    }
+
+    /* Zero pad the last block */
+    if (fill != 0) {
+        /* An odd sample count already left the upper half of its word clear */
+        for (uint32_t i = (fill + 1) / 2; i < BLOCK_WORDS; ++i) {
+            ring[head][i] = 0;
+        }
+
+        head = (head + 1) % RECORDER_BUFFERS;
+        ++pending;
+        fill = 0;
+    }
+
+    stopping = true;
+
+    while (poll(error)) {  }
+
+    return *this;
+};
+
+
+const struct AudioRecorder::recorderStats_s& AudioRecorder::getStats() {
+    return stats;
+};
+
+
+/*****************************************************************/
+/*                           RECOVERY                            */
+/*****************************************************************/
+
+AudioRecorder& AudioRecorder::readIndex(uint32_t indexBlock, struct recorderIndex_s& saved, recorderError_e& error) {
+    SD::errorType_e cardError = SD::NO_ERROR;
+
+    card.readBlock(cardAddress(indexBlock), indexBuffer, nullptr, cardError);
+
+    if (cardError != SD::NO_ERROR) {
+        error = SD_ERROR;
+
+        return *this;
+    }
+
+    uint32_t* words = (uint32_t *) &saved;
+
+    for (uint32_t i = 0; i < sizeof(saved) / 4; ++i) {
+        words[i] = indexBuffer[i];
+    }
+
+    if (saved.magic != INDEX_MAGIC || saved.checksum != indexChecksum(saved)) {
+        error = NO_INDEX;
+    }
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                            PRIVATE                            */
+/*****************************************************************/
+
+void AudioRecorder::capture() {
+    /* Checked before draining: the buffer filled up since the last call */
+    if (microphone.isFull()) {
+        ++stats.overruns;
+    }
+
+    while (!microphone.isEmpty()) {
+        /* Ring full, leave the samples in the capture buffer */
+        if (pending == RECORDER_BUFFERS) {
+            break;
+        }
+
+        /* Offset binary to signed */
+        uint32_t sample = microphone.readSample() ^ 0x8000;
+
+        if (fill & 1) {
+            ring[head][fill / 2] |= sample << 16;
+        } else {
+            ring[head][fill / 2] = sample;
+        }
+
+        ++stats.samples;
+
+        if (++fill == BLOCK_SAMPLES) {
+            head = (head + 1) % RECORDER_BUFFERS;
+            ++pending;
+            fill = 0;
+
+            if (pending > stats.maxPending) {
+                stats.maxPending = pending;
+            }
+        }
+    }
+};
+
+
+bool AudioRecorder::transfer() {
+    SD::errorType_e error = SD::NO_ERROR;
+
+    switch (state) {
+        case STREAMING:
+            if (pending != 0 && segmentBlocks < RECORDER_SEGMENT_BLOCKS) {
+                if (card.writeStreamBlock(ring[tail], error)) {
+                    tail = (tail + 1) % RECORDER_BUFFERS;
+                    --pending;
+
+                    ++segmentBlocks;
+                    ++stats.blocks;
+                }
+            }
+
+            if (segmentBlocks == RECORDER_SEGMENT_BLOCKS || (stopping && pending == 0)) {
+                state = CLOSING;
+            }
+        break;
+
+        case CLOSING:
+            if (card.isWriteDone(error)) {
+                if (error == SD::NO_ERROR) {
+                    card.stopWriteStream(error);
+                }
+
+                state = PROGRAMMING;
+            }
+        break;
+
+        case PROGRAMMING: {
+            SD::cardStatus_u status = card.getCardStatus(error);
+
+            if (error != SD::NO_ERROR || status.fields.currentState != SD::TRAN) {
+                break;
+            }
+
+            bool closed = stopping && pending == 0;
+
+            /* Every block queued has been written */
+            index.state = closed ? CLOSED : RECORDING;
+            index.blocks = stats.blocks;
+            index.samples = closed ? stats.samples : 0;
+            ++index.sequence;
+            index.checksum = indexChecksum(index);
+
+            const uint32_t* words = (const uint32_t *) &index;
+
+            for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+                indexBuffer[i] = (i < (sizeof(index) / 4)) ? words[i] : 0;
+            }
+
+            card.startWriteBlock(cardAddress(index.firstBlock - 1), indexBuffer, nullptr, error);
+
+            state = INDEX;
+        } break;
+
+        case INDEX:
+            if (!card.isWriteDone(error) || error != SD::NO_ERROR) {
+                break;
+            }
+
+            if (index.state == CLOSED) {
+                state = STOPPED;
+            } else {
+                card.startWriteStream(cardAddress(index.firstBlock + stats.blocks), RECORDER_SEGMENT_BLOCKS, nullptr, error);
+
+                segmentBlocks = 0;
+                state = STREAMING;
+            }
+        break;
+
+        default:
+        break;
+    }
+
+    return error == SD::NO_ERROR;
+};
+
+
+void AudioRecorder::abort(recorderError_e& error) {
+    microphone.stopRecording();
+
+    /* Leave the card in transfer state */
+    if (state == STREAMING || state == CLOSING) {
+        SD::errorType_e ignored = SD::NO_ERROR;
+
+        card.stopWriteStream(ignored);
+    }
+
+    error = SD_ERROR;
+    state = STOPPED;
+};
+
+
+/* SDHC = block address, SDSC = byte address */
+uint32_t AudioRecorder::cardAddress(uint32_t block) {
+    return highCapacity ? block : (block * 512);
+};
+
+#endif
@@ -0,0 +1,299 @@
+#ifndef BLOCK_CACHE_CPP
+#define BLOCK_CACHE_CPP
+
+#include "../lib/BlockCache.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+static_assert(BLOCK_CACHE_LINES > 0, "BLOCK_CACHE_LINES must not be zero");
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+BlockCache::BlockCache(SD& sdCard, bool isHighCapacity) : card(sdCard), highCapacity(isHighCapacity) {
+    for (uint32_t i = 0; i < LINES; ++i) {
+        lines[i].valid = false;
+        lines[i].dirty = false;
+        lines[i].lastUse = 0;
+    }
+
+    useCounter = 0;
+
+    /* No sector is the successor of the last one */
+    lastBlock = 0xFFFFFFFE;
+
+    stats = {};
+};
+
+
+/*****************************************************************/
+/*                            ACCESS                             */
+/*****************************************************************/
+
+const uint8_t* BlockCache::read(uint32_t block, SD::errorType_e& error) {
+    struct cacheLine_s* line = lookup(block);
+
+    if (line != nullptr) {
+        ++stats.hits;
+    } else {
+        ++stats.misses;
+
+        line = fill(block, error);
+
+        if (line == nullptr) {
+            return nullptr;
+        }
+    }
+
+    line->lastUse = ++useCounter;
+    lastBlock = block;
+
+    return (const uint8_t *) line->data;
+};
+
+
+uint8_t* BlockCache::modify(uint32_t block, bool overwrite, SD::errorType_e& error) {
+    struct cacheLine_s* line = lookup(block);
+
+    if (line != nullptr) {
+        ++stats.hits;
+    } else {
+        ++stats.misses;
+
+        if (overwrite) {
+            /* The old content is replaced by the caller */
+            line = evict(nullptr, 0, error);
+
+            if (line != nullptr) {
+                line->block = block;
+                line->valid = true;
+            }
+        } else {
+            line = fill(block, error);
+        }
+
+        if (line == nullptr) {
+            return nullptr;
+        }
+    }
+
+    line->dirty = true;
+    line->lastUse = ++useCounter;
+    lastBlock = block;
+
+    return (uint8_t *) line->data;
+};
+
+
+BlockCache& BlockCache::readBlocks(uint32_t block, uint32_t count, uint32_t* buffer, SD::errorType_e& error) {
+    uint32_t i = 0;
+
+    while (i < count) {
+        struct cacheLine_s* line = lookup(block + i);
+
+        /* The cached copy can be newer than the card */
+        if (line != nullptr) {
+            for (uint32_t j = 0; j < BLOCK_WORDS; ++j) {
+                buffer[(i * BLOCK_WORDS) + j] = line->data[j];
+            }
+
+            ++stats.hits;
+            ++i;
+
+            continue;
+        }
+
+        /* Longest run of uncached sectors */
+        uint32_t run = 1;
+
+        while ((i + run) < count && lookup(block + i + run) == nullptr) {
+            ++run;
+        }
+
+        if (run == 1) {
+            card.readBlock(cardAddress(block + i), buffer + (i * BLOCK_WORDS), nullptr, error);
+        } else {
+            card.readBurst(cardAddress(block + i), run, buffer + (i * BLOCK_WORDS), nullptr, error);
+        }
+
+        if (error != SD::NO_ERROR) {
+            return *this;
+        }
+
+        stats.bypassed += run;
+        i += run;
+    }
+
+    if (count != 0) {
+        lastBlock = block + count - 1;
+    }
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                          MAINTENANCE                          */
+/*****************************************************************/
+
+BlockCache& BlockCache::flush(SD::errorType_e& error) {
+    for (uint32_t i = 0; i < LINES; ++i) {
+        if (lines[i].valid && lines[i].dirty) {
+            writeBack(&lines[i], error);
+
+            if (error != SD::NO_ERROR) {
+                return *this;
+            }
+        }
+    }
+
+    return *this;
+};
+
+
+BlockCache& BlockCache::invalidate() {
+    for (uint32_t i = 0; i < LINES; ++i) {
+        lines[i].valid = false;
+        lines[i].dirty = false;
+    }
+
+    lastBlock = 0xFFFFFFFE;
+
+    return *this;
+};
+
+
+const struct BlockCache::cacheStats_s& BlockCache::getStats() {
+    return stats;
+};
+
+
+/*****************************************************************/
+/*                          REPLACEMENT                          */
+/*****************************************************************/
+
+struct BlockCache::cacheLine_s* BlockCache::lookup(uint32_t block) {
+    for (uint32_t i = 0; i < LINES; ++i) {
+        if (lines[i].valid && lines[i].block == block) {
+            return &lines[i];
+        }
+    }
+
+    return nullptr;
+};
+
+
+struct BlockCache::cacheLine_s* BlockCache::evict(struct cacheLine_s* const* excluded, uint32_t excludedCount, SD::errorType_e& error) {
+    struct cacheLine_s* victim = nullptr;
+    uint32_t victimAge = 0;
+
+    for (uint32_t i = 0; i < LINES; ++i) {
+        struct cacheLine_s* line = &lines[i];
+        bool isExcluded = false;
+
+        for (uint32_t j = 0; j < excludedCount; ++j) {
+            isExcluded |= (excluded[j] == line);
+        }
+
+        if (isExcluded) {
+            continue;
+        }
+
+        /* A free line is always the best choice */
+        if (!line->valid) {
+            return line;
+        }
+
+        /* The age is wrap safe, the counter is not */
+        uint32_t age = useCounter - line->lastUse;
+
+        if (victim == nullptr || age > victimAge) {
+            victim = line;
+            victimAge = age;
+        }
+    }
+
+    if (victim->dirty) {
+        writeBack(victim, error);
+
+        if (error != SD::NO_ERROR) {
+            return nullptr;
+        }
+    }
+
+    victim->valid = false;
+
+    return victim;
+};
+
+
+struct BlockCache::cacheLine_s* BlockCache::fill(uint32_t block, SD::errorType_e& error) {
+    struct cacheLine_s* victims[1 + READ_AHEAD];
+    uint32_t count = 1;
+
+    /* Read ahead up to the next cached sector */
+    if (block == (lastBlock + 1)) {
+        while (count < (1 + READ_AHEAD) && (block + count) != 0 && lookup(block + count) == nullptr) {
+            ++count;
+        }
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        victims[i] = evict(victims, i, error);
+
+        if (victims[i] == nullptr) {
+            return nullptr;
+        }
+    }
+
+    if (count == 1) {
+        card.readBlock(cardAddress(block), victims[0]->data, nullptr, error);
+    } else {
+        uint32_t* blockList[1 + READ_AHEAD];
+
+        for (uint32_t i = 0; i < count; ++i) {
+            blockList[i] = victims[i]->data;
+        }
+
+        card.readBurst(cardAddress(block), count, blockList, nullptr, error);
+    }
+
+    if (error != SD::NO_ERROR) {
+        return nullptr;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        victims[i]->block = block + i;
+        victims[i]->valid = true;
+        victims[i]->dirty = false;
+
+        /* Newer than the lines already cached, older than the next access */
+        victims[i]->lastUse = useCounter;
+    }
+
+    stats.readAhead += count - 1;
+
+    return victims[0];
+};
+
+
+void BlockCache::writeBack(struct cacheLine_s* line, SD::errorType_e& error) {
+    card.writeBlock(cardAddress(line->block), line->data, nullptr, error);
+
+    if (error == SD::NO_ERROR) {
+        line->dirty = false;
+        ++stats.writeBacks;
+    }
+};
+
+
+/* SDHC = block address, SDSC = byte address */
+uint32_t BlockCache::cardAddress(uint32_t block) {
+    return highCapacity ? block : (block * 512);
+};
+
+#endif
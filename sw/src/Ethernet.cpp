@@ -7,6 +7,11 @@
 
 #include <inttypes.h>
 
+
+/* Zero bytes for the frame padding */
+static const uint8_t zeroPadding[Ethernet::MIN_PAYLOAD_LENGTH] = { 0 };
+
+
 /****************************************************************/
 /*                         CONSTRUCTORS                         */
 /****************************************************************/
@@ -18,7 +23,8 @@ Ethernet::Ethernet() :
     macTxBuffer    ( (uint8_t *) (ethBaseAddress + 35)         ),
     macRxPktDesc   ( (uint64_t *) (ethBaseAddress + 36)        ),        
     macRxBuffer    ( (uint8_t *) (ethBaseAddress + 38)         ),
-    macInterrupt   ( (uint32_t *) (ethBaseAddress + 39)        ) {  
+    macInterrupt   ( (uint32_t *) (ethBaseAddress + 39)        ),
+    macPayloadLevel( (uint32_t *) (ethBaseAddress + 40)        ) {  
     
     /* Reset and Wake up PHY */    
     reset(); 
@@ -139,6 +145,20 @@ bool Ethernet::isFullPayloadRX() {
     return macCtrlStatus->payloadFullRX;
 };
 
+uint32_t Ethernet::getFreePayloadTX() {
+    union macPayloadLevel_s level; level.raw = *macPayloadLevel;
+
+    return level.fields.freeTX;
+};
+
+
+uint32_t Ethernet::getPendingPayloadRX() {
+    union macPayloadLevel_s level; level.raw = *macPayloadLevel;
+
+    return level.fields.pendingRX;
+};
+
+
 bool Ethernet::isEmptyPacketTX() {
     return macCtrlStatus->packetEmptyTX;
 };
@@ -240,21 +260,13 @@ Ethernet& Ethernet::sendFrame(const uint8_t* packet, uint32_t length, struct Eth
     while (isFullPacketTX()) {  }
 
     /* Send payload bytes to the TX buffer */
-    for (int i = 0; i < length; ++i) {
-        while (isFullPayloadTX()) {  }
-
-        *macTxBuffer = packet[i];
-    }
+    writePayloadTX(packet, length);
 
     /* Compute the padding bytes */
     uint32_t padding = (length < MIN_PAYLOAD_LENGTH) ? (MIN_PAYLOAD_LENGTH - length) : 0;
 
     if (padding != 0) {
-        for (int i = 0; i < padding; ++i) {
-            while (isFullPayloadTX()) {  }
-            
-            *macTxBuffer = 0;
-        }
+        writePayloadTX(zeroPadding, padding);
     }
 
     union tempDescriptor_u {
@@ -311,25 +323,17 @@ Ethernet& Ethernet::sendFrame(const uint8_t* packet, uint32_t length, struct mac
     while (isFullPacketTX()) {  }
 
     /* Send EtherType MSB first */
-    *macTxBuffer = (etherType & 0xFF00) >> 8;
-    *macTxBuffer = etherType & 0x00FF;
+    uint8_t typeBytes[2] = { (uint8_t) ((etherType & 0xFF00) >> 8), (uint8_t) (etherType & 0x00FF) };
+    writePayloadTX(typeBytes, 2);
 
     /* Send payload bytes to the TX buffer */
-    for (int i = 0; i < length; ++i) {
-        while (isFullPayloadTX()) {  }
-
-        *macTxBuffer = packet[i];
-    }
+    writePayloadTX(packet, length);
 
     /* Compute the padding bytes */
     uint32_t padding = (length < MIN_PAYLOAD_LENGTH) ? (MIN_PAYLOAD_LENGTH - length) : 0;
 
     if (padding != 0) {
-        for (int i = 0; i < padding; ++i) {
-            while (isFullPayloadTX()) {  }
-
-            *macTxBuffer = 0;
-        }
+        writePayloadTX(zeroPadding, padding);
     }
 
     union tempDescriptor_u {
@@ -367,6 +371,62 @@ Ethernet& Ethernet::sendFrame(const uint8_t* packet, uint32_t length, struct mac
 };
 
 
+Ethernet& Ethernet::sendFrame(const struct bufferChain_s* chain, struct macAddr_s destMac, uint16_t etherType, ethError_e& error) {
+    /* Check MAC mode */
+    if (macCtrlStatus->ethernetMode == ethMode_e::IEEE_8023) {
+        error = Ethernet::BAD_CONFIG;
+
+        return *this;
+    }
+
+    uint32_t length = 0;
+
+    for (const struct bufferChain_s* segment = chain; segment != nullptr; segment = segment->next) {
+        length += segment->length;
+    }
+
+    /* Check if the length exceed the maximum payload size */
+    if (length > MAX_PAYLOAD_LENGTH) {
+        error = Ethernet::LENGTH_EXCEEDED;
+
+        return *this;
+    }
+    
+    /* Wait in case of a buffer full */
+    while (isFullPacketTX()) {  }
+
+    /* Send EtherType MSB first */
+    uint8_t typeBytes[2] = { (uint8_t) ((etherType & 0xFF00) >> 8), (uint8_t) (etherType & 0x00FF) };
+    writePayloadTX(typeBytes, 2);
+
+    /* Send every segment to the TX buffer */
+    for (const struct bufferChain_s* segment = chain; segment != nullptr; segment = segment->next) {
+        writePayloadTX(segment->data, segment->length);
+    }
+
+    /* Compute the padding bytes */
+    uint32_t padding = (length < MIN_PAYLOAD_LENGTH) ? (MIN_PAYLOAD_LENGTH - length) : 0;
+
+    if (padding != 0) {
+        writePayloadTX(zeroPadding, padding);
+    }
+
+    /* Create the 8-byte descriptor */
+    union macDescriptor_s descriptor;
+
+    descriptor.fields.length = length + padding;
+
+    for (int i = 0; i < 6; ++i) {
+        descriptor.fields.address[i] = destMac.byte[i];
+    }
+
+    /* Send the descriptor the the descriptor buffer in the MAC */
+    *macTxPktDesc = descriptor.raw;
+
+    return *this;
+};
+
+
 Ethernet& Ethernet::receiveFrame(uint8_t* buffer, uint32_t length, ethError_e& error) {
     if (macCtrlStatus->ethernetMode == ethMode_e::ETHERNET_II) {
         error = Ethernet::BAD_CONFIG;
@@ -387,9 +447,7 @@ Ethernet& Ethernet::receiveFrame(uint8_t* buffer, uint32_t length, ethError_e& e
     }
 
     /* Fill the buffer */
-    for (int i = 0; i < length + 4; ++i) {
-        buffer[i] = *macRxBuffer;
-    }
+    readPayloadRX(buffer, length + 4);
 
     return *this;
 };
@@ -414,12 +472,99 @@ Ethernet& Ethernet::receiveFrame(uint8_t* buffer, uint32_t length, uint16_t* eth
         return *this;
     }
 
-    /* Save EtherType */
-    *etherType = (*macRxBuffer << 8) | (*macRxBuffer);
+    /* Save EtherType (MSB first) */
+    uint8_t typeBytes[2];
+    readPayloadRX(typeBytes, 2);
+
+    *etherType = (typeBytes[0] << 8) | typeBytes[1];
 
     /* Fill the buffer */
-    for (int i = 0; i < length + 4; ++i) {
-        buffer[i] = *macRxBuffer;
+    readPayloadRX(buffer, length + 4);
+
+    return *this;
+};
+
+
+Ethernet& Ethernet::writePayloadTX(const uint8_t* data, uint32_t length) {
+    while (length >= 4) {
+        /* Check the free space once for the entire burst */
+        uint32_t words;
+        while ((words = getFreePayloadTX() / 4) == 0) {  }
+
+        if (words > length / 4) {
+            words = length / 4;
+        }
+
+        length -= words * 4;
+
+        if (((uintptr_t) data & 3) == 0) {
+            for (; words != 0; --words, data += 4) {
+                *macTxBurst(4) = *((const uint32_t *) data);
+            }
+        } else {
+            for (; words != 0; --words, data += 4) {
+                *macTxBurst(4) = data[0] | (data[1] << 8) | (data[2] << 16) | (data[3] << 24);
+            }
+        }
+    }
+
+    /* Remaining 1 - 3 bytes in a single access */
+    if (length != 0) {
+        uint32_t tail = 0;
+
+        for (uint32_t i = 0; i < length; ++i) {
+            tail |= data[i] << (i * 8);
+        }
+
+        while (getFreePayloadTX() < length) {  }
+
+        *macTxBurst(length) = tail;
+    }
+
+    return *this;
+};
+
+
+Ethernet& Ethernet::readPayloadRX(uint8_t* data, uint32_t length) {
+    uint32_t words = length / 4;
+
+    if (((uintptr_t) data & 3) == 0) {
+        for (; words != 0; --words, data += 4) {
+            *((uint32_t *) data) = *macRxBurst(4);
+        }
+    } else {
+        for (; words != 0; --words, data += 4) {
+            uint32_t word = *macRxBurst(4);
+
+            data[0] = word;
+            data[1] = word >> 8;
+            data[2] = word >> 16;
+            data[3] = word >> 24;
+        }
+    }
+
+    /* Remaining 1 - 3 bytes in a single access */
+    length &= 3;
+
+    if (length != 0) {
+        uint32_t tail = *macRxBurst(length);
+
+        for (uint32_t i = 0; i < length; ++i) {
+            data[i] = tail >> (i * 8);
+        }
+    }
+
+    return *this;
+};
+
+
+Ethernet& Ethernet::skipPayloadRX(uint32_t length) {
+    for (uint32_t words = length / 4; words != 0; --words) {
+        (void) *macRxBurst(4);
+    }
+
+    if ((length & 3) != 0) {
+        (void) *macRxBurst(length & 3);
     }
 
     return *this;
@@ -0,0 +1,213 @@
+#ifndef ETHERNET_RX_CPP
+#define ETHERNET_RX_CPP
+
+#include "../lib/driver/EthernetRX.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+EthernetRX::EthernetRX(Ethernet& ethernetDriver) : ethernet(ethernetDriver) {
+    readyRing.head = 0;
+    readyRing.tail = 0;
+
+    /* Every buffer starts in the pool */
+    freeRing.tail = 0;
+
+    for (uint32_t i = 0; i < POOL_SIZE; ++i) {
+        freeRing.slot[i] = i;
+    }
+
+    freeRing.head = POOL_SIZE;
+
+    stats.received = 0;
+    stats.dropped = 0;
+    stats.malformed = 0;
+    stats.errors = 0;
+    stats.overflows = 0;
+};
+
+
+EthernetRX::~EthernetRX() {
+    enable(false);
+};
+
+
+/*****************************************************************/
+/*                         CONFIGURATION                         */
+/*****************************************************************/
+
+EthernetRX& EthernetRX::enable(bool enable) {
+    Ethernet::ethError_e error = Ethernet::NO_ERROR;
+
+    /* Interrupt enable bits follow the event positions */
+    ethernet.setMacInterrupt(2, enable, error)
+            .setMacInterrupt(3, enable, error);
+
+    return *this;
+};
+
+
+uint32_t EthernetRX::interruptHandler() {
+    union Ethernet::macInterrupt_s interrupt;
+    interrupt.raw = *ethernet.macInterrupt;
+
+    /* Clear before draining: a frame that completes from now on raises a new interrupt */
+    *ethernet.macInterrupt = 0;
+
+    if (interrupt.fields.rxError) {
+        ++stats.errors;
+    }
+
+    if (ethernet.isFullPacketRX()) {
+        ++stats.overflows;
+    }
+
+    bool ethernetII = ethernet.macCtrlStatus->ethernetMode == Ethernet::ETHERNET_II;
+
+    while (!ethernet.isEmptyPacketRX()) {
+        drainFrame(ethernetII, interrupt.fields.rxError);
+    }
+
+    return interrupt.raw;
+};
+
+
+bool EthernetRX::drainFrame(bool ethernetII, bool rxError) {
+    union Ethernet::macDescriptor_s descriptor = ethernet.getRxDescriptor();
+    uint32_t length = descriptor.fields.length;
+
+    /* Bytes of this frame in the MAC payload buffer after the EtherType */
+    uint32_t size;
+    bool valid;
+
+    if (ethernetII) {
+        /* The MAC counts the payload plus CRC */
+        size = length;
+        valid = (size >= 4) && (size <= FRAME_SIZE);
+    } else {
+        /* Short payloads are padded to the minimum length */
+        size = ((length < Ethernet::MIN_PAYLOAD_LENGTH) ? Ethernet::MIN_PAYLOAD_LENGTH : length) + 4;
+        valid = length <= Ethernet::MAX_PAYLOAD_LENGTH;
+    }
+
+    if (!valid) {
+        /* The frame boundary is lost, flush the payload buffer to resynchronize */
+        ++stats.malformed;
+        ethernet.skipPayloadRX(ethernet.getPendingPayloadRX());
+
+        return false;
+    }
+
+    uint8_t index;
+
+    if (!pop(freeRing, index)) {
+        ++stats.dropped;
+        ethernet.skipPayloadRX(size + (ethernetII ? 2 : 0));
+
+        return false;
+    }
+
+    struct rxFrame_s* frame = &pool[index];
+
+    frame->descriptor = descriptor;
+    frame->size = size;
+
+    /* The MAC raises RX_ERROR together with RX_DONE for the frame just completed */
+    frame->error = rxError && ethernet.isEmptyPacketRX();
+
+    if (ethernetII) {
+        /* EtherType MSB first */
+        uint8_t typeBytes[2];
+        ethernet.readPayloadRX(typeBytes, 2);
+
+        frame->etherType = (typeBytes[0] << 8) | typeBytes[1];
+        frame->length = size - 4;
+    } else {
+        frame->etherType = 0;
+        frame->length = length;
+    }
+
+    ethernet.readPayloadRX(frame->payload, size);
+
+    /* The ring holds every buffer of the pool, it can't be full */
+    push(readyRing, index);
+    ++stats.received;
+
+    return true;
+};
+
+
+/*****************************************************************/
+/*                          RECEPTION                            */
+/*****************************************************************/
+
+struct EthernetRX::rxFrame_s* EthernetRX::receive() {
+    uint8_t index;
+
+    if (!pop(readyRing, index)) {
+        return nullptr;
+    }
+
+    return &pool[index];
+};
+
+
+EthernetRX& EthernetRX::release(struct rxFrame_s* frame) {
+    push(freeRing, frame - pool);
+
+    return *this;
+};
+
+
+uint32_t EthernetRX::pending() {
+    return readyRing.head - readyRing.tail;
+};
+
+
+const struct EthernetRX::rxStats_s& EthernetRX::getStats() {
+    return stats;
+};
+
+
+/*****************************************************************/
+/*                            RINGS                              */
+/*****************************************************************/
+
+bool EthernetRX::push(struct indexRing_s& ring, uint8_t index) {
+    uint32_t head = ring.head;
+
+    if ((head - ring.tail) == POOL_SIZE) {
+        return false;
+    }
+
+    ring.slot[head & (POOL_SIZE - 1)] = index;
+
+    /* Publish the slot before the new head */
+    asm volatile ("" ::: "memory");
+    ring.head = head + 1;
+
+    return true;
+};
+
+
+bool EthernetRX::pop(struct indexRing_s& ring, uint8_t& index) {
+    uint32_t tail = ring.tail;
+
+    if (ring.head == tail) {
+        return false;
+    }
+
+    index = ring.slot[tail & (POOL_SIZE - 1)];
+
+    /* Read the slot before handing it back to the producer */
+    asm volatile ("" ::: "memory");
+    ring.tail = tail + 1;
+
+    return true;
+};
+
+#endif
@@ -0,0 +1,596 @@
+#ifndef FAT32_CPP
+#define FAT32_CPP
+
+#include "../lib/FAT32.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/* Directory entry layout */
+static const uint32_t ENTRY_SIZE = 32;
+static const uint8_t ENTRY_END = 0x00;
+static const uint8_t ENTRY_DELETED = 0xE5;
+static const uint8_t ATTR_LONG_NAME = 0x0F;
+
+/* Characters of a long name entry and their offsets */
+static const uint32_t LFN_CHARACTERS = 13;
+static const uint8_t LFN_OFFSET[LFN_CHARACTERS] = { 1, 3, 5, 7, 9, 14, 16, 18, 20, 22, 24, 28, 30 };
+
+/* FAT entry values */
+static const uint32_t CLUSTER_MASK = 0x0FFFFFFF;
+static const uint32_t CLUSTER_END = 0x0FFFFFF8;
+
+/* MBR partition types of FAT32 (CHS / LBA) */
+static const uint8_t PARTITION_FAT32 = 0x0B;
+static const uint8_t PARTITION_FAT32_LBA = 0x0C;
+
+
+/* On-disk fields are little endian and not always aligned */
+static inline uint32_t le16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static inline uint32_t le32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t) data[3] << 24);
+}
+
+static inline char toLower(char character) {
+    return (character >= 'A' && character <= 'Z') ? (character + ('a' - 'A')) : character;
+}
+
+/* Case insensitive compare of a name and a path component */
+static bool nameMatches(const char* name, const char* component, uint32_t length) {
+    for (uint32_t i = 0; i < length; ++i) {
+        if (name[i] == '\0' || toLower(name[i]) != toLower(component[i])) {
+            return false;
+        }
+    }
+
+    return name[length] == '\0';
+}
+
+/* Checksum of the 8.3 name stored in its long name entries */
+static uint8_t shortNameChecksum(const uint8_t* entry) {
+    uint8_t sum = 0;
+
+    for (uint32_t i = 0; i < 11; ++i) {
+        sum = ((sum & 1) << 7) + (sum >> 1) + entry[i];
+    }
+
+    return sum;
+}
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+FAT32::FAT32(BlockCache& blockCache) : cache(blockCache), mounted(false) {
+
+};
+
+
+/*****************************************************************/
+/*                            VOLUME                             */
+/*****************************************************************/
+
+FAT32& FAT32::mount(fatError_e& error) {
+    mounted = false;
+
+    /* Whole card volume */
+    if (readBootSector(0, error)) {
+        mounted = true;
+
+        return *this;
+    }
+
+    if (error != NO_FILESYSTEM) {
+        return *this;
+    }
+
+    error = NO_ERROR;
+
+    /* First FAT32 partition of the MBR */
+    const uint8_t* mbr = sector(0, error);
+
+    if (mbr == nullptr) {
+        return *this;
+    }
+
+    uint32_t partitionStart = 0;
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        const uint8_t* partition = mbr + 446 + (i * 16);
+
+        if (partition[4] == PARTITION_FAT32 || partition[4] == PARTITION_FAT32_LBA) {
+            partitionStart = le32(partition + 8);
+            break;
+        }
+    }
+
+    if (partitionStart == 0) {
+        error = NO_FILESYSTEM;
+
+        return *this;
+    }
+
+    mounted = readBootSector(partitionStart, error);
+
+    return *this;
+};
+
+
+uint32_t FAT32::getClusterSize() {
+    return BlockCache::BLOCK_SIZE << clusterShift;
+};
+
+
+/*****************************************************************/
+/*                             FILES                             */
+/*****************************************************************/
+
+FAT32& FAT32::open(const char* path, struct fatFile_s& file, fatError_e& error) {
+    if (!mounted) {
+        error = NO_FILESYSTEM;
+
+        return *this;
+    }
+
+    file.firstCluster = rootCluster;
+    file.size = 0;
+    file.directory = true;
+    file.position = 0;
+    file.cluster = 0;
+    file.clusterIndex = 0;
+
+    struct fatEntry_s entry;
+
+    while (*path != '\0') {
+        /* Next path component */
+        const char* end = path;
+
+        while (*end != '\0' && *end != '/') {
+            ++end;
+        }
+
+        uint32_t length = end - path;
+
+        if (length != 0) {
+            if (!file.directory) {
+                error = NOT_A_DIRECTORY;
+
+                return *this;
+            }
+
+            bool found = false;
+
+            while (nextEntry(file, entry, error)) {
+                if (nameMatches(entry.name, path, length)) {
+                    found = true;
+                    break;
+                }
+            }
+
+            if (error != NO_ERROR) {
+                return *this;
+            }
+
+            if (!found) {
+                error = NOT_FOUND;
+
+                return *this;
+            }
+
+            file.directory = (entry.attributes & ATTR_DIRECTORY) != 0;
+            file.firstCluster = entry.firstCluster;
+            file.size = file.directory ? 0 : entry.size;
+            file.position = 0;
+            file.cluster = 0;
+            file.clusterIndex = 0;
+
+            /* ".." of a first level directory points to the root as cluster 0 */
+            if (file.directory && file.firstCluster == 0) {
+                file.firstCluster = rootCluster;
+            }
+        }
+
+        path = (*end == '/') ? (end + 1) : end;
+    }
+
+    return *this;
+};
+
+
+uint32_t FAT32::read(struct fatFile_s& file, void* buffer, uint32_t size, fatError_e& error) {
+    if (file.directory) {
+        error = NOT_A_FILE;
+
+        return 0;
+    }
+
+    if (file.position >= file.size) {
+        return 0;
+    }
+
+    uint8_t* destination = (uint8_t *) buffer;
+
+    uint32_t remaining = ((file.size - file.position) < size) ? (file.size - file.position) : size;
+    uint32_t done = 0;
+
+    const uint32_t clusterSectors = 1 << clusterShift;
+
+    while (remaining != 0) {
+        if (!locate(file, error)) {
+            /* The chain is shorter than the file size */
+            if (error == NO_ERROR) {
+                error = CORRUPTED;
+            }
+
+            break;
+        }
+
+        uint32_t offset = file.position & ((BlockCache::BLOCK_SIZE << clusterShift) - 1);
+        uint32_t sectorIndex = offset / BlockCache::BLOCK_SIZE;
+        uint32_t byteOffset = offset % BlockCache::BLOCK_SIZE;
+        uint32_t first = clusterSector(file.cluster) + sectorIndex;
+        uint32_t length;
+
+        if (byteOffset == 0 && remaining >= BlockCache::BLOCK_SIZE && ((uintptr_t) destination & 3) == 0) {
+            /* Whole sectors: follow the chain while the clusters are contiguous */
+            uint32_t wanted = remaining / BlockCache::BLOCK_SIZE;
+            uint32_t sectors = clusterSectors - sectorIndex;
+
+            uint32_t cluster = file.cluster;
+            uint32_t clusterIndex = file.clusterIndex;
+
+            while (sectors < wanted) {
+                uint32_t next = nextCluster(cluster, error);
+
+                if (next != (cluster + 1)) {
+                    break;
+                }
+
+                cluster = next;
+                ++clusterIndex;
+                sectors += clusterSectors;
+            }
+
+            if (error != NO_ERROR) {
+                break;
+            }
+
+            if (sectors > wanted) {
+                sectors = wanted;
+            }
+
+            SD::errorType_e sdError = SD::NO_ERROR;
+
+            cache.readBlocks(first, sectors, (uint32_t *) destination, sdError);
+
+            if (sdError != SD::NO_ERROR) {
+                error = IO_ERROR;
+                break;
+            }
+
+            file.cluster = cluster;
+            file.clusterIndex = clusterIndex;
+
+            length = sectors * BlockCache::BLOCK_SIZE;
+        } else {
+            /* Partial sector through the cache */
+            const uint8_t* data = sector(first, error);
+
+            if (data == nullptr) {
+                break;
+            }
+
+            length = BlockCache::BLOCK_SIZE - byteOffset;
+
+            if (length > remaining) {
+                length = remaining;
+            }
+
+            for (uint32_t i = 0; i < length; ++i) {
+                destination[i] = data[byteOffset + i];
+            }
+        }
+
+        destination += length;
+        done += length;
+        file.position += length;
+        remaining -= length;
+    }
+
+    return done;
+};
+
+
+FAT32& FAT32::seek(struct fatFile_s& file, uint32_t position) {
+    /* The cluster is found again on the next access */
+    file.position = (position < file.size || file.directory) ? position : file.size;
+
+    return *this;
+};
+
+
+uint32_t FAT32::load(const char* path, void* buffer, uint32_t capacity, fatError_e& error) {
+    struct fatFile_s file;
+
+    open(path, file, error);
+
+    if (error != NO_ERROR) {
+        return 0;
+    }
+
+    if (file.directory) {
+        error = NOT_A_FILE;
+
+        return 0;
+    }
+
+    if (file.size > capacity) {
+        error = TOO_LARGE;
+
+        return 0;
+    }
+
+    return read(file, buffer, file.size, error);
+};
+
+
+/*****************************************************************/
+/*                          DIRECTORIES                          */
+/*****************************************************************/
+
+bool FAT32::nextEntry(struct fatFile_s& directory, struct fatEntry_s& entry, fatError_e& error) {
+    if (!directory.directory) {
+        error = NOT_A_DIRECTORY;
+
+        return false;
+    }
+
+    /* Long name being assembled, its fragments come last to first */
+    bool longName = false;
+    uint32_t nextOrdinal = 0;
+    uint8_t checksum = 0;
+
+    while (true) {
+        /* End of the cluster chain */
+        if (!locate(directory, error)) {
+            return false;
+        }
+
+        uint32_t offset = directory.position & ((BlockCache::BLOCK_SIZE << clusterShift) - 1);
+        const uint8_t* data = sector(clusterSector(directory.cluster) + (offset / BlockCache::BLOCK_SIZE), error);
+
+        if (data == nullptr) {
+            return false;
+        }
+
+        const uint8_t* raw = data + (offset % BlockCache::BLOCK_SIZE);
+
+        if (raw[0] == ENTRY_END) {
+            /* Stay on the end marker */
+            return false;
+        }
+
+        directory.position += ENTRY_SIZE;
+
+        uint8_t attributes = raw[11];
+
+        if (raw[0] == ENTRY_DELETED) {
+            longName = false;
+            continue;
+        }
+
+        if ((attributes & 0x3F) == ATTR_LONG_NAME) {
+            uint32_t ordinal = raw[0] & 0x1F;
+
+            /* Last fragment, stored first */
+            if (raw[0] & 0x40) {
+                longName = true;
+                nextOrdinal = ordinal;
+                checksum = raw[13];
+
+                uint32_t length = ordinal * LFN_CHARACTERS;
+                entry.name[(length < MAX_NAME) ? length : MAX_NAME] = '\0';
+            }
+
+            if (!longName || ordinal == 0 || ordinal != nextOrdinal || raw[13] != checksum) {
+                longName = false;
+                continue;
+            }
+
+            for (uint32_t i = 0; i < LFN_CHARACTERS; ++i) {
+                uint32_t character = le16(raw + LFN_OFFSET[i]);
+                uint32_t index = ((ordinal - 1) * LFN_CHARACTERS) + i;
+
+                /* Padding after the terminator */
+                if (character == 0xFFFF || index >= MAX_NAME) {
+                    continue;
+                }
+
+                entry.name[index] = (character < 0x80) ? character : '?';
+            }
+
+            --nextOrdinal;
+            continue;
+        }
+
+        if (attributes & ATTR_VOLUME_ID) {
+            longName = false;
+            continue;
+        }
+
+        /* 8.3 name if there is no valid long name */
+        if (!longName || nextOrdinal != 0 || checksum != shortNameChecksum(raw)) {
+            uint32_t length = 0;
+
+            for (uint32_t i = 0; i < 8 && raw[i] != ' '; ++i) {
+                char character = (i == 0 && raw[0] == 0x05) ? 0xE5 : raw[i];
+                entry.name[length++] = (raw[12] & 0x08) ? toLower(character) : character;
+            }
+
+            if (raw[8] != ' ') {
+                entry.name[length++] = '.';
+
+                for (uint32_t i = 8; i < 11 && raw[i] != ' '; ++i) {
+                    entry.name[length++] = (raw[12] & 0x10) ? toLower(raw[i]) : raw[i];
+                }
+            }
+
+            entry.name[length] = '\0';
+        }
+
+        entry.attributes = attributes;
+        entry.size = le32(raw + 28);
+        entry.firstCluster = ((le16(raw + 20) << 16) | le16(raw + 26)) & CLUSTER_MASK;
+
+        return true;
+    }
+};
+
+
+/*****************************************************************/
+/*                          ALLOCATION                           */
+/*****************************************************************/
+
+uint32_t FAT32::nextCluster(uint32_t cluster, fatError_e& error) {
+    /* 128 entries per FAT sector */
+    const uint8_t* data = sector(fatStart + (cluster / 128), error);
+
+    if (data == nullptr) {
+        return 0;
+    }
+
+    uint32_t next = le32(data + ((cluster % 128) * 4)) & CLUSTER_MASK;
+
+    if (next >= CLUSTER_END) {
+        return 0;
+    }
+
+    /* Free, reserved, bad or outside of the volume */
+    if (next < 2 || next >= (clusterCount + 2)) {
+        error = CORRUPTED;
+
+        return 0;
+    }
+
+    return next;
+};
+
+
+bool FAT32::locate(struct fatFile_s& file, fatError_e& error) {
+    uint32_t target = file.position >> (clusterShift + 9);
+
+    /* The chain can only be walked forward */
+    if (file.cluster == 0 || target < file.clusterIndex) {
+        file.cluster = file.firstCluster;
+        file.clusterIndex = 0;
+    }
+
+    /* Empty file */
+    if (file.cluster < 2) {
+        return false;
+    }
+
+    while (file.clusterIndex < target) {
+        uint32_t next = nextCluster(file.cluster, error);
+
+        if (next == 0) {
+            return false;
+        }
+
+        file.cluster = next;
+        ++file.clusterIndex;
+    }
+
+    return true;
+};
+
+
+uint32_t FAT32::clusterSector(uint32_t cluster) {
+    return dataStart + ((cluster - 2) << clusterShift);
+};
+
+
+bool FAT32::readBootSector(uint32_t block, fatError_e& error) {
+    const uint8_t* data = sector(block, error);
+
+    if (data == nullptr) {
+        return false;
+    }
+
+    uint32_t bytesPerSector = le16(data + 11);
+    uint32_t sectorsPerCluster = data[13];
+    uint32_t reservedSectors = le16(data + 14);
+    uint32_t fatNumber = data[16];
+    uint32_t rootEntries = le16(data + 17);
+    uint32_t fatSize16 = le16(data + 22);
+    uint32_t totalSectors = (le16(data + 19) != 0) ? le16(data + 19) : le32(data + 32);
+    uint32_t fatSize = le32(data + 36);
+
+    /* FAT32 has no fixed root directory and only a 32 bit FAT size */
+    bool valid = data[510] == 0x55 && data[511] == 0xAA &&
+                 bytesPerSector == BlockCache::BLOCK_SIZE &&
+                 sectorsPerCluster != 0 && (sectorsPerCluster & (sectorsPerCluster - 1)) == 0 &&
+                 reservedSectors != 0 && fatNumber != 0 &&
+                 rootEntries == 0 && fatSize16 == 0 && fatSize != 0;
+
+    if (!valid) {
+        error = NO_FILESYSTEM;
+
+        return false;
+    }
+
+    clusterShift = 0;
+
+    while ((1U << clusterShift) != sectorsPerCluster) {
+        ++clusterShift;
+    }
+
+    fatStart = block + reservedSectors;
+    dataStart = fatStart + (fatNumber * fatSize);
+    rootCluster = le32(data + 44);
+
+    uint32_t systemSectors = dataStart - block;
+
+    if (totalSectors <= systemSectors) {
+        error = CORRUPTED;
+
+        return false;
+    }
+
+    clusterCount = (totalSectors - systemSectors) >> clusterShift;
+
+    /* The FAT must map every cluster */
+    if ((clusterCount + 2) > (fatSize * 128)) {
+        clusterCount = (fatSize * 128) - 2;
+    }
+
+    if (rootCluster < 2 || rootCluster >= (clusterCount + 2)) {
+        error = CORRUPTED;
+
+        return false;
+    }
+
+    return true;
+};
+
+
+const uint8_t* FAT32::sector(uint32_t block, fatError_e& error) {
+    SD::errorType_e sdError = SD::NO_ERROR;
+
+    const uint8_t* data = cache.read(block, sdError);
+
+    if (sdError != SD::NO_ERROR) {
+        error = IO_ERROR;
+
+        return nullptr;
+    }
+
+    return data;
+};
+
+#endif
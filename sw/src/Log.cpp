@@ -0,0 +1,71 @@
+#ifndef LOG_CPP
+#define LOG_CPP
+
+#include "../lib/Log.h"
+
+#include <inttypes.h>
+
+
+/****************************************************************/
+/*                             DATA                             */
+/****************************************************************/
+
+volatile uint32_t Log::ring[Log::RING_WORDS];
+volatile uint32_t Log::head = 0;
+volatile uint32_t Log::tail = 0;
+
+volatile uint32_t Log::dropped = 0;
+
+
+/****************************************************************/
+/*                            OUTPUT                            */
+/****************************************************************/
+
+void Log::flush() {
+    /* Records queued during the flush are sent too */
+    while (tail != head) {
+        uint32_t header = ring[tail & (RING_WORDS - 1)];
+        uint32_t words = header >> 24;
+
+        Serial_IO::write((char) LOG_MARKER);
+
+        for (uint32_t i = 0; i <= words; ++i) {
+            sendWord(ring[(tail + i) & (RING_WORDS - 1)]);
+        }
+
+        tail += words + 1;
+    }
+
+    if (dropped != 0) {
+        uint32_t count = dropped;
+
+        dropped = 0;
+
+        Serial_IO::write((char) LOG_MARKER);
+
+        sendWord((1 << 24) | DROPPED_ID);
+        sendWord(count);
+    }
+};
+
+
+uint32_t Log::pending() {
+    return head - tail;
+};
+
+
+/****************************************************************/
+/*                            PRIVATE                           */
+/****************************************************************/
+
+void Log::sendWord(uint32_t word) {
+    char bytes[4];
+
+    for (uint32_t i = 0; i < 4; ++i) {
+        bytes[i] = (char) (word >> (i * 8));
+    }
+
+    Serial_IO::write(bytes, 4);
+};
+
+#endif
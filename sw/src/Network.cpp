@@ -0,0 +1,540 @@
+#ifndef NETWORK_CPP
+#define NETWORK_CPP
+
+#include "../lib/Network.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/* ARP operations */
+static const uint16_t ARP_REQUEST = 1;
+static const uint16_t ARP_REPLY = 2;
+
+/* ICMP types */
+static const uint8_t ICMP_ECHO_REPLY = 0;
+static const uint8_t ICMP_ECHO_REQUEST = 8;
+
+/* Don't fragment flag */
+static const uint16_t IPV4_DONT_FRAGMENT = 0x4000;
+
+static const uint8_t DEFAULT_TTL = 64;
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+Network::Network(Ethernet& ethernetDriver, EthernetRX& rxDriver, Timer& clock, uint32_t ipAddress, uint32_t ipNetmask, uint32_t ipGateway) :
+    ethernet       ( ethernetDriver ),
+    receiver       ( rxDriver       ),
+    timer          ( clock          ),
+    address        ( ipAddress      ),
+    netmask        ( ipNetmask      ),
+    gateway        ( ipGateway      ),
+    identification ( 0              ),
+    checksumTX     ( false          ),
+    arpNext        ( 0              ) {
+
+    for (int i = 0; i < 6; ++i) {
+        mac.byte[i] = (ETH_MAC_ADDRESS >> (i * 8)) & 0xFF;
+    }
+
+    for (uint32_t i = 0; i < ARP_CACHE_SIZE; ++i) {
+        arpCache[i].valid = false;
+        arpCache[i].pending = false;
+    }
+
+    for (uint32_t i = 0; i < MAX_SOCKETS; ++i) {
+        sockets[i].port = 0;
+        sockets[i].handler = nullptr;
+    }
+
+    stats = {};
+
+    /* Sum the fields that are the same in every transmitted header */
+    struct ipv4Header_s header = {};
+
+    header.versionIHL = 0x45;
+    header.fragment = swap16(IPV4_DONT_FRAGMENT);
+    header.timeToLive = DEFAULT_TTL;
+    header.source = swap32(address);
+
+    ipv4TemplateSum = Checksum::add(&header, IPV4_HEADER_SIZE);
+};
+
+
+/*****************************************************************/
+/*                            SOCKETS                            */
+/*****************************************************************/
+
+Network& Network::bind(uint16_t port, udpHandler_t handler, void* context, netError_e& error) {
+    struct socket_s* free = nullptr;
+
+    for (uint32_t i = 0; i < MAX_SOCKETS; ++i) {
+        if (sockets[i].handler != nullptr && sockets[i].port == port) {
+            free = &sockets[i];
+
+            break;
+        }
+
+        if (sockets[i].handler == nullptr && free == nullptr) {
+            free = &sockets[i];
+        }
+    }
+
+    if (free == nullptr) {
+        error = NO_SOCKET;
+
+        return *this;
+    }
+
+    free->port = port;
+    free->context = context;
+    free->handler = handler;
+
+    return *this;
+};
+
+
+Network& Network::unbind(uint16_t port) {
+    for (uint32_t i = 0; i < MAX_SOCKETS; ++i) {
+        if (sockets[i].handler != nullptr && sockets[i].port == port) {
+            sockets[i].handler = nullptr;
+        }
+    }
+
+    return *this;
+};
+
+
+Network& Network::sendTo(uint32_t destination, uint16_t destinationPort, uint16_t sourcePort, const struct Ethernet::bufferChain_s* payload, netError_e& error) {
+    uint32_t length = 0;
+
+    for (const struct Ethernet::bufferChain_s* segment = payload; segment != nullptr; segment = segment->next) {
+        length += segment->length;
+    }
+
+    if (length > MAX_UDP_PAYLOAD) {
+        error = LENGTH_EXCEEDED;
+
+        return *this;
+    }
+
+    /* Find the MAC of the next hop */
+    struct Ethernet::macAddr_s destinationMac;
+
+    if (destination == BROADCAST) {
+        for (int i = 0; i < 6; ++i) {
+            destinationMac.byte[i] = 0xFF;
+        }
+    } else {
+        bool local = ((destination ^ address) & netmask) == 0;
+
+        if (!resolve((local || gateway == 0) ? destination : gateway, destinationMac)) {
+            error = ARP_PENDING;
+
+            return *this;
+        }
+    }
+
+    struct ipv4Header_s* ip = (struct ipv4Header_s *) txHeader;
+    struct udpHeader_s* udp = (struct udpHeader_s *) (txHeader + (IPV4_HEADER_SIZE / 4));
+
+    ip->versionIHL = 0x45;
+    ip->typeOfService = 0;
+    ip->totalLength = swap16(IPV4_HEADER_SIZE + UDP_HEADER_SIZE + length);
+    ip->identification = swap16(identification++);
+    ip->fragment = swap16(IPV4_DONT_FRAGMENT);
+    ip->timeToLive = DEFAULT_TTL;
+    ip->protocol = PROTOCOL_UDP;
+    ip->source = swap32(address);
+    ip->destination = swap32(destination);
+
+    /* Only the per packet fields are added to the template sum */
+    uint32_t sum = ipv4TemplateSum;
+    sum = Checksum::add16(ip->totalLength, sum);
+    sum = Checksum::add16(ip->identification, sum);
+    sum = Checksum::add16(PROTOCOL_UDP << 8, sum);
+    sum = Checksum::add(&ip->destination, 4, sum);
+
+    ip->checksum = Checksum::finish(sum);
+
+    udp->sourcePort = swap16(sourcePort);
+    udp->destinationPort = swap16(destinationPort);
+    udp->length = swap16(UDP_HEADER_SIZE + length);
+    udp->checksum = 0;
+
+    if (checksumTX) {
+        /* Pseudo header: addresses, protocol and UDP length */
+        sum = Checksum::add(&ip->source, 8);
+        sum = Checksum::add16(swap16(PROTOCOL_UDP), sum);
+        sum = Checksum::add16(udp->length, sum);
+        sum = Checksum::add(udp, UDP_HEADER_SIZE, sum);
+
+        uint32_t offset = 0;
+
+        for (const struct Ethernet::bufferChain_s* segment = payload; segment != nullptr; segment = segment->next) {
+            sum = Checksum::combine(sum, Checksum::add(segment->data, segment->length), offset);
+            offset += segment->length;
+        }
+
+        /* Zero means no checksum */
+        uint16_t checksum = Checksum::finish(sum);
+        udp->checksum = (checksum == 0) ? 0xFFFF : checksum;
+    }
+
+    /* Headers in front of the application segments */
+    struct Ethernet::bufferChain_s headers = { (const uint8_t *) txHeader, IPV4_HEADER_SIZE + UDP_HEADER_SIZE, payload };
+
+    Ethernet::ethError_e ethError = Ethernet::NO_ERROR;
+    ethernet.sendFrame(&headers, destinationMac, ETHERTYPE_IPV4, ethError);
+
+    if (ethError != Ethernet::NO_ERROR) {
+        error = TX_ERROR;
+
+        return *this;
+    }
+
+    ++stats.udpSent;
+
+    return *this;
+};
+
+
+Network& Network::sendTo(uint32_t destination, uint16_t destinationPort, uint16_t sourcePort, const uint8_t* payload, uint32_t length, netError_e& error) {
+    struct Ethernet::bufferChain_s segment = { payload, length, nullptr };
+
+    return sendTo(destination, destinationPort, sourcePort, &segment, error);
+};
+
+
+Network& Network::setChecksumTX(bool enable) {
+    checksumTX = enable;
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                          PROCESSING                           */
+/*****************************************************************/
+
+uint32_t Network::poll() {
+    uint32_t processed = 0;
+    struct EthernetRX::rxFrame_s* frame;
+
+    while ((frame = receiver.receive()) != nullptr) {
+        if (frame->error) {
+            ++stats.dropped;
+        } else if (frame->etherType == ETHERTYPE_ARP) {
+            handleArp(frame);
+        } else if (frame->etherType == ETHERTYPE_IPV4) {
+            handleIpv4(frame);
+        } else {
+            ++stats.dropped;
+        }
+
+        receiver.release(frame);
+        ++processed;
+    }
+
+    return processed;
+};
+
+
+bool Network::resolve(uint32_t target, struct Ethernet::macAddr_s& targetMac) {
+    struct arpEntry_s* entry = findArp(target);
+
+    if (entry != nullptr && entry->valid) {
+        targetMac = entry->mac;
+
+        return true;
+    }
+
+    uint64_t now = timer.getTime();
+
+    /* A caller retrying in a loop must not flood the link */
+    if (entry != nullptr && (now - entry->requested) < ARP_RETRY) {
+        return false;
+    }
+
+    if (entry == nullptr) {
+        entry = replaceArp(target);
+    }
+
+    entry->pending = true;
+    entry->requested = now;
+
+    static const uint8_t unknownMac[6] = { 0 };
+
+    sendArp(ARP_REQUEST, unknownMac, target);
+    ++stats.arpRequests;
+
+    return false;
+};
+
+
+const struct Network::netStats_s& Network::getStats() {
+    return stats;
+};
+
+
+void Network::handleArp(const struct EthernetRX::rxFrame_s* frame) {
+    const struct arpPacket_s* arp = (const struct arpPacket_s *) frame->payload;
+
+    if ((frame->length < sizeof(struct arpPacket_s)) || (arp->hardwareType != swap16(1)) || (arp->protocolType != swap16(ETHERTYPE_IPV4)) ||
+        (arp->hardwareLength != 6) || (arp->protocolLength != 4)) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    uint32_t senderIp = 0, targetIp = 0;
+
+    for (int i = 0; i < 4; ++i) {
+        senderIp = (senderIp << 8) | arp->senderIp[i];
+        targetIp = (targetIp << 8) | arp->targetIp[i];
+    }
+
+    if (targetIp != address) {
+        /* Refresh only the entries already known or requested */
+        if (findArp(senderIp) != nullptr) {
+            learn(senderIp, arp->senderMac);
+        }
+
+        return;
+    }
+
+    learn(senderIp, arp->senderMac);
+
+    if (arp->operation == swap16(ARP_REQUEST)) {
+        sendArp(ARP_REPLY, arp->senderMac, senderIp);
+        ++stats.arpReplies;
+    }
+};
+
+
+void Network::handleIpv4(struct EthernetRX::rxFrame_s* frame) {
+    struct ipv4Header_s* ip = (struct ipv4Header_s *) frame->payload;
+
+    if (frame->length < IPV4_HEADER_SIZE) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    uint32_t headerLength = (ip->versionIHL & 0xF) * 4;
+    uint32_t totalLength = swap16(ip->totalLength);
+
+    if (((ip->versionIHL >> 4) != 4) || (headerLength < IPV4_HEADER_SIZE) || (totalLength < headerLength) || (totalLength > frame->length)) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    /* A valid header sums to 0xFFFF, fragments are not supported */
+    if ((Checksum::fold(Checksum::add(ip, headerLength)) != 0xFFFF) || ((swap16(ip->fragment) & 0x3FFF) != 0)) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    uint32_t destination = swap32(ip->destination);
+
+    if ((destination != address) && (destination != BROADCAST) && (destination != (address | ~netmask))) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    switch (ip->protocol) {
+        case PROTOCOL_ICMP:
+            if (destination == address) {
+                handleIcmp(frame, headerLength);
+            }
+        break;
+
+        case PROTOCOL_UDP:
+            handleUdp(frame, headerLength);
+        break;
+
+        default:
+            ++stats.dropped;
+        break;
+    }
+};
+
+
+void Network::handleIcmp(struct EthernetRX::rxFrame_s* frame, uint32_t headerLength) {
+    struct ipv4Header_s* ip = (struct ipv4Header_s *) frame->payload;
+    struct icmpEcho_s* icmp = (struct icmpEcho_s *) (frame->payload + headerLength);
+
+    uint32_t totalLength = swap16(ip->totalLength);
+
+    if ((totalLength - headerLength < sizeof(struct icmpEcho_s)) || (icmp->type != ICMP_ECHO_REQUEST)) {
+        return;
+    }
+
+    /* Build the reply in place: the checksums are updated instead of recomputed */
+    icmp->checksum = Checksum::update(icmp->checksum, ICMP_ECHO_REQUEST | (icmp->code << 8), ICMP_ECHO_REPLY | (icmp->code << 8));
+    icmp->type = ICMP_ECHO_REPLY;
+
+    ip->checksum = Checksum::update(ip->checksum, ip->timeToLive | (ip->protocol << 8), DEFAULT_TTL | (ip->protocol << 8));
+    ip->timeToLive = DEFAULT_TTL;
+
+    /* Swapping the addresses doesn't change the header sum */
+    uint32_t source = ip->source;
+    ip->source = ip->destination;
+    ip->destination = source;
+
+    /* Reply to the sender MAC */
+    struct Ethernet::macAddr_s destinationMac;
+
+    for (int i = 0; i < 6; ++i) {
+        destinationMac.byte[i] = frame->descriptor.fields.address[i];
+    }
+
+    Ethernet::ethError_e ethError = Ethernet::NO_ERROR;
+    ethernet.sendFrame(frame->payload, totalLength, destinationMac, ETHERTYPE_IPV4, ethError);
+
+    ++stats.echoReplies;
+};
+
+
+void Network::handleUdp(const struct EthernetRX::rxFrame_s* frame, uint32_t headerLength) {
+    const struct ipv4Header_s* ip = (const struct ipv4Header_s *) frame->payload;
+    const struct udpHeader_s* udp = (const struct udpHeader_s *) (frame->payload + headerLength);
+
+    uint32_t totalLength = swap16(ip->totalLength);
+    uint32_t udpLength = swap16(udp->length);
+
+    if ((totalLength - headerLength < UDP_HEADER_SIZE) || (udpLength < UDP_HEADER_SIZE) || (udpLength > totalLength - headerLength)) {
+        ++stats.dropped;
+
+        return;
+    }
+
+    if (udp->checksum != 0) {
+        uint32_t sum = Checksum::add(&ip->source, 8);
+        sum = Checksum::add16(swap16(PROTOCOL_UDP), sum);
+        sum = Checksum::add16(udp->length, sum);
+        sum = Checksum::add(udp, udpLength, sum);
+
+        if (Checksum::fold(sum) != 0xFFFF) {
+            ++stats.dropped;
+
+            return;
+        }
+    }
+
+    uint16_t port = swap16(udp->destinationPort);
+
+    for (uint32_t i = 0; i < MAX_SOCKETS; ++i) {
+        if (sockets[i].handler != nullptr && sockets[i].port == port) {
+            ++stats.udpReceived;
+
+            sockets[i].handler((const uint8_t *) (udp + 1), udpLength - UDP_HEADER_SIZE, swap32(ip->source), swap16(udp->sourcePort), sockets[i].context);
+
+            return;
+        }
+    }
+
+    ++stats.dropped;
+};
+
+
+void Network::sendArp(uint16_t operation, const uint8_t* targetMac, uint32_t targetIp) {
+    /* Word aligned for the burst copy */
+    union {
+        struct arpPacket_s packet;
+        uint32_t words[(sizeof(struct arpPacket_s) + 3) / 4];
+    } buffer;
+
+    struct arpPacket_s& arp = buffer.packet;
+
+    arp.hardwareType = swap16(1);
+    arp.protocolType = swap16(ETHERTYPE_IPV4);
+    arp.hardwareLength = 6;
+    arp.protocolLength = 4;
+    arp.operation = swap16(operation);
+
+    toWire(mac, arp.senderMac);
+
+    for (int i = 0; i < 6; ++i) {
+        arp.targetMac[i] = targetMac[i];
+    }
+
+    for (int i = 0; i < 4; ++i) {
+        arp.senderIp[i] = address >> (24 - (i * 8));
+        arp.targetIp[i] = targetIp >> (24 - (i * 8));
+    }
+
+    /* Requests are broadcast, replies go back to the requester */
+    struct Ethernet::macAddr_s destinationMac;
+
+    if (operation == ARP_REQUEST) {
+        for (int i = 0; i < 6; ++i) {
+            destinationMac.byte[i] = 0xFF;
+        }
+    } else {
+        fromWire(targetMac, destinationMac);
+    }
+
+    Ethernet::ethError_e ethError = Ethernet::NO_ERROR;
+    ethernet.sendFrame((const uint8_t *) &arp, sizeof(struct arpPacket_s), destinationMac, ETHERTYPE_ARP, ethError);
+};
+
+
+void Network::learn(uint32_t ipAddress, const uint8_t* wireMac) {
+    struct arpEntry_s* entry = findArp(ipAddress);
+
+    if (entry == nullptr) {
+        entry = replaceArp(ipAddress);
+    }
+
+    fromWire(wireMac, entry->mac);
+    entry->valid = true;
+    entry->pending = false;
+};
+
+
+struct Network::arpEntry_s* Network::findArp(uint32_t ipAddress) {
+    for (uint32_t i = 0; i < ARP_CACHE_SIZE; ++i) {
+        if ((arpCache[i].valid || arpCache[i].pending) && arpCache[i].address == ipAddress) {
+            return &arpCache[i];
+        }
+    }
+
+    return nullptr;
+};
+
+
+struct Network::arpEntry_s* Network::replaceArp(uint32_t ipAddress) {
+    struct arpEntry_s* entry = &arpCache[arpNext];
+
+    arpNext = (arpNext + 1) % ARP_CACHE_SIZE;
+
+    entry->address = ipAddress;
+    entry->valid = false;
+    entry->pending = false;
+
+    return entry;
+};
+
+
+/* The driver keeps the first byte on the wire in byte[5] */
+void Network::toWire(const struct Ethernet::macAddr_s& macAddress, uint8_t* wire) {
+    for (int i = 0; i < 6; ++i) {
+        wire[i] = macAddress.byte[5 - i];
+    }
+};
+
+
+void Network::fromWire(const uint8_t* wire, struct Ethernet::macAddr_s& macAddress) {
+    for (int i = 0; i < 6; ++i) {
+        macAddress.byte[i] = wire[5 - i];
+    }
+};
+
+#endif
@@ -161,8 +161,8 @@ SD& SD::init(clockSpeed_e speed, busWidth_e width, uint8_t* cmd8_response, bool&
 
     /* ----------- Clock Configuration ----------- */
 
-    /* Switch to requested clock speed */
-    control->clockSpeed = speed; 
+    /* Switch to requested clock speed, 50 MHz needs High-Speed mode first */
+    control->clockSpeed = (speed == CLK_50MHZ) ? CLK_25MHZ : speed; 
 
 
     /* ----------- CID Register Reading ----------- */
@@ -321,6 +321,21 @@ SD& SD::init(clockSpeed_e speed, busWidth_e width, uint8_t* cmd8_response, bool&
     /* Update host controller configuration */
     control->busWidth = width;
 
+
+    /* ----------- High-Speed Mode ----------- */
+
+    if (speed == CLK_50MHZ) {
+        setHighSpeed(error);
+
+        /* A card without High-Speed mode or a failed switch (timeout or CRC
+         * error on the CMD6 status) keeps working at 25 MHz */
+        if (error != SD::NO_ERROR) {
+            setClockSpeed(CLK_25MHZ);
+
+            error = SD::NO_ERROR;
+        }
+    }
+
     return *this;
 };
 
@@ -345,6 +360,55 @@ SD& SD::setClockSpeed(clockSpeed_e speed) {
 };
 
 
+SD& SD::setHighSpeed(errorType_e& error) {
+    uint8_t switchStatus[64];
+
+    /* CMD6 exists from SD spec 1.10 (SCR SD_SPEC != 0) */
+    if (((cardSCR >> 56) & 0xF) == 0) {
+        error = SD::CARD_ERR;
+
+        return *this;
+    }
+
+    /* Check mode: function 1 of group 1 (High-Speed) supported, bit 401 */
+    readSwitchStatus(0x00FFFFF1, switchStatus, error);
+
+    if (error != SD::NO_ERROR) {
+        return *this;
+    }
+
+    if (!(switchStatus[13] & 0x02)) {
+        error = SD::CARD_ERR;
+
+        return *this;
+    }
+
+    /* Switch mode: the group 1 result (bits 379:376) is the function selected */
+    readSwitchStatus(0x80FFFFF1, switchStatus, error);
+
+    if (error != SD::NO_ERROR) {
+        return *this;
+    }
+
+    if ((switchStatus[16] & 0x0F) != 0x1) {
+        error = SD::CARD_ERR;
+
+        return *this;
+    }
+
+    /* The card switched at the end of the status block, the 8 clocks it
+     * needs are long gone before the next command */
+    control->clockSpeed = CLK_50MHZ;
+
+    return *this;
+};
+
+
+SD::clockSpeed_e SD::getClockSpeed() {
+    return (clockSpeed_e) control->clockSpeed;
+};
+
+
 SD& SD::setBusWidth(busWidth_e width, errorType_e& error) {
     /* Send CMD55: APP_CMD */
     sendCommand(55, (uint32_t) SD::cardRCA << 16);
@@ -608,6 +672,41 @@ SD& SD::readBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* burstRea
 };
 
 
+SD& SD::readBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* const* blockList, uint8_t* responseBuffer,  errorType_e& error) {
+    sendCommand(18, baseAddress);
+
+    readResponse(responseBuffer, error);
+
+    if (error != SD::NO_ERROR) {
+        return *this;
+    }
+
+    for (int i = 0; i < burstLength; ++i) {
+        uint32_t* blockRead = blockList[i];
+
+        for (int j = 0; j < MAX_32_BIT_BLOCK; ++j) {
+            while (status->rxBufferEmpty) {  }
+
+            blockRead[j] = __builtin_bswap32(*rxBuffer);
+        }
+
+        if (status->dataCRC_Error) {
+            error = SD::DAT_CRC_ERR;
+            status->dataCRC_Error = false;
+
+            break;
+        }
+    }
+
+    sendCommand(12, 0);
+
+    flushResponseBuffer();
+    flushDataBuffer();
+
+    return *this;
+};
+
+
 SD& SD::writeBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* burstWrite, uint8_t* responseBuffer,  errorType_e& error) {
     /* Since CMD FSM will automatically start data FSM if it detects CMD25 fill first the buffer 
      * to avoiding reading into an empty buffer */
@@ -700,6 +799,119 @@ SD& SD::writeBurst(uint32_t baseAddress, uint32_t burstLength, uint32_t* burstWr
 };
 
 
+/*****************************************************************/
+/*                        STREAM TRANSFER                        */
+/*****************************************************************/
+
+SD& SD::startWriteStream(uint32_t baseAddress, uint32_t preEraseBlocks, uint8_t* responseBuffer, errorType_e& error) {
+    if (preEraseBlocks != 0) {
+        /* Send CMD55: APP_CMD */
+        sendCommand(55, (uint32_t) SD::cardRCA << 16);
+        flushResponseBuffer();
+
+        /* ACMD23: SET_WR_BLK_ERASE_COUNT, 23 bits */
+        sendCommand(23, preEraseBlocks & 0x7FFFFF);
+        readResponse(responseBuffer, error);
+
+        if (error != SD::NO_ERROR) {
+            return *this;
+        }
+    }
+
+    /* The data FSM waits for a whole block in the TX buffer before sending it, 
+     * the command can be issued with the buffer empty */
+    sendCommand(25, baseAddress);
+
+    readResponse(responseBuffer, error);
+
+    if (error != SD::NO_ERROR) {
+        control->flushTX = true;
+    }
+
+    return *this;
+};
+
+
+bool SD::writeStreamBlock(const uint32_t* block, errorType_e& error) {
+    /* A rejected block or a card stuck busy stopped the data FSM, the TX
+     * buffer would never empty again */
+    if (status->dataError || status->dataCRC_Error || status->dataTimeout) {
+        isWriteDone(error);
+
+        return false;
+    }
+
+    /* The buffer is one block deep */
+    if (!status->txBufferEmpty) {
+        return false;
+    }
+
+    for (int i = 0; i < MAX_32_BIT_BLOCK; ++i) {
+        *txBuffer = block[i];
+    }
+
+    return true;
+};
+
+
+SD& SD::stopWriteStream(errorType_e& error) {
+    /* Don't cut the last block, returns at once if isWriteDone() was already true */
+    while (!isWriteDone(error)) {  }
+
+    /* Stop burst */
+    sendCommand(12, 0);
+
+    /* Flush useless data */
+    flushResponseBuffer();
+    flushDataBuffer();
+
+    return *this;
+};
+
+
+SD& SD::startWriteBlock(uint32_t blockAddress, const uint32_t* blockWrite, uint8_t* responseBuffer, errorType_e& error) {
+    for (int i = 0; i < MAX_32_BIT_BLOCK; ++i) {
+        *txBuffer = blockWrite[i];
+    }
+
+    /* Issue write block command */
+    sendCommand(24, blockAddress);
+
+    /* Read response */
+    readResponse(responseBuffer, error);
+
+    if (error != SD::NO_ERROR) {
+        control->flushTX = true;
+    }
+
+    return *this;
+};
+
+
+bool SD::isWriteDone(errorType_e& error) {
+    if (status->dataError || status->dataCRC_Error || status->dataTimeout) {
+        if (status->dataError) {
+            error = SD::DAT_ERR;
+        } else if (status->dataCRC_Error) {
+            error = SD::DAT_CRC_ERR;
+        } else {
+            error = SD::DAT_TIMEOUT;
+        }
+
+        status->dataError = false;
+        status->dataCRC_Error = false;
+        status->dataTimeout = false;
+
+        /* The data FSM stopped, drop what is left of the block */
+        control->flushTX = true;
+
+        return true;
+    }
+
+    return status->txBufferEmpty && (status->dataIdle || status->dataWaitTX);
+};
+
+
 SD& SD::flushResponseBuffer() {
     /* Wait for both FSMs to be idle */
     while (!status->cmdIdle || !status->dataIdle) {  }
@@ -823,6 +1035,52 @@ SD& SD::readOCR(uint8_t* ocrBuffer, errorType_e& error) {
     return *this;
 };
 
+
+SD& SD::readSwitchStatus(uint32_t argument, uint8_t* statusBuffer, errorType_e& error) {
+    /* CMD6: SWITCH_FUNC, R1 then a 512 bit status block on DAT */
+    sendCommand(6, argument);
+    readResponse(nullptr, error);
+
+    if (error != SD::NO_ERROR) {
+        return *this;
+    }
+
+    for (int i = 0; i < 16; i++) {
+        uint32_t timeout = 0;
+
+        while (status->rxBufferEmpty) {
+            if (status->dataTimeout || ++timeout > 100000) {
+                error = SD::DAT_TIMEOUT;
+                status->dataTimeout = false;
+
+                flushDataBuffer();
+
+                return *this;
+            }
+        }
+
+        uint32_t word = *rxBuffer;
+
+        /* Convert to big-endian bytes */
+        statusBuffer[i * 4 + 0] = (word >> 24) & 0xFF;
+        statusBuffer[i * 4 + 1] = (word >> 16) & 0xFF;
+        statusBuffer[i * 4 + 2] = (word >> 8) & 0xFF;
+        statusBuffer[i * 4 + 3] = word & 0xFF;
+    }
+
+    /* The CRC is checked after the last word */
+    while (!status->dataIdle) {  }
+
+    if (status->dataCRC_Error) {
+        error = SD::DAT_CRC_ERR;
+        status->dataCRC_Error = false;
+    }
+
+    flushDataBuffer();
+
+    return *this;
+};
+
 bool SD::isCardInserted() {
     return status->cardDetected;
 };
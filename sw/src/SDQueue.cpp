@@ -0,0 +1,353 @@
+#ifndef SD_QUEUE_CPP
+#define SD_QUEUE_CPP
+
+#include "../lib/driver/SDQueue.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/* Interrupt enable positions */
+static const uint32_t ENABLE_TX_EMPTY = 1 << 0;
+static const uint32_t ENABLE_RX_FULL = 1 << 1;
+static const uint32_t ENABLE_DATA_DONE = 1 << 5;
+
+/* Event bits (SD::sdInterruptStatus_s) */
+static const uint32_t EVENT_DATA_DONE = 1 << 2;
+static const uint32_t EVENT_RX_FULL = 1 << 6;
+static const uint32_t EVENT_TX_EMPTY = 1 << 7;
+
+/* Words of a block, the controller FIFOs hold exactly one */
+static const uint32_t BLOCK_WORDS = 128;
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+SDQueue::SDQueue(SD& sdCard, bool isHighCapacity) : card(sdCard), highCapacity(isHighCapacity) {
+    head = 0;
+    tail = 0;
+    active = false;
+    requestBlock = 0;
+
+    stats.requests = 0;
+    stats.blocks = 0;
+    stats.commands = 0;
+    stats.merged = 0;
+    stats.errors = 0;
+};
+
+
+SDQueue::~SDQueue() {
+    card.control->interruptEnable = 0;
+};
+
+
+/*****************************************************************/
+/*                           REQUESTS                            */
+/*****************************************************************/
+
+bool SDQueue::submit(struct sdRequest_s* request) {
+    uint32_t slot = head;
+
+    if ((slot - tail) == QUEUE_SIZE) {
+        return false;
+    }
+
+    /* Without a block the transfer would never end */
+    if (request->count == 0) {
+        return false;
+    }
+
+    request->done = false;
+    request->error = SD::NO_ERROR;
+
+    ring[slot & (QUEUE_SIZE - 1)] = request;
+
+    /* Publish the slot before the new head */
+    asm volatile ("" ::: "memory");
+    head = slot + 1;
+
+    /* While a transfer is active the handler picks the request up when it
+     * completes. Otherwise no SD interrupt can fire and the transfer is
+     * started from here. */
+    if (!active) {
+        start();
+    }
+
+    return true;
+};
+
+
+uint32_t SDQueue::interruptHandler() {
+    volatile uint32_t* eventRegister = (volatile uint32_t *) card.event;
+
+    uint32_t events = *eventRegister;
+    *eventRegister = 0;
+
+    if (!active) {
+        return events;
+    }
+
+    /* FIFO events are level sensitive: they are latched again until the FIFO
+     * is serviced, the status is checked to skip the stale ones */
+    if (write) {
+        if ((events & EVENT_TX_EMPTY) && card.status->txBufferEmpty) {
+            /* The data FSM took the whole previous block */
+            if (++transferred == blocks) {
+                /* Last block consumed, same sequence as SD::writeBurst() */
+                card.control->interruptEnable = 0;
+
+                card.sendCommand(12, 0);
+                card.flushResponseBuffer();
+                card.flushDataBuffer();
+
+                complete(dataError());
+            } else {
+                uint32_t* source = nextBlock();
+
+                for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+                    *card.txBuffer = source[i];
+                }
+            }
+        } else if (events & EVENT_DATA_DONE) {
+            /* End of a single block write or burst aborted by the card */
+            SD::errorType_e error = dataError();
+
+            if (error == SD::NO_ERROR && blocks > 1) {
+                error = SD::DAT_ERR;
+            }
+
+            if (error != SD::NO_ERROR) {
+                card.control->flushTX = true;
+            }
+
+            complete(error);
+        }
+    } else {
+        if ((events & EVENT_RX_FULL) && card.status->rxBufferFull) {
+            uint32_t* destination = nextBlock();
+
+            /* SD serial data is MSB-first, same word order as SD::readBlock() */
+            for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+                destination[i] = __builtin_bswap32(*card.rxBuffer);
+            }
+
+            if (++transferred == blocks) {
+                card.control->interruptEnable = 0;
+
+                if (blocks == 1) {
+                    /* The CRC is checked right after the last word */
+                    while (!card.status->dataIdle) {  }
+                } else {
+                    card.sendCommand(12, 0);
+                    card.flushResponseBuffer();
+                    card.flushDataBuffer();
+                }
+
+                complete(dataError());
+            }
+        } else if (events & EVENT_DATA_DONE) {
+            /* The data FSM stopped before the last block */
+            SD::errorType_e error = dataError();
+
+            card.control->interruptEnable = 0;
+
+            if (blocks > 1) {
+                card.sendCommand(12, 0);
+                card.flushResponseBuffer();
+            }
+
+            card.flushDataBuffer();
+
+            complete(error == SD::NO_ERROR ? SD::DAT_TIMEOUT : error);
+        }
+    }
+
+    return events;
+};
+
+
+uint32_t SDQueue::pending() {
+    return head - tail;
+};
+
+
+bool SDQueue::isIdle() {
+    return head == tail;
+};
+
+
+const struct SDQueue::sdQueueStats_s& SDQueue::getStats() {
+    return stats;
+};
+
+
+/*****************************************************************/
+/*                           TRANSFERS                           */
+/*****************************************************************/
+
+void SDQueue::start() {
+    active = true;
+
+    struct sdRequest_s* first = ring[tail & (QUEUE_SIZE - 1)];
+
+    /* A request larger than MAX_BURST is sent in several commands, requestBlock
+     * holds the blocks of the first request sent by the previous ones */
+    uint32_t address = first->block + requestBlock;
+    uint32_t remaining = first->count - requestBlock;
+
+    write = first->write;
+    blocks = (remaining > MAX_BURST) ? MAX_BURST : remaining;
+    requests = (blocks == remaining) ? 1 : 0;
+
+    /* Merge the requests that continue the same transfer */
+    uint32_t queued = head - tail;
+
+    while (requests != 0 && requests < queued) {
+        struct sdRequest_s* next = ring[(tail + requests) & (QUEUE_SIZE - 1)];
+
+        if (next->write != write || next->block != (address + blocks) || (blocks + next->count) > MAX_BURST) {
+            break;
+        }
+
+        blocks += next->count;
+        ++requests;
+    }
+
+    if (requests > 1) {
+        stats.merged += requests - 1;
+    }
+
+    ++stats.commands;
+
+    transferred = 0;
+    requestIndex = 0;
+
+    /* Discard the events of the previous transfer */
+    *((volatile uint32_t *) card.event) = 0;
+
+    SD::errorType_e error = SD::NO_ERROR;
+
+    if (write) {
+        /* The data FSM starts right after the command, queue the first block */
+        uint32_t* source = nextBlock();
+
+        for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+            *card.txBuffer = source[i];
+        }
+
+        card.sendCommand((blocks == 1) ? 24 : 25, cardAddress(address));
+    } else {
+        card.sendCommand((blocks == 1) ? 17 : 18, cardAddress(address));
+    }
+
+    card.readResponse(nullptr, error);
+
+    if (error != SD::NO_ERROR) {
+        if (write) {
+            card.control->flushTX = true;
+        }
+
+        complete(error);
+
+        return;
+    }
+
+    /* The data phase can't be over yet: the card access time and the block
+     * transfer take much longer than the response. Full / empty FIFO events
+     * are level sensitive and can't be missed anyway. */
+    if (write) {
+        card.control->interruptEnable = ENABLE_DATA_DONE | ((blocks > 1) ? ENABLE_TX_EMPTY : 0);
+    } else {
+        card.control->interruptEnable = ENABLE_RX_FULL | ENABLE_DATA_DONE;
+    }
+};
+
+
+void SDQueue::complete(SD::errorType_e error) {
+    card.control->interruptEnable = 0;
+    *((volatile uint32_t *) card.event) = 0;
+
+    uint32_t finished = requests;
+
+    /* A failed part of a split request fails the whole request */
+    if (error != SD::NO_ERROR && finished == 0) {
+        finished = 1;
+    }
+
+    /* Otherwise the split request continues where this command ended */
+    if (finished != 0) {
+        requestBlock = 0;
+    }
+
+    for (uint32_t i = 0; i < finished; ++i) {
+        struct sdRequest_s* request = ring[tail & (QUEUE_SIZE - 1)];
+
+        ++stats.requests;
+        stats.blocks += request->count;
+
+        if (error != SD::NO_ERROR) {
+            ++stats.errors;
+        }
+
+        request->error = error;
+
+        /* Publish the error and the data before done */
+        asm volatile ("" ::: "memory");
+        request->done = true;
+
+        /* The slot can be reused from now on */
+        tail = tail + 1;
+
+        if (request->callback != nullptr) {
+            request->callback(request);
+        }
+    }
+
+    if (head != tail) {
+        start();
+    } else {
+        active = false;
+    }
+};
+
+
+uint32_t* SDQueue::nextBlock() {
+    struct sdRequest_s* request = ring[(tail + requestIndex) & (QUEUE_SIZE - 1)];
+    uint32_t* buffer = request->buffer + (requestBlock * BLOCK_WORDS);
+
+    if (++requestBlock == request->count) {
+        requestBlock = 0;
+        ++requestIndex;
+    }
+
+    return buffer;
+};
+
+
+SD::errorType_e SDQueue::dataError() {
+    SD::errorType_e error = SD::NO_ERROR;
+
+    if (card.status->dataTimeout) {
+        error = SD::DAT_TIMEOUT;
+        card.status->dataTimeout = false;
+    } else if (card.status->dataCRC_Error) {
+        error = SD::DAT_CRC_ERR;
+        card.status->dataCRC_Error = false;
+    } else if (card.status->dataError) {
+        error = SD::DAT_ERR;
+        card.status->dataError = false;
+    }
+
+    return error;
+};
+
+
+/* SDHC = block address, SDSC = byte address */
+uint32_t SDQueue::cardAddress(uint32_t block) {
+    return highCapacity ? block : (block * 512);
+};
+
+#endif
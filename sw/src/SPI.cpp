@@ -126,15 +126,15 @@ SPI& SPI::enableInterrupt(bool enable) {
 /*****************************************************************/
 
 
-SPI& SPI::exchangeStream(uint8_t* txBuf, uint8_t* rxBuf, uint32_t size) {
-    /* Write to TX buffer the entire array */
-    loadBufferTX(txBuf, size);
+SPI& SPI::exchangeStream(const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size) {
+    stream(nullptr, 0, txBuf, rxBuf, size);
 
-    /* Wait until the transaction ends */
-    while (!status->idle) {  }
+    return *this;
+};
 
-    /* Copy the received data into the array */
-    unloadBufferRX(rxBuf, size);
+
+SPI& SPI::transaction(const uint8_t* command, uint32_t commandSize, const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size) {
+    stream(command, commandSize, txBuf, rxBuf, size);
 
     return *this;
 };
@@ -159,6 +159,44 @@ SPI& SPI::retrieve(uint8_t* rxBuf, uint32_t size, spiError_e* error) {
 /*                         UTILITY                         */
 /***********************************************************/
 
+void SPI::stream(const uint8_t* command, uint32_t commandSize, const uint8_t* txBuf, uint8_t* rxBuf, uint32_t size) {
+    uint32_t total = commandSize + size;
+    uint32_t sent = 0;
+    uint32_t received = 0;
+
+    /* Bytes left from a previous transfer would shift the data */
+    while (!status->idle) {  }
+
+    while (!status->emptyRX) {
+        (void) *bufferRX;
+    }
+
+    while (received < total) {
+        /* Refill TX. Never more bytes in flight than the RX buffer holds, so it can't overflow */
+        while (sent < total && (sent - received) < BUFFER_SIZE && !status->fullTX) {
+            if (sent < commandSize) {
+                *bufferTX = command[sent];
+            } else {
+                *bufferTX = (txBuf != nullptr) ? txBuf[sent - commandSize] : DUMMY_BYTE;
+            }
+
+            ++sent;
+        }
+
+        /* Drain RX */
+        while (received < sent && !status->emptyRX) {
+            uint8_t data = *bufferRX;
+
+            if (received >= commandSize && rxBuf != nullptr) {
+                rxBuf[received - commandSize] = data;
+            }
+
+            ++received;
+        }
+    }
+};
+
+
 void SPI::unloadBufferRX (uint8_t* data, uint32_t size) {
     for (int i = 0; i < size; ++i) {
         /* Wait for bytes in buffer */
@@ -0,0 +1,259 @@
+#ifndef SPI_FLASH_CPP
+#define SPI_FLASH_CPP
+
+#include "../lib/driver/SPIFlash.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+SPIFlash::SPIFlash(SPI& device, uint32_t slaveIndex) : spi(device), slave(slaveIndex) {
+    id.manufacturer = 0;
+    id.memoryType = 0;
+    id.capacity = 0;
+
+    size = 0;
+    busy = false;
+};
+
+
+/*****************************************************************/
+/*                        IDENTIFICATION                         */
+/*****************************************************************/
+
+SPIFlash& SPIFlash::init(flashError_e& error) {
+    uint8_t opcode = JEDEC_ID;
+    uint8_t jedec[3];
+
+    error = NO_ERROR;
+    size = 0;
+
+    spi.connect(slave, nullptr);
+    spi.transaction(&opcode, 1, nullptr, jedec, 3);
+
+    id.manufacturer = jedec[0];
+    id.memoryType = jedec[1];
+    id.capacity = jedec[2];
+
+    /* A floating or missing MISO reads as all zeros or all ones */
+    if (id.manufacturer == 0x00 || id.manufacturer == 0xFF || id.capacity >= 32) {
+        error = NOT_DETECTED;
+
+        return *this;
+    }
+
+    /* Above 16 MiB the 3 byte address commands reach the first 16 MiB */
+    size = 1u << ((id.capacity > 24) ? 24 : id.capacity);
+
+    /* The state of the device is unknown after a reset */
+    busy = true;
+
+    return wait(error);
+};
+
+
+/*****************************************************************/
+/*                           TRANSFERS                           */
+/*****************************************************************/
+
+SPIFlash& SPIFlash::read(uint32_t address, uint8_t* buffer, uint32_t count, flashError_e& error) {
+    error = NO_ERROR;
+
+    if (address >= size || count > (size - address)) {
+        error = OUT_OF_RANGE;
+
+        return *this;
+    }
+
+    if (count == 0) {
+        return *this;
+    }
+
+    wait(error);
+
+    if (error != NO_ERROR) {
+        return *this;
+    }
+
+    /* Opcode, address and a dummy byte, then the data in the same chip select window */
+    uint8_t header[5];
+
+    command(header, FAST_READ, address);
+    header[4] = SPI::DUMMY_BYTE;
+
+    spi.connect(slave, nullptr);
+    spi.transaction(header, 5, nullptr, buffer, count);
+
+    return *this;
+};
+
+
+SPIFlash& SPIFlash::program(uint32_t address, const uint8_t* data, uint32_t count, flashError_e& error) {
+    programPages(address, data, count, nullptr, nullptr, error);
+
+    return *this;
+};
+
+
+SPIFlash& SPIFlash::program(uint32_t address, uint32_t count, flashFill_t fill, void* context, flashError_e& error) {
+    programPages(address, nullptr, count, fill, context, error);
+
+    return *this;
+};
+
+
+SPIFlash& SPIFlash::eraseSector(uint32_t address, flashError_e& error) {
+    error = NO_ERROR;
+
+    if (address >= size) {
+        error = OUT_OF_RANGE;
+
+        return *this;
+    }
+
+    wait(error);
+
+    if (error != NO_ERROR) {
+        return *this;
+    }
+
+    if (!writeEnable()) {
+        error = WRITE_PROTECTED;
+
+        return *this;
+    }
+
+    uint8_t header[4];
+
+    command(header, SECTOR_ERASE, address & ~(SECTOR_SIZE - 1));
+    spi.transaction(header, 4, nullptr, nullptr, 0);
+
+    /* Polled by the next operation */
+    busy = true;
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                            STATUS                             */
+/*****************************************************************/
+
+bool SPIFlash::isBusy() {
+    if (!busy) {
+        return false;
+    }
+
+    busy = (readStatus() & STATUS_BUSY) != 0;
+
+    return busy;
+};
+
+
+SPIFlash& SPIFlash::wait(flashError_e& error) {
+    uint32_t polls = 0;
+
+    error = NO_ERROR;
+
+    while (isBusy()) {
+        if (++polls == BUSY_POLLS) {
+            error = TIMEOUT;
+
+            break;
+        }
+    }
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                            PRIVATE                            */
+/*****************************************************************/
+
+uint8_t SPIFlash::readStatus() {
+    uint8_t opcode = READ_STATUS;
+    uint8_t status;
+
+    spi.connect(slave, nullptr);
+    spi.transaction(&opcode, 1, nullptr, &status, 1);
+
+    return status;
+};
+
+
+bool SPIFlash::writeEnable() {
+    uint8_t opcode = WRITE_ENABLE;
+
+    spi.connect(slave, nullptr);
+    spi.transaction(&opcode, 1, nullptr, nullptr, 0);
+
+    /* Not set on a write protected device */
+    return (readStatus() & STATUS_WEL) != 0;
+};
+
+
+void SPIFlash::command(uint8_t* bytes, uint8_t opcode, uint32_t address) {
+    bytes[0] = opcode;
+    bytes[1] = (uint8_t) (address >> 16);
+    bytes[2] = (uint8_t) (address >> 8);
+    bytes[3] = (uint8_t) address;
+};
+
+
+void SPIFlash::programPages(uint32_t address, const uint8_t* data, uint32_t count, flashFill_t fill, void* context, flashError_e& error) {
+    error = NO_ERROR;
+
+    if (address >= size || count > (size - address)) {
+        error = OUT_OF_RANGE;
+
+        return;
+    }
+
+    uint32_t offset = 0;
+
+    while (offset < count) {
+        /* A page program wraps inside the page: stop at its end */
+        uint32_t chunk = PAGE_SIZE - ((address + offset) & (PAGE_SIZE - 1));
+
+        if (chunk > (count - offset)) {
+            chunk = count - offset;
+        }
+
+        /* Prepare the page while the previous one is being programmed */
+        uint8_t header[4];
+        const uint8_t* source = page;
+
+        command(header, PAGE_PROGRAM, address + offset);
+
+        if (fill != nullptr) {
+            fill(page, offset, chunk, context);
+        } else {
+            source = data + offset;
+        }
+
+        wait(error);
+
+        if (error != NO_ERROR) {
+            return;
+        }
+
+        if (!writeEnable()) {
+            error = WRITE_PROTECTED;
+
+            return;
+        }
+
+        /* At most 260 bytes: always a single TX buffer burst */
+        spi.transaction(header, 4, source, nullptr, chunk);
+
+        busy = true;
+        offset += chunk;
+    }
+};
+
+#endif
@@ -0,0 +1,154 @@
+#ifndef SPI_QUEUE_CPP
+#define SPI_QUEUE_CPP
+
+#include "../lib/driver/SPIQueue.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+SPIQueue::SPIQueue(SPI& device) : spi(device) {
+    head = 0;
+    tail = 0;
+    active = false;
+
+    *spi.event = 0;
+    spi.enableInterrupt(true);
+};
+
+
+SPIQueue::~SPIQueue() {
+    spi.enableInterrupt(false);
+};
+
+
+/*****************************************************************/
+/*                         TRANSACTIONS                          */
+/*****************************************************************/
+
+bool SPIQueue::submit(struct spiTransaction_s* transaction) {
+    uint32_t slot = head;
+
+    if ((slot - tail) == QUEUE_SIZE) {
+        return false;
+    }
+
+    uint32_t total = transaction->commandSize + transaction->size;
+
+    /* An empty transaction would never raise the interrupt */
+    if (transaction->slave >= SPI_SLAVES || total == 0 || total > SPI::BUFFER_SIZE) {
+        return false;
+    }
+
+    transaction->done = false;
+    transaction->error = SPI::NO_ERROR;
+
+    ring[slot & (QUEUE_SIZE - 1)] = transaction;
+
+    /* Publish the slot before the new head */
+    asm volatile ("" ::: "memory");
+    head = slot + 1;
+
+    /* While a transaction is active the handler picks this one up when it
+     * completes. Otherwise no SPI interrupt can fire and it is started from
+     * here. */
+    if (!active) {
+        start();
+    }
+
+    return true;
+};
+
+
+uint32_t SPIQueue::interruptHandler() {
+    uint32_t events = *spi.event;
+    *spi.event = 0;
+
+    if (!active) {
+        return events;
+    }
+
+    struct spiTransaction_s* transaction = ring[tail & (QUEUE_SIZE - 1)];
+    uint32_t total = transaction->commandSize + transaction->size;
+
+    /* Every byte sent has been received when the TX buffer emptied */
+    for (uint32_t i = 0; i < total; ++i) {
+        if (spi.isEmptyRX()) {
+            /* The TX buffer ran dry before the whole transaction was written */
+            transaction->error = SPI::RECEIVE_SIZE_ERROR;
+
+            break;
+        }
+
+        uint8_t data = *spi.bufferRX;
+
+        if (i >= transaction->commandSize && transaction->rxData != nullptr) {
+            transaction->rxData[i - transaction->commandSize] = data;
+        }
+    }
+
+    ++tail;
+    active = false;
+
+    transaction->done = true;
+
+    if (transaction->callback != nullptr) {
+        transaction->callback(transaction);
+    }
+
+    if (tail != head) {
+        start();
+    }
+
+    return events;
+};
+
+
+uint32_t SPIQueue::pending() {
+    return head - tail;
+};
+
+
+bool SPIQueue::isIdle() {
+    return head == tail;
+};
+
+
+/*****************************************************************/
+/*                            PRIVATE                            */
+/*****************************************************************/
+
+void SPIQueue::start() {
+    struct spiTransaction_s* transaction = ring[tail & (QUEUE_SIZE - 1)];
+
+    active = true;
+
+    /* Waits for the previous chip select window to close */
+    spi.connect(transaction->slave, nullptr);
+
+    while (!spi.isEmptyRX()) {
+        (void) *spi.bufferRX;
+    }
+
+    /* The whole transaction fits: no full check, the buffer must be written
+     * faster than the bus empties it or the chip select rises early */
+    for (uint32_t i = 0; i < transaction->commandSize; ++i) {
+        *spi.bufferTX = transaction->command[i];
+    }
+
+    if (transaction->txData != nullptr) {
+        for (uint32_t i = 0; i < transaction->size; ++i) {
+            *spi.bufferTX = transaction->txData[i];
+        }
+    } else {
+        for (uint32_t i = 0; i < transaction->size; ++i) {
+            *spi.bufferTX = SPI::DUMMY_BYTE;
+        }
+    }
+};
+
+#endif
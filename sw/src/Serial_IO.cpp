@@ -13,6 +13,11 @@
 volatile struct UART::uartCtrlStatus_s* volatile Serial_IO::status;
 volatile uint8_t* Serial_IO::bufferTX;
 volatile uint8_t* Serial_IO::bufferRX;
+UARTBuffer* Serial_IO::buffer = nullptr;
+
+uint32_t (*Serial_IO::bufferWrite)(UARTBuffer* rings, const uint8_t* data, uint32_t size) = nullptr;
+uint32_t (*Serial_IO::bufferRead)(UARTBuffer* rings, uint8_t* data, uint32_t size) = nullptr;
+void (*Serial_IO::bufferFlush)(UARTBuffer* rings) = nullptr;
 
 
 /****************************************************************/
@@ -38,75 +43,86 @@ void Serial_IO::init(uint32_t baudRate, bool parityEnable, UART::parityMode_e pa
 };
 
 
-/****************************************************************/
-/*                        SIMPLE WRITE                          */
-/****************************************************************/
-
-void Serial_IO::write(char character) {
-    /* Wait until the TX buffer become not full */
-    while (status->fullTX) {  }
-
-    /* Write to the TX buffer */
-    *bufferTX = (uint8_t) character;
-}; 
+void Serial_IO::flush() {
+    if (buffer != nullptr) {
+        bufferFlush(buffer);
+    } else {
+        UART::waitSent(status);
+    }
+};
 
 
-void Serial_IO::write(const char* str) {
-    uint32_t size; 
+/****************************************************************/
+/*                          TRANSFER                            */
+/****************************************************************/
 
-    /* Compute string size */
-    for (size = 0; str[size] != '\0'; ++size) {  }
+void Serial_IO::send(const char* data, uint32_t size) {
+    if (buffer != nullptr) {
+        while (size != 0) {
+            /* Wait only if the ring is full */
+            uint32_t accepted = bufferWrite(buffer, (const uint8_t *) data, size);
 
-    write(str, size);
-};
+            data += accepted;
+            size -= accepted;
+        }
 
+        return;
+    }
 
-void Serial_IO::write(const char* str, uint32_t size) {
-    for (int i = 0; i < size; ++i) {
+    for (uint32_t i = 0; i < size; ++i) {
         /* Wait until the TX buffer not full */
         while (status->fullTX) {  }
 
         /* Write to the TX buffer */
-        *bufferTX = str[i];
+        *bufferTX = data[i];
     }
 };
 
-void Serial_IO::write(float num, uint32_t digits) {
-    /* Extract raw bits */
-    uint32_t bits = *(uint32_t*)&num;
 
-    /* Extract significand and exponent, check for NAN */
-    if (((bits & 0x7F800000) == 0x7F800000) && ((bits & 0x007FFFFF) != 0)) {
-        write("nan");
+char Serial_IO::receive() {
+    if (buffer != nullptr) {
+        uint8_t data;
 
-        return;
-    }
+        while (bufferRead(buffer, &data, 1) == 0) {  }
 
-    if (num < 0.0f) {
-        *bufferTX = '-';
-        num = -num;
+        return (char) data;
     }
 
-    uint32_t intPart = (uint32_t) num;
-    float fracPart = num - (float) intPart;
+    /* Wait until RX buffer is not empty */
+    while (status->emptyRX);
 
-    /* Write unsigned */
-    writeD(intPart, false);
+    /* Read RX buffer */
+    return (char)(*bufferRX);
+};
 
-    if (digits == 0) {
-        return;
-    }
 
-    write('.');
+/****************************************************************/
+/*                        SIMPLE WRITE                          */
+/****************************************************************/
 
-    for (uint32_t i = 0; i < digits; i++) {
-        fracPart *= 10.0f;
+void Serial_IO::write(char character) {
+    send(&character, 1);
+}; 
 
-        uint32_t digit = (uint32_t)fracPart;
-        write(char('0' + digit));
 
-        fracPart -= (float)digit;
-    }
+void Serial_IO::write(const char* str) {
+    uint32_t size; 
+
+    /* Compute string size */
+    for (size = 0; str[size] != '\0'; ++size) {  }
+
+    write(str, size);
+};
+
+
+void Serial_IO::write(const char* str, uint32_t size) {
+    send(str, size);
+};
+
+void Serial_IO::write(float num, uint32_t digits) {
+    char buffer[FORMAT_FLOAT_SIZE];
+
+    write(buffer, formatFloat(buffer, num, digits));
 };
 
 
@@ -247,32 +263,8 @@ void Serial_IO::vprintf(const char *format, va_list args) {
                     if (format[i] == 'f') {
                         /* Get the value passed as argument */
                         float value = static_cast<float>(va_arg(args, double));
-                        
-                        /* Print minus sign */
-                        if (value < 0) {
-                            write('-');
-                            value = -value;
-                        }
-                        
-                        /* Extract integer and fractional part */
-                        int integerPart = static_cast<int>(value);
-                        float fractionalPart = value - integerPart;
-
-                        writeD(integerPart, false);
-                        write('.');
-
-                        for (int i = 0; i < precision; ++i) {
-                            /* Bring the most significant digit of the fractional part into the integer part
-                            * EX: 0.15 => 1.50 */
-                            fractionalPart *= 10;
 
-                            /* Extract and print */
-                            int digit = static_cast<int>(fractionalPart);
-                            write('0' + digit);
-
-                            /* Remove the integer part and repeat */
-                            fractionalPart -= digit;
-                        }
+                        write(value, precision);
 
                         break;
                     } else {
@@ -331,11 +323,7 @@ uint32_t Serial_IO::readString(char *str, uint32_t size) {
 
     /* Size - 1 to accomodate the last character "\0" */
     while (count < size - 1) {
-        /* Wait until RX buffer is not empty */
-        while (status->emptyRX);
-
-        /* Read RX buffer */
-        char received = (char)(*bufferRX);
+        char received = receive();
         
         if (received == '\n' || received == '\0') {
             /* Exit if the user press ENTER */
@@ -436,11 +424,7 @@ uint32_t Serial_IO::readNumber(Serial_IO::base_e base, bool *error) {
 
 
 char Serial_IO::readChar() {
-    /* Wait until RX buffer is not empty */
-    while (status->emptyRX);
-
-    /* Read RX buffer */
-    return (char)(*bufferRX);
+    return receive();
 };
 
 
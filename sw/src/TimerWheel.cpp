@@ -0,0 +1,398 @@
+#ifndef TIMER_WHEEL_CPP
+#define TIMER_WHEEL_CPP
+
+#include "../lib/TimerWheel.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/* Ticks covered by the whole wheel */
+#define WHEEL_RANGE_BITS (TimerWheel::LEVELS * TimerWheel::SLOT_BITS)
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+TimerWheel::TimerWheel(Timer& device) : timer(device) {
+    for (uint32_t i = 0; i <= OVERFLOW_LIST; ++i) {
+        slots[i] = nullptr;
+    }
+
+    for (uint32_t i = 0; i < LEVELS; ++i) {
+        occupied[i] = 0;
+    }
+
+    current = 0;
+    depth = 0;
+
+    /* Count from zero, the threshold is moved with the deadlines */
+    timer.init(TIMER_MAX_TIME, Timer::FREE_RUNNING)
+         .start();
+
+    timer.setInterrupt(true);
+};
+
+
+TimerWheel::~TimerWheel() {
+    timer.setInterrupt(false)
+         .clearInterrupt();
+};
+
+
+/*****************************************************************/
+/*                            TIMERS                             */
+/*****************************************************************/
+
+TimerWheel& TimerWheel::start(struct wheelTimer_s* wheelTimer, uint64_t delay, uint64_t period) {
+    return startAt(wheelTimer, now() + delay, period);
+};
+
+
+TimerWheel& TimerWheel::startAt(struct wheelTimer_s* wheelTimer, uint64_t deadline, uint64_t period) {
+    lock();
+
+    if (isActive(wheelTimer)) {
+        unlink(wheelTimer);
+    }
+
+    wheelTimer->expires = deadline;
+    wheelTimer->period = period;
+
+    insert(wheelTimer);
+
+    unlock();
+
+    return *this;
+};
+
+
+bool TimerWheel::cancel(struct wheelTimer_s* wheelTimer) {
+    lock();
+
+    bool active = isActive(wheelTimer);
+
+    if (active) {
+        unlink(wheelTimer);
+    }
+
+    unlock();
+
+    return active;
+};
+
+
+/*****************************************************************/
+/*                             TIME                              */
+/*****************************************************************/
+
+uint64_t TimerWheel::now() {
+    volatile uint32_t* count = (volatile uint32_t *) timer.value;
+    uint32_t high, low;
+
+    /* The low word may carry into the high one between the two loads */
+    do {
+        high = count[1];
+        low = count[0];
+    } while (high != count[1]);
+
+    return ((uint64_t) high << 32) | low;
+};
+
+
+uint64_t TimerWheel::nextDeadline() {
+    lock();
+
+    uint64_t deadline = earliest();
+
+    unlock();
+
+    return deadline;
+};
+
+
+/*****************************************************************/
+/*                           INTERRUPT                           */
+/*****************************************************************/
+
+uint32_t TimerWheel::interruptHandler() {
+    timer.clearInterrupt();
+
+    /* The application is changing the wheel, its unlock() programs the deadline */
+    if (depth != 0) {
+        return 0;
+    }
+
+    lock();
+
+    uint32_t fired = advance(now());
+
+    unlock();
+
+    return fired;
+};
+
+
+/*****************************************************************/
+/*                             SLEEP                             */
+/*****************************************************************/
+
+void TimerWheel::idle() {
+    asm volatile ("wfi");
+};
+
+
+static void wakeUp(struct TimerWheel::wheelTimer_s* alarm) {
+    *((volatile bool *) alarm->context) = true;
+}
+
+
+TimerWheel& TimerWheel::sleep(uint64_t counts) {
+    volatile bool elapsed = false;
+    struct wheelTimer_s alarm;
+
+    alarm.callback = wakeUp;
+    alarm.context = (void *) &elapsed;
+    alarm.link = nullptr;
+
+    /* The alarm repeats every tick until it is cancelled: if it expires between
+     * the check and the wfi, the next repetition ends the sleep */
+    start(&alarm, counts, 1ull << TICK_SHIFT);
+
+    while (!elapsed) {
+        idle();
+    }
+
+    cancel(&alarm);
+
+    return *this;
+};
+
+
+/*****************************************************************/
+/*                            PRIVATE                            */
+/*****************************************************************/
+
+void TimerWheel::lock() {
+    ++depth;
+};
+
+
+void TimerWheel::unlock() {
+    if (--depth == 0) {
+        arm();
+    }
+};
+
+
+void TimerWheel::insert(struct wheelTimer_s* wheelTimer) {
+    uint64_t tick = wheelTimer->expires >> TICK_SHIFT;
+
+    /* Late timers expire at the next advance */
+    if (tick < current) {
+        tick = current;
+    }
+
+    uint64_t difference = tick ^ current;
+    uint32_t index = OVERFLOW_LIST;
+
+    /* Beyond the wheel the timer waits for its range in the overflow list */
+    if ((difference >> WHEEL_RANGE_BITS) == 0) {
+        /* The level is the highest group of slot bits that differs from the current tick */
+        uint32_t level = 0;
+
+        while ((difference >> (SLOT_BITS * (level + 1))) != 0) {
+            ++level;
+        }
+
+        uint32_t slot = (uint32_t) (tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+
+        index = (level * SLOTS) + slot;
+        occupied[level] |= 1u << slot;
+    }
+
+    wheelTimer->index = index;
+    wheelTimer->next = slots[index];
+    wheelTimer->link = &slots[index];
+
+    if (wheelTimer->next != nullptr) {
+        wheelTimer->next->link = &wheelTimer->next;
+    }
+
+    slots[index] = wheelTimer;
+};
+
+
+void TimerWheel::unlink(struct wheelTimer_s* wheelTimer) {
+    uint32_t index = wheelTimer->index;
+
+    *wheelTimer->link = wheelTimer->next;
+
+    if (wheelTimer->next != nullptr) {
+        wheelTimer->next->link = wheelTimer->link;
+    }
+
+    wheelTimer->next = nullptr;
+    wheelTimer->link = nullptr;
+
+    if (slots[index] == nullptr && index != OVERFLOW_LIST) {
+        occupied[index / SLOTS] &= ~(1u << (index & (SLOTS - 1)));
+    }
+};
+
+
+bool TimerWheel::nextSlot(uint32_t& index, uint64_t& tick) {
+    /* Every timer of a level is due before those of the levels above it, and the
+     * occupied slots of a level are never behind the current tick */
+    for (uint32_t level = 0; level < LEVELS; ++level) {
+        if (occupied[level] != 0) {
+            uint32_t slot = __builtin_ctz(occupied[level]);
+            uint64_t window = (1ull << (SLOT_BITS * (level + 1))) - 1;
+
+            index = (level * SLOTS) + slot;
+            tick = (current & ~window) | ((uint64_t) slot << (SLOT_BITS * level));
+
+            return true;
+        }
+    }
+
+    return false;
+};
+
+
+uint32_t TimerWheel::advance(uint64_t count) {
+    uint64_t target = count >> TICK_SHIFT;
+    uint32_t fired = 0;
+
+    while (true) {
+        uint32_t index;
+        uint64_t tick;
+
+        /* Jump over the empty ticks */
+        if (!nextSlot(index, tick) || tick > target) {
+            if (target <= current) {
+                return fired;
+            }
+
+            /* The wheel slots all belong to the current range: it is empty when
+             * time leaves it */
+            bool nextRange = ((target ^ current) >> WHEEL_RANGE_BITS) != 0;
+
+            current = target;
+
+            if (!nextRange || slots[OVERFLOW_LIST] == nullptr) {
+                return fired;
+            }
+
+            /* Move the timers of the new range to the wheel, the others go back
+             * to the overflow list */
+            struct wheelTimer_s* overflow = slots[OVERFLOW_LIST];
+
+            slots[OVERFLOW_LIST] = nullptr;
+
+            while (overflow != nullptr) {
+                struct wheelTimer_s* wheelTimer = overflow;
+
+                overflow = overflow->next;
+                insert(wheelTimer);
+            }
+
+            continue;
+        }
+
+        current = tick;
+
+        if (index >= SLOTS) {
+            /* Time reached a slot of an upper level: move its timers down */
+            while (slots[index] != nullptr) {
+                struct wheelTimer_s* wheelTimer = slots[index];
+
+                unlink(wheelTimer);
+                insert(wheelTimer);
+            }
+
+            continue;
+        }
+
+        /* Level 0 slot of the current tick. The callback can change the list,
+         * the scan restarts after each one. */
+        while (true) {
+            struct wheelTimer_s* wheelTimer = slots[index];
+
+            while (wheelTimer != nullptr && wheelTimer->expires > count) {
+                wheelTimer = wheelTimer->next;
+            }
+
+            if (wheelTimer == nullptr) {
+                break;
+            }
+
+            unlink(wheelTimer);
+
+            if (wheelTimer->period != 0) {
+                wheelTimer->expires += wheelTimer->period;
+
+                insert(wheelTimer);
+            }
+
+            wheelTimer->callback(wheelTimer);
+            ++fired;
+        }
+
+        /* The timers left are due later in this tick */
+        if (slots[index] != nullptr) {
+            return fired;
+        }
+    }
+};
+
+
+uint64_t TimerWheel::earliest() {
+    uint32_t index;
+    uint64_t tick;
+    uint64_t deadline = TIMER_MAX_TIME;
+
+    /* The first occupied slot holds the earliest deadlines, lists are short.
+     * The overflow list is only scanned when the wheel is empty. */
+    if (!nextSlot(index, tick)) {
+        index = OVERFLOW_LIST;
+    }
+
+    for (struct wheelTimer_s* node = slots[index]; node != nullptr; node = node->next) {
+        if (node->expires < deadline) {
+            deadline = node->expires;
+        }
+    }
+
+    return deadline;
+};
+
+
+void TimerWheel::arm() {
+    uint64_t deadline = earliest();
+
+    if (deadline == TIMER_MAX_TIME) {
+        timer.setThreshold(TIMER_MAX_TIME);
+
+        return;
+    }
+
+    uint64_t lead = ARM_LEAD;
+
+    while (true) {
+        uint64_t earliest = now() + lead;
+        uint64_t threshold = (deadline > earliest) ? deadline : earliest;
+
+        timer.setThreshold(threshold);
+
+        /* The count must still be behind the threshold, or the match already happened */
+        if (now() < threshold || timer.interruptConfiguration->interruptPending) {
+            return;
+        }
+
+        lead *= 2;
+    }
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef UART_BUFFER_CPP
+#define UART_BUFFER_CPP
+
+#include "../lib/driver/UARTBuffer.h"
+#include "../lib/platform.h"
+
+#include <inttypes.h>
+
+
+/****************************************************************/
+/*                         CONSTRUCTORS                         */
+/****************************************************************/
+
+UARTBuffer::UARTBuffer(UART& device) : uart(device) {
+    txHead = 0;
+    txTail = 0;
+
+    rxHead = 0;
+    rxTail = 0;
+
+    rxDropped = 0;
+
+    uart.setInterrupt(UART::DATA_RX);
+};
+
+
+/*****************************************************************/
+/*                         COMMUNICATION                         */
+/*****************************************************************/
+
+uint32_t UARTBuffer::write(const uint8_t* data, uint32_t size) {
+    uint32_t written = 0;
+
+    /* Nothing queued: skip the ring, the order is kept since the interrupt
+     * handler only sends bytes from the ring */
+    while (written < size && txHead == txTail && !uart.status->fullTX) {
+        *uart.bufferTX = data[written++];
+    }
+
+    while (written < size && (txHead - txTail) < TX_SIZE) {
+        txRing[txHead & (TX_SIZE - 1)] = data[written++];
+
+        ++txHead;
+    }
+
+    /* Refill the hardware buffer once it is empty */
+    if (txHead != txTail) {
+        uart.setInterrupt(UART::TX_EMPTY);
+    }
+
+    return written;
+};
+
+
+uint32_t UARTBuffer::read(uint8_t* data, uint32_t size) {
+    uint32_t count = 0;
+
+    while (count < size && rxTail != rxHead) {
+        data[count++] = rxRing[rxTail & (RX_SIZE - 1)];
+
+        ++rxTail;
+    }
+
+    return count;
+};
+
+
+uint32_t UARTBuffer::available() {
+    return rxHead - rxTail;
+};
+
+
+UARTBuffer& UARTBuffer::flush() {
+    /* The interrupt handler doesn't touch the TX ring anymore */
+    uart.disableInterrupt(UART::TX_EMPTY);
+
+    while (txTail != txHead) {
+        fillTX();
+    }
+
+    UART::waitSent(uart.status);
+
+    return *this;
+};
+
+
+uint32_t UARTBuffer::getDropped() {
+    return rxDropped;
+};
+
+
+/*****************************************************************/
+/*                           INTERRUPT                           */
+/*****************************************************************/
+
+uint32_t UARTBuffer::interruptHandler() {
+    uint32_t events = *uart.event;
+
+    /* Clear before servicing: an event raised from now on interrupts again */
+    *uart.event = 0;
+
+    /* Drain by status, not by event */
+    while (!uart.status->emptyRX) {
+        uint8_t data = *uart.bufferRX;
+
+        if ((rxHead - rxTail) < RX_SIZE) {
+            rxRing[rxHead & (RX_SIZE - 1)] = data;
+
+            ++rxHead;
+        } else {
+            ++rxDropped;
+        }
+    }
+
+    /* Disabled during flush() */
+    if (uart.status->interruptEnable & UART::TX_EMPTY) {
+        fillTX();
+    }
+
+    return events;
+};
+
+
+void UARTBuffer::fillTX() {
+    while (txTail != txHead && !uart.status->fullTX) {
+        *uart.bufferTX = txRing[txTail & (TX_SIZE - 1)];
+
+        ++txTail;
+    }
+
+    if (txTail == txHead) {
+        uart.disableInterrupt(UART::TX_EMPTY);
+    }
+};
+
+#endif
@@ -6,6 +6,7 @@ volatile uint32_t interruptCount[INTERRUPT_COUNT] = {0};
 volatile uint32_t interruptEvent[INTERRUPT_COUNT] = {0};
 volatile uint32_t interruptEntry[INTERRUPT_COUNT] = {0};
 volatile uint32_t unexpectedInterrupts = 0;
+void (*volatile interruptHook[INTERRUPT_COUNT])() = {nullptr};
 
 extern "C" uint32_t tohost;
 
@@ -35,6 +36,13 @@ extern "C" void interruptDispatch(uint32_t cause) {
         return;
     }
 
+    if (interruptHook[vector] != nullptr) {
+        interruptHook[vector]();
+        ++interruptCount[vector];
+
+        return;
+    }
+
     switch (vector) {
         case TRACE_INTERRUPT:
             interruptEvent[vector] = reg32(TRACE_UNIT_BASE);
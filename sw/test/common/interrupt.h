@@ -21,6 +21,9 @@ extern volatile uint32_t interruptEvent[INTERRUPT_COUNT];
 extern volatile uint32_t interruptEntry[INTERRUPT_COUNT];
 extern volatile uint32_t unexpectedInterrupts;
 
+/* Called instead of the default acknowledge of a vector when set (e.g. a driver handler) */
+extern void (*volatile interruptHook[INTERRUPT_COUNT])();
+
 extern "C" void interruptDispatch(uint32_t cause);
 extern "C" void interruptDispatchVectored(uint32_t cause, uint32_t entry);
 
@@ -0,0 +1,189 @@
+#include "interrupt.h"
+
+#include "driver/Ethernet.h"
+#include "driver/EthernetRX.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    const uint16_t TEST_ETHERTYPE = 0x88B5;
+
+    /* Frames sent back to back without receiving: two more than the pool */
+    const uint32_t BURST_FRAMES = EthernetRX::POOL_SIZE + 2;
+
+    const uint32_t WAIT_POLLS = 1'000'000;
+
+    /* Longer than a frame on the wire, to check that nothing else arrives */
+    const uint32_t QUIET_POLLS = 20'000;
+
+    Ethernet ethernet;
+    EthernetRX receiver(ethernet);
+
+    uint8_t frameData[Ethernet::MAX_PAYLOAD_LENGTH];
+
+
+    void ethernetHook() {
+        receiver.interruptHandler();
+    }
+
+
+    /* Lengths from the minimum payload up, not multiple of 4 */
+    uint32_t frameLength(uint32_t sequence) {
+        return Ethernet::MIN_PAYLOAD_LENGTH + (sequence * 97) % 700;
+    }
+
+
+    uint8_t pattern(uint32_t sequence, uint32_t offset) {
+        return (uint8_t) ((sequence * 31) + offset);
+    }
+
+
+    bool send(const struct Ethernet::macAddr_s& destination, uint32_t sequence) {
+        Ethernet::ethError_e error = Ethernet::NO_ERROR;
+        uint32_t length = frameLength(sequence);
+
+        for (uint32_t i = 0; i < length; ++i) {
+            frameData[i] = pattern(sequence, i);
+        }
+
+        ethernet.sendFrame(frameData, length, destination, TEST_ETHERTYPE, error);
+
+        return error == Ethernet::NO_ERROR;
+    }
+
+
+    bool check(const struct EthernetRX::rxFrame_s* frame, uint32_t sequence) {
+        uint32_t length = frameLength(sequence);
+
+        if (frame->error || frame->etherType != TEST_ETHERTYPE || frame->length != length) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < length; ++i) {
+            if (frame->payload[i] != pattern(sequence, i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    /* Wait for the receiver to account for a number of frames */
+    bool waitFrames(uint32_t frames, uint32_t limit = WAIT_POLLS) {
+        const struct EthernetRX::rxStats_s& stats = receiver.getStats();
+
+        for (uint32_t polls = 0; polls < limit; ++polls) {
+            if ((stats.received + stats.dropped) >= frames) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    const struct EthernetRX::rxStats_s& stats = receiver.getStats();
+    struct Ethernet::macAddr_s self;
+    bool passed = true;
+
+    for (int i = 0; i < 6; ++i) {
+        self.byte[i] = (ETH_MAC_ADDRESS >> (i * 8)) & 0xFF;
+    }
+
+    *ethernet.macInterrupt = 0;
+    ethernet.init(Ethernet::MBPS100, Ethernet::FULL_DUPLEX, false, Ethernet::ETHERNET_II);
+
+    interruptHook[ETHERNET_INTERRUPT] = ethernetHook;
+    receiver.enable(true);
+
+
+    /* One frame at a time: every frame is copied in the ring by the interrupt */
+    bool ordered = true;
+
+    for (uint32_t sequence = 0; sequence < EthernetRX::POOL_SIZE; ++sequence) {
+        ordered &= send(self, sequence) && waitFrames(sequence + 1);
+
+        struct EthernetRX::rxFrame_s* frame = receiver.receive();
+
+        ordered &= (frame != nullptr) && check(frame, sequence);
+
+        if (frame != nullptr) {
+            receiver.release(frame);
+        }
+    }
+
+    passed &= report("Frames received through the ring", ordered && (stats.received == EthernetRX::POOL_SIZE));
+
+
+    /* Back to back without receiving: the pool fills and the rest is dropped */
+    uint32_t base = stats.received + stats.dropped;
+    bool sent = true;
+
+    for (uint32_t i = 0; i < BURST_FRAMES; ++i) {
+        sent &= send(self, EthernetRX::POOL_SIZE + i);
+    }
+
+    sent &= waitFrames(base + BURST_FRAMES);
+
+    passed &= report("Burst queued while the application is busy", sent && (receiver.pending() == EthernetRX::POOL_SIZE));
+    passed &= report("Frames beyond the pool dropped", stats.dropped == (BURST_FRAMES - EthernetRX::POOL_SIZE));
+
+    bool burst = true;
+
+    for (uint32_t i = 0; i < EthernetRX::POOL_SIZE; ++i) {
+        struct EthernetRX::rxFrame_s* frame = receiver.receive();
+
+        burst &= (frame != nullptr) && check(frame, EthernetRX::POOL_SIZE + i);
+
+        if (frame != nullptr) {
+            receiver.release(frame);
+        }
+    }
+
+    passed &= report("Burst frames intact and in order", burst && (receiver.receive() == nullptr));
+
+
+    /* Not addressed to the SoC: filtered by the MAC */
+    struct Ethernet::macAddr_s other = {{ 0x01, 0x00, 0x00, 0x00, 0x00, 0x02 }};
+    base = stats.received + stats.dropped;
+
+    send(other, 0);
+    send(self, 1);
+
+    bool filtered = waitFrames(base + 1) && !waitFrames(base + 2, QUIET_POLLS);
+    struct EthernetRX::rxFrame_s* frame = receiver.receive();
+
+    filtered &= (frame != nullptr) && check(frame, 1);
+
+    if (frame != nullptr) {
+        receiver.release(frame);
+    }
+
+    passed &= report("Foreign destination filtered", filtered);
+
+    Serial_IO::printf("Received %u, dropped %u, errors %u, overflows %u\n", stats.received, stats.dropped, stats.errors, stats.overflows);
+
+    receiver.enable(false);
+    interruptHook[ETHERNET_INTERRUPT] = nullptr;
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+DRIVERS := UART Serial_IO Ethernet EthernetRX
+
+# Every TX frame comes back on RX through the PHY model
+SIM_ARGS := ETH_LOOPBACK=1
+
+TRACE ?= 0
+MAX_CYCLES ?= 10000000
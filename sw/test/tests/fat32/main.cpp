@@ -0,0 +1,203 @@
+#include "driver/SD.h"
+#include "BlockCache.h"
+#include "FAT32.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    /* Contents written by make_image.py */
+    const char HELLO[] = "Hello from the ZenithSoC FAT32 test\n";
+    const char NESTED[] = "nested file\n";
+
+    const char LONG_NAME[] = "Long File Name Data.bin";
+    const uint32_t LONG_SIZE = 5000;
+
+    const char DIRECTORY_NAME[] = "Sub Directory";
+
+    /* Not a multiple of the sector or of a word */
+    const uint32_t CHUNK = 333;
+
+    /* Last sector of the image, outside of the FAT32 volume data */
+    const uint32_t SCRATCH_BLOCK = 64 + 8192 - 1;
+
+    SD card;
+    bool highCapacity = false;
+
+    uint32_t buffer[(LONG_SIZE + 3) / 4];
+    uint32_t readBack[BlockCache::BLOCK_SIZE / 4];
+
+
+    uint8_t pattern(uint32_t offset) {
+        return (uint8_t) ((offset * 7) + (offset >> 8));
+    }
+
+
+    bool equal(const void* data, const char* text, uint32_t size) {
+        const uint8_t* bytes = (const uint8_t *) data;
+
+        for (uint32_t i = 0; i < size; ++i) {
+            if (bytes[i] != (uint8_t) text[i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    bool samePattern(const void* data, uint32_t offset, uint32_t size) {
+        const uint8_t* bytes = (const uint8_t *) data;
+
+        for (uint32_t i = 0; i < size; ++i) {
+            if (bytes[i] != pattern(offset + i)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    bool sameName(const char* name, const char* expected) {
+        while (*name != '\0' && *name == *expected) {
+            ++name;
+            ++expected;
+        }
+
+        return *name == *expected;
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    SD::errorType_e sdError = SD::NO_ERROR;
+    uint8_t cmd8[6] = {0};
+    bool passed = true;
+
+    card.init(SD::CLK_25MHZ, SD::BUS_WIDE, cmd8, highCapacity, sdError);
+
+    /* Addressing mode known after init, the objects stay out of the stack */
+    static BlockCache blockCache(card, highCapacity);
+    static FAT32 fat(blockCache);
+
+    FAT32::fatError_e error = FAT32::NO_ERROR;
+
+    fat.mount(error);
+
+    passed &= report("FAT32 partition mounted", (sdError == SD::NO_ERROR) && (error == FAT32::NO_ERROR) && (fat.getClusterSize() == 512));
+
+    if (!passed) {
+        Serial_IO::flush();
+
+        return 1;
+    }
+
+
+    /* 8.3 name in the first root cluster */
+    uint32_t size = fat.load("/HELLO.TXT", buffer, sizeof(buffer), error);
+
+    passed &= report("Short name file loaded", (error == FAT32::NO_ERROR) && (size == sizeof(HELLO) - 1) && equal(buffer, HELLO, size));
+
+
+    /* Long name after the first root cluster, fragmented chain read in
+     * unaligned chunks */
+    struct FAT32::fatFile_s file;
+
+    fat.open("/long file name data.bin", file, error);
+
+    bool chunks = (error == FAT32::NO_ERROR) && !file.directory && (file.size == LONG_SIZE);
+    uint32_t position = 0;
+
+    while (chunks && position < LONG_SIZE) {
+        uint32_t read = fat.read(file, buffer, CHUNK, error);
+        uint32_t expected = ((LONG_SIZE - position) < CHUNK) ? (LONG_SIZE - position) : CHUNK;
+
+        chunks = (error == FAT32::NO_ERROR) && (read == expected) && samePattern(buffer, position, read);
+        position += read;
+    }
+
+    chunks &= (fat.read(file, buffer, CHUNK, error) == 0);
+
+    passed &= report("Long name fragmented file read in chunks", chunks);
+
+
+    /* Whole file at once, not cached: the contiguous clusters merge in
+     * bursts that bypass the cache */
+    const struct BlockCache::cacheStats_s& stats = blockCache.getStats();
+
+    blockCache.invalidate();
+    size = fat.load("/Long File Name Data.bin", buffer, sizeof(buffer), error);
+
+    passed &= report("Fragmented file loaded", (error == FAT32::NO_ERROR) && (size == LONG_SIZE) && samePattern(buffer, 0, size) && (stats.bypassed != 0));
+
+
+    /* Back to a cluster before the current one */
+    fat.seek(file, 1500);
+    size = fat.read(file, buffer, 100, error);
+
+    passed &= report("Seek", (error == FAT32::NO_ERROR) && (size == 100) && samePattern(buffer, 1500, size));
+
+
+    /* Lower case 8.3 name in a sub directory */
+    size = fat.load("/Sub Directory/nested.txt", buffer, sizeof(buffer), error);
+
+    passed &= report("Sub directory file loaded", (error == FAT32::NO_ERROR) && (size == sizeof(NESTED) - 1) && equal(buffer, NESTED, size));
+
+
+    fat.open("/missing.txt", file, error);
+
+    passed &= report("Missing file not found", error == FAT32::NOT_FOUND);
+
+
+    /* Root listing across its clusters */
+    struct FAT32::fatEntry_s entry;
+    bool longFile = false, directory = false;
+    uint32_t entries = 0;
+
+    error = FAT32::NO_ERROR;
+    fat.open("/", file, error);
+
+    while (fat.nextEntry(file, entry, error)) {
+        longFile |= sameName(entry.name, LONG_NAME) && (entry.size == LONG_SIZE);
+        directory |= sameName(entry.name, DIRECTORY_NAME) && (entry.attributes & FAT32::ATTR_DIRECTORY);
+
+        ++entries;
+    }
+
+    passed &= report("Root directory listed", (error == FAT32::NO_ERROR) && longFile && directory && (entries > 16));
+
+
+    /* Cache write-back */
+    sdError = SD::NO_ERROR;
+
+    uint8_t* line = blockCache.modify(SCRATCH_BLOCK, true, sdError);
+
+    for (uint32_t i = 0; (line != nullptr) && (i < BlockCache::BLOCK_SIZE); ++i) {
+        line[i] = pattern(i + 1);
+    }
+
+    blockCache.flush(sdError);
+    card.readBlock(highCapacity ? SCRATCH_BLOCK : (SCRATCH_BLOCK * 512), readBack, nullptr, sdError);
+
+    passed &= report("Cache write-back", (line != nullptr) && (sdError == SD::NO_ERROR) && samePattern(readBack, 1, BlockCache::BLOCK_SIZE));
+
+    Serial_IO::printf("Cache hits %u, misses %u, read ahead %u, bypassed %u\n", stats.hits, stats.misses, stats.readAhead, stats.bypassed);
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""Generate the FAT32 card image of the fat32 test.
+
+MBR with one FAT32 (LBA) partition, one sector per cluster. The root
+directory spans several clusters, one file has a long name and a
+fragmented cluster chain, and a sub directory holds an 8.3 name stored
+in lower case. main.cpp checks the same contents.
+"""
+
+import struct
+import sys
+
+SECTOR = 512
+
+PARTITION_START = 64
+PARTITION_SECTORS = 8192
+RESERVED_SECTORS = 32
+FAT_NUMBER = 2
+FAT_SIZE = 64
+ROOT_CLUSTER = 2
+
+CLUSTER_END = 0x0FFFFFFF
+
+HELLO = b"Hello from the ZenithSoC FAT32 test\n"
+NESTED = b"nested file\n"
+
+LONG_NAME = "Long File Name Data.bin"
+LONG_SIZE = 5000
+
+DIRECTORY_NAME = "Sub Directory"
+
+# Short files placed before the long name, the root takes more than a cluster
+EMPTY_FILES = 20
+
+
+def pattern(size):
+    return bytes(((i * 7) + (i >> 8)) & 0xFF for i in range(size))
+
+
+class Volume:
+
+    def __init__(self):
+        self.data_start = RESERVED_SECTORS + FAT_NUMBER * FAT_SIZE
+        self.clusters = PARTITION_SECTORS - self.data_start
+        self.fat = [0] * (FAT_SIZE * SECTOR // 4)
+        self.fat[0] = 0x0FFFFFF8
+        self.fat[1] = CLUSTER_END
+        self.content = {}
+        self.next_free = ROOT_CLUSTER
+
+    def allocate(self):
+        cluster = self.next_free
+        self.next_free += 1
+        assert cluster < self.clusters + 2
+        return cluster
+
+    def chain(self, clusters, data):
+        assert len(data) <= len(clusters) * SECTOR
+        for index, cluster in enumerate(clusters):
+            last = index == len(clusters) - 1
+            self.fat[cluster] = CLUSTER_END if last else clusters[index + 1]
+            self.content[cluster] = data[index * SECTOR:(index + 1) * SECTOR]
+
+    def sector_offset(self, cluster):
+        return (PARTITION_START + self.data_start + cluster - 2) * SECTOR
+
+
+def short_entry(name, attributes, cluster, size, case_flags=0):
+    return struct.pack("<11sBBBHHHHHHHI", name, attributes, case_flags, 0,
+                       0, 0, 0, cluster >> 16, 0, 0, cluster & 0xFFFF, size)
+
+
+def short_checksum(name):
+    checksum = 0
+    for byte in name:
+        checksum = (((checksum & 1) << 7) + (checksum >> 1) + byte) & 0xFF
+    return checksum
+
+
+def long_entries(long_name, short_name):
+    characters = [ord(c) for c in long_name] + [0]
+    characters += [0xFFFF] * (-len(characters) % 13)
+    count = len(characters) // 13
+    checksum = short_checksum(short_name)
+    entries = []
+
+    for ordinal in range(count, 0, -1):
+        part = characters[(ordinal - 1) * 13:ordinal * 13]
+        sequence = ordinal | (0x40 if ordinal == count else 0)
+        entries.append(struct.pack("<B10sBBB12sH4s", sequence,
+                                   struct.pack("<5H", *part[0:5]), 0x0F, 0, checksum,
+                                   struct.pack("<6H", *part[5:11]), 0,
+                                   struct.pack("<2H", *part[11:13])))
+
+    return b"".join(entries)
+
+
+def clusters_for(size):
+    return max(1, (size + SECTOR - 1) // SECTOR)
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: make_image.py <card.img>")
+
+    volume = Volume()
+
+    # Label, HELLO.TXT, the empty files, two long names (two LFN entries each) and FILLER.BIN
+    root_entries = 2 + EMPTY_FILES + 3 + 3 + 1
+    root = [volume.allocate() for _ in range(clusters_for(root_entries * 32))]
+
+    hello = [volume.allocate()]
+    directory = [volume.allocate()]
+
+    # Runs of three clusters separated by a cluster of another file
+    long_data = pattern(LONG_SIZE)
+    long_clusters, filler = [], []
+    while len(long_clusters) < clusters_for(LONG_SIZE):
+        if len(long_clusters) % 3 == 0 and long_clusters:
+            filler.append(volume.allocate())
+        long_clusters.append(volume.allocate())
+
+    volume.chain(hello, HELLO)
+    volume.chain(long_clusters, long_data)
+    volume.chain(filler, bytes(len(filler) * SECTOR))
+
+    nested = [volume.allocate()]
+    volume.chain(nested, NESTED)
+
+    sub = short_entry(b".          ", 0x10, directory[0], 0)
+    sub += short_entry(b"..         ", 0x10, 0, 0)
+    sub += short_entry(b"NESTED  TXT", 0x20, nested[0], len(NESTED), 0x18)
+    volume.chain(directory, sub)
+
+    entries = short_entry(b"ZENITH     ", 0x08, 0, 0)
+    entries += short_entry(b"HELLO   TXT", 0x20, hello[0], len(HELLO))
+    for i in range(EMPTY_FILES):
+        entries += short_entry(b"EMPTY%02d TXT" % i, 0x20, 0, 0)
+    entries += long_entries(LONG_NAME, b"LONGFI~1BIN")
+    entries += short_entry(b"LONGFI~1BIN", 0x20, long_clusters[0], LONG_SIZE)
+    entries += long_entries(DIRECTORY_NAME, b"SUBDIR~1   ")
+    entries += short_entry(b"SUBDIR~1   ", 0x10, directory[0], 0)
+    entries += short_entry(b"FILLER  BIN", 0x20, filler[0], len(filler) * SECTOR)
+    volume.chain(root, entries)
+
+    image = bytearray((PARTITION_START + PARTITION_SECTORS) * SECTOR)
+
+    # MBR, partition 0: FAT32 LBA
+    struct.pack_into("<B3sB3sII", image, 446, 0x00, b"\x00\x02\x00", 0x0C,
+                     b"\xFE\xFF\xFF", PARTITION_START, PARTITION_SECTORS)
+    image[510:512] = b"\x55\xAA"
+
+    boot = PARTITION_START * SECTOR
+    struct.pack_into("<3s8sHBHBHHBHHHII", image, boot, b"\xEB\x58\x90", b"MSWIN4.1",
+                     SECTOR, 1, RESERVED_SECTORS, FAT_NUMBER, 0, 0, 0xF8, 0, 32, 64,
+                     PARTITION_START, PARTITION_SECTORS)
+    struct.pack_into("<IHHIHH12sBBBI11s8s", image, boot + 36, FAT_SIZE, 0, 0,
+                     ROOT_CLUSTER, 1, 6, bytes(12), 0x80, 0, 0x29, 0x5A454E54,
+                     b"ZENITH     ", b"FAT32   ")
+    image[boot + 510:boot + 512] = b"\x55\xAA"
+
+    fat = struct.pack("<%dI" % len(volume.fat), *volume.fat)
+    for copy in range(FAT_NUMBER):
+        offset = (PARTITION_START + RESERVED_SECTORS + copy * FAT_SIZE) * SECTOR
+        image[offset:offset + len(fat)] = fat
+
+    for cluster, data in volume.content.items():
+        offset = volume.sector_offset(cluster)
+        image[offset:offset + len(data)] = data
+
+    with open(sys.argv[1], "wb") as output:
+        output.write(image)
+
+
+if __name__ == "__main__":
+    main()
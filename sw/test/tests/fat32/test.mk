@@ -0,0 +1,13 @@
+DRIVERS := UART Serial_IO SD BlockCache FAT32
+
+# FAT32 card image generated for the run, loaded from block 0 of the card model
+CARD_IMAGE := $(abspath $(BUILD)/card.img)
+
+SIM_DEPS := $(CARD_IMAGE)
+SIM_ARGS := SD=$(CARD_IMAGE) SD_BLOCK=0
+
+$(CARD_IMAGE): $(TEST_DIR)/make_image.py | $(BUILD)
+	python3 $< $@
+
+TRACE ?= 0
+MAX_CYCLES ?= 20000000
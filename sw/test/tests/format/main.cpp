@@ -0,0 +1,269 @@
+#include "Format.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    struct integerCase_s {
+        uint64_t value;
+        const char* text;
+    };
+
+
+    struct floatCase_s {
+        float value;
+        uint32_t precision;
+        const char* text;
+    };
+
+
+    const integerCase_s integerCases[] = {
+        { 0, "0" },
+        { 9, "9" },
+        { 10, "10" },
+        { 99, "99" },
+        { 100, "100" },
+        { 12345, "12345" },
+        { 999999999, "999999999" },
+        { 1000000000, "1000000000" },
+        { 4294967295u, "4294967295" },
+        { 4294967296ull, "4294967296" },
+        { 1000000000000ull, "1000000000000" },
+        { 18446744073709551615ull, "18446744073709551615" }
+    };
+
+
+    /* Expected strings from printf("%.*f") */
+    const floatCase_s floatCases[] = {
+        { 0.0f, 3, "0.000" },
+        { 3.14159265f, 0, "3" },
+        { 3.14159265f, 6, "3.141593" },
+        { 3.14159265f, 9, "3.141592741" },
+        { -2.5f, 0, "-2" },
+        { 1234.5678f, 0, "1235" },
+        { 1234.5678f, 3, "1234.568" },
+        { 1e-5f, 6, "0.000010" },
+        { 0.125f, 2, "0.12" },
+        { 0.375f, 2, "0.38" },
+        { 16777216.0f, 1, "16777216.0" },
+        { 1e10f, 0, "10000000000" },
+        { -3.4e38f, 0, "-339999995214436424907732413799364296704" }
+    };
+
+
+    uint32_t readCycles() {
+        uint32_t cycles;
+
+        asm volatile ("csrr %0, mcycle" : "=r" (cycles));
+
+        return cycles;
+    }
+
+
+    bool equal(const char* buffer, uint32_t length, const char* text) {
+        for (uint32_t i = 0; i < length; ++i) {
+            if (text[i] != buffer[i]) {
+                return false;
+            }
+        }
+
+        return text[length] == '\0';
+    }
+
+
+    bool report(const char* text, const char* buffer, uint32_t length) {
+        bool passed = equal(buffer, length, text);
+
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(text);
+
+        if (!passed) {
+            Serial_IO::write(" got ");
+            Serial_IO::write(buffer, length);
+        }
+
+        Serial_IO::write('\n');
+
+        return passed;
+    }
+
+
+/****************************************************************/
+/*                     PREVIOUS ALGORITHMS                      */
+/****************************************************************/
+
+    /* Serial_IO::writeD before the format core: 64 bit % and / per digit */
+    uint32_t previousDecimal(char* buffer, uint64_t number) {
+        uint32_t size = 0;
+
+        do {
+            buffer[size++] = (char) ((number % 10) + '0');
+            number /= 10;
+        } while (number != 0);
+
+        for (uint32_t i = 0; i < size / 2; ++i) {
+            char swap = buffer[size - 1 - i];
+
+            buffer[size - 1 - i] = buffer[i];
+            buffer[i] = swap;
+        }
+
+        return size;
+    }
+
+
+    /* ee_printf number() before the format core: divider per digit */
+    uint32_t previousNumber(char* buffer, uint32_t number, volatile uint32_t base) {
+        char reversed[33];
+        uint32_t size = 0;
+
+        do {
+            reversed[size++] = "0123456789abcdef"[number % base];
+            number /= base;
+        } while (number != 0);
+
+        for (uint32_t i = 0; i < size; ++i) {
+            buffer[i] = reversed[size - 1 - i];
+        }
+
+        return size;
+    }
+
+
+    /* Serial_IO::write(float) before the format core: truncated, float arithmetic per digit */
+    uint32_t previousFloat(char* buffer, float number, uint32_t digits) {
+        uint32_t size = 0;
+
+        if (number < 0.0f) {
+            buffer[size++] = '-';
+            number = -number;
+        }
+
+        uint32_t integer = (uint32_t) number;
+        float fraction = number - (float) integer;
+
+        size += previousDecimal(buffer + size, integer);
+
+        if (digits != 0) {
+            buffer[size++] = '.';
+        }
+
+        for (uint32_t i = 0; i < digits; ++i) {
+            fraction *= 10.0f;
+
+            uint32_t digit = (uint32_t) fraction;
+
+            buffer[size++] = (char) ('0' + digit);
+            fraction -= (float) digit;
+        }
+
+        return size;
+    }
+
+
+/****************************************************************/
+/*                          BENCHMARK                           */
+/****************************************************************/
+
+    const uint32_t ROUNDS = 16;
+
+    /* Keeps the conversions from being optimized away */
+    volatile uint32_t sink;
+
+
+    void writeCycles(const char* name, uint32_t previous, uint32_t current, uint32_t calls) {
+        Serial_IO::write(name);
+        Serial_IO::write(": ");
+        Serial_IO::write(previous / calls, Serial_IO::DEC);
+        Serial_IO::write(" -> ");
+        Serial_IO::write(current / calls, Serial_IO::DEC);
+        Serial_IO::write(" cycles per call\n");
+    }
+
+
+    template<typename Function> uint32_t measure(Function convert) {
+        char buffer[FORMAT_FLOAT_SIZE];
+        uint32_t start = readCycles();
+
+        for (uint32_t round = 0; round < ROUNDS; ++round) {
+            sink = convert(buffer) + buffer[0];
+        }
+
+        return readCycles() - start;
+    }
+
+
+    void benchmark() {
+        const uint32_t values32[] = { 7, 1234, 65535, 3141592, 123456789, 4294967295u };
+        const uint64_t values64[] = { 5000000000ull, 1234567890123ull, 18446744073709551615ull };
+        const float floats[] = { 3.14159265f, -2.5f, 1234.5678f, 0.001f };
+
+        const uint32_t count32 = sizeof(values32) / sizeof(values32[0]);
+        const uint32_t count64 = sizeof(values64) / sizeof(values64[0]);
+        const uint32_t countFloat = sizeof(floats) / sizeof(floats[0]);
+
+        uint32_t previous = 0, current = 0;
+
+        /* Serial_IO::writeD, 32 bit types */
+        for (uint32_t i = 0; i < count32; ++i) {
+            previous += measure([&](char* buffer) { return previousDecimal(buffer, values32[i]); });
+            current += measure([&](char* buffer) { return formatUnsigned32(buffer, values32[i]); });
+        }
+
+        writeCycles("writeD 32 bit", previous, current, count32 * ROUNDS);
+
+        /* Serial_IO::writeD, 64 bit types */
+        previous = current = 0;
+
+        for (uint32_t i = 0; i < count64; ++i) {
+            previous += measure([&](char* buffer) { return previousDecimal(buffer, values64[i]); });
+            current += measure([&](char* buffer) { return formatUnsigned64(buffer, values64[i]); });
+        }
+
+        writeCycles("writeD 64 bit", previous, current, count64 * ROUNDS);
+
+        /* ee_printf %d / %u */
+        previous = current = 0;
+
+        for (uint32_t i = 0; i < count32; ++i) {
+            previous += measure([&](char* buffer) { return previousNumber(buffer, values32[i], 10); });
+            current += measure([&](char* buffer) { return formatUnsigned32(buffer, values32[i]); });
+        }
+
+        writeCycles("ee_printf %u", previous, current, count32 * ROUNDS);
+
+        /* Serial_IO::write(float, 6) */
+        previous = current = 0;
+
+        for (uint32_t i = 0; i < countFloat; ++i) {
+            previous += measure([&](char* buffer) { return previousFloat(buffer, floats[i], 6); });
+            current += measure([&](char* buffer) { return formatFloat(buffer, floats[i], 6); });
+        }
+
+        writeCycles("write(float, 6)", previous, current, countFloat * ROUNDS);
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    char buffer[FORMAT_FLOAT_SIZE];
+    bool passed = true;
+
+    for (const integerCase_s& test : integerCases) {
+        passed &= report(test.text, buffer, formatUnsigned64(buffer, test.value));
+    }
+
+    for (const floatCase_s& test : floatCases) {
+        passed &= report(test.text, buffer, formatFloat(buffer, test.value, test.precision));
+    }
+
+    benchmark();
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
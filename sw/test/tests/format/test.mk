@@ -0,0 +1,4 @@
+DRIVERS := UART Serial_IO
+
+TRACE ?= 0
+MAX_CYCLES ?= 20000000
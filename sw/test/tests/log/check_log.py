@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Check the UART output of the log test.
+
+The testbench decodes the LOG() records of the firmware with
+tools/log/log_decoder.h. main.cpp prints the same format with
+Serial_IO::printf on the next line, prefixed with "= ": both lines must be
+equal. The records queued while the ring was full must come back in order,
+numbered from 0.
+"""
+
+import re
+import sys
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: check_log.py <stdout.txt>")
+
+    with open(sys.argv[1], "rb") as capture:
+        # Serial_IO::printf ends with a NUL byte
+        text = capture.read().replace(b"\0", b"").decode("latin-1")
+
+    lines = text.splitlines()
+
+    try:
+        begin = lines.index("[LOG] round trip begin")
+    except ValueError:
+        sys.exit("FAIL: round trip not started")
+
+    end = None
+    for index in range(begin, len(lines)):
+        match = re.fullmatch(r"\[LOG\] round trip end, (\d+) checks", lines[index])
+        if match:
+            end, expected = index, int(match.group(1))
+            break
+
+    if end is None:
+        sys.exit("FAIL: round trip not finished")
+
+    errors, checks, queued = [], 0, 0
+    previous = ""
+
+    for line in lines[begin + 1:end]:
+        if line.startswith("= "):
+            checks += 1
+            if previous != line[2:]:
+                errors.append("decoded %r, printed %r" % (previous, line[2:]))
+        elif line.startswith("queued "):
+            if line != "queued %d" % queued:
+                errors.append("record %r out of order, expected 'queued %d'" % (line, queued))
+            queued += 1
+        previous = line
+
+    if checks != expected:
+        errors.append("%d checks found, %d printed" % (checks, expected))
+
+    if queued == 0:
+        errors.append("no queued record decoded")
+
+    for error in errors:
+        print("FAIL: " + error)
+
+    if errors:
+        sys.exit(1)
+
+    print("[PASS] %d LOG records decoded as printed, %d queued in order" % (checks, queued))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,81 @@
+#include "Log.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+/*
+ *  The testbench expands the LOG() records on the fly. Every record is
+ *  followed by the same format written with Serial_IO::printf on a line
+ *  starting with "= ": check_log.py compares each decoded line with the
+ *  printed one.
+ */
+#define ROUND_TRIP(format, ...) do { \
+    LOG(format, ##__VA_ARGS__); \
+    Log::flush(); \
+    Serial_IO::write("= "); \
+    Serial_IO::printf(format, ##__VA_ARGS__); \
+    Serial_IO::write("\n"); \
+    ++checks; \
+} while (0)
+
+
+namespace {
+
+    /* Records past a full ring (two words each) */
+    const uint32_t EXTRA_RECORDS = 5;
+
+    uint32_t checks = 0;
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    bool passed = true;
+
+    Serial_IO::write("[LOG] round trip begin\n");
+
+    /* Argument types and sizes, mixed with plain text */
+    ROUND_TRIP("no argument");
+    ROUND_TRIP("signed %d unsigned %u", -42, 3'000'000'000u);
+    ROUND_TRIP("64 bit %l", (int64_t) -5'000'000'000);
+    ROUND_TRIP("hex %x %xb %xh", 0xDEADBEEF, 0x5A, 0xBEEF);
+    ROUND_TRIP("hex 64 bit %xd", (uint64_t) 0x0123456789ABCDEF);
+    ROUND_TRIP("binary %bb %bh", 0xA5, 0x8001);
+    ROUND_TRIP("float %.2f %.3f", 12.75f, 0.125f);
+    ROUND_TRIP("%u arguments: %u %u %u %u %u %u %u", 7, 1, 2, 3, 4, 5, 6, 7);
+
+    passed &= report("Records queued and flushed", Log::pending() == 0);
+
+
+    /* Fill the ring without flushing: the last records are dropped */
+    const uint32_t records = (Log::RING_WORDS / 2) + EXTRA_RECORDS;
+
+    for (uint32_t i = 0; i < records; ++i) {
+        LOG("queued %u", i);
+    }
+
+    passed &= report("Ring full", Log::pending() == Log::RING_WORDS);
+
+    Log::flush();
+
+    Serial_IO::printf("= [LOG] %u records dropped\n", EXTRA_RECORDS);
+    ++checks;
+
+    passed &= report("Ring drained", Log::pending() == 0);
+
+    Serial_IO::printf("[LOG] round trip end, %u checks\n", checks);
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,7 @@
+DRIVERS := UART Serial_IO Log
+
+# The testbench decodes the records, check_log.py compares them with printf
+SIM_CHECK := python3 $(TEST_DIR)/check_log.py $(VERILATOR)/out/stdout.txt
+
+TRACE ?= 0
+MAX_CYCLES ?= 5000000
@@ -0,0 +1,169 @@
+#include "interrupt.h"
+
+#include "driver/Ethernet.h"
+#include "driver/EthernetRX.h"
+#include "driver/Timer.h"
+#include "Network.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    const uint32_t SELF_IP = Network::ipAddress(192, 168, 1, 10);
+    const uint32_t NETMASK = Network::ipAddress(255, 255, 255, 0);
+
+    /* Nobody answers for this address on the loopback link */
+    const uint32_t ABSENT_IP = Network::ipAddress(192, 168, 1, 99);
+
+    const uint16_t LOCAL_PORT = 7000;
+    const uint16_t REMOTE_PORT = 7001;
+
+    /* sendTo() calls of an application retrying in a loop */
+    const uint32_t RETRIES = 16;
+
+    const uint32_t WAIT_POLLS = 200'000;
+
+    Ethernet ethernet;
+    EthernetRX receiver(ethernet);
+
+    const uint8_t message[] = "zero copy UDP over the PHY loopback";
+
+    struct datagram_s {
+        volatile bool received;
+        uint32_t length;
+        uint32_t sourceIp;
+        uint16_t sourcePort;
+        bool matches;
+    };
+
+
+    void ethernetHook() {
+        receiver.interruptHandler();
+    }
+
+
+    void udpReceived(const uint8_t* payload, uint32_t length, uint32_t sourceIp, uint16_t sourcePort, void* context) {
+        struct datagram_s* datagram = (struct datagram_s*) context;
+
+        datagram->matches = (length == sizeof(message));
+
+        for (uint32_t i = 0; i < length && datagram->matches; ++i) {
+            datagram->matches = (payload[i] == message[i]);
+        }
+
+        datagram->length = length;
+        datagram->sourceIp = sourceIp;
+        datagram->sourcePort = sourcePort;
+        datagram->received = true;
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    Timer timer(0);
+    timer.init(TIMER_MAX_TIME, Timer::FREE_RUNNING)
+         .start();
+
+    *ethernet.macInterrupt = 0;
+    ethernet.init(Ethernet::MBPS100, Ethernet::FULL_DUPLEX, false, Ethernet::ETHERNET_II);
+
+    interruptHook[ETHERNET_INTERRUPT] = ethernetHook;
+    receiver.enable(true);
+
+    Network network(ethernet, receiver, timer, SELF_IP, NETMASK);
+    Network::netError_e error = Network::NO_ERROR;
+    const struct Network::netStats_s& stats = network.getStats();
+    struct datagram_s datagram = {};
+    bool passed = true;
+
+    network.bind(LOCAL_PORT, udpReceived, &datagram, error)
+           .setChecksumTX(true);
+
+
+    /* Unknown destination: one ARP request however often the send is retried */
+    uint32_t pendingCalls = 0;
+
+    for (uint32_t i = 0; i < RETRIES; ++i) {
+        error = Network::NO_ERROR;
+        network.sendTo(SELF_IP, LOCAL_PORT, REMOTE_PORT, message, sizeof(message), error);
+
+        pendingCalls += (error == Network::ARP_PENDING);
+    }
+
+    passed &= report("Retried sends wait for ARP", pendingCalls == RETRIES);
+    passed &= report("Single ARP request per retry interval", stats.arpRequests == 1);
+
+
+    /* The request loops back: the stack answers itself and learns its own MAC */
+    struct Ethernet::macAddr_s mac;
+    bool resolved = false;
+
+    for (uint32_t polls = 0; polls < WAIT_POLLS && !resolved; ++polls) {
+        network.poll();
+
+        resolved = (stats.arpReplies != 0) && network.resolve(SELF_IP, mac);
+    }
+
+    passed &= report("ARP request answered and cached", resolved);
+
+
+    /* UDP datagram with checksum, delivered to the bound port */
+    error = Network::NO_ERROR;
+    network.sendTo(SELF_IP, LOCAL_PORT, REMOTE_PORT, message, sizeof(message), error);
+
+    for (uint32_t polls = 0; polls < WAIT_POLLS && !datagram.received; ++polls) {
+        network.poll();
+    }
+
+    passed &= report("UDP datagram delivered", (error == Network::NO_ERROR) && datagram.received && datagram.matches &&
+                                              (datagram.sourceIp == SELF_IP) && (datagram.sourcePort == REMOTE_PORT));
+
+
+    /* Unanswered request: sent again only after ARP_RETRY counts */
+    uint32_t requests = stats.arpRequests;
+
+    network.resolve(ABSENT_IP, mac);
+    network.resolve(ABSENT_IP, mac);
+
+    bool paced = (stats.arpRequests == requests + 1);
+    uint64_t sent = timer.getTime();
+
+    /* Well inside the interval: no new request */
+    while ((timer.getTime() - sent) < (Network::ARP_RETRY / 2)) {
+        network.poll();
+        network.resolve(ABSENT_IP, mac);
+    }
+
+    paced &= (stats.arpRequests == requests + 1);
+
+    while ((timer.getTime() - sent) <= Network::ARP_RETRY) {
+        network.poll();
+    }
+
+    paced &= !network.resolve(ABSENT_IP, mac) && (stats.arpRequests == requests + 2);
+
+    passed &= report("Unanswered ARP request repeated after the retry time", paced);
+
+    Serial_IO::printf("ARP requests %u, replies %u, UDP sent %u, received %u, dropped %u\n",
+                      stats.arpRequests, stats.arpReplies, stats.udpSent, stats.udpReceived, stats.dropped);
+
+    receiver.enable(false);
+    interruptHook[ETHERNET_INTERRUPT] = nullptr;
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
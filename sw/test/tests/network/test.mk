@@ -0,0 +1,10 @@
+DRIVERS := UART Serial_IO Timer Ethernet EthernetRX Network
+
+# Every TX frame comes back on RX through the PHY model
+SIM_ARGS := ETH_LOOPBACK=1
+
+# Short ARP retry time (200 us) to check the pacing in simulation
+CASE_CPPFLAGS := -DNET_ARP_RETRY=20000
+
+TRACE ?= 0
+MAX_CYCLES ?= 10000000
@@ -0,0 +1,317 @@
+#include "interrupt.h"
+
+#include "driver/SD.h"
+#include "driver/SDQueue.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    const uint32_t BLOCK_WORDS = 128;
+
+    /* Blocks of each step, far below the default image block */
+    const uint32_t SINGLE_BLOCK = 0x200;
+    const uint32_t MERGE_BLOCK = 0x210;
+    const uint32_t LARGE_BLOCK = 0x240;
+
+    /* Larger than two commands: the last part takes one more block
+     * with merged bursts */
+    const uint32_t LARGE_COUNT = (2 * SDQueue::MAX_BURST) + 3;
+
+    /* Adjacent requests of the merge step */
+    const uint32_t MERGE_REQUESTS = 4;
+    const uint32_t MERGE_COUNT = 5;
+
+    const uint32_t BUFFER_BLOCKS = (LARGE_COUNT + 1 > MERGE_COUNT) ? (LARGE_COUNT + 1) : MERGE_COUNT;
+
+    const uint32_t WAIT_POLLS = 2'000'000;
+
+    /* Completions recorded by the callback */
+    const uint32_t MAX_COMPLETIONS = 8;
+
+    SD card;
+    bool highCapacity = false;
+    SDQueue* queue = nullptr;
+
+    uint32_t source[BUFFER_BLOCKS * BLOCK_WORDS];
+    uint32_t readBack[BUFFER_BLOCKS * BLOCK_WORDS];
+
+    struct SDQueue::sdRequest_s* completed[MAX_COMPLETIONS];
+    volatile uint32_t completions = 0;
+    volatile bool doneInCallback = true;
+
+
+    void sdHook() {
+        queue->interruptHandler();
+    }
+
+
+    void recordCompletion(struct SDQueue::sdRequest_s* request) {
+        doneInCallback &= request->done;
+
+        if (completions < MAX_COMPLETIONS) {
+            completed[completions] = request;
+        }
+
+        ++completions;
+    }
+
+
+    uint32_t pattern(uint32_t block, uint32_t word) {
+        return (block * 0x01010101) ^ (word * 0x9E3779B9);
+    }
+
+
+    void fill(uint32_t* buffer, uint32_t block, uint32_t count) {
+        for (uint32_t i = 0; i < count * BLOCK_WORDS; ++i) {
+            buffer[i] = pattern(block + (i / BLOCK_WORDS), i % BLOCK_WORDS);
+        }
+    }
+
+
+    bool same(const uint32_t* buffer, uint32_t block, uint32_t count) {
+        for (uint32_t i = 0; i < count * BLOCK_WORDS; ++i) {
+            if (buffer[i] != pattern(block + (i / BLOCK_WORDS), i % BLOCK_WORDS)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    void request(struct SDQueue::sdRequest_s& sdRequest, bool write, uint32_t block, uint32_t count, uint32_t* buffer) {
+        sdRequest.write = write;
+        sdRequest.block = block;
+        sdRequest.count = count;
+        sdRequest.buffer = buffer;
+        sdRequest.callback = recordCompletion;
+        sdRequest.context = nullptr;
+    }
+
+
+    bool waitIdle() {
+        for (uint32_t polls = 0; polls < WAIT_POLLS; ++polls) {
+            if (queue->isIdle()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    /* The queue doesn't wait for the card programming after a write */
+    bool waitTransferState() {
+        for (uint32_t polls = 0; polls < WAIT_POLLS; ++polls) {
+            SD::errorType_e error = SD::NO_ERROR;
+            SD::cardStatus_u status = card.getCardStatus(error);
+
+            if (error != SD::NO_ERROR) {
+                return false;
+            }
+
+            if (status.fields.currentState == SD::TRAN) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool succeeded(const struct SDQueue::sdRequest_s& sdRequest) {
+        return sdRequest.done && (sdRequest.error == SD::NO_ERROR);
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    SD::errorType_e error = SD::NO_ERROR;
+    uint8_t cmd8[6] = {0};
+    bool passed = true;
+
+    card.init(SD::CLK_25MHZ, SD::BUS_WIDE, cmd8, highCapacity, error);
+
+    passed &= report("Card initialized", error == SD::NO_ERROR);
+
+    if (!passed) {
+        Serial_IO::flush();
+
+        return 1;
+    }
+
+    SDQueue sdQueue(card, highCapacity);
+    const struct SDQueue::sdQueueStats_s& stats = sdQueue.getStats();
+
+    queue = &sdQueue;
+    interruptHook[SD_INTERRUPT] = sdHook;
+
+    struct SDQueue::sdRequest_s requests[MERGE_REQUESTS] = {};
+    uint32_t commands;
+
+
+    /* A request without a block would never complete */
+    request(requests[0], false, SINGLE_BLOCK, 0, readBack);
+
+    passed &= report("Empty request rejected", !sdQueue.submit(&requests[0]) && sdQueue.isIdle() && (stats.commands == 0));
+
+
+    /* Single block write then read, CMD24 / CMD17 */
+    fill(source, SINGLE_BLOCK, 1);
+    request(requests[0], true, SINGLE_BLOCK, 1, source);
+
+    bool single = sdQueue.submit(&requests[0]) && waitIdle() && succeeded(requests[0]) && waitTransferState();
+
+    request(requests[1], false, SINGLE_BLOCK, 1, readBack);
+
+    single &= sdQueue.submit(&requests[1]) && waitIdle() && succeeded(requests[1]) && same(readBack, SINGLE_BLOCK, 1);
+    single &= (stats.commands == 2) && (stats.merged == 0) && (completions == 2);
+
+    passed &= report("Single block write and read", single);
+
+
+    /* Adjacent writes queued while the first one runs: the next three join
+     * one CMD25, completed in submission order */
+    const uint32_t mergeCounts[MERGE_REQUESTS] = { 1, 1, 2, 1 };
+    uint32_t merged = stats.merged;
+    uint32_t offset = 0;
+
+    commands = stats.commands;
+    completions = 0;
+
+    fill(source, MERGE_BLOCK, MERGE_COUNT);
+
+    bool queued = true;
+
+    for (uint32_t i = 0; i < MERGE_REQUESTS; ++i) {
+        request(requests[i], true, MERGE_BLOCK + offset, mergeCounts[i], source + (offset * BLOCK_WORDS));
+        queued &= sdQueue.submit(&requests[i]);
+
+        offset += mergeCounts[i];
+    }
+
+    bool mergedWrites = queued && waitIdle() && waitTransferState() && (completions == MERGE_REQUESTS) && doneInCallback;
+
+    for (uint32_t i = 0; i < MERGE_REQUESTS; ++i) {
+        mergedWrites &= succeeded(requests[i]) && (completed[i] == &requests[i]);
+    }
+
+    /* With single block commands every block is a command */
+    if (SDQueue::MAX_BURST > 1) {
+        mergedWrites &= ((stats.commands - commands) == 2) && ((stats.merged - merged) == 2);
+    } else {
+        mergedWrites &= ((stats.commands - commands) == MERGE_COUNT) && (stats.merged == merged);
+    }
+
+    passed &= report("Adjacent writes merged", mergedWrites);
+
+
+    /* Non adjacent reads and a change of direction are not merged: a gap
+     * after the first block, then two adjacent reads and a write after them */
+    const uint32_t splitBlocks[MERGE_REQUESTS] = { 0, 2, 3, 4 };
+
+    merged = stats.merged;
+    commands = stats.commands;
+    completions = 0;
+
+    queued = true;
+
+    for (uint32_t i = 0; i < MERGE_REQUESTS; ++i) {
+        bool write = (i == MERGE_REQUESTS - 1);
+        uint32_t block = MERGE_BLOCK + splitBlocks[i];
+
+        /* The write stores the data already there */
+        request(requests[i], write, block, 1, write ? (source + (splitBlocks[i] * BLOCK_WORDS)) : (readBack + (i * BLOCK_WORDS)));
+        queued &= sdQueue.submit(&requests[i]);
+    }
+
+    bool splitRequests = queued && waitIdle() && waitTransferState() && (completions == MERGE_REQUESTS);
+
+    for (uint32_t i = 0; i < MERGE_REQUESTS; ++i) {
+        splitRequests &= succeeded(requests[i]) && (completed[i] == &requests[i]);
+
+        if (!requests[i].write) {
+            splitRequests &= same(readBack + (i * BLOCK_WORDS), MERGE_BLOCK + splitBlocks[i], 1);
+        }
+    }
+
+    if (SDQueue::MAX_BURST > 1) {
+        splitRequests &= ((stats.commands - commands) == 3) && ((stats.merged - merged) == 1);
+    } else {
+        splitRequests &= ((stats.commands - commands) == MERGE_REQUESTS) && (stats.merged == merged);
+    }
+
+    passed &= report("Non adjacent requests kept apart", splitRequests);
+
+
+    /* A request larger than a command is sent in MAX_BURST block parts and
+     * completes once. An adjacent request queued meanwhile joins the last part. */
+    uint32_t blocks = stats.blocks;
+    uint32_t completedRequests = stats.requests;
+
+    commands = stats.commands;
+    merged = stats.merged;
+    completions = 0;
+
+    fill(source, LARGE_BLOCK, LARGE_COUNT + 1);
+
+    request(requests[0], true, LARGE_BLOCK, LARGE_COUNT, source);
+    request(requests[1], true, LARGE_BLOCK + LARGE_COUNT, 1, source + (LARGE_COUNT * BLOCK_WORDS));
+
+    bool large = sdQueue.submit(&requests[0]) && sdQueue.submit(&requests[1]) && waitIdle() && waitTransferState();
+
+    large &= succeeded(requests[0]) && succeeded(requests[1]) && (completions == 2);
+    large &= (completed[0] == &requests[0]) && (completed[1] == &requests[1]);
+    large &= ((stats.requests - completedRequests) == 2) && ((stats.blocks - blocks) == LARGE_COUNT + 1);
+    large &= ((stats.commands - commands) == (LARGE_COUNT + SDQueue::MAX_BURST) / SDQueue::MAX_BURST);
+    large &= ((stats.merged - merged) == ((SDQueue::MAX_BURST > 1) ? 1 : 0));
+
+    passed &= report("Large write split in commands", large);
+
+
+    /* Same reads */
+    commands = stats.commands;
+    merged = stats.merged;
+    completions = 0;
+
+    for (uint32_t i = 0; i < (LARGE_COUNT + 1) * BLOCK_WORDS; ++i) {
+        readBack[i] = 0;
+    }
+
+    request(requests[0], false, LARGE_BLOCK, LARGE_COUNT, readBack);
+    request(requests[1], false, LARGE_BLOCK + LARGE_COUNT, 1, readBack + (LARGE_COUNT * BLOCK_WORDS));
+
+    bool largeRead = sdQueue.submit(&requests[0]) && sdQueue.submit(&requests[1]) && waitIdle();
+
+    largeRead &= succeeded(requests[0]) && succeeded(requests[1]) && (completions == 2) && (completed[0] == &requests[0]);
+    largeRead &= same(readBack, LARGE_BLOCK, LARGE_COUNT + 1);
+    largeRead &= ((stats.commands - commands) == (LARGE_COUNT + SDQueue::MAX_BURST) / SDQueue::MAX_BURST);
+    largeRead &= ((stats.merged - merged) == ((SDQueue::MAX_BURST > 1) ? 1 : 0));
+
+    passed &= report("Large read split in commands", largeRead);
+
+
+    passed &= report("No request error", stats.errors == 0);
+
+    Serial_IO::printf("%u requests, %u blocks, %u commands, %u merged\n", stats.requests, stats.blocks, stats.commands, stats.merged);
+
+    interruptHook[SD_INTERRUPT] = nullptr;
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
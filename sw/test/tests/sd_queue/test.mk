@@ -0,0 +1,18 @@
+DRIVERS := UART Serial_IO SD SDQueue
+
+# Merged bursts (default), and single block commands only
+CASES := default single
+
+CASE ?= default
+
+CASE_BURST_default :=
+CASE_BURST_single := -DSD_QUEUE_MAX_BURST=1
+
+ifeq ($(filter $(CASE),$(CASES)),)
+$(error Unknown CASE '$(CASE)')
+endif
+
+CASE_CPPFLAGS := $(CASE_BURST_$(CASE))
+
+TRACE ?= 0
+MAX_CYCLES ?= 30000000
@@ -0,0 +1,344 @@
+#include "driver/SD.h"
+#include "Serial_IO.h"
+
+#ifdef SD_TEST_RECORDER
+#include "driver/AudioCapture.h"
+#include "AudioRecorder.h"
+#endif
+
+#include <stdint.h>
+
+namespace {
+
+    const uint32_t BLOCK_WORDS = 128;
+
+    /* Blocks written by each step, far below the default image block */
+    const uint32_t SINGLE_BLOCK = 0x100;
+    const uint32_t ASYNC_BLOCK = 0x101;
+    const uint32_t BURST_BLOCK = 0x110;
+    const uint32_t STREAM_BLOCK = 0x120;
+
+    const uint32_t TRANSFER_BLOCKS = 4;
+
+    const uint32_t WAIT_POLLS = 1'000'000;
+
+    SD card;
+    bool highCapacity = false;
+
+    uint32_t blocks[TRANSFER_BLOCKS][BLOCK_WORDS];
+    uint32_t readBack[BLOCK_WORDS];
+
+
+    /* SDHC = block address, SDSC = byte address */
+    uint32_t cardAddress(uint32_t block) {
+        return highCapacity ? block : (block * 512);
+    }
+
+
+    void fill(uint32_t* buffer, uint32_t block) {
+        for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+            buffer[i] = (block * 0x01010101) ^ (i * 0x9E3779B9);
+        }
+    }
+
+
+    bool verify(uint32_t block) {
+        SD::errorType_e error = SD::NO_ERROR;
+
+        card.readBlock(cardAddress(block), readBack, nullptr, error);
+
+        if (error != SD::NO_ERROR) {
+            return false;
+        }
+
+        fill(blocks[0], block);
+
+        for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+            if (readBack[i] != blocks[0][i]) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+
+    /* The host doesn't wait for the card programming after a write */
+    bool waitTransferState() {
+        for (uint32_t polls = 0; polls < WAIT_POLLS; ++polls) {
+            SD::errorType_e error = SD::NO_ERROR;
+            SD::cardStatus_u status = card.getCardStatus(error);
+
+            if (error != SD::NO_ERROR) {
+                return false;
+            }
+
+            if (status.fields.currentState == SD::TRAN) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool waitWriteDone(SD::errorType_e& error) {
+        for (uint32_t polls = 0; polls < WAIT_POLLS; ++polls) {
+            if (card.isWriteDone(error)) {
+                return error == SD::NO_ERROR;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+
+#ifdef SD_TEST_RECORDER
+
+    /* Index blocks of the recordings, the data follows each one */
+    const uint32_t RECORDER_INDEX = 0x140;
+    const uint32_t RECOVERY_INDEX = 0x180;
+
+    const uint32_t BLOCK_SAMPLES = 256;
+
+    /* The testbench PDM input is constant, a high sample rate keeps the
+     * recording short: a block every ~1 ms */
+    const uint32_t PDM_FREQUENCY = 2'000'000;
+    const uint32_t SAMPLE_RATE = 250'000;
+
+    /* Blocks recorded before stop(): three segments, the last one partial */
+    const uint32_t RECORDED_BLOCKS = (2 * RECORDER_SEGMENT_BLOCKS) + 1;
+
+    const uint32_t RECORD_POLLS = 2'000'000;
+
+
+    bool recordBlocks(AudioRecorder& recorder, uint32_t count, AudioRecorder::recorderError_e& error) {
+        const struct AudioRecorder::recorderStats_s& stats = recorder.getStats();
+
+        for (uint32_t polls = 0; polls < RECORD_POLLS; ++polls) {
+            if (!recorder.poll(error)) {
+                return false;
+            }
+
+            if (stats.blocks >= count) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    /* Small RECORDER_SEGMENT_BLOCKS: the stream is closed and the index
+     * rewritten several times, then a recording is cut short like on a
+     * power loss and recovered from its index */
+    bool testRecorder() {
+        /* Built once the card addressing is known, the 32 KiB test stack holds its ring */
+        AudioCapture microphone;
+        AudioRecorder recorder(card, microphone, highCapacity);
+
+        AudioCapture::audioCaptError_e captureError = AudioCapture::NO_ERROR;
+        AudioRecorder::recorderError_e error = AudioRecorder::NO_ERROR;
+        const struct AudioRecorder::recorderStats_s& stats = recorder.getStats();
+        bool passed = true;
+
+        microphone.init(AudioCapture::LEFT, false, PDM_FREQUENCY, SAMPLE_RATE, captureError);
+
+        recorder.start(RECORDER_INDEX, SAMPLE_RATE, 1, error);
+
+        bool recorded = (captureError == AudioCapture::NO_ERROR) && (error == AudioRecorder::NO_ERROR) && recordBlocks(recorder, RECORDED_BLOCKS, error);
+
+        recorder.stop(error);
+
+        recorded &= (error == AudioRecorder::NO_ERROR) && waitTransferState();
+
+        /* A partial last block is padded and counted */
+        uint32_t samples = stats.samples;
+        uint32_t blocks = stats.blocks;
+
+        recorded &= (blocks == ((samples + BLOCK_SAMPLES - 1) / BLOCK_SAMPLES)) && (blocks >= RECORDED_BLOCKS);
+
+        passed &= report("Recorder segments", recorded);
+        Serial_IO::printf("%u samples in %u blocks, %u overruns, %u blocks pending at most\n", samples, blocks, stats.overruns, stats.maxPending);
+
+
+        /* Index closed: one rewrite per segment, a last empty segment when
+         * the stop came right after one */
+        struct AudioRecorder::recorderIndex_s index;
+        uint32_t segments = (blocks + RECORDER_SEGMENT_BLOCKS - 1) / RECORDER_SEGMENT_BLOCKS;
+
+        error = AudioRecorder::NO_ERROR;
+        recorder.readIndex(RECORDER_INDEX, index, error);
+
+        bool closed = (error == AudioRecorder::NO_ERROR) && (index.state == AudioRecorder::CLOSED) &&
+                      (index.sampleRate == SAMPLE_RATE) && (index.channels == 1) && (index.firstBlock == RECORDER_INDEX + 1) &&
+                      (index.blocks == blocks) && (index.samples == samples) &&
+                      (index.sequence >= segments + 1) && (index.sequence <= segments + 2);
+
+        /* Nothing but the index in the block */
+        SD::errorType_e cardError = SD::NO_ERROR;
+
+        card.readBlock(cardAddress(RECORDER_INDEX), readBack, nullptr, cardError);
+        closed &= (cardError == SD::NO_ERROR);
+
+        for (uint32_t i = sizeof(index) / 4; i < BLOCK_WORDS; ++i) {
+            closed &= (readBack[i] == 0);
+        }
+
+        passed &= report("Recorder index closed", closed);
+        Serial_IO::printf("Index sequence %u for %u segments\n", index.sequence, segments);
+
+
+        /* Samples are 16 bit, the ones past the last sample are zero (the card
+         * reads 0xFF where nothing was written). The PDM rate is fixed: the
+         * sample count, and so a partial last block, is the same every run. */
+        uint32_t lastSamples = samples % BLOCK_SAMPLES;
+
+        card.readBlock(cardAddress(RECORDER_INDEX + blocks), readBack, nullptr, cardError);
+
+        bool padded = (cardError == SD::NO_ERROR) && (lastSamples != 0);
+
+        for (uint32_t i = lastSamples; i < BLOCK_SAMPLES; ++i) {
+            padded &= ((readBack[i / 2] >> ((i & 1) * 16)) & 0xFFFF) == 0;
+        }
+
+        passed &= report("Recorder last block zero padded", padded);
+
+
+        /* Cut in the second segment: the stream is ended without the recorder,
+         * its index still counts the first segment only */
+        error = AudioRecorder::NO_ERROR;
+        recorder.start(RECOVERY_INDEX, SAMPLE_RATE, 1, error);
+
+        bool recovered = (error == AudioRecorder::NO_ERROR) && recordBlocks(recorder, RECORDER_SEGMENT_BLOCKS + 1, error);
+
+        microphone.stopRecording();
+
+        card.stopWriteStream(cardError);
+
+        recovered &= (cardError == SD::NO_ERROR) && waitTransferState();
+
+        recorder.readIndex(RECOVERY_INDEX, index, error);
+
+        recovered &= (error == AudioRecorder::NO_ERROR) && (index.state == AudioRecorder::RECORDING) &&
+                     (index.firstBlock == RECOVERY_INDEX + 1) && (index.blocks == RECORDER_SEGMENT_BLOCKS) &&
+                     (index.samples == 0) && (index.sequence == 2);
+
+        /* Not an index */
+        AudioRecorder::recorderError_e noIndex = AudioRecorder::NO_ERROR;
+
+        recorder.readIndex(RECOVERY_INDEX + 1, index, noIndex);
+
+        recovered &= (noIndex == AudioRecorder::NO_INDEX);
+
+        passed &= report("Recorder index recovered", recovered);
+
+        return passed;
+    }
+
+#endif
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    SD::errorType_e error = SD::NO_ERROR;
+    uint8_t cmd8[6] = {0};
+    bool passed = true;
+
+    card.init(SD_TEST_SPEED, SD::BUS_WIDE, cmd8, highCapacity, error);
+
+    /* The card model supports High-Speed, no fallback expected */
+    passed &= report("Card initialized at the requested speed", (error == SD::NO_ERROR) && (card.getClockSpeed() == SD_TEST_SPEED));
+
+    if (!passed) {
+        Serial_IO::flush();
+
+        return 1;
+    }
+
+
+    /* CMD24: the block is buffered before the command */
+    fill(blocks[0], SINGLE_BLOCK);
+    card.writeBlock(cardAddress(SINGLE_BLOCK), blocks[0], nullptr, error);
+
+    passed &= report("Single block write", (error == SD::NO_ERROR) && waitTransferState() && verify(SINGLE_BLOCK));
+
+
+    /* CMD24 without waiting, completion polled */
+    error = SD::NO_ERROR;
+    fill(blocks[0], ASYNC_BLOCK);
+    card.startWriteBlock(cardAddress(ASYNC_BLOCK), blocks[0], nullptr, error);
+
+    passed &= report("Single block write polled", (error == SD::NO_ERROR) && waitWriteDone(error) && waitTransferState() && verify(ASYNC_BLOCK));
+
+
+    /* CMD25: the next block is refilled while the previous one is sent */
+    error = SD::NO_ERROR;
+
+    for (uint32_t i = 0; i < TRANSFER_BLOCKS; ++i) {
+        fill(blocks[i], BURST_BLOCK + i);
+    }
+
+    card.writeBurst(cardAddress(BURST_BLOCK), TRANSFER_BLOCKS, blocks[0], nullptr, error);
+
+    bool burst = (error == SD::NO_ERROR) && waitTransferState();
+
+    for (uint32_t i = 0; i < TRANSFER_BLOCKS; ++i) {
+        burst &= verify(BURST_BLOCK + i);
+    }
+
+    passed &= report("Multiple block write", burst);
+
+
+    /* Open ended CMD25 with a producer slower than the bus: every block
+     * waits in WAIT_TX with an empty buffer before being queued */
+    error = SD::NO_ERROR;
+
+    for (uint32_t i = 0; i < TRANSFER_BLOCKS; ++i) {
+        fill(blocks[i], STREAM_BLOCK + i);
+    }
+
+    card.startWriteStream(cardAddress(STREAM_BLOCK), TRANSFER_BLOCKS, nullptr, error);
+
+    bool stream = error == SD::NO_ERROR;
+
+    for (uint32_t i = 0; stream && (i < TRANSFER_BLOCKS); ++i) {
+        stream &= waitWriteDone(error) && card.writeStreamBlock(blocks[i], error);
+    }
+
+    stream &= waitWriteDone(error);
+
+    card.stopWriteStream(error);
+
+    stream &= (error == SD::NO_ERROR) && waitTransferState();
+
+    for (uint32_t i = 0; i < TRANSFER_BLOCKS; ++i) {
+        stream &= verify(STREAM_BLOCK + i);
+    }
+
+    passed &= report("Write stream with a slow producer", stream);
+
+
+    /* The first block written must not have been touched by the others */
+    passed &= report("Blocks kept apart", verify(SINGLE_BLOCK));
+
+#ifdef SD_TEST_RECORDER
+    passed &= testRecorder();
+#endif
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
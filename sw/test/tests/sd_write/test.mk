@@ -0,0 +1,24 @@
+DRIVERS := UART Serial_IO SD AudioCapture AudioRecorder
+
+# One firmware per bus speed: the card keeps High-Speed mode until reset.
+# recorder adds the AudioRecorder steps with 2 block segments.
+CASES := clk25 clk50 recorder
+
+CASE ?= clk25
+
+CASE_SPEED_clk25 := SD::CLK_25MHZ
+CASE_SPEED_clk50 := SD::CLK_50MHZ
+CASE_SPEED_recorder := SD::CLK_25MHZ
+
+CASE_RECORDER_recorder := -DSD_TEST_RECORDER -DRECORDER_SEGMENT_BLOCKS=2
+
+CASE_SPEED := $(CASE_SPEED_$(CASE))
+
+ifeq ($(CASE_SPEED),)
+$(error Unknown CASE '$(CASE)')
+endif
+
+CASE_CPPFLAGS := -DSD_TEST_SPEED=$(CASE_SPEED) $(CASE_RECORDER_$(CASE))
+
+TRACE ?= 0
+MAX_CYCLES ?= 20000000
@@ -0,0 +1,142 @@
+#include "driver/SPI.h"
+#include "driver/SPIFlash.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    /* Unaligned and longer than the SPI buffers: partial first and last pages */
+    const uint32_t PROGRAM_ADDRESS = 0x0F0;
+    const uint32_t PROGRAM_SIZE = 1500;
+
+    uint8_t readBuffer[PROGRAM_SIZE];
+
+
+    uint32_t readCycles() {
+        uint32_t cycles;
+
+        asm volatile ("csrr %0, mcycle" : "=r" (cycles));
+
+        return cycles;
+    }
+
+
+    uint8_t pattern(uint32_t offset) {
+        return (uint8_t) ((offset * 7) + (offset >> 8) + 3);
+    }
+
+
+    void fillPattern(uint8_t* page, uint32_t offset, uint32_t size, void* context) {
+        (void) context;
+
+        for (uint32_t i = 0; i < size; ++i) {
+            page[i] = pattern(offset + i);
+        }
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    SPI spi(0); SPI::spiError_e spiError = SPI::NO_ERROR;
+
+    /* Fastest clock the testbench flash model samples correctly */
+    spi.init(12'500'000, SPI::MODE0, SPI::MSB_FIRST, &spiError);
+
+    SPIFlash flash(spi, 0); SPIFlash::flashError_e error;
+    bool passed = true;
+
+    flash.init(error);
+
+    struct SPIFlash::flashId_s id = flash.getId();
+
+    passed &= report("JEDEC ID", (error == SPIFlash::NO_ERROR) && (id.manufacturer == 0xEF) &&
+                                 (id.memoryType == 0x40) && (id.capacity == 0x18) && (flash.getSize() == (16u << 20)));
+
+    if (!passed) {
+        Serial_IO::flush();
+
+        return 1;
+    }
+
+
+    /* The erase runs in the background, the CPU is free until the next flash access */
+    uint32_t start = readCycles();
+    uint32_t polls = 0;
+
+    flash.eraseSector(PROGRAM_ADDRESS, error);
+
+    uint32_t issue = readCycles() - start;
+
+    while (flash.isBusy()) {
+        ++polls;
+    }
+
+    uint32_t erase = readCycles() - start;
+
+    passed &= report("Sector erase in background", (error == SPIFlash::NO_ERROR) && (polls != 0));
+    Serial_IO::printf("Erase issued in %u cycles, done after %u cycles and %u status polls\n", issue, erase, polls);
+
+
+    flash.read(PROGRAM_ADDRESS, readBuffer, PROGRAM_SIZE, error);
+
+    bool erased = (error == SPIFlash::NO_ERROR);
+
+    for (uint32_t i = 0; i < PROGRAM_SIZE; ++i) {
+        erased &= (readBuffer[i] == 0xFF);
+    }
+
+    passed &= report("Fast read of the erased sector", erased);
+
+
+    /* Pages are filled while the previous one is being programmed */
+    start = readCycles();
+
+    flash.program(PROGRAM_ADDRESS, PROGRAM_SIZE, fillPattern, nullptr, error);
+
+    uint32_t program = readCycles() - start;
+
+    flash.read(PROGRAM_ADDRESS, readBuffer, PROGRAM_SIZE, error);
+
+    uint32_t total = readCycles() - start;
+    bool programmed = (error == SPIFlash::NO_ERROR);
+
+    for (uint32_t i = 0; i < PROGRAM_SIZE; ++i) {
+        programmed &= (readBuffer[i] == pattern(i));
+    }
+
+    passed &= report("Page program and fast read back", programmed);
+    Serial_IO::printf("%u bytes programmed in %u cycles, read back after %u cycles\n", PROGRAM_SIZE, program, total);
+
+
+    /* Programming clears bits only, an address past the end is rejected */
+    const uint8_t zeros[2] = { 0x00, 0x00 };
+    uint8_t check[4];
+
+    flash.program(PROGRAM_ADDRESS + 1, zeros, sizeof(zeros), error)
+         .read(PROGRAM_ADDRESS, check, sizeof(check), error);
+
+    bool cleared = (error == SPIFlash::NO_ERROR) && (check[0] == pattern(0)) && (check[1] == 0) &&
+                   (check[2] == 0) && (check[3] == pattern(3));
+
+    flash.read(flash.getSize() - 1, check, 2, error);
+
+    passed &= report("Program from memory", cleared);
+    passed &= report("Out of range access", error == SPIFlash::OUT_OF_RANGE);
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
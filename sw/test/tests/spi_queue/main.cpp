@@ -0,0 +1,225 @@
+#include "interrupt.h"
+
+#include "driver/SPI.h"
+#include "driver/SPIFlash.h"
+#include "driver/SPIQueue.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    /* Flash commands sent through the queue */
+    const uint8_t JEDEC_ID = 0x9F;
+    const uint8_t READ_STATUS = 0x05;
+    const uint8_t WRITE_ENABLE = 0x06;
+    const uint8_t WRITE_DISABLE = 0x04;
+    const uint8_t READ = 0x03;
+
+    /* Status register 1 bits */
+    const uint8_t STATUS_BUSY = 1 << 0;
+    const uint8_t STATUS_WEL = 1 << 1;
+
+    /* Programmed before the queue takes the SPI, read back through it */
+    const uint32_t DATA_ADDRESS = 0x2000;
+    const uint32_t DATA_SIZE = 64;
+
+    /* Largest read of one transaction: the command and its address fill the rest */
+    const uint32_t READ_COMMAND_SIZE = 4;
+    const uint32_t LARGE_SIZE = SPI::BUFFER_SIZE - READ_COMMAND_SIZE;
+
+    const uint32_t WAIT_POLLS = 2'000'000;
+
+    /* JEDEC ID, status, WREN, status, WRDI, status, read, large read */
+    const uint32_t TRANSACTIONS = 8;
+
+    SPIQueue* queue = nullptr;
+
+    uint8_t dataBuffer[DATA_SIZE];
+    uint8_t largeBuffer[LARGE_SIZE];
+
+    struct SPIQueue::spiTransaction_s* completed[TRANSACTIONS];
+    volatile uint32_t completions = 0;
+    volatile bool doneInCallback = true;
+
+
+    void spiHook() {
+        queue->interruptHandler();
+    }
+
+
+    void recordCompletion(struct SPIQueue::spiTransaction_s* transaction) {
+        doneInCallback &= transaction->done;
+
+        if (completions < TRANSACTIONS) {
+            completed[completions] = transaction;
+        }
+
+        ++completions;
+    }
+
+
+    uint8_t pattern(uint32_t offset) {
+        return (uint8_t) ((offset * 13) + (offset >> 8) + 5);
+    }
+
+
+    void transaction(struct SPIQueue::spiTransaction_s& spiTransaction, const uint8_t* command, uint32_t commandSize, uint8_t* rxData, uint32_t size) {
+        spiTransaction.slave = 0;
+        spiTransaction.command = command;
+        spiTransaction.commandSize = commandSize;
+        spiTransaction.txData = nullptr;
+        spiTransaction.rxData = rxData;
+        spiTransaction.size = size;
+        spiTransaction.callback = recordCompletion;
+        spiTransaction.context = nullptr;
+    }
+
+
+    bool waitIdle() {
+        for (uint32_t polls = 0; polls < WAIT_POLLS; ++polls) {
+            if (queue->isIdle()) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+
+    bool succeeded(const struct SPIQueue::spiTransaction_s& spiTransaction) {
+        return spiTransaction.done && (spiTransaction.error == SPI::NO_ERROR);
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    SPI spi(0); SPI::spiError_e spiError = SPI::NO_ERROR;
+
+    /* Fastest clock the testbench flash model samples correctly */
+    spi.init(12'500'000, SPI::MODE0, SPI::MSB_FIRST, &spiError);
+
+    /* Known data for the reads, written with the blocking driver */
+    SPIFlash flash(spi, 0); SPIFlash::flashError_e error;
+    bool passed = true;
+
+    for (uint32_t i = 0; i < LARGE_SIZE; ++i) {
+        largeBuffer[i] = pattern(i);
+    }
+
+    flash.init(error)
+         .program(DATA_ADDRESS, largeBuffer, LARGE_SIZE, error)
+         .wait(error);
+
+    passed &= report("Flash programmed", error == SPIFlash::NO_ERROR);
+
+    if (!passed) {
+        Serial_IO::flush();
+
+        return 1;
+    }
+
+
+    /* The queue owns the SPI from now on */
+    SPIQueue spiQueue(spi);
+
+    queue = &spiQueue;
+    interruptHook[SPI_INTERRUPT] = spiHook;
+
+    struct SPIQueue::spiTransaction_s transactions[TRANSACTIONS] = {};
+
+
+    /* Rejected before reaching the bus */
+    const uint8_t readCommand[READ_COMMAND_SIZE] = { READ, (uint8_t) (DATA_ADDRESS >> 16), (uint8_t) (DATA_ADDRESS >> 8), (uint8_t) DATA_ADDRESS };
+
+    transaction(transactions[0], readCommand, 0, nullptr, 0);
+    bool rejected = !spiQueue.submit(&transactions[0]);
+
+    transaction(transactions[0], readCommand, READ_COMMAND_SIZE, largeBuffer, LARGE_SIZE + 1);
+    rejected &= !spiQueue.submit(&transactions[0]);
+
+    transaction(transactions[0], readCommand, 1, nullptr, 1);
+    transactions[0].slave = SPI_SLAVES;
+    rejected &= !spiQueue.submit(&transactions[0]);
+
+    passed &= report("Empty, oversized and bad slave transactions rejected", rejected && spiQueue.isIdle() && (completions == 0));
+
+
+    /* Everything queued at once, each transaction depends on the previous
+     * ones: the write enable latch follows WREN and WRDI */
+    const uint8_t jedecCommand = JEDEC_ID;
+    const uint8_t statusCommand = READ_STATUS;
+    const uint8_t enableCommand = WRITE_ENABLE;
+    const uint8_t disableCommand = WRITE_DISABLE;
+
+    uint8_t id[3] = {0};
+    uint8_t status[3] = { 0xFF, 0x00, 0xFF };
+
+    for (uint32_t i = 0; i < DATA_SIZE; ++i) {
+        dataBuffer[i] = 0;
+    }
+
+    for (uint32_t i = 0; i < LARGE_SIZE; ++i) {
+        largeBuffer[i] = 0;
+    }
+
+    transaction(transactions[0], &jedecCommand, 1, id, sizeof(id));
+    transaction(transactions[1], &statusCommand, 1, &status[0], 1);
+    transaction(transactions[2], &enableCommand, 1, nullptr, 0);
+    transaction(transactions[3], &statusCommand, 1, &status[1], 1);
+    transaction(transactions[4], &disableCommand, 1, nullptr, 0);
+    transaction(transactions[5], &statusCommand, 1, &status[2], 1);
+    transaction(transactions[6], readCommand, READ_COMMAND_SIZE, dataBuffer, DATA_SIZE);
+    transaction(transactions[7], readCommand, READ_COMMAND_SIZE, largeBuffer, LARGE_SIZE);
+
+    bool queued = true;
+
+    for (uint32_t i = 0; i < TRANSACTIONS; ++i) {
+        queued &= spiQueue.submit(&transactions[i]);
+    }
+
+    bool ordered = queued && waitIdle() && (completions == TRANSACTIONS) && doneInCallback;
+
+    for (uint32_t i = 0; i < TRANSACTIONS; ++i) {
+        ordered &= succeeded(transactions[i]) && (completed[i] == &transactions[i]);
+    }
+
+    passed &= report("Transactions completed in order", ordered);
+
+
+    passed &= report("JEDEC ID", (id[0] == 0xEF) && (id[1] == 0x40) && (id[2] == 0x18));
+
+    passed &= report("Write enable latch", ((status[0] & (STATUS_BUSY | STATUS_WEL)) == 0) &&
+                                           ((status[1] & (STATUS_BUSY | STATUS_WEL)) == STATUS_WEL) &&
+                                           ((status[2] & (STATUS_BUSY | STATUS_WEL)) == 0));
+
+    bool data = true;
+
+    for (uint32_t i = 0; i < DATA_SIZE; ++i) {
+        data &= (dataBuffer[i] == pattern(i));
+    }
+
+    for (uint32_t i = 0; i < LARGE_SIZE; ++i) {
+        data &= (largeBuffer[i] == pattern(i));
+    }
+
+    passed &= report("Read data", data);
+
+    interruptHook[SPI_INTERRUPT] = nullptr;
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
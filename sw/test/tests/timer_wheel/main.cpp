@@ -0,0 +1,238 @@
+#include "interrupt.h"
+
+#include "driver/Timer.h"
+#include "TimerWheel.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    const uint32_t ONE_SHOTS = 4;
+    const uint32_t PERIODIC_RUNS = 5;
+
+    /* Counts covered by the wheel, later deadlines wait in its overflow list */
+    const uint64_t WHEEL_RANGE = 1ull << ((TimerWheel::LEVELS * TimerWheel::SLOT_BITS) + TimerWheel::TICK_SHIFT);
+
+    /* Distance of the far timer in wheel ranges, and the short timers run meanwhile */
+    const uint64_t FAR_RANGES = 6;
+    const uint32_t SHORT_TIMERS = 16;
+
+    TimerWheel* wheel = nullptr;
+
+    /* Expiration record of the one shot timers */
+    struct expiration_s {
+        uint64_t deadline;
+        uint64_t fired;
+        uint32_t order;
+    };
+
+    struct expiration_s expirations[ONE_SHOTS];
+    volatile uint32_t expired = 0;
+
+    /* Deadlines of the periodic timer, late by at most one interrupt each */
+    uint64_t periodicDeadline[PERIODIC_RUNS];
+    uint64_t periodicFired[PERIODIC_RUNS];
+    volatile uint32_t periodicRuns = 0;
+
+    volatile uint32_t cancelledRuns = 0;
+
+    /* Short timers restarted from their callbacks until stopShort is set */
+    volatile uint32_t shortRuns = 0;
+    volatile bool shortEarly = false;
+    volatile bool stopShort = false;
+
+
+    void timerHook() {
+        wheel->interruptHandler();
+    }
+
+
+    void oneShot(struct TimerWheel::wheelTimer_s* timer) {
+        struct expiration_s* expiration = (struct expiration_s*) timer->context;
+
+        expiration->fired = wheel->now();
+        expiration->order = expired++;
+    }
+
+
+    void periodic(struct TimerWheel::wheelTimer_s* timer) {
+        uint32_t run = periodicRuns;
+
+        /* Already rescheduled: the previous deadline is one period back */
+        periodicDeadline[run] = timer->expires - timer->period;
+        periodicFired[run] = wheel->now();
+
+        if (++periodicRuns == PERIODIC_RUNS) {
+            wheel->cancel(timer);
+        }
+    }
+
+
+    void cancelled(struct TimerWheel::wheelTimer_s* timer) {
+        (void) timer;
+
+        ++cancelledRuns;
+    }
+
+
+    void restarted(struct TimerWheel::wheelTimer_s* timer) {
+        shortEarly |= wheel->now() < timer->expires;
+
+        uint32_t runs = ++shortRuns;
+
+        if (!stopShort) {
+            wheel->start(timer, TimerWheel::micros(2) + ((runs % 16) * 100));
+        }
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    Timer timer(0);
+    TimerWheel timerWheel(timer);
+    bool passed = true;
+
+    wheel = &timerWheel;
+    interruptHook[TIMER_INTERRUPT] = timerHook;
+
+    /* Started out of order, same tick for the first two */
+    const uint64_t delays[ONE_SHOTS] = {
+        TimerWheel::micros(30), TimerWheel::micros(30) + 200, TimerWheel::micros(12), TimerWheel::micros(90)
+    };
+    const uint32_t expectedOrder[ONE_SHOTS] = { 1, 2, 0, 3 };
+
+    struct TimerWheel::wheelTimer_s oneShots[ONE_SHOTS] = {};
+    struct TimerWheel::wheelTimer_s periodicTimer = {};
+    struct TimerWheel::wheelTimer_s cancelledTimer = {};
+
+    for (uint32_t i = 0; i < ONE_SHOTS; ++i) {
+        oneShots[i].callback = oneShot;
+        oneShots[i].context = &expirations[i];
+
+        timerWheel.start(&oneShots[i], delays[i]);
+        expirations[i].deadline = oneShots[i].expires;
+    }
+
+    periodicTimer.callback = periodic;
+    timerWheel.start(&periodicTimer, TimerWheel::micros(5), TimerWheel::micros(10));
+
+    cancelledTimer.callback = cancelled;
+    timerWheel.start(&cancelledTimer, TimerWheel::micros(20));
+
+    passed &= report("Earliest deadline programmed", timerWheel.nextDeadline() == periodicTimer.expires);
+
+    bool wasActive = timerWheel.cancel(&cancelledTimer);
+
+    passed &= report("Cancel before the deadline", wasActive && !timerWheel.isActive(&cancelledTimer));
+
+
+    /* Everything expires during the sleep, the CPU waits in wfi */
+    uint64_t start = timerWheel.now();
+
+    timerWheel.sleep(TimerWheel::micros(120));
+
+    uint64_t slept = timerWheel.now() - start;
+
+    passed &= report("Sleep duration", slept >= TimerWheel::micros(120));
+    Serial_IO::printf("Slept %u counts, %u timer interrupts\n", (uint32_t) slept, interruptCount[TIMER_INTERRUPT]);
+
+
+    bool ordered = (expired == ONE_SHOTS);
+    uint64_t worst = 0;
+
+    for (uint32_t i = 0; i < ONE_SHOTS; ++i) {
+        ordered &= (expirations[i].order == expectedOrder[i]) && (expirations[i].fired >= expirations[i].deadline);
+
+        if (expirations[i].fired - expirations[i].deadline > worst) {
+            worst = expirations[i].fired - expirations[i].deadline;
+        }
+    }
+
+    passed &= report("One shot timers in deadline order", ordered);
+
+
+    bool regular = (periodicRuns == PERIODIC_RUNS) && !timerWheel.isActive(&periodicTimer);
+
+    for (uint32_t i = 0; i < PERIODIC_RUNS && i < periodicRuns; ++i) {
+        /* No drift: every deadline is a whole number of periods from the first */
+        regular &= (periodicDeadline[i] == periodicDeadline[0] + (i * TimerWheel::micros(10))) &&
+                   (periodicFired[i] >= periodicDeadline[i]);
+
+        if (periodicFired[i] - periodicDeadline[i] > worst) {
+            worst = periodicFired[i] - periodicDeadline[i];
+        }
+    }
+
+    passed &= report("Periodic timer cancelled from its callback", regular);
+    passed &= report("Cancelled timer never runs", cancelledRuns == 0);
+    passed &= report("Wheel empty", timerWheel.nextDeadline() == TIMER_MAX_TIME);
+
+    Serial_IO::printf("Worst expiration latency %u counts\n", (uint32_t) worst);
+
+
+    /* Only a small wheel (case "small") wraps within a simulation: a deadline
+     * several ranges away, short timers crossing the range boundaries */
+    if (WHEEL_RANGE <= TimerWheel::millis(1)) {
+        struct expiration_s farExpiration = {};
+        struct TimerWheel::wheelTimer_s farTimer = {};
+        struct TimerWheel::wheelTimer_s shortTimers[SHORT_TIMERS] = {};
+
+        farTimer.callback = oneShot;
+        farTimer.context = &farExpiration;
+
+        timerWheel.start(&farTimer, FAR_RANGES * WHEEL_RANGE);
+        farExpiration.deadline = farTimer.expires;
+
+        for (uint32_t i = 0; i < SHORT_TIMERS; ++i) {
+            shortTimers[i].callback = restarted;
+
+            timerWheel.start(&shortTimers[i], TimerWheel::micros(1) + (i * 50));
+        }
+
+        /* Halfway the far timer still waits out of the wheel, the short ones
+         * are spread on their own slots */
+        timerWheel.sleep((FAR_RANGES / 2) * WHEEL_RANGE);
+
+        bool apart = timerWheel.isActive(&farTimer);
+
+        for (uint32_t i = 0; i < SHORT_TIMERS; ++i) {
+            apart &= timerWheel.isActive(&shortTimers[i]) && (shortTimers[i].index != farTimer.index);
+        }
+
+        passed &= report("Short timers apart from a far deadline", apart);
+
+        while (timerWheel.isActive(&farTimer)) {
+            timerWheel.idle();
+        }
+
+        stopShort = true;
+
+        for (uint32_t i = 0; i < SHORT_TIMERS; ++i) {
+            timerWheel.cancel(&shortTimers[i]);
+        }
+
+        passed &= report("Far deadline reached across the wheel ranges", (farExpiration.fired >= farExpiration.deadline) && !shortEarly);
+        passed &= report("Wheel empty after the far timer", timerWheel.nextDeadline() == TIMER_MAX_TIME);
+
+        Serial_IO::printf("Far timer late by %u counts, %u short timer runs\n", (uint32_t) (farExpiration.fired - farExpiration.deadline), shortRuns);
+    }
+
+    interruptHook[TIMER_INTERRUPT] = nullptr;
+
+    Serial_IO::flush();
+
+    return passed ? 0 : 1;
+}
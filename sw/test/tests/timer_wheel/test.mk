@@ -0,0 +1,19 @@
+DRIVERS := UART Serial_IO Timer TimerWheel
+
+# The default wheel, and a small one (2 levels, 16 count ticks: 164 us range)
+# whose overflow list is used within the simulation
+CASES := default small
+
+CASE ?= default
+
+CASE_WHEEL_default :=
+CASE_WHEEL_small := -DTIMER_WHEEL_LEVELS=2 -DTIMER_WHEEL_TICK_SHIFT=4
+
+ifeq ($(filter $(CASE),$(CASES)),)
+$(error Unknown CASE '$(CASE)')
+endif
+
+CASE_CPPFLAGS := $(CASE_WHEEL_$(CASE))
+
+TRACE ?= 0
+MAX_CYCLES ?= 5000000
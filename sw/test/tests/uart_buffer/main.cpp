@@ -0,0 +1,171 @@
+#include "interrupt.h"
+
+#include "driver/UART.h"
+#include "driver/UARTBuffer.h"
+#include "Serial_IO.h"
+
+#include <stdint.h>
+
+namespace {
+
+    /* More than the TX ring and the hardware buffer together */
+    const uint32_t STREAM_BYTES = 2000;
+
+    /* Bytes sent without reading beyond the RX ring */
+    const uint32_t OVERFLOW_BYTES = 40;
+
+    const uint32_t WAIT_POLLS = 1'000'000;
+
+    /* A few frames at 6.25 Mbaud, to check that nothing else arrives */
+    const uint32_t QUIET_POLLS = 5'000;
+
+    /* The testbench routes TX back to RX */
+    UART uart(DEBUG_UART);
+    UARTBuffer rings(uart);
+
+    uint8_t stream[STREAM_BYTES];
+
+
+    void uartHook() {
+        rings.interruptHandler();
+    }
+
+
+    /* Printable, the testbench prints every byte sent */
+    uint8_t pattern(uint32_t offset) {
+        return ((offset % 64) == 63) ? '\n' : ('a' + (offset % 26));
+    }
+
+
+    /* Wait for the line to be idle and drop what came back */
+    void drain() {
+        uint8_t data;
+
+        rings.flush();
+
+        for (uint32_t polls = 0; polls < QUIET_POLLS; ++polls) {
+            if (rings.read(&data, 1) != 0) {
+                polls = 0;
+            }
+        }
+    }
+
+
+    /* Receive and check bytes from an offset of the pattern */
+    bool receive(uint32_t offset, uint32_t size) {
+        uint32_t polls = 0;
+
+        while (size != 0 && polls < WAIT_POLLS) {
+            uint8_t data;
+
+            if (rings.read(&data, 1) == 0) {
+                ++polls;
+                continue;
+            }
+
+            if (data != pattern(offset++)) {
+                return false;
+            }
+
+            --size;
+            polls = 0;
+        }
+
+        return size == 0;
+    }
+
+
+    bool report(const char* name, bool passed) {
+        Serial_IO::write(passed ? "[PASS] " : "[FAIL] ");
+        Serial_IO::write(name);
+        Serial_IO::write("\n");
+
+        return passed;
+    }
+
+}
+
+
+extern "C" int main() {
+    Serial_IO::init(6'250'000, false, UART::EVEN, UART::STOP1, UART::BIT8);
+
+    bool passed = true;
+
+    for (uint32_t i = 0; i < STREAM_BYTES; ++i) {
+        stream[i] = pattern(i);
+    }
+
+    interruptHook[UART_INTERRUPT] = uartHook;
+    drain();
+
+
+    /* The first call fills the hardware buffer and the TX ring and returns
+     * without waiting for the line, the rest is written while receiving */
+    uint32_t accepted = rings.write(stream, STREAM_BYTES);
+
+    bool queued = (accepted >= UARTBuffer::TX_SIZE) && (accepted < STREAM_BYTES) && !uart.status->emptyTX;
+
+    uint32_t sent = accepted, received = 0;
+    bool ordered = true;
+
+    while (ordered && received < STREAM_BYTES) {
+        if (sent < STREAM_BYTES) {
+            sent += rings.write(stream + sent, STREAM_BYTES - sent);
+        }
+
+        /* Fewer bytes than the RX ring at a time: nothing is dropped */
+        uint32_t chunk = ((STREAM_BYTES - received) < 32) ? (STREAM_BYTES - received) : 32;
+
+        ordered = receive(received, chunk);
+        received += chunk;
+    }
+
+    passed &= report("TX ring queues without waiting", queued);
+    passed &= report("Stream through both rings in order", ordered && (rings.getDropped() == 0));
+
+
+    /* Nobody reads: the interrupt fills the RX ring and drops the rest */
+    drain();
+
+    uint32_t dropped = rings.getDropped();
+    uint32_t size = UARTBuffer::RX_SIZE + OVERFLOW_BYTES;
+
+    for (uint32_t written = 0; written < size; ) {
+        written += rings.write(stream + written, size - written);
+    }
+
+    rings.flush();
+
+    for (uint32_t polls = 0; polls < QUIET_POLLS && (rings.getDropped() - dropped) < OVERFLOW_BYTES; ++polls) {  }
+
+    bool overflow = (rings.available() == UARTBuffer::RX_SIZE) && ((rings.getDropped() - dropped) == OVERFLOW_BYTES);
+
+    /* The oldest bytes are kept */
+    overflow &= receive(0, UARTBuffer::RX_SIZE) && (rings.available() == 0);
+
+    passed &= report("RX ring overflow counted", overflow);
+
+
+    /* Serial_IO output and input through the rings */
+    drain();
+    Serial_IO::setBuffer(&rings);
+
+    const char echo[] = "ring echo\n";
+    bool looped = true;
+
+    Serial_IO::write(echo);
+
+    for (uint32_t i = 0; echo[i] != '\0'; ++i) {
+        looped &= Serial_IO::readChar() == echo[i];
+    }
+
+    passed &= report("Serial_IO through the rings", looped);
+
+    Serial_IO::flush();
+    Serial_IO::setBuffer(nullptr);
+
+    uart.disableInterrupt(UART::DATA_RX);
+    interruptHook[UART_INTERRUPT] = nullptr;
+
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,385 @@
+// ============================================================================
+// capture_main.cpp - audio capture pipeline vs. bit-exact reference model
+//
+//   1. The registers are computed as AudioCapture::init / setGain would
+//      (+frequency, +sample_rate, +gain), or forced (+normalizer).
+//   2. A sigma-delta modulated tone (or random bits, +random) is driven on the
+//      microphone data pin, one bit per half PDM clock period; the bench holds
+//      each bit stable around the edge that samples it.
+//   3. Every bit the microphone presents on a sampling edge also goes to the
+//      reference model. The RTL reports each bit that reaches the filter and
+//      each PCM sample through DPI, and both streams are compared in order.
+//   4. At the end the packed bit stream is replayed through the model alone
+//      to report its throughput against the RTL.
+//
+// Exit code: 0 = every sample matched, 1 = mismatch, 2 = bad configuration.
+// ============================================================================
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Vcapture_tb_top.h"
+#include "Vcapture_tb_top__Dpi.h"
+#include "verilated.h"
+#include "verilated_fst_c.h"
+
+#include "capture_model.h"
+
+// Must match the -G overrides of capture_tb_top (Makefile ORDER / COMB_DELAY)
+#ifndef CIC_ORDER
+#define CIC_ORDER 5
+#endif
+
+#ifndef CIC_COMB_DELAY
+#define CIC_COMB_DELAY 1
+#endif
+
+using Model = CaptureModel<CIC_ORDER, CIC_COMB_DELAY>;
+
+static constexpr uint32_t SYSTEM_FREQUENCY = 100'000'000;   // sw/lib/platform.h
+static constexpr uint64_t HALF_PERIOD_PS   = 5000;
+static constexpr int      LEFT = 0, RIGHT = 1;               // apu_pkg
+static constexpr uint64_t REPORT_LIMIT     = 10;
+
+
+// ============================================================================
+//      STIMULUS
+// ============================================================================
+
+// Second-order sigma-delta modulator, the usual MEMS microphone output.
+class PdmSource {
+public:
+    PdmSource(double tone_hz, double pdm_hz, double amplitude, bool random, uint64_t seed)
+        : step_(2.0 * M_PI * tone_hz / pdm_hz), amplitude_(amplitude),
+          random_(random), state_(seed | 1) {}
+
+    bool next() {
+        if (random_) {
+            state_ ^= state_ << 13;
+            state_ ^= state_ >> 7;
+            state_ ^= state_ << 17;
+            return state_ & 1;
+        }
+
+        const double x = amplitude_ * std::sin(phase_);
+        phase_ += step_;
+
+        i1_ += x - y_;
+        i2_ += i1_ - y_;
+
+        const bool bit = i2_ >= 0.0;
+        y_ = bit ? 1.0 : -1.0;
+
+        return bit;
+    }
+
+private:
+    double   step_, amplitude_;
+    double   phase_ = 0.0, i1_ = 0.0, i2_ = 0.0, y_ = 0.0;
+    bool     random_;
+    uint64_t state_;
+};
+
+
+// ============================================================================
+//      CHECKER (fed by the DPI taps)
+// ============================================================================
+
+struct Checker {
+    std::deque<uint8_t>       bits;       // presented on a sampling edge, not yet seen by the RTL
+    std::deque<Model::Sample> expected;   // produced by the model, not yet seen from the RTL
+
+    uint64_t bits_checked   = 0;
+    uint64_t bit_errors     = 0;
+    uint64_t samples        = 0;
+    uint64_t mismatches     = 0;
+    uint64_t saturated      = 0;
+    uint64_t invalid        = 0;
+    uint64_t cycle          = 0;
+
+    FILE* pcm_out = nullptr;
+};
+
+static Checker g_check;
+
+extern "C" void capture_pdm_bit(uint32_t bit_value) {
+    Checker& c = g_check;
+
+    if (c.bits.empty()) {
+        if (c.bit_errors++ < REPORT_LIMIT)
+            std::cout << "[APU] cycle " << c.cycle << ": filter input without a sampled PDM bit\n";
+        return;
+    }
+
+    if (c.bits.front() != (bit_value & 1) && c.bit_errors++ < REPORT_LIMIT)
+        std::cout << "[APU] cycle " << c.cycle << ": PDM bit #" << c.bits_checked
+                  << " entered the filter as " << (bit_value & 1) << ", driven "
+                  << int(c.bits.front()) << "\n";
+
+    c.bits.pop_front();
+    c.bits_checked++;
+}
+
+extern "C" void capture_sample(uint32_t pcm, uint32_t channel, uint32_t invalid) {
+    Checker& c = g_check;
+    (void)channel;
+
+    if (invalid)
+        c.invalid++;
+
+    if (c.pcm_out) {
+        const uint8_t le[2] = { uint8_t(pcm), uint8_t(pcm >> 8) };
+        std::fwrite(le, 1, 2, c.pcm_out);
+    }
+
+    if (c.expected.empty()) {
+        if (c.mismatches++ < REPORT_LIMIT)
+            std::cout << "[APU] cycle " << c.cycle << ": RTL sample #" << c.samples
+                      << " = 0x" << std::hex << pcm << std::dec
+                      << " but the model has not produced it\n";
+        c.samples++;
+        return;
+    }
+
+    const Model::Sample m = c.expected.front();
+    c.expected.pop_front();
+
+    if (m.saturated)
+        c.saturated++;
+
+    if (m.pcm != (pcm & 0xFFFF) && c.mismatches++ < REPORT_LIMIT)
+        std::cout << "[APU] cycle " << c.cycle << ": sample #" << c.samples
+                  << " RTL 0x" << std::hex << std::setw(4) << std::setfill('0') << pcm
+                  << " | MODEL 0x" << std::setw(4) << m.pcm
+                  << std::dec << std::setfill(' ') << (m.saturated ? " (saturated)" : "") << "\n";
+
+    c.samples++;
+}
+
+
+// ============================================================================
+//      MAIN
+// ============================================================================
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    uint64_t bits       = 1'000'000;
+    uint32_t frequency  = 2'048'000;
+    uint32_t sample_rate = 16'000;
+    uint32_t gain       = 0x7FFF;
+    uint32_t normalizer = 0;
+    double   tone       = 1000.0;
+    double   amplitude  = 0.5;
+    bool     random     = false;
+    bool     dual       = false;
+    int      channel    = LEFT;
+    uint64_t seed       = 1;
+    bool     wave       = false;
+    std::string pcm_path;
+
+    for (int i = 1; i < argc; i++) {
+        std::string a(argv[i]);
+
+        if      (a.rfind("+bits=", 0) == 0)         bits = std::stoull(a.substr(6));
+        else if (a.rfind("+frequency=", 0) == 0)    frequency = std::stoul(a.substr(11));
+        else if (a.rfind("+sample_rate=", 0) == 0)  sample_rate = std::stoul(a.substr(13));
+        else if (a.rfind("+gain=", 0) == 0)         gain = std::stoul(a.substr(6), nullptr, 0);
+        else if (a.rfind("+normalizer=", 0) == 0)   normalizer = std::stoul(a.substr(12), nullptr, 0);
+        else if (a.rfind("+tone=", 0) == 0)         tone = std::stod(a.substr(6));
+        else if (a.rfind("+amplitude=", 0) == 0)    amplitude = std::stod(a.substr(11));
+        else if (a == "+random")                    random = true;
+        else if (a == "+dual")                      dual = true;
+        else if (a == "+right")                     channel = RIGHT;
+        else if (a.rfind("+seed=", 0) == 0)         seed = std::stoull(a.substr(6));
+        else if (a == "+wave")                      wave = true;
+        else if (a.rfind("+pcm_out=", 0) == 0)      pcm_path = a.substr(9);
+    }
+
+    CaptureConfig cfg;
+
+    if (!CaptureConfig::from_init(SYSTEM_FREQUENCY, frequency, sample_rate, gain, cfg)) {
+        std::cerr << "[APU] illegal configuration (frequency " << frequency
+                  << ", sample rate " << sample_rate << ", gain 0x" << std::hex << gain
+                  << std::dec << ")\n";
+        return 2;
+    }
+
+    if (normalizer)
+        cfg.normalizer = normalizer;
+
+    // Each bit is moved half a PDM half-period away from the edge that samples
+    // it; below this the synchronizer latency would make the edge ambiguous.
+    if (cfg.clock_divisor < 2) {
+        std::cerr << "[APU] clock divisor " << cfg.clock_divisor << " too small for the bench\n";
+        return 2;
+    }
+
+    std::cout << "[APU] CIC order " << CIC_ORDER << ", comb delay " << CIC_COMB_DELAY
+              << ", PDM clock " << SYSTEM_FREQUENCY / (2 * cfg.clock_divisor + 2) << " Hz"
+              << " (divisor " << cfg.clock_divisor << "), decimation " << cfg.decimation
+              << ", normalizer " << cfg.normalizer << ", gain 0x" << std::hex << cfg.gain
+              << std::dec << (dual ? ", dual channel" : channel == LEFT ? ", left" : ", right")
+              << "\n[APU] stimulus: " << bits << " bits of ";
+
+    if (random)
+        std::cout << "random data\n";
+    else
+        std::cout << tone << " Hz tone, amplitude " << amplitude << "\n";
+
+    if (!pcm_path.empty())
+        g_check.pcm_out = std::fopen(pcm_path.c_str(), "wb");
+
+    Vcapture_tb_top* dut = new Vcapture_tb_top;
+    VerilatedFstC* tfp = nullptr;
+
+    if (wave) {
+        Verilated::traceEverOn(true);
+        tfp = new VerilatedFstC;
+        dut->trace(tfp, 99);
+        tfp->open("out/capture.fst");
+    }
+
+    uint64_t time_ps = 0;
+
+    auto tick = [&]() {
+        dut->clk = 1;
+        dut->eval();
+        if (tfp) tfp->dump(time_ps);
+        time_ps += HALF_PERIOD_PS;
+
+        dut->clk = 0;
+        dut->eval();
+        if (tfp) tfp->dump(time_ps);
+        time_ps += HALF_PERIOD_PS;
+
+        g_check.cycle++;
+    };
+
+    dut->enable_i        = 0;
+    dut->clock_divisor_i = cfg.clock_divisor;
+    dut->dual_channel_i  = dual;
+    dut->channel_i       = channel;
+    dut->decimation_i    = cfg.decimation;
+    dut->normalizer_i    = cfg.normalizer;
+    dut->gain_i          = cfg.gain;
+    dut->pdm_data_i      = 0;
+
+    dut->rst_n = 0;
+    for (int i = 0; i < 8; i++) tick();
+    dut->rst_n = 1;
+    tick();
+
+    dut->enable_i = 1;
+
+    Model model(cfg);
+    PdmSource source(tone, double(frequency), amplitude, random, seed);
+
+    std::vector<uint64_t> packed;
+    packed.reserve(bits / 64 + 64);
+    uint64_t sent = 0;
+
+    const uint32_t half_period = cfg.clock_divisor + 1;
+    uint32_t since_edge = 0;
+    uint8_t  last_clk   = dut->pdm_clk_o;
+    bool     pending    = false;    // the pin holds a bit for the next edge
+
+    const auto rtl_start = std::chrono::steady_clock::now();
+
+    // Run until every bit went through and the pipeline has drained. While
+    // draining the pin is held and the bits sampled from it still go to the
+    // model, so both sides keep seeing the same stream.
+    uint64_t drain = 0;
+    const uint64_t drain_cycles = uint64_t(half_period) * 2 * cfg.decimation * (CIC_ORDER + 2) + 256;
+
+    // Generous bound in case the PDM clock never toggles
+    const uint64_t max_cycles = (bits + 1) * half_period * (dual ? 1 : 2) * 2 + drain_cycles;
+
+    while (drain < drain_cycles && g_check.cycle < max_cycles) {
+        tick();
+
+        if (sent >= bits)
+            drain++;
+
+        const uint8_t clk = dut->pdm_clk_o;
+
+        if (clk != last_clk) {
+            // The edge just seen sampled the pin
+            if (pending) {
+                const uint8_t bit = dut->pdm_data_i;
+
+                g_check.bits.push_back(bit);
+                if (sent % 64 == 0)
+                    packed.push_back(0);
+                packed.back() |= uint64_t(bit) << (sent % 64);
+                sent++;
+
+                Model::Sample s;
+                if (model.push(bit, s))
+                    g_check.expected.push_back(s);
+
+                pending = false;
+            }
+
+            last_clk = clk;
+            since_edge = 0;
+        } else if (++since_edge == half_period / 2) {
+            // Next edge is a rising one while the clock is low
+            const bool rising = !clk;
+            const bool sampled = dual || (channel == LEFT ? rising : !rising);
+
+            if (sampled) {
+                if (sent < bits)
+                    dut->pdm_data_i = source.next();
+                pending = true;
+            }
+        }
+    }
+
+    const double rtl_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - rtl_start).count();
+
+    // Model alone on the packed stream: throughput and self-consistency
+    Model replay(cfg);
+    std::vector<Model::Sample> replayed;
+    replayed.reserve(sent / cfg.decimation + 1);
+
+    const auto model_start = std::chrono::steady_clock::now();
+    replay.process(packed.data(), sent, replayed);
+    const double model_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - model_start).count();
+
+    const uint64_t model_samples = g_check.samples + g_check.expected.size();
+    const bool consistent = replayed.size() == model_samples;
+
+    if (tfp) { tfp->close(); delete tfp; }
+    dut->final();
+    delete dut;
+
+    if (g_check.pcm_out)
+        std::fclose(g_check.pcm_out);
+
+    std::cout << std::fixed << std::setprecision(2)
+              << "[APU] " << sent << " PDM bits, " << g_check.bits_checked << " reached the filter, "
+              << g_check.bit_errors << " bit errors\n"
+              << "[APU] " << g_check.samples << " PCM samples compared, " << g_check.mismatches
+              << " mismatches, " << g_check.saturated << " saturated, " << g_check.invalid
+              << " invalid, " << g_check.expected.size() << " still in the RTL pipeline\n"
+              << "[APU] RTL   " << g_check.cycle << " cycles in " << rtl_s << " s ("
+              << (rtl_s > 0 ? sent / rtl_s / 1e6 : 0.0) << " Mbit/s)\n"
+              << "[APU] model " << replayed.size() << " samples in " << model_s * 1e3 << " ms ("
+              << (model_s > 0 ? sent / model_s / 1e6 : 0.0) << " Mbit/s)"
+              << (consistent ? "" : ", DIFFERENT sample count from the incremental model") << "\n";
+
+    const bool pass = g_check.mismatches == 0 && g_check.bit_errors == 0 &&
+                      g_check.samples > 0 && consistent && g_check.bits.empty();
+
+    std::cout << (pass ? "[APU] PASS\n" : "[APU] FAIL\n");
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,188 @@
+// ============================================================================
+// Bit-exact reference model of the audio capture pipeline
+// (hw/apu/capture_unit: cic_filter -> normalizer -> PCM conversion -> gain).
+//
+// The model consumes the PDM bits in the order pdm2pcm_converter hands them
+// to recorder_audio_pipeline (one bit per valid_i) and produces the same
+// 16-bit samples as pcm_o, in the same order:
+//
+//   - CIC: ORDER integrators at the input rate, ORDER combs at the decimated
+//     rate, 32-bit wrap-around arithmetic. The RTL registers every stage, so
+//     a sample leaves the filter one decimation period after it is computed
+//     and the first ORDER decimation periods produce nothing.
+//   - Normalizer: ({cic, 32'b0} / normalizer) keeping quotient[32:0].
+//   - PCM: quotient[32] saturates to 0xFFFF, otherwise quotient[31:16].
+//   - Gain: (gain * pcm)[30:15], gain in Q1.15.
+//
+// Cycle-level assumption: the comb update (decimator == factor) happens in a
+// cycle without a new PDM bit. pdm2pcm_converter guarantees it whenever the
+// clock divisor is at least 1, which AudioCapture::setFrequency always
+// produces.
+//
+// The integrator and comb chains are fixed-size arrays updated from their old
+// values, so the per-bit update has no loop-carried dependency across stages
+// and the compiler unrolls and vectorizes it. Bits are consumed 64 at a time
+// from packed words by process().
+// ============================================================================
+
+#ifndef ZENITH_CAPTURE_MODEL_H
+#define ZENITH_CAPTURE_MODEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Register values programmed by AudioCapture::init / setGain.
+struct CaptureConfig {
+    uint32_t clock_divisor = 0;     // SYSTEM_FREQUENCY / (frequency * 2)
+    uint32_t decimation    = 0;     // frequency / sampleRate, 8-bit
+    uint32_t normalizer    = 0;     // decimation ^ 4
+    uint32_t gain          = 0x7FFF;
+
+    // Mirrors the driver, including its error checks. Returns false on an
+    // illegal clock or decimation rate.
+    static bool from_init(uint32_t system_hz, uint32_t frequency, uint32_t sample_rate,
+                          uint32_t gain, CaptureConfig& out) {
+        if (frequency > 3'000'000 || frequency < 1'000'000 || sample_rate == 0 || gain >= 0x8000)
+            return false;
+
+        out.clock_divisor = system_hz / (frequency * 2);
+        out.decimation    = frequency / sample_rate;
+
+        if (out.decimation > 0xFF || out.decimation == 0 || out.clock_divisor > 0x7F)
+            return false;
+
+        out.normalizer = 1;
+        for (int i = 0; i < 4; ++i)
+            out.normalizer *= out.decimation;
+
+        out.gain = gain;
+        return true;
+    }
+};
+
+template <int ORDER = 5, int DELAY = 1>
+class CaptureModel {
+    static_assert(ORDER >= 2, "cic_filter needs at least two stages");
+    static_assert(DELAY >= 1, "comb delay must be at least one sample");
+
+public:
+    struct Sample {
+        uint16_t pcm;
+        bool     saturated;
+    };
+
+    explicit CaptureModel(const CaptureConfig& cfg) : cfg_(cfg) { reset(); }
+
+    // reset_filter_i (interface disabled).
+    void reset() {
+        integ_.fill(0);
+        integ_delay_.fill(0);
+        comb_.fill(0);
+        for (auto& d : comb_delay_) d.fill(0);
+
+        decimator_ = 0;
+        valid_out_ = 0;
+    }
+
+    // One PDM bit. Returns true and fills s when the pipeline emits a sample.
+    bool push(bool bit, Sample& s) {
+        integrate(bit ? 1u : 0u);
+
+        if (++decimator_ != (cfg_.decimation & 0xFF))
+            return false;
+
+        uint32_t cic = 0;
+        if (!decimate(cic))
+            return false;
+
+        s = convert(cic);
+        return true;
+    }
+
+    // nbits bits packed LSB first into words. Samples are appended to out.
+    void process(const uint64_t* words, size_t nbits, std::vector<Sample>& out) {
+        Sample s;
+
+        for (size_t w = 0; w < nbits / 64; ++w) {
+            uint64_t bits = words[w];
+
+            for (int b = 0; b < 64; ++b, bits >>= 1) {
+                if (push(bits & 1, s))
+                    out.push_back(s);
+            }
+        }
+
+        for (size_t b = nbits & ~size_t(63); b < nbits; ++b) {
+            if (push((words[b / 64] >> (b % 64)) & 1, s))
+                out.push_back(s);
+        }
+    }
+
+    // Normalizer, PCM conversion and gain applied to one CIC output.
+    Sample convert(uint32_t cic) const {
+        const uint64_t quotient = (uint64_t(cic) << 32) / cfg_.normalizer;
+
+        Sample s;
+        s.saturated = (quotient >> 32) & 1;
+
+        const uint32_t pcm = s.saturated ? 0xFFFFu : uint32_t(quotient >> 16) & 0xFFFFu;
+        const uint32_t product = (cfg_.gain & 0xFFFFu) * pcm;
+
+        s.pcm = uint16_t(product >> 15);
+        return s;
+    }
+
+private:
+    using Stages = std::array<uint32_t, ORDER>;
+
+    void integrate(uint32_t bit) {
+        const Stages old = integ_;
+
+        // integrator_delay shifts on every valid_i, like the integrators
+        for (int d = DELAY - 1; d > 0; --d)
+            integ_delay_[d] = integ_delay_[d - 1];
+        integ_delay_[0] = old[ORDER - 1];
+
+        integ_[0] = old[0] + bit;
+        for (int i = 1; i < ORDER; ++i)
+            integ_[i] = old[i - 1] + old[i];
+    }
+
+    // The valid_sample cycle. The filter output is comb_ff[ORDER - 1] before
+    // the update, valid once the pipeline is full.
+    bool decimate(uint32_t& cic) {
+        const Stages old = comb_;
+        const bool full = (valid_out_ >> (ORDER - 1)) & 1;
+
+        cic = old[ORDER - 1];
+
+        comb_[0] = integ_[ORDER - 1] - integ_delay_[DELAY - 1];
+        for (int i = 1; i < ORDER; ++i)
+            comb_[i] = old[i - 1] - comb_delay_[i - 1][DELAY - 1];
+
+        for (int i = 0; i < ORDER - 1; ++i) {
+            for (int d = DELAY - 1; d > 0; --d)
+                comb_delay_[i][d] = comb_delay_[i][d - 1];
+            comb_delay_[i][0] = old[i];
+        }
+
+        valid_out_ = ((valid_out_ << 1) | 1) & ((1u << ORDER) - 1);
+        decimator_ = 0;
+
+        return full;
+    }
+
+    CaptureConfig cfg_;
+
+    Stages integ_;
+    std::array<uint32_t, DELAY> integ_delay_;
+    Stages comb_;
+    std::array<std::array<uint32_t, DELAY>, ORDER - 1> comb_delay_;
+
+    uint32_t decimator_ = 0;
+    uint32_t valid_out_ = 0;
+};
+
+#endif
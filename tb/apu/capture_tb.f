@@ -0,0 +1,12 @@
+../../hw/utils/defs/vivado.svh
+
+../../hw/utils/pkg/apu_pkg.sv
+
+-F ../../hw/cpu/_cpu.f
+-F ../../hw/common/_common.f
+
+../../hw/apu/intf/pdm2pcm_converter.sv
+../../hw/apu/capture_unit/cic_filter.sv
+../../hw/apu/capture_unit/recorder_audio_pipeline.sv
+
+capture_tb_top.sv
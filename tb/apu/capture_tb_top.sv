@@ -0,0 +1,116 @@
+// ============================================================================
+// Unit bench top for the audio capture path: pdm2pcm_converter feeding
+// recorder_audio_pipeline, wired exactly as in audio_capture_unit. The
+// register values and the microphone data pin are driven by capture_main.cpp,
+// every PCM sample is handed back through DPI and checked against the
+// reference model (capture_model.h).
+// ============================================================================
+
+`ifndef CAPTURE_TB_TOP_SV
+`define CAPTURE_TB_TOP_SV
+
+module capture_tb_top #(
+    /* Overridden from the Makefile (ORDER / COMB_DELAY) */
+    parameter CIC_FILTER_ORDER = 5,
+    parameter CIC_COMB_DELAY   = 1
+) (
+    input logic clk,
+    input logic rst_n,
+
+    /* Capture unit registers */
+    input logic        enable_i,
+    input logic [6:0]  clock_divisor_i,
+    input logic        dual_channel_i,
+    input logic        channel_i,
+    input logic [7:0]  decimation_i,
+    input logic [31:0] normalizer_i,
+    input logic [15:0] gain_i,
+
+    /* Microphone interface */
+    input  logic pdm_data_i,
+    output logic pdm_clk_o,
+    output logic pdm_lrsel_o
+);
+
+//=============================================================================
+//      PDM INTERFACE
+//=============================================================================
+
+    logic pdm_sampled, pdm_valid, pdm_channel;
+
+    pdm2pcm_converter pdm_converter (
+        .clk_i        ( clk      ),
+        .rst_n_i      ( rst_n    ),
+        .clk_en_i     ( enable_i ),
+
+        .clock_divisor_i ( clock_divisor_i ),
+
+        .dual_channel_i ( dual_channel_i ),
+        .channel_i      ( channel_i      ),
+
+        .pdm_data_o ( pdm_sampled ),
+        .valid_o    ( pdm_valid   ),
+        .channel_o  ( pdm_channel ),
+
+        .pdm_data_i   ( pdm_data_i  ),
+        .pdm_clk_o    ( pdm_clk_o   ),
+        .pdm_lrsel_o  ( pdm_lrsel_o )
+    );
+
+
+//=============================================================================
+//      PROCESSING PIPELINE
+//=============================================================================
+
+    logic [15:0] sample; logic sample_valid, sample_channel, sample_invalid;
+
+    recorder_audio_pipeline #(
+        .CIC_FILTER_ORDER ( CIC_FILTER_ORDER ),
+        .CIC_COMB_DELAY   ( CIC_COMB_DELAY   )
+    ) audio_pipeline (
+        .clk_i    ( clk      ),
+        .rst_n_i  ( rst_n    ),
+        .clk_en_i ( enable_i ),
+
+        .pdm_i     ( pdm_sampled ),
+        .valid_i   ( pdm_valid   ),
+        .channel_i ( pdm_channel ),
+
+        .decimator_factor_i ( decimation_i ),
+        .normalizer_i       ( normalizer_i ),
+        .gain_i             ( gain_i       ),
+
+        .pcm_o     ( sample         ),
+        .valid_o   ( sample_valid   ),
+        .channel_o ( sample_channel ),
+        .invalid_o ( sample_invalid )
+    );
+
+
+//=============================================================================
+//      DPI TAPS
+//=============================================================================
+
+    /* One call per PDM bit entering the filter, to check the stimulus timing */
+    import "DPI-C" function void capture_pdm_bit(input int unsigned bit_value);
+
+    /* One call per PCM sample leaving the pipeline */
+    import "DPI-C" function void capture_sample(
+        input int unsigned pcm,
+        input int unsigned channel,
+        input int unsigned invalid
+    );
+
+    always_ff @(posedge clk) begin
+        if (rst_n && enable_i) begin
+            if (pdm_valid)
+                capture_pdm_bit({31'b0, pdm_sampled});
+
+            if (sample_valid)
+                capture_sample({16'b0, sample}, {31'b0, sample_channel}, {31'b0, sample_invalid});
+        end
+    end
+
+endmodule : capture_tb_top
+
+`endif
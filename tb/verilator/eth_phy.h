@@ -0,0 +1,512 @@
+// ============================================================================
+// LAN8720A stand-in for the full-SoC testbench (RMII + MDIO).
+//
+// zenith_tb_top does the bit-level work (MDIO frames, RMII dibits) and hands
+// whole register accesses and bytes to this model through DPI:
+//
+//   - MDIO: the LAN8720A registers used by sw/lib/driver/Ethernet.h, with
+//     self-clearing reset / restart auto-negotiation, read-to-clear interrupt
+//     source and the speed indication of the negotiated link.
+//   - TX:   every frame sent by the MAC is checked (preamble, SFD, FCS) and
+//           optionally written to a pcap file.
+//   - RX:   frames come from the loopback path (+eth_loopback or BMCR bit 14)
+//           and from a pcap file, separated by a configurable idle gap.
+//
+// Times are simulator cycles (10 ns). The SV side passes a 32-bit cycle
+// counter which is extended to 64 bits here.
+// ============================================================================
+
+#ifndef ZENITH_ETH_PHY_H
+#define ZENITH_ETH_PHY_H
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+// -----------------------------------------------------------------------------
+//      CRC32 (IEEE 802.3, reflected, slicing-by-4)
+// -----------------------------------------------------------------------------
+
+class EthCrc32 {
+public:
+    static uint32_t compute(const uint8_t* data, size_t length) {
+        static const Tables t = make_tables();
+
+        uint32_t crc = 0xFFFFFFFFu;
+
+        // Four bytes per step: one lookup per byte, no per-bit loop
+        while (length >= 4) {
+            crc ^= static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8
+                 | static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+
+            crc = t[3][crc & 0xFF] ^ t[2][(crc >> 8) & 0xFF]
+                ^ t[1][(crc >> 16) & 0xFF] ^ t[0][crc >> 24];
+
+            data += 4;
+            length -= 4;
+        }
+
+        while (length--)
+            crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+private:
+    using Tables = std::array<std::array<uint32_t, 256>, 4>;
+
+    static Tables make_tables() {
+        Tables t{};
+
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+
+            for (int k = 0; k < 8; k++)
+                c = (c & 1) ? (c >> 1) ^ 0xEDB88320u : c >> 1;
+
+            t[0][i] = c;
+        }
+
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int s = 1; s < 4; s++)
+                t[s][i] = (t[s - 1][i] >> 8) ^ t[0][t[s - 1][i] & 0xFF];
+        }
+
+        return t;
+    }
+};
+
+
+// -----------------------------------------------------------------------------
+//      PCAP FILES (LINKTYPE_ETHERNET, no FCS)
+// -----------------------------------------------------------------------------
+
+class PcapWriter {
+public:
+    bool open(const std::string& path) {
+        out_.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+
+        if (!out_.is_open())
+            return false;
+
+        // Nanosecond-resolution magic: one cycle is 10 ns
+        const uint32_t header[6] = {0xA1B23C4Du, 0x00040002u, 0, 0, 65535, 1};
+        out_.write(reinterpret_cast<const char*>(header), sizeof(header));
+        return true;
+    }
+
+    bool is_open() const { return out_.is_open(); }
+
+    void write(uint64_t time_ns, const uint8_t* data, uint32_t length) {
+        const uint32_t record[4] = {
+            static_cast<uint32_t>(time_ns / 1000000000u),
+            static_cast<uint32_t>(time_ns % 1000000000u),
+            length,
+            length
+        };
+
+        out_.write(reinterpret_cast<const char*>(record), sizeof(record));
+        out_.write(reinterpret_cast<const char*>(data), length);
+        out_.flush();
+    }
+
+private:
+    std::ofstream out_;
+};
+
+// Reads the whole capture up front; both byte orders and both time
+// resolutions are accepted, timestamps are ignored.
+static inline bool read_pcap(const std::string& path, std::vector<std::vector<uint8_t>>& frames) {
+    std::ifstream in(path, std::ios::binary);
+
+    uint32_t header[6];
+    if (!in.read(reinterpret_cast<char*>(header), sizeof(header)))
+        return false;
+
+    auto swap = [](uint32_t v) {
+        return (v >> 24) | ((v >> 8) & 0xFF00u) | ((v << 8) & 0xFF0000u) | (v << 24);
+    };
+
+    bool swapped;
+
+    if (header[0] == 0xA1B2C3D4u || header[0] == 0xA1B23C4Du)
+        swapped = false;
+    else if (header[0] == 0xD4C3B2A1u || header[0] == 0x4D3CB2A1u)
+        swapped = true;
+    else
+        return false;
+
+    const uint32_t linktype = swapped ? swap(header[5]) : header[5];
+    if (linktype != 1)
+        return false;
+
+    uint32_t record[4];
+
+    while (in.read(reinterpret_cast<char*>(record), sizeof(record))) {
+        const uint32_t captured = swapped ? swap(record[2]) : record[2];
+
+        std::vector<uint8_t> frame(captured);
+        if (!in.read(reinterpret_cast<char*>(frame.data()), captured))
+            return false;
+
+        frames.push_back(std::move(frame));
+    }
+
+    return true;
+}
+
+
+// -----------------------------------------------------------------------------
+//      PHY MODEL
+// -----------------------------------------------------------------------------
+
+class EthPhyModel {
+public:
+    // Register addresses (Ethernet.h)
+    static constexpr uint32_t BASIC_CONTROL        = 0;
+    static constexpr uint32_t BASIC_STATUS         = 1;
+    static constexpr uint32_t PHY_IDENTIFIER1      = 2;
+    static constexpr uint32_t PHY_IDENTIFIER2      = 3;
+    static constexpr uint32_t AUTONEG_ADVERTISE    = 4;
+    static constexpr uint32_t AUTONEG_LINK_ABILITY = 5;
+    static constexpr uint32_t AUTONEG_EXPANSION    = 6;
+    static constexpr uint32_t MODE_CTRL_STATUS     = 17;
+    static constexpr uint32_t SPECIAL_MODES        = 18;
+    static constexpr uint32_t SYMBOL_ERROR_COUNT   = 26;
+    static constexpr uint32_t CTRL_STATUS_IND      = 27;
+    static constexpr uint32_t INTERRUPT_SOURCE     = 29;
+    static constexpr uint32_t INTERRUPT_MASK       = 30;
+    static constexpr uint32_t SPECIAL_CTRL_STATUS  = 31;
+
+    // Preamble + SFD, minimum frame without FCS, minimum IFG in byte times
+    static constexpr uint32_t PREAMBLE_BYTES = 8;
+    static constexpr uint32_t MIN_FRAME      = 60;
+    static constexpr uint32_t IFG_BYTES      = 12;
+
+    struct Config {
+        bool        loopback = false;
+        std::string tx_pcap;
+        std::string rx_pcap;
+        uint32_t    gap = 0;         // extra idle cycles before each RX frame
+        uint64_t    rx_start = 0;    // first cycle an injected frame may start
+    };
+
+    EthPhyModel() {
+        reset_registers();
+        link_up();
+    }
+
+    bool configure(const Config& cfg) {
+        cfg_ = cfg;
+
+        if (!cfg.tx_pcap.empty() && !tx_pcap_.open(cfg.tx_pcap)) {
+            std::cerr << "[ETH] cannot open " << cfg.tx_pcap << "\n";
+            return false;
+        }
+
+        if (!cfg.rx_pcap.empty()) {
+            if (!read_pcap(cfg.rx_pcap, injected_)) {
+                std::cerr << "[ETH] cannot read " << cfg.rx_pcap << " (Ethernet pcap expected)\n";
+                return false;
+            }
+
+            std::cout << "[ETH] " << injected_.size() << " RX frames from " << cfg.rx_pcap << "\n";
+        }
+
+        next_rx_ = cfg.rx_start;
+        return true;
+    }
+
+    // True when the link runs at 10 Mbps (the SV side paces dibits on it)
+    bool slow_link() const { return !(speed_ & 0b010); }
+
+
+    // --- MDIO ---------------------------------------------------------------
+
+    uint16_t mdio_read(uint32_t reg) {
+        const uint16_t value = regs_[reg & 31];
+
+        // Interrupt source bits clear on read
+        if ((reg & 31) == INTERRUPT_SOURCE)
+            regs_[INTERRUPT_SOURCE] = 0;
+
+        return value;
+    }
+
+    void mdio_write(uint32_t reg, uint16_t value) {
+        switch (reg & 31) {
+            case BASIC_CONTROL:
+                if (value & 0x8000) {
+                    reset_registers();
+                    link_up();
+                    return;
+                }
+
+                regs_[BASIC_CONTROL] = value & ~0x0200;
+
+                if (value & 0x0800) {
+                    link_down();
+                } else if (!(regs_[BASIC_STATUS] & 0x0004) || (value & 0x0200)) {
+                    link_up();
+                } else {
+                    resolve_speed();
+                }
+            break;
+
+            case AUTONEG_ADVERTISE:
+            case MODE_CTRL_STATUS:
+            case SPECIAL_MODES:
+            case CTRL_STATUS_IND:
+            case INTERRUPT_MASK:
+                regs_[reg & 31] = value;
+            break;
+
+            default:
+                // Read-only or unimplemented
+            break;
+        }
+    }
+
+
+    // --- RMII TX ------------------------------------------------------------
+
+    void tx_byte(uint8_t byte) {
+        tx_frame_.push_back(byte);
+    }
+
+    // 'dibits' is the number of dibits seen while TX_EN was high.
+    void tx_end(uint32_t cycle32, uint32_t dibits) {
+        const uint64_t now = extend(cycle32);
+        std::vector<uint8_t> wire;
+        wire.swap(tx_frame_);
+
+        if (dibits % 4)
+            error("TX frame ends on a partial byte (" + std::to_string(dibits) + " dibits)");
+
+        // 7 x 0x55 then 0xD5, at least one preamble byte is required
+        size_t sfd = 0;
+        while (sfd < wire.size() && wire[sfd] == 0x55)
+            sfd++;
+
+        if (sfd == 0 || sfd >= wire.size() || wire[sfd] != 0xD5) {
+            error("TX frame without preamble / SFD");
+            return;
+        }
+
+        const uint8_t* frame = wire.data() + sfd + 1;
+        const size_t length = wire.size() - sfd - 1;
+
+        if (length < 14 + 4) {
+            error("TX frame too short (" + std::to_string(length) + " bytes)");
+            return;
+        }
+
+        const uint32_t fcs = frame[length - 4] | frame[length - 3] << 8
+                           | frame[length - 2] << 16 | static_cast<uint32_t>(frame[length - 1]) << 24;
+        const uint32_t expected = EthCrc32::compute(frame, length - 4);
+
+        tx_frames_++;
+        tx_bytes_ += length;
+
+        if (!tx_first_)
+            tx_first_ = now;
+        else
+            tx_span_bytes_ += length;
+
+        tx_last_ = now;
+
+        if (fcs != expected) {
+            tx_bad_fcs_++;
+
+            char text[96];
+            std::snprintf(text, sizeof(text), "TX frame %llu bad FCS 0x%08x, expected 0x%08x",
+                          static_cast<unsigned long long>(tx_frames_), fcs, expected);
+            error(text);
+        }
+
+        if (tx_pcap_.is_open())
+            tx_pcap_.write(now * 10, frame, static_cast<uint32_t>(length - 4));
+
+        if (powered_down())
+            return;
+
+        // The looped frame follows the minimum IFG after the TX end
+        if (cfg_.loopback || (regs_[BASIC_CONTROL] & 0x4000))
+            looped_.emplace_back(now + ifg_cycles(), std::vector<uint8_t>(frame, frame + length));
+    }
+
+
+    // --- RMII RX ------------------------------------------------------------
+
+    // Next byte on the wire (preamble, SFD, frame, FCS), or -1 when the
+    // carrier is off. Called at byte boundaries.
+    int rx_byte(uint32_t cycle32) {
+        const uint64_t now = extend(cycle32);
+
+        if (rx_pos_ < rx_wire_.size())
+            return rx_wire_[rx_pos_++];
+
+        if (!rx_wire_.empty()) {
+            // Carrier just dropped: the IFG starts now
+            rx_wire_.clear();
+            rx_pos_ = 0;
+            rx_frames_++;
+            next_rx_ = std::max(next_rx_, now + ifg_cycles() + cfg_.gap);
+            return -1;
+        }
+
+        if (powered_down() || now < next_rx_)
+            return -1;
+
+        if (!looped_.empty() && looped_.front().first <= now) {
+            start_rx(looped_.front().second, true);
+            looped_.pop_front();
+        } else if (injected_pos_ < injected_.size()) {
+            start_rx(injected_[injected_pos_++], false);
+        } else {
+            return -1;
+        }
+
+        return rx_wire_[rx_pos_++];
+    }
+
+
+    // --- Report -------------------------------------------------------------
+
+    void report() const {
+        if (!tx_frames_ && !rx_frames_ && !errors_)
+            return;
+
+        std::cout << "[ETH] TX " << tx_frames_ << " frames, " << tx_bytes_ << " bytes, "
+                  << tx_bad_fcs_ << " bad FCS";
+
+        // Throughput between the end of the first and the end of the last frame
+        if (tx_last_ > tx_first_)
+            std::cout << ", " << (tx_span_bytes_ * 8.0 * 100.0 / (tx_last_ - tx_first_)) << " Mbit/s";
+
+        std::cout << " | RX " << rx_frames_ << " frames, " << rx_bytes_ << " bytes"
+                  << " | " << errors_ << " errors\n";
+    }
+
+private:
+    void reset_registers() {
+        regs_.fill(0);
+
+        regs_[BASIC_CONTROL]        = 0x3100;   // 100 Mbps, auto-negotiation, full duplex
+        regs_[BASIC_STATUS]         = 0x7809;   // 10/100 abilities, AN able, extended caps
+        regs_[PHY_IDENTIFIER1]      = 0x0007;
+        regs_[PHY_IDENTIFIER2]      = 0xC0F1;   // LAN8720A rev. 1
+        regs_[AUTONEG_ADVERTISE]    = 0x01E1;
+        regs_[AUTONEG_EXPANSION]    = 0x0001;
+        regs_[SPECIAL_MODES]        = 0x00E1;   // all capable, PHYAD 1
+        regs_[CTRL_STATUS_IND]      = 0x000A;
+        regs_[SPECIAL_CTRL_STATUS]  = 0x0040;
+    }
+
+    bool powered_down() const { return regs_[BASIC_CONTROL] & 0x0C00; }
+
+    // The link partner advertises every 10/100 mode, so the negotiated speed
+    // is the best one in our advertisement register.
+    void resolve_speed() {
+        const uint16_t bmcr = regs_[BASIC_CONTROL];
+        const uint16_t adv = regs_[AUTONEG_ADVERTISE];
+
+        if (bmcr & 0x1000) {
+            if (adv & 0x0100)      speed_ = 0b110;
+            else if (adv & 0x0080) speed_ = 0b010;
+            else if (adv & 0x0040) speed_ = 0b101;
+            else                   speed_ = 0b001;
+        } else {
+            speed_ = ((bmcr & 0x2000) ? 0b010 : 0b001) | ((bmcr & 0x0100) ? 0b100 : 0);
+        }
+
+        regs_[SPECIAL_CTRL_STATUS] = (regs_[SPECIAL_CTRL_STATUS] & ~0x001C) | (speed_ << 2);
+    }
+
+    // Negotiation completes instantly
+    void link_up() {
+        resolve_speed();
+
+        const bool autoneg = regs_[BASIC_CONTROL] & 0x1000;
+
+        regs_[BASIC_STATUS] |= 0x0004 | (autoneg ? 0x0020 : 0);
+        regs_[AUTONEG_LINK_ABILITY] = autoneg ? 0x45E1 : 0;
+        regs_[MODE_CTRL_STATUS] |= 0x0002;
+        regs_[SPECIAL_CTRL_STATUS] |= autoneg ? 0x1000 : 0;
+        regs_[INTERRUPT_SOURCE] |= autoneg ? 0x0040 : 0;
+    }
+
+    void link_down() {
+        regs_[BASIC_STATUS] &= ~0x0024;
+        regs_[MODE_CTRL_STATUS] &= ~0x0002;
+        regs_[SPECIAL_CTRL_STATUS] &= ~0x1000;
+        regs_[INTERRUPT_SOURCE] |= 0x0010;
+    }
+
+    // 10 ns cycles: 8 cycles per byte at 100 Mbps, 80 at 10 Mbps
+    uint64_t ifg_cycles() const { return IFG_BYTES * (slow_link() ? 80 : 8); }
+
+    void start_rx(const std::vector<uint8_t>& frame, bool has_fcs) {
+        rx_wire_.assign(PREAMBLE_BYTES - 1, 0x55);
+        rx_wire_.push_back(0xD5);
+        rx_wire_.insert(rx_wire_.end(), frame.begin(), frame.end());
+
+        if (!has_fcs) {
+            // Captures hold the frame without padding and FCS
+            if (frame.size() < MIN_FRAME)
+                rx_wire_.resize(PREAMBLE_BYTES + MIN_FRAME, 0);
+
+            const uint32_t fcs = EthCrc32::compute(rx_wire_.data() + PREAMBLE_BYTES,
+                                                   rx_wire_.size() - PREAMBLE_BYTES);
+            for (int i = 0; i < 4; i++)
+                rx_wire_.push_back(static_cast<uint8_t>(fcs >> (8 * i)));
+        }
+
+        rx_pos_ = 0;
+        rx_bytes_ += rx_wire_.size() - PREAMBLE_BYTES;
+    }
+
+    uint64_t extend(uint32_t cycle32) {
+        if (cycle32 < last_cycle32_)
+            cycle_high_ += 1ull << 32;
+
+        last_cycle32_ = cycle32;
+        return cycle_high_ | cycle32;
+    }
+
+    void error(const std::string& text) {
+        errors_++;
+        std::cout << "[ETH] ERROR: " << text << "\n";
+    }
+
+    Config cfg_;
+    std::array<uint16_t, 32> regs_{};
+    uint32_t speed_ = 0b110;
+
+    PcapWriter tx_pcap_;
+    std::vector<uint8_t> tx_frame_;
+
+    std::vector<std::vector<uint8_t>> injected_;
+    size_t injected_pos_ = 0;
+    std::deque<std::pair<uint64_t, std::vector<uint8_t>>> looped_;
+    std::vector<uint8_t> rx_wire_;
+    size_t rx_pos_ = 0;
+    uint64_t next_rx_ = 0;
+
+    uint32_t last_cycle32_ = 0;
+    uint64_t cycle_high_ = 0;
+
+    uint64_t tx_frames_ = 0, tx_bytes_ = 0, tx_bad_fcs_ = 0;
+    uint64_t tx_first_ = 0, tx_last_ = 0, tx_span_bytes_ = 0;
+    uint64_t rx_frames_ = 0, rx_bytes_ = 0;
+    uint64_t errors_ = 0;
+};
+
+#endif
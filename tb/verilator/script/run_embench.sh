@@ -31,6 +31,11 @@ for ELF in "${ELF_PATHS[@]}"; do
         TRACE=$TRACE \
         > "$LOG_FILE" 2>&1
 
+    # Keep each kernel's retire trace for the tools/trace explorers
+    if [ "$TRACE" = "1" ] && [ -f out/trace.txt ]; then
+        cp out/trace.txt "logs/embench/${BENCH_NAME}.trace"
+    fi
+
     CYCLES=$(grep -o "EMBENCH_CYCLES=[0-9]*" "$LOG_FILE" | tail -1 | cut -d= -f2)
 
     if grep -q "\[ZTB\] PASS" "$LOG_FILE"; then
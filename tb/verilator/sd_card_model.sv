@@ -63,17 +63,48 @@ module sd_card_model (
         .wbm_ack_i     ( wbm_ack         ),
         .wbm_cti_o     ( wbm_cycle_type  ),
         .wbm_bte_o     ( wbm_burst_type  ),
-        .opt_enable_hs ( 1'b0            )
+        .opt_enable_hs ( 1'b1            )
     );
 
-    assign sd_cmd_io = (sd_cmd_t == 1'b0) ? sd_cmd_o : 1'bz;
+    // The PHY model always drives its outputs on the falling edge of the SD
+    // clock. Once CMD6 selected High-Speed mode a real card drives them after
+    // the rising edge, delay them by half a period to check the host sampling
+    // point at 50 MHz.
+    logic       high_speed;
+    logic       sd_cmd_hs,   sd_cmd_t_hs;
+    logic [3:0] sd_dat_hs,   sd_dat_t_hs;
+    logic       sd_cmd_out,  sd_cmd_t_out;
+    logic [3:0] sd_dat_out,  sd_dat_t_out;
+
+    assign high_speed = (sd_model.isdl.card_function[3:0] == 4'h1);
+
+    always_ff @(posedge sd_clk_i or negedge rst_n_i) begin
+        if (!rst_n_i) begin
+            sd_cmd_hs   <= 1'b1;
+            sd_cmd_t_hs <= 1'b1;
+            sd_dat_hs   <= 4'hF;
+            sd_dat_t_hs <= 4'hF;
+        end else begin
+            sd_cmd_hs   <= sd_cmd_o;
+            sd_cmd_t_hs <= sd_cmd_t;
+            sd_dat_hs   <= sd_dat_o;
+            sd_dat_t_hs <= sd_dat_t;
+        end
+    end
+
+    assign sd_cmd_out   = high_speed ? sd_cmd_hs   : sd_cmd_o;
+    assign sd_cmd_t_out = high_speed ? sd_cmd_t_hs : sd_cmd_t;
+    assign sd_dat_out   = high_speed ? sd_dat_hs   : sd_dat_o;
+    assign sd_dat_t_out = high_speed ? sd_dat_t_hs : sd_dat_t;
+
+    assign sd_cmd_io = (sd_cmd_t_out == 1'b0) ? sd_cmd_out : 1'bz;
     assign sd_cmd_i  = sd_cmd_io;
 
     genvar data_bit;
     generate
         for (data_bit = 0; data_bit < 4; data_bit++) begin : sd_data_connection
             assign sd_data_io[data_bit] =
-                (sd_dat_t[data_bit] == 1'b0) ? sd_dat_o[data_bit] : 1'bz;
+                (sd_dat_t_out[data_bit] == 1'b0) ? sd_dat_out[data_bit] : 1'bz;
         end
     endgenerate
 
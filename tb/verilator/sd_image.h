@@ -0,0 +1,114 @@
+// ============================================================================
+// SD card image loading shared by the Verilator testbench and the pure-ISS
+// harness (vp/common/sim/iss_main.cpp). An image is either a raw binary or a
+// byte-oriented hex file ('@addr' cursors, optional 0x prefixes, comments).
+// ============================================================================
+
+#ifndef ZENITH_SD_IMAGE_H
+#define ZENITH_SD_IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <cctype>
+
+inline bool has_hex_extension(const std::string& path) {
+    std::string lower = path;
+    std::transform(lower.begin(), lower.end(), lower.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return lower.size() >= 4 && lower.substr(lower.size() - 4) == ".hex";
+}
+
+inline bool load_sd_hex(const std::string& path, std::vector<uint8_t>& data) {
+    std::ifstream input(path);
+    if (!input.is_open())
+        return false;
+
+    uint64_t cursor = 0;
+    std::string line;
+
+    while (std::getline(input, line)) {
+        const auto comment = line.find_first_of("#;");
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        const auto cpp_comment = line.find("//");
+        if (cpp_comment != std::string::npos)
+            line.erase(cpp_comment);
+
+        std::istringstream tokens(line);
+        std::string token;
+
+        while (tokens >> token) {
+            if (!token.empty() && token.front() == '@') {
+                try {
+                    cursor = std::stoull(token.substr(1), nullptr, 16);
+                } catch (...) {
+                    return false;
+                }
+                continue;
+            }
+
+            if (token.rfind("0x", 0) == 0 || token.rfind("0X", 0) == 0)
+                token.erase(0, 2);
+
+            token.erase(std::remove(token.begin(), token.end(), '_'), token.end());
+            if (!token.empty() && token.back() == ',')
+                token.pop_back();
+
+            if (token.empty())
+                continue;
+
+            if (token.size() % 2 != 0)
+                token.insert(token.begin(), '0');
+
+            for (size_t pos = 0; pos < token.size(); pos += 2) {
+                uint8_t value;
+                try {
+                    value = static_cast<uint8_t>(
+                        std::stoul(token.substr(pos, 2), nullptr, 16));
+                } catch (...) {
+                    return false;
+                }
+
+                if (cursor >= data.size())
+                    data.resize(cursor + 1, 0xFF);
+                data[cursor++] = value;
+            }
+        }
+    }
+
+    return true;
+}
+
+// Read a whole image file, hex or binary depending on the extension.
+inline bool read_sd_image(const std::string& path, std::vector<uint8_t>& image) {
+    if (has_hex_extension(path))
+        return load_sd_hex(path, image);
+
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open())
+        return false;
+
+    image.assign(std::istreambuf_iterator<char>(input),
+                 std::istreambuf_iterator<char>());
+    return true;
+}
+
+// Lay 'image' out on an erased (0xFF) card starting at 512-byte 'block'.
+inline bool place_sd_image(const std::vector<uint8_t>& image, uint32_t block,
+                           std::vector<uint8_t>& disk) {
+    const uint64_t offset = static_cast<uint64_t>(block) * 512;
+    if (offset + image.size() > UINT32_MAX)
+        return false;
+
+    disk.assign(offset + image.size(), 0xFF);
+    std::copy(image.begin(), image.end(), disk.begin() + offset);
+    return true;
+}
+
+#endif
@@ -4,7 +4,17 @@
 //      the DPI export functions defined in the wrapper.
 //   3. Drive clock and reset, then let the core run freely.
 //   4. Print an execution trace: PC | disasm | rd<=value | mem access.
+//      Disassembly is cached per PC and the printout can be restricted with
+//      +trace_filter= (PC range, ELF function or instruction class).
 //   5. Stop on a `tohost` write, on +max_cycles, or on Ctrl-C.
+//   6. Report simulator throughput (cycles/s, instructions/s, IPC) and where
+//      the wall time went, periodically and in out/sim_stats.json at the end.
+//   7. With +cpi_stack, attribute every cycle between retires to a stall
+//      cause, per ELF function, and write out/cpi_stack.json.
+//   8. Serve the RMII/MDIO pins with a LAN8720A model (eth_phy.h): loopback,
+//      TX frames to pcap, RX frames from pcap.
+//   9. Serve SPI0 slave 0 with a SPI NOR flash model (spi_flash.h), optionally
+//      preloaded with an image.
 //
 // The trace disassembler reuses Spike's disassembler_t (libriscv), exactly like
 // the cosim flow. The ISA string is injected at build time via -DCOSIM_ISA.
@@ -19,8 +29,12 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <unordered_map>
 #include <algorithm>
 #include <cctype>
+#include <chrono>
+#include <functional>
+#include <memory>
 
 #include "Vzenith_tb_top.h"
 #include "Vzenith_tb_top__Dpi.h"
@@ -32,6 +46,10 @@
 #include "riscv/disasm.h"
 
 #include "elf_loader.h"      // reused from cosim/sim (added to the include path)
+#include "sd_image.h"
+#include "eth_phy.h"
+#include "spi_flash.h"
+#include "log_decoder.h"    // tools/log (added to the include path)
 
 #ifndef COSIM_ISA
 #define COSIM_ISA "rv32im_zicsr"
@@ -42,101 +60,38 @@ static volatile std::sig_atomic_t g_stop_signal = 0;
 
 
 // -----------------------------------------------------------------------------
-//      SD CARD BACKING STORE
+//      WALL-TIME ACCOUNTING
 // -----------------------------------------------------------------------------
 
-static std::vector<uint8_t> g_sd_bytes;
+using WallClock = std::chrono::steady_clock;
 
-static bool has_hex_extension(const std::string& path) {
-    std::string lower = path;
-    std::transform(lower.begin(), lower.end(), lower.begin(),
-                   [](unsigned char c) { return std::tolower(c); });
-    return lower.size() >= 4 && lower.substr(lower.size() - 4) == ".hex";
+static inline uint64_t elapsed_ns(WallClock::time_point from, WallClock::time_point to) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
 }
 
-static bool load_sd_hex(const std::string& path, std::vector<uint8_t>& data) {
-    std::ifstream input(path);
-    if (!input.is_open())
-        return false;
-
-    uint64_t cursor = 0;
-    std::string line;
-
-    while (std::getline(input, line)) {
-        const auto comment = line.find_first_of("#;");
-        if (comment != std::string::npos)
-            line.erase(comment);
-
-        const auto cpp_comment = line.find("//");
-        if (cpp_comment != std::string::npos)
-            line.erase(cpp_comment);
-
-        std::istringstream tokens(line);
-        std::string token;
-
-        while (tokens >> token) {
-            if (!token.empty() && token.front() == '@') {
-                try {
-                    cursor = std::stoull(token.substr(1), nullptr, 16);
-                } catch (...) {
-                    return false;
-                }
-                continue;
-            }
-
-            if (token.rfind("0x", 0) == 0 || token.rfind("0X", 0) == 0)
-                token.erase(0, 2);
+// Time spent inside the DPI imports below. They run from within eval(), so
+// this is a subset of the eval time measured by Sim.
+static uint64_t g_dpi_ns = 0;
 
-            token.erase(std::remove(token.begin(), token.end(), '_'), token.end());
-            if (!token.empty() && token.back() == ',')
-                token.pop_back();
-
-            if (token.empty())
-                continue;
-
-            if (token.size() % 2 != 0)
-                token.insert(token.begin(), '0');
+struct DpiTimer {
+    WallClock::time_point start = WallClock::now();
+    ~DpiTimer() { g_dpi_ns += elapsed_ns(start, WallClock::now()); }
+};
 
-            for (size_t pos = 0; pos < token.size(); pos += 2) {
-                uint8_t value;
-                try {
-                    value = static_cast<uint8_t>(
-                        std::stoul(token.substr(pos, 2), nullptr, 16));
-                } catch (...) {
-                    return false;
-                }
 
-                if (cursor >= data.size())
-                    data.resize(cursor + 1, 0xFF);
-                data[cursor++] = value;
-            }
-        }
-    }
+// -----------------------------------------------------------------------------
+//      SD CARD BACKING STORE
+// -----------------------------------------------------------------------------
 
-    return true;
-}
+static std::vector<uint8_t> g_sd_bytes;
 
 static bool load_sd_image(const std::string& path, uint32_t block) {
     std::vector<uint8_t> image;
 
-    if (has_hex_extension(path)) {
-        if (!load_sd_hex(path, image))
-            return false;
-    } else {
-        std::ifstream input(path, std::ios::binary);
-        if (!input.is_open())
-            return false;
-
-        image.assign(std::istreambuf_iterator<char>(input),
-                     std::istreambuf_iterator<char>());
-    }
-
-    const uint64_t offset = static_cast<uint64_t>(block) * 512;
-    if (offset + image.size() > UINT32_MAX)
+    if (!read_sd_image(path, image) || !place_sd_image(image, block, g_sd_bytes))
         return false;
 
-    g_sd_bytes.assign(offset + image.size(), 0xFF);
-    std::copy(image.begin(), image.end(), g_sd_bytes.begin() + offset);
+    const uint64_t offset = static_cast<uint64_t>(block) * 512;
 
     std::cout << "[ZTB] SD image loaded: " << path
               << " bytes=" << image.size()
@@ -146,6 +101,7 @@ static bool load_sd_image(const std::string& path, uint32_t block) {
 }
 
 extern "C" uint32_t zenith_sd_read_word(uint32_t byte_addr) {
+    DpiTimer timer;
     uint32_t data = 0xFFFFFFFFu;
 
     for (uint32_t lane = 0; lane < 4; lane++) {
@@ -168,6 +124,7 @@ extern "C" uint32_t zenith_sd_read_word(uint32_t byte_addr) {
 extern "C" void zenith_sd_write_word(uint32_t byte_addr,
                                       uint32_t data,
                                       uint32_t strobe) {
+    DpiTimer timer;
     const uint64_t end = static_cast<uint64_t>(byte_addr) + 4;
     if (end > UINT32_MAX)
         return;
@@ -198,6 +155,9 @@ extern "C" void zenith_sd_write_word(uint32_t byte_addr,
 static std::ofstream g_uart_file;
 static std::ofstream g_trace_file;
 
+// Expands the firmware LOG() records, plain text passes through
+static LogDecoder g_log;
+
 static void uart_capture_open(const std::string& dir) {
     std::string path = dir + "/stdout.txt";
 
@@ -210,15 +170,77 @@ static void uart_capture_open(const std::string& dir) {
 
 
 extern "C" void zenith_uart_tx_byte(uint32_t data) {
-    char c = static_cast<char> (data & 0xFF);
+    DpiTimer timer;
+    std::string text;
+
+    g_log.feed(static_cast<uint8_t> (data & 0xFF), text);
 
-    std::cout << c << std::flush;
+    if (text.empty())
+        return;
+
+    std::cout << text << std::flush;
 
     if (g_uart_file.is_open()) {
-        g_uart_file << c << std::flush;
+        g_uart_file << text << std::flush;
     }
 }
 
+// -----------------------------------------------------------------------------
+//      ETHERNET PHY (eth_phy.h)
+// -----------------------------------------------------------------------------
+
+static EthPhyModel g_eth;
+
+extern "C" uint32_t zenith_eth_mdio_read(uint32_t reg_addr) {
+    DpiTimer timer;
+    return g_eth.mdio_read(reg_addr);
+}
+
+extern "C" void zenith_eth_mdio_write(uint32_t reg_addr, uint32_t data) {
+    DpiTimer timer;
+    g_eth.mdio_write(reg_addr, static_cast<uint16_t>(data));
+}
+
+extern "C" uint32_t zenith_eth_slow_link() {
+    return g_eth.slow_link();
+}
+
+extern "C" void zenith_eth_tx_byte(uint32_t data) {
+    DpiTimer timer;
+    g_eth.tx_byte(static_cast<uint8_t>(data));
+}
+
+extern "C" void zenith_eth_tx_end(uint32_t cycle, uint32_t dibits) {
+    DpiTimer timer;
+    g_eth.tx_end(cycle, dibits);
+}
+
+extern "C" int zenith_eth_rx_byte(uint32_t cycle) {
+    DpiTimer timer;
+    return g_eth.rx_byte(cycle);
+}
+
+// -----------------------------------------------------------------------------
+//      SPI NOR FLASH (spi_flash.h)
+// -----------------------------------------------------------------------------
+
+static SpiFlashModel g_flash;
+
+extern "C" void zenith_flash_select() {
+    DpiTimer timer;
+    g_flash.select();
+}
+
+extern "C" int zenith_flash_byte(uint32_t data, uint32_t cycle) {
+    DpiTimer timer;
+    return g_flash.byte(static_cast<uint8_t>(data), cycle);
+}
+
+extern "C" void zenith_flash_deselect(uint32_t cycle) {
+    DpiTimer timer;
+    g_flash.deselect(cycle);
+}
+
 // -----------------------------------------------------------------------------
 //      MEMORY MAP (apogeo_memory_map.svh)
 // -----------------------------------------------------------------------------
@@ -245,6 +267,129 @@ struct TraceEvent {
 
 static std::deque<TraceEvent> g_events;
 
+
+// -----------------------------------------------------------------------------
+//      TRACE FILTER
+// -----------------------------------------------------------------------------
+
+// instruction_status_t encodings carried in TraceEvent::info (apogeo_pkg.sv,
+// same numbers as the trace unit event table in docs/peripherals/trace_unit.rst).
+static constexpr uint32_t INFO_U_SYSTEM_CALL  = 8;
+static constexpr uint32_t INFO_M_SYSTEM_CALL  = 11;
+static constexpr uint32_t INFO_SLEEP          = 16;
+static constexpr uint32_t INFO_HANDLER_RETURN = 17;
+static constexpr uint32_t INFO_STORE          = 18;
+static constexpr uint32_t INFO_LOAD           = 19;
+static constexpr uint32_t INFO_BRANCH         = 20;
+static constexpr uint32_t INFO_JUMP           = 21;
+static constexpr uint32_t INFO_CSR            = 22;
+
+enum TraceClass : uint32_t {
+    CLASS_ALU, CLASS_LOAD, CLASS_STORE, CLASS_BRANCH, CLASS_JUMP,
+    CLASS_CSR, CLASS_SYSTEM, CLASS_EXCEPTION, CLASS_COUNT
+};
+
+static const char* const TRACE_CLASS_NAMES[CLASS_COUNT] = {
+    "alu", "load", "store", "branch", "jump", "csr", "system", "exception"
+};
+
+static TraceClass classify(const TraceEvent& e) {
+    if (e.is_exception)
+        return CLASS_EXCEPTION;
+
+    switch (e.info) {
+        case INFO_LOAD:           return CLASS_LOAD;
+        case INFO_STORE:          return CLASS_STORE;
+        case INFO_BRANCH:         return CLASS_BRANCH;
+        case INFO_JUMP:           return CLASS_JUMP;
+        case INFO_CSR:            return CLASS_CSR;
+        case INFO_U_SYSTEM_CALL:
+        case INFO_M_SYSTEM_CALL:
+        case INFO_SLEEP:
+        case INFO_HANDLER_RETURN: return CLASS_SYSTEM;
+        default:                  return CLASS_ALU;
+    }
+}
+
+// Selects which retired events reach the printed trace. PC ranges (given
+// directly or through ELF function symbols) are OR-ed together, then the
+// instruction class mask is applied. An empty filter accepts everything.
+struct TraceFilter {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;   // [lo, hi)
+    uint32_t class_mask = 0;
+
+    bool accepts(const TraceEvent& e) const {
+        if (class_mask && !(class_mask & (1u << classify(e))))
+            return false;
+
+        if (ranges.empty())
+            return true;
+
+        for (const auto& [lo, hi] : ranges) {
+            if (e.pc >= lo && e.pc < hi)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Parse one +trace_filter= value: a comma separated list of
+    //   pc:LO-HI          half-open PC range (any stoul base)
+    //   sym:NAME          the range covered by an ELF function symbol
+    //   class:A|B|...     alu, load, store, branch, jump, csr, system, exception
+    bool parse(const std::string& spec, const ElfImage& img, std::string& error) {
+        std::istringstream items(spec);
+        std::string item;
+
+        while (std::getline(items, item, ',')) {
+            if (item.rfind("pc:", 0) == 0) {
+                const auto dash = item.find('-', 3);
+                if (dash == std::string::npos) {
+                    error = "expected pc:LO-HI in '" + item + "'";
+                    return false;
+                }
+
+                try {
+                    const uint32_t lo = std::stoul(item.substr(3, dash - 3), nullptr, 0);
+                    const uint32_t hi = std::stoul(item.substr(dash + 1), nullptr, 0);
+                    ranges.emplace_back(lo, hi);
+                } catch (...) {
+                    error = "bad PC range '" + item + "'";
+                    return false;
+                }
+            } else if (item.rfind("sym:", 0) == 0) {
+                const ElfSymbol* sym = find_function(img, item.substr(4));
+                if (!sym) {
+                    error = "function symbol '" + item.substr(4) + "' not found in the ELF";
+                    return false;
+                }
+
+                ranges.emplace_back(sym->value, sym->value + std::max<uint32_t>(sym->size, 2));
+            } else if (item.rfind("class:", 0) == 0) {
+                std::istringstream names(item.substr(6));
+                std::string name;
+
+                while (std::getline(names, name, '|')) {
+                    const auto* end = TRACE_CLASS_NAMES + CLASS_COUNT;
+                    const auto* it  = std::find(TRACE_CLASS_NAMES, end, name);
+
+                    if (it == end) {
+                        error = "unknown instruction class '" + name + "'";
+                        return false;
+                    }
+
+                    class_mask |= 1u << (it - TRACE_CLASS_NAMES);
+                }
+            } else if (!item.empty()) {
+                error = "unknown filter '" + item + "'";
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+
 // DPI import: called by the wrapper on every retired instruction.
 extern "C" void zenith_trace_commit(uint32_t is_exception,
                                     uint32_t pc,
@@ -256,6 +401,7 @@ extern "C" void zenith_trace_commit(uint32_t is_exception,
                                     uint32_t mem_addr,
                                     uint32_t mem_data,
                                     uint32_t mem_width) {
+    DpiTimer timer;
 
     g_events.push_back(TraceEvent{
         is_exception != 0,
@@ -271,6 +417,296 @@ extern "C" void zenith_trace_commit(uint32_t is_exception,
     });
 }
 
+// -----------------------------------------------------------------------------
+//      CPI STACK (+cpi_stack)
+// -----------------------------------------------------------------------------
+
+// zenith_perf_hint() bits, set by zenith_tb_top while a cache controller is
+// busy with memory. Counted per cycle until the next retire consumes them.
+static constexpr uint32_t PERF_HINT_ICACHE_MISS   = 0;
+static constexpr uint32_t PERF_HINT_DCACHE_REFILL = 1;
+static constexpr uint32_t PERF_HINT_DCACHE_STORE  = 2;
+static constexpr uint32_t PERF_HINT_COUNT         = 3;
+
+static uint64_t g_perf_hint_cycles[PERF_HINT_COUNT] = {};
+
+extern "C" void zenith_perf_hint(uint32_t hints) {
+    for (uint32_t i = 0; i < PERF_HINT_COUNT; i++) {
+        if (hints & (1u << i))
+            g_perf_hint_cycles[i]++;
+    }
+}
+
+enum CpiBucket : uint32_t {
+    CPI_BASE,        // one cycle per retired instruction
+    CPI_ICACHE,      // fetch stalled on an instruction cache refill
+    CPI_DCACHE,      // data cache refill, write-back or store miss
+    CPI_MMIO,        // load/store to a peripheral
+    CPI_REDIRECT,    // taken branch/jump or misprediction refetch
+    CPI_LOAD_USE,    // consumer of the previous load waits for its data
+    CPI_LOAD,        // other load latency (cache hit path)
+    CPI_MULDIV,      // long-latency execute: M extension and Zfinx FP
+    CPI_EXCEPTION,   // trap entry and handler return
+    CPI_OTHER,       // anything else (CSR, fences, frontend bubbles)
+    CPI_BUCKET_COUNT
+};
+
+static const char* const CPI_BUCKET_NAMES[CPI_BUCKET_COUNT] = {
+    "base", "icache", "dcache", "mmio", "redirect",
+    "load_use", "load", "muldiv", "exception", "other"
+};
+
+// Attributes every cycle between two retires to one bucket, per ELF function
+// and for the whole run. The stall cycles of a gap go first to the cache
+// hints counted during it, then to a single cause inferred from the retiring
+// instruction and its predecessor.
+class CpiStack {
+public:
+    using Fetch = std::function<uint32_t(uint32_t)>;
+
+    CpiStack(const ElfImage& img, Fetch fetch) : fetch_(std::move(fetch)) {
+        for (const ElfSymbol& sym : img.functions) {
+            if (sym.size)
+                functions_.push_back(sym);
+        }
+
+        std::sort(functions_.begin(), functions_.end(),
+                  [](const ElfSymbol& a, const ElfSymbol& b) { return a.value < b.value; });
+
+        // Last entry collects PCs outside every function (boot ROM, stripped code)
+        stacks_.resize(functions_.size() + 1);
+    }
+
+    // 'gap' is the number of cycles since the previous retire.
+    void retire(const TraceEvent& e, uint64_t gap) {
+        const Decoded& d = decode(e.pc);
+        Stack& stack = stacks_[d.function];
+
+        uint64_t hints[PERF_HINT_COUNT];
+        std::copy(g_perf_hint_cycles, g_perf_hint_cycles + PERF_HINT_COUNT, hints);
+        std::fill(g_perf_hint_cycles, g_perf_hint_cycles + PERF_HINT_COUNT, 0);
+
+        if (!e.is_exception)
+            stack.retired++;
+
+        // Cycles before the very first retire are reset and boot latency
+        if (!have_prev_) {
+            prev_ = e;
+            have_prev_ = true;
+            return;
+        }
+
+        uint64_t stall = gap ? gap - 1 : 0;
+        stack.cycles[CPI_BASE] += gap ? 1 : 0;
+
+        if (e.is_exception || prev_.is_exception || prev_.info == INFO_HANDLER_RETURN) {
+            stack.cycles[CPI_EXCEPTION] += stall;
+        } else {
+            const uint64_t icache = std::min(stall, hints[PERF_HINT_ICACHE_MISS]);
+            stall -= icache;
+
+            const uint64_t dcache = std::min(stall, hints[PERF_HINT_DCACHE_REFILL] +
+                                                    hints[PERF_HINT_DCACHE_STORE]);
+            stall -= dcache;
+
+            stack.cycles[CPI_ICACHE] += icache;
+            stack.cycles[CPI_DCACHE] += dcache;
+            stack.cycles[cause(e, d)] += stall;
+        }
+
+        prev_ = e;
+    }
+
+    // Cached decode results are stale after a store overwrites the code.
+    void invalidate(uint32_t pc) { decoded_.erase(pc); }
+
+    void report(const std::string& json_path) const {
+        Stack total;
+        for (const Stack& stack : stacks_)
+            total += stack;
+
+        const uint64_t total_cycles = total.total();
+
+        std::cout << "[ZTB] CPI stack: " << total_cycles << " cycles, "
+                  << total.retired << " retired, CPI="
+                  << std::fixed << std::setprecision(3) << total.cpi() << "\n";
+
+        for (uint32_t b = 0; b < CPI_BUCKET_COUNT; b++) {
+            if (!total.cycles[b])
+                continue;
+
+            std::cout << "[ZTB]   " << std::left << std::setw(10) << CPI_BUCKET_NAMES[b]
+                      << std::right << std::setw(8)
+                      << double(total.cycles[b]) / std::max<uint64_t>(total.retired, 1)
+                      << " CPI " << std::setprecision(1) << std::setw(6)
+                      << 100.0 * total.cycles[b] / std::max<uint64_t>(total_cycles, 1)
+                      << "%\n" << std::setprecision(3);
+        }
+
+        // Functions by cycles spent, top 10 on stdout, all of them in the JSON
+        std::vector<size_t> order;
+        for (size_t i = 0; i < stacks_.size(); i++) {
+            if (stacks_[i].total())
+                order.push_back(i);
+        }
+
+        std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return stacks_[a].total() > stacks_[b].total();
+        });
+
+        std::cout << "[ZTB] hottest functions (cycles, CPI, top stall):\n";
+
+        for (size_t n = 0; n < std::min<size_t>(order.size(), 10); n++) {
+            const Stack& stack = stacks_[order[n]];
+            const uint32_t top = stack.top_stall();
+
+            std::cout << "[ZTB]   " << std::left << std::setw(32) << function_name(order[n])
+                      << std::right << std::setw(12) << stack.total()
+                      << std::setw(8) << stack.cpi() << "  "
+                      << (top == CPI_BASE ? "-" : CPI_BUCKET_NAMES[top]) << "\n";
+        }
+
+        std::cout << std::defaultfloat;
+
+        std::ofstream json(json_path, std::ios::out | std::ios::trunc);
+        if (!json.is_open()) {
+            std::cerr << "[ZTB] WARN: cannot write " << json_path << "\n";
+            return;
+        }
+
+        json << "{\n  \"total\": ";
+        write_json(json, total);
+        json << ",\n  \"functions\": [";
+
+        for (size_t n = 0; n < order.size(); n++) {
+            const size_t i = order[n];
+            const uint32_t start = i < functions_.size() ? functions_[i].value : 0;
+
+            json << (n ? "," : "") << "\n    { \"name\": \"" << function_name(i)
+                 << "\", \"start\": " << start << ", \"stack\": ";
+            write_json(json, stacks_[i]);
+            json << " }";
+        }
+
+        json << "\n  ]\n}\n";
+    }
+
+private:
+    struct Stack {
+        uint64_t cycles[CPI_BUCKET_COUNT] = {};
+        uint64_t retired = 0;
+
+        Stack& operator+=(const Stack& other) {
+            for (uint32_t b = 0; b < CPI_BUCKET_COUNT; b++)
+                cycles[b] += other.cycles[b];
+            retired += other.retired;
+            return *this;
+        }
+
+        uint64_t total() const {
+            uint64_t sum = 0;
+            for (uint64_t c : cycles)
+                sum += c;
+            return sum;
+        }
+
+        double cpi() const { return retired ? double(total()) / retired : 0.0; }
+
+        uint32_t top_stall() const {
+            uint32_t top = CPI_BASE;
+            for (uint32_t b = CPI_BASE + 1; b < CPI_BUCKET_COUNT; b++) {
+                if (cycles[b] > cycles[top])
+                    top = b;
+            }
+            return top;
+        }
+    };
+
+    struct Decoded {
+        uint32_t rs1;        // 0 when the operand is unused
+        uint32_t rs2;
+        bool     muldiv;
+        uint32_t function;   // index into stacks_
+    };
+
+    const Decoded& decode(uint32_t pc) {
+        auto it = decoded_.find(pc);
+        if (it != decoded_.end())
+            return it->second;
+
+        const uint32_t insn   = fetch_(pc);
+        const uint32_t opcode = insn & 0x7F;
+
+        Decoded d{};
+
+        if ((insn & 0x3) == 0x3) {
+            const bool no_rs1 = opcode == 0x37 || opcode == 0x17 || opcode == 0x6F;
+            const bool has_rs2 = opcode == 0x23 || opcode == 0x33 || opcode == 0x63 || opcode == 0x53;
+
+            d.rs1 = no_rs1 ? 0 : (insn >> 15) & 0x1F;
+            d.rs2 = has_rs2 ? (insn >> 20) & 0x1F : 0;
+            d.muldiv = (opcode == 0x33 && (insn >> 25) == 0x01) || opcode == 0x53;
+        }
+
+        d.function = lookup_function(pc);
+
+        return decoded_.emplace(pc, d).first->second;
+    }
+
+    CpiBucket cause(const TraceEvent& e, const Decoded& d) const {
+        if ((e.is_load || e.is_store) && e.mem_addr >= BOOT_END && e.mem_addr < USER_BASE)
+            return CPI_MMIO;
+
+        if ((prev_.info == INFO_BRANCH || prev_.info == INFO_JUMP) && e.pc != prev_.pc + 4)
+            return CPI_REDIRECT;
+
+        if (prev_.is_load && prev_.rd && (d.rs1 == prev_.rd || d.rs2 == prev_.rd))
+            return CPI_LOAD_USE;
+
+        if (d.muldiv)
+            return CPI_MULDIV;
+
+        if (e.is_load)
+            return CPI_LOAD;
+
+        return CPI_OTHER;
+    }
+
+    uint32_t lookup_function(uint32_t pc) const {
+        auto it = std::upper_bound(functions_.begin(), functions_.end(), pc,
+                                   [](uint32_t v, const ElfSymbol& s) { return v < s.value; });
+
+        if (it != functions_.begin()) {
+            --it;
+            if (pc < it->value + it->size)
+                return static_cast<uint32_t>(it - functions_.begin());
+        }
+
+        return static_cast<uint32_t>(functions_.size());
+    }
+
+    std::string function_name(size_t index) const {
+        return index < functions_.size() ? functions_[index].name : "<unknown>";
+    }
+
+    static void write_json(std::ostream& os, const Stack& stack) {
+        os << "{ \"retired\": " << stack.retired << ", \"cycles\": " << stack.total();
+
+        for (uint32_t b = 0; b < CPI_BUCKET_COUNT; b++)
+            os << ", \"" << CPI_BUCKET_NAMES[b] << "\": " << stack.cycles[b];
+
+        os << " }";
+    }
+
+    Fetch fetch_;
+    std::vector<ElfSymbol> functions_;
+    std::vector<Stack> stacks_;
+    std::unordered_map<uint32_t, Decoded> decoded_;
+
+    TraceEvent prev_{};
+    bool have_prev_ = false;
+};
+
 // ============================================================================
 //      SIMULATION DRIVER
 // ============================================================================
@@ -280,11 +716,13 @@ public:
     Sim(bool trace_wave,
         bool trace_print,
         uint64_t trace_start,
-        uint64_t max_cycles)
+        uint64_t max_cycles,
+        double stats_interval)
         : enable_wave_(trace_wave),
           enable_print_(trace_print),
           trace_start_(trace_start),
           max_cycles_(max_cycles),
+          stats_interval_(stats_interval),
           isa_(COSIM_ISA, "MSU"),
           dis_(&isa_) {
 
@@ -354,25 +792,51 @@ public:
         return 0;
     }
 
+    // Disassembly of the instruction at PC. Loops retire the same PCs over
+    // and over, so the text is cached and only rebuilt after a store hits
+    // the cached code range (see invalidate_code()).
+    const std::string& disassemble_at(uint32_t pc) {
+        auto it = disasm_cache_.find(pc);
+        if (it != disasm_cache_.end())
+            return it->second;
+
+        insn_t insn(peek_insn(pc));
+
+        code_lo_ = std::min(code_lo_, pc);
+        code_hi_ = std::max(code_hi_, pc + 4);
+
+        return disasm_cache_.emplace(pc, dis_.disassemble(insn)).first->second;
+    }
+
 
     // --- Clock / reset ------------------------------------------------------
+    // Each phase is timed for the telemetry breakdown; a steady_clock read
+    // costs tens of ns against microseconds for a full-SoC eval().
     void tick() {
+        WallClock::time_point t0 = WallClock::now();
+
         dut_->clk = 1;
         dut_->eval();
-        dump();
+        t0 = account(eval_ns_, t0);
+        dump(t0);
 
         Verilated::timeInc(HALF_PERIOD_NS);
         sim_time_ += HALF_PERIOD_NS;
 
         dut_->clk = 0;
         dut_->eval();
-        dump();
+        t0 = account(eval_ns_, t0);
+        dump(t0);
 
         Verilated::timeInc(HALF_PERIOD_NS);
         sim_time_ += HALF_PERIOD_NS;
 
         cycles_++;
         drain_trace();
+        account(drain_ns_, t0);
+
+        if (stats_interval_ > 0 && (cycles_ & (STATS_POLL_CYCLES - 1)) == 0)
+            poll_stats();
     }
 
     void reset() {
@@ -387,6 +851,57 @@ public:
 
     // --- Main run loop ------------------------------------------------------
     int run(uint32_t tohost_addr) {
+        run_start_ = last_stats_ = WallClock::now();
+
+        const int rc = run_loop(tohost_addr);
+
+        report_stats(rc);
+
+        if (cpi_stack_)
+            cpi_stack_->report("out/cpi_stack.json");
+
+        return rc;
+    }
+
+    void set_tohost(uint32_t a) { tohost_addr_ = a; }
+
+    void set_trace_filter(const TraceFilter& f) { filter_ = f; }
+
+    void enable_cpi_stack(const ElfImage& img) {
+        cpi_stack_ = std::make_unique<CpiStack>(img, [this](uint32_t pc) { return peek_insn(pc); });
+    }
+
+    void verify_ddr_image(const ElfImage& img) {
+        size_t mismatches = 0;
+
+        for (const auto& [addr, expected] : img.words) {
+            if (addr < USER_BASE)
+                continue;
+
+            const uint32_t actual = peek_insn(addr);
+            if (actual != expected) {
+                if (mismatches < 8) {
+                    std::cout << "[ZTB] DDR mismatch @0x" << std::hex << addr
+                              << " expected=0x" << expected
+                              << " actual=0x" << actual << std::dec << "\n";
+                }
+                mismatches++;
+            }
+        }
+
+        std::cout << "[ZTB] SD-to-DDR verification: "
+                  << (mismatches == 0 ? "MATCH" : "MISMATCH")
+                  << " (" << mismatches << " differing ELF words)\n";
+    }
+
+    // --- Future manual-control seams (not implemented yet) -----------------
+    // void pause();
+    // void resume();
+    // void poke_mem(uint32_t addr, uint32_t data);
+    // void force_irq(uint8_t vector);
+
+private:
+    int run_loop(uint32_t tohost_addr) {
         std::cout << "[ZTB] start (max_cycles="
                 << (max_cycles_
                         ? std::to_string(max_cycles_)
@@ -443,41 +958,118 @@ public:
         return 0;
     }
 
-    void set_tohost(uint32_t a) { tohost_addr_ = a; }
+    void dump(WallClock::time_point& t0) {
+        if (!tfp_)
+            return;
 
-    void verify_ddr_image(const ElfImage& img) {
-        size_t mismatches = 0;
+        tfp_->dump(sim_time_);
+        t0 = account(dump_ns_, t0);
+    }
 
-        for (const auto& [addr, expected] : img.words) {
-            if (addr < USER_BASE)
-                continue;
+    // Add the time since 't0' to 'bucket' and return the new timestamp.
+    static WallClock::time_point account(uint64_t& bucket, WallClock::time_point t0) {
+        const WallClock::time_point now = WallClock::now();
+        bucket += elapsed_ns(t0, now);
+        return now;
+    }
 
-            const uint32_t actual = peek_insn(addr);
-            if (actual != expected) {
-                if (mismatches < 8) {
-                    std::cout << "[ZTB] DDR mismatch @0x" << std::hex << addr
-                              << " expected=0x" << expected
-                              << " actual=0x" << actual << std::dec << "\n";
-                }
-                mismatches++;
-            }
+
+    // --- Telemetry ----------------------------------------------------------
+    static constexpr uint64_t STATS_POLL_CYCLES = 1u << 14;   // power of two
+
+    void poll_stats() {
+        const WallClock::time_point now = WallClock::now();
+        const double window = elapsed_ns(last_stats_, now) * 1e-9;
+
+        if (window < stats_interval_)
+            return;
+
+        const uint64_t cycles  = cycles_ - last_stats_cycles_;
+        const uint64_t retired = retired_ - last_stats_retired_;
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "[ZTB] stats: cycle=" << cycles_
+                  << " retired=" << retired_
+                  << " | " << cycles / window / 1e3 << " kcycles/s "
+                  << retired / window / 1e3 << " kinsn/s IPC="
+                  << (cycles ? double(retired) / cycles : 0.0)
+                  << std::defaultfloat << "\n";
+
+        last_stats_ = now;
+        last_stats_cycles_ = cycles_;
+        last_stats_retired_ = retired_;
+    }
+
+    // End-of-run summary on stdout and in out/sim_stats.json. eval time is
+    // reported without the DPI callbacks it contains; "other" is everything
+    // left over (loop overhead, tohost checks, printing outside drain).
+    void report_stats(int rc) {
+        const double wall  = elapsed_ns(run_start_, WallClock::now()) * 1e-9;
+        const double eval  = (eval_ns_ - std::min(eval_ns_, g_dpi_ns)) * 1e-9;
+        const double dpi   = g_dpi_ns * 1e-9;
+        const double dump  = dump_ns_ * 1e-9;
+        const double drain = drain_ns_ * 1e-9;
+        const double other = std::max(0.0, wall - eval - dpi - dump - drain);
+
+        const double cps = wall > 0 ? cycles_ / wall : 0.0;
+        const double ips = wall > 0 ? retired_ / wall : 0.0;
+        const double ipc = cycles_ ? double(retired_) / cycles_ : 0.0;
+
+        auto pct = [wall](double t) { return wall > 0 ? 100.0 * t / wall : 0.0; };
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << "[ZTB] run: " << cycles_ << " cycles, " << retired_
+                  << " retired in " << wall << " s | "
+                  << cps / 1e3 << " kcycles/s " << ips / 1e3
+                  << " kinsn/s IPC=" << std::setprecision(3) << ipc << "\n"
+                  << std::setprecision(1)
+                  << "[ZTB] wall: eval " << pct(eval) << "% | dpi " << pct(dpi)
+                  << "% | fst " << pct(dump) << "% | trace " << pct(drain)
+                  << "% | other " << pct(other) << "%\n"
+                  << std::defaultfloat;
+
+        std::ofstream json("out/sim_stats.json", std::ios::out | std::ios::trunc);
+        if (!json.is_open()) {
+            std::cerr << "[ZTB] WARN: cannot write out/sim_stats.json\n";
+            return;
         }
 
-        std::cout << "[ZTB] SD-to-DDR verification: "
-                  << (mismatches == 0 ? "MATCH" : "MISMATCH")
-                  << " (" << mismatches << " differing ELF words)\n";
+        json << std::setprecision(9)
+             << "{\n"
+             << "  \"exit_code\": " << rc << ",\n"
+             << "  \"cycles\": " << cycles_ << ",\n"
+             << "  \"retired\": " << retired_ << ",\n"
+             << "  \"ipc\": " << ipc << ",\n"
+             << "  \"wall_s\": " << wall << ",\n"
+             << "  \"cycles_per_s\": " << cps << ",\n"
+             << "  \"insns_per_s\": " << ips << ",\n"
+             << "  \"wave\": " << (tfp_ ? "true" : "false") << ",\n"
+             << "  \"trace_print\": " << (enable_print_ ? "true" : "false") << ",\n"
+             << "  \"breakdown_s\": {\n"
+             << "    \"eval\": " << eval << ",\n"
+             << "    \"dpi\": " << dpi << ",\n"
+             << "    \"fst_dump\": " << dump << ",\n"
+             << "    \"trace_drain\": " << drain << ",\n"
+             << "    \"other\": " << other << "\n"
+             << "  }\n"
+             << "}\n";
     }
 
-    // --- Future manual-control seams (not implemented yet) -----------------
-    // void pause();
-    // void resume();
-    // void poke_mem(uint32_t addr, uint32_t data);
-    // void force_irq(uint8_t vector);
+    // Drop cached disassembly for every instruction overlapping a store of
+    // 'bytes' at 'addr'. Stores outside [code_lo_, code_hi_) cost one compare.
+    void invalidate_code(uint32_t addr, uint32_t bytes) {
+        if (addr >= code_hi_ || addr + bytes <= code_lo_)
+            return;
 
-private:
-    void dump() {
-        if (tfp_)
-            tfp_->dump(sim_time_);
+        // A 4-byte instruction at PC overlaps when PC > addr - 4 (PCs are even)
+        uint32_t pc = (addr & ~1u) >= 2 ? (addr & ~1u) - 2 : 0;
+
+        for (; pc < addr + bytes; pc += 2) {
+            disasm_cache_.erase(pc);
+
+            if (cpi_stack_)
+                cpi_stack_->invalidate(pc);
+        }
     }
 
     // Pop retired events, print them, and watch for the tohost store.
@@ -486,6 +1078,18 @@ private:
             TraceEvent e = g_events.front();
             g_events.pop_front();
 
+            if (!e.is_exception)
+                retired_++;
+
+            if (cpi_stack_) {
+                cpi_stack_->retire(e, cycles_ - last_retire_cycle_);
+
+                // Decoded PCs must be covered by invalidate_code() even
+                // when nothing is disassembled (+notrace)
+                code_lo_ = std::min(code_lo_, e.pc);
+                code_hi_ = std::max(code_hi_, e.pc + 4);
+            }
+
             recent_events_.push_back(e);
             if (recent_events_.size() > 32)
                 recent_events_.pop_front();
@@ -500,7 +1104,10 @@ private:
                 finished_ = true;
             }
 
-            if (enable_print_ && cycles_ >= trace_start_)
+            if (e.is_store)
+                invalidate_code(e.mem_addr, 1u << std::min<uint32_t>(e.mem_width, 2));
+
+            if (enable_print_ && cycles_ >= trace_start_ && filter_.accepts(e))
                 print_event(e);
         }
     }
@@ -522,13 +1129,10 @@ private:
         }
 
         // Disassemble the word fetched at PC (DDR region only).
-        uint32_t word = peek_insn(e.pc);
-        insn_t insn(word);
-
         os << std::setfill(' ')
            << std::left
            << std::setw(28)
-           << dis_.disassemble(insn)
+           << disassemble_at(e.pc)
            << std::right;
 
         if (e.rd != 0) {
@@ -585,8 +1189,18 @@ private:
     uint64_t trace_start_;
     uint64_t max_cycles_;
     uint64_t cycles_ = 0;
+    uint64_t retired_ = 0;
     uint64_t sim_time_ = 0;
 
+    double stats_interval_;
+    WallClock::time_point run_start_;
+    WallClock::time_point last_stats_;
+    uint64_t last_stats_cycles_ = 0;
+    uint64_t last_stats_retired_ = 0;
+    uint64_t eval_ns_ = 0;
+    uint64_t dump_ns_ = 0;
+    uint64_t drain_ns_ = 0;
+
     uint32_t tohost_addr_ = 0;
     bool tohost_hit_ = false;
     uint32_t tohost_value_ = 0;
@@ -595,8 +1209,15 @@ private:
     std::deque<TraceEvent> recent_events_;
     uint64_t last_retire_cycle_ = 0;
 
+    TraceFilter filter_;
+    std::unique_ptr<CpiStack> cpi_stack_;
+
     isa_parser_t isa_;
     disassembler_t dis_;
+
+    std::unordered_map<uint32_t, std::string> disasm_cache_;
+    uint32_t code_lo_ = UINT32_MAX;
+    uint32_t code_hi_ = 0;
 };
 
 // ============================================================================
@@ -625,6 +1246,11 @@ int main(int argc, char** argv) {
     bool enable_print = true;
     uint64_t trace_start = 0;
     uint64_t max_cycles = 0;   // 0 = unlimited
+    double stats_interval = 10.0;   // seconds, 0 = end-of-run report only
+    std::vector<std::string> trace_filters;
+    bool cpi_stack = false;
+    EthPhyModel::Config eth;
+    SpiFlashModel::Config flash;
 
     for (int i = 1; i < argc; i++) {
         std::string a(argv[i]);
@@ -645,12 +1271,39 @@ int main(int argc, char** argv) {
             trace_start = std::stoull(a.substr(13));
         else if (a.rfind("+max_cycles=", 0) == 0)
             max_cycles = std::stoull(a.substr(12));
+        else if (a.rfind("+trace_filter=", 0) == 0)
+            trace_filters.push_back(a.substr(14));
+        else if (a.rfind("+stats_interval=", 0) == 0)
+            stats_interval = std::stod(a.substr(16));
+        else if (a == "+cpi_stack")
+            cpi_stack = true;
+        else if (a == "+eth_loopback")
+            eth.loopback = true;
+        else if (a.rfind("+eth_tx_pcap=", 0) == 0)
+            eth.tx_pcap = a.substr(13);
+        else if (a.rfind("+eth_rx_pcap=", 0) == 0)
+            eth.rx_pcap = a.substr(13);
+        else if (a.rfind("+eth_gap=", 0) == 0)
+            eth.gap = std::stoul(a.substr(9), nullptr, 0);
+        else if (a.rfind("+eth_rx_start=", 0) == 0)
+            eth.rx_start = std::stoull(a.substr(14), nullptr, 0);
+        else if (a.rfind("+flash=", 0) == 0)
+            flash.image = a.substr(7);
+        else if (a.rfind("+flash_page_cycles=", 0) == 0)
+            flash.page_cycles = std::stoull(a.substr(19), nullptr, 0);
+        else if (a.rfind("+flash_sector_cycles=", 0) == 0)
+            flash.sector_cycles = std::stoull(a.substr(21), nullptr, 0);
     }
 
     if (fw_path.empty() && sd_path.empty()) {
         std::cerr << "[ZTB] usage: " << argv[0]
                   << " +firmware=fw.elf [+boot=boot.elf] [+wave] [+notrace]"
-                  << " [+sd=image.bin|hex] [+sd_block=N] [+max_cycles=N]\n";
+                  << " [+sd=image.bin|hex] [+sd_block=N] [+max_cycles=N]"
+                  << " [+trace_filter=pc:LO-HI,sym:NAME,class:A|B]"
+                  << " [+stats_interval=SEC] [+cpi_stack]"
+                  << " [+eth_loopback] [+eth_tx_pcap=F] [+eth_rx_pcap=F]"
+                  << " [+eth_gap=CYCLES] [+eth_rx_start=CYCLE]"
+                  << " [+flash=image.bin] [+flash_page_cycles=N] [+flash_sector_cycles=N]\n";
         return 2;
     }
 
@@ -662,15 +1315,36 @@ int main(int argc, char** argv) {
         return 2;
     }
 
+    // Firmware without LOG() calls has no .zlog: the UART is printed as is
+    std::string log_error;
+    if (!fw_path.empty() && g_log.load(fw_path, log_error))
+        std::cout << "[ZTB] decoding LOG() records with " << fw_path << "\n";
+
+    TraceFilter filter;
+    for (const std::string& spec : trace_filters) {
+        std::string error;
+
+        if (!filter.parse(spec, img, error)) {
+            std::cerr << "[ZTB] bad +trace_filter: " << error << "\n";
+            return 2;
+        }
+    }
+
     if (!sd_path.empty() && !load_sd_image(sd_path, sd_block)) {
         std::cerr << "[ZTB] cannot load SD image: " << sd_path << "\n";
         return 2;
     }
 
+    if (!g_eth.configure(eth))
+        return 2;
+
+    if (!g_flash.configure(flash))
+        return 2;
+
     uart_capture_open("out");
     g_trace_file.open("out/trace.txt", std::ios::out | std::ios::trunc);
 
-    g_sim = new Sim(enable_wave, enable_print, trace_start, max_cycles);
+    g_sim = new Sim(enable_wave, enable_print, trace_start, max_cycles, stats_interval);
     if (!g_sim->scope()) {
         std::cerr << "[ZTB] FATAL: DPI scope zenith_tb_top not found\n";
         return 4;
@@ -682,6 +1356,9 @@ int main(int argc, char** argv) {
     if (sd_path.empty() && !fw_path.empty())
         g_sim->preload_image(img);
     g_sim->set_tohost(img.tohost);
+    g_sim->set_trace_filter(filter);
+    if (cpi_stack)
+        g_sim->enable_cpi_stack(img);
 
     ElfImage boot;
     if (!boot_path.empty() && load_elf(boot_path, boot)) {
@@ -705,6 +1382,9 @@ int main(int argc, char** argv) {
 
     int rc = g_sim->run(img.tohost);
 
+    g_eth.report();
+    g_flash.report();
+
     if (!sd_path.empty() && !fw_path.empty())
         g_sim->verify_ddr_image(img);
 
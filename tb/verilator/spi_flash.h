@@ -0,0 +1,280 @@
+// ============================================================================
+// SPI NOR flash stand-in for the full-SoC testbench (W25Q128JV command set).
+//
+// zenith_tb_top samples MOSI on the SCLK rising edges and shifts MISO out
+// after the falling edges; whole bytes are handed to this model through DPI.
+// For every received byte the model returns the byte to send in the next
+// byte slot, or -1 when it has nothing to send (MISO then falls back to the
+// MOSI loopback).
+//
+//   - 0x9F JEDEC ID, 0x05 read status, 0x06 / 0x04 write enable / disable
+//   - 0x03 read, 0x0B fast read (one dummy byte), addresses wrap at the end
+//   - 0x02 page program: bits are only cleared, the address wraps inside
+//     the 256 byte page (later bytes replace earlier ones)
+//   - 0x20 sector erase (4 KiB), 0xD8 block erase (64 KiB)
+//
+// Program and erase start when the chip select rises after a whole command
+// with the write enable latch set, then the device is busy for a configurable
+// number of cycles: only the status register can be read meanwhile.
+//
+// Times are simulator cycles (10 ns). The SV side passes a 32-bit cycle
+// counter which is extended to 64 bits here.
+// ============================================================================
+
+#ifndef ZENITH_SPI_FLASH_H
+#define ZENITH_SPI_FLASH_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class SpiFlashModel {
+public:
+    static constexpr uint32_t SIZE = 16u << 20;
+    static constexpr uint32_t PAGE_SIZE = 256;
+    static constexpr uint32_t SECTOR_SIZE = 4096;
+    static constexpr uint32_t BLOCK_SIZE = 65536;
+
+    // Winbond, W25Q (SPI), 128 Mbit
+    static constexpr uint8_t JEDEC_ID[3] = { 0xEF, 0x40, 0x18 };
+
+    struct Config {
+        std::string image;                   // raw binary loaded at address 0
+        uint64_t    page_cycles = 50000;     // page program time (500 us)
+        uint64_t    sector_cycles = 500000;  // sector erase time (5 ms)
+        uint64_t    block_cycles = 2000000;  // block erase time (20 ms)
+    };
+
+    SpiFlashModel() : memory_(SIZE, 0xFF) {}
+
+    bool configure(const Config& cfg) {
+        cfg_ = cfg;
+
+        if (cfg.image.empty())
+            return true;
+
+        std::ifstream file(cfg.image, std::ios::binary);
+
+        if (!file) {
+            std::cerr << "[FLASH] cannot open " << cfg.image << "\n";
+            return false;
+        }
+
+        const std::vector<uint8_t> image((std::istreambuf_iterator<char>(file)),
+                                         std::istreambuf_iterator<char>());
+
+        if (image.size() > SIZE) {
+            std::cerr << "[FLASH] " << cfg.image << " is larger than 16 MiB\n";
+            return false;
+        }
+
+        std::copy(image.begin(), image.end(), memory_.begin());
+
+        std::cout << "[FLASH] image loaded: " << cfg.image << " bytes=" << image.size() << "\n";
+        return true;
+    }
+
+
+    // --- Bus ----------------------------------------------------------------
+
+    // Chip select falling edge
+    void select() {
+        index_ = 0;
+        opcode_ = 0;
+        address_ = 0;
+        ignored_ = false;
+        program_.assign(PAGE_SIZE, -1);
+        programmed_ = 0;
+    }
+
+    // Byte received in the current chip select window. Returns the byte to
+    // send in the next slot, -1 for none.
+    int byte(uint8_t data, uint32_t cycle32) {
+        const uint64_t now = extend(cycle32);
+        const uint32_t index = index_++;
+
+        update(now);
+
+        if (index == 0) {
+            opcode_ = data;
+
+            // Busy: everything but the status read is ignored
+            ignored_ = busy(now) && opcode_ != READ_STATUS;
+
+            if (ignored_) {
+                busy_ignored_++;
+                return -1;
+            }
+        }
+
+        if (ignored_)
+            return -1;
+
+        // Address bytes, MSB first
+        if (index >= 1 && index <= 3)
+            address_ = (address_ << 8) | data;
+
+        switch (opcode_) {
+            case JEDEC:
+                return index < 3 ? JEDEC_ID[index] : 0x00;
+
+            case READ_STATUS:
+                status_reads_++;
+                return status(now);
+
+            case READ:
+                return index >= 3 ? next_read() : -1;
+
+            case FAST_READ:
+                return index >= 4 ? next_read() : -1;
+
+            case PAGE_PROGRAM:
+                if (index >= 4)
+                    program_[(address_ + programmed_++) & (PAGE_SIZE - 1)] = data;
+                return -1;
+
+            default:
+                return -1;
+        }
+    }
+
+    // Chip select rising edge: the write and erase commands are executed
+    void deselect(uint32_t cycle32) {
+        const uint64_t now = extend(cycle32);
+
+        update(now);
+
+        if (ignored_ || index_ == 0)
+            return;
+
+        switch (opcode_) {
+            case WRITE_ENABLE:
+                if (index_ == 1)
+                    wel_ = true;
+                break;
+
+            case WRITE_DISABLE:
+                if (index_ == 1)
+                    wel_ = false;
+                break;
+
+            case PAGE_PROGRAM:
+                if (!wel_ || index_ < 4)
+                    break;
+
+                if (programmed_ == 0) {
+                    wel_ = false;
+                    break;
+                }
+
+                for (uint32_t column = 0; column < PAGE_SIZE; column++) {
+                    if (program_[column] >= 0)
+                        memory_[((address_ & ~(PAGE_SIZE - 1)) | column) & (SIZE - 1)] &= program_[column];
+                }
+
+                pages_++;
+                start(now, cfg_.page_cycles);
+                break;
+
+            case SECTOR_ERASE:
+            case BLOCK_ERASE: {
+                if (!wel_ || index_ != 4)
+                    break;
+
+                const uint32_t size = (opcode_ == SECTOR_ERASE) ? SECTOR_SIZE : BLOCK_SIZE;
+                const uint32_t base = address_ & (SIZE - 1) & ~(size - 1);
+
+                std::fill(memory_.begin() + base, memory_.begin() + base + size, 0xFF);
+
+                erases_++;
+                start(now, (opcode_ == SECTOR_ERASE) ? cfg_.sector_cycles : cfg_.block_cycles);
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+
+    // --- Report -------------------------------------------------------------
+
+    void report() const {
+        if (!reads_ && !pages_ && !erases_)
+            return;
+
+        std::cout << "[FLASH] " << reads_ << " bytes read, " << pages_ << " pages programmed, "
+                  << erases_ << " erases | " << status_reads_ << " status reads, "
+                  << busy_ignored_ << " commands ignored while busy\n";
+    }
+
+private:
+    enum Opcode : uint8_t {
+        PAGE_PROGRAM  = 0x02,
+        READ          = 0x03,
+        WRITE_DISABLE = 0x04,
+        READ_STATUS   = 0x05,
+        WRITE_ENABLE  = 0x06,
+        FAST_READ     = 0x0B,
+        SECTOR_ERASE  = 0x20,
+        JEDEC         = 0x9F,
+        BLOCK_ERASE   = 0xD8
+    };
+
+    bool busy(uint64_t now) const { return now < busy_until_; }
+
+    // The write enable latch clears when an operation completes
+    void update(uint64_t now) {
+        if (busy_until_ != 0 && !busy(now)) {
+            wel_ = false;
+            busy_until_ = 0;
+        }
+    }
+
+    // Status register 1: BUSY (bit 0), WEL (bit 1)
+    uint8_t status(uint64_t now) const {
+        return (busy(now) ? 0x01 : 0x00) | (wel_ ? 0x02 : 0x00);
+    }
+
+    void start(uint64_t now, uint64_t cycles) {
+        busy_until_ = now + std::max<uint64_t>(cycles, 1);
+    }
+
+    int next_read() {
+        reads_++;
+        return memory_[address_++ & (SIZE - 1)];
+    }
+
+    uint64_t extend(uint32_t cycle32) {
+        if (cycle32 < last_cycle32_)
+            cycle_high_ += 1ull << 32;
+
+        last_cycle32_ = cycle32;
+        return cycle_high_ | cycle32;
+    }
+
+    Config cfg_;
+    std::vector<uint8_t> memory_;
+
+    uint32_t index_ = 0;
+    uint8_t  opcode_ = 0;
+    uint32_t address_ = 0;
+    bool     ignored_ = false;
+    std::vector<int> program_ = std::vector<int>(PAGE_SIZE, -1);
+    uint32_t programmed_ = 0;
+
+    bool     wel_ = false;
+    uint64_t busy_until_ = 0;
+
+    uint32_t last_cycle32_ = 0;
+    uint64_t cycle_high_ = 0;
+
+    uint64_t reads_ = 0, pages_ = 0, erases_ = 0;
+    uint64_t status_reads_ = 0, busy_ignored_ = 0;
+};
+
+#endif
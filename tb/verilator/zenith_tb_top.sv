@@ -43,13 +43,17 @@ module zenith_tb_top (
     wire  [SPI_DEVICE_NUMBER - 1:0]                   spi_mosi_o;
     wire  [SPI_DEVICE_NUMBER - 1:0]                   spi_miso_i;
 
-    /* Local loopback: a complete transaction does not require a slave model */
-    assign spi_miso_i = spi_mosi_o;
+    /* Local loopback: a complete transaction does not require a slave model.
+     * SPI0 slave 0 is also the flash model below, which drives MISO only
+     * while it answers a command. */
+    for (genvar spi_index = 1; spi_index < SPI_DEVICE_NUMBER; ++spi_index) begin : spi_loopback
+        assign spi_miso_i[spi_index] = spi_mosi_o[spi_index];
+    end
 
     /* GPIO0 drives GPIO1 so software can generate deterministic input edges */
     assign pin_io[0][1] = pin_io[0][0];
 
-    /* RMII Ethernet */
+    /* RMII Ethernet, driven by the PHY model below */
     wire  [1:0] rmii_rxd_io;
     wire        rmii_crsdv_io;
     logic       rmii_rxer_i = '0;
@@ -58,9 +62,9 @@ module zenith_tb_top (
     wire        rmii_refclk_o;
     wire        rmii_rstn_o;
 
-    /* SMI */
+    /* SMI (pulled up on the board, idle MDIO reads 1) */
     wire smi_mdc_o;
-    wire smi_mdio_io;
+    tri1 smi_mdio_io;
 
     /* PDM audio */
     logic pdm_data_i = '0;
@@ -339,6 +343,312 @@ module zenith_tb_top (
     end
 
 
+// ============================================================================
+//      ETHERNET PHY MODEL (eth_phy.h)
+// ============================================================================
+//
+// LAN8720A stand-in at PHY address 1. The MDIO frames and the RMII dibits are
+// decoded here; register accesses and whole bytes go to the C++ model, which
+// checks the FCS, dumps TX frames to pcap and feeds RX from loopback or pcap.
+
+    import "DPI-C" function int unsigned zenith_eth_mdio_read(input int unsigned reg_addr);
+    import "DPI-C" function void zenith_eth_mdio_write(input int unsigned reg_addr, input int unsigned data);
+    import "DPI-C" function int unsigned zenith_eth_slow_link();
+    import "DPI-C" function void zenith_eth_tx_byte(input int unsigned data);
+    import "DPI-C" function void zenith_eth_tx_end(input int unsigned cycle, input int unsigned dibits);
+    import "DPI-C" function int zenith_eth_rx_byte(input int unsigned cycle);
+
+    localparam logic [4:0] ETH_PHY_ADDRESS = 5'd1;
+
+    int unsigned eth_cycle;
+
+    /* 10 Mbps link, updated after every MDIO write */
+    logic eth_slow;
+
+    always_ff @(posedge clk) begin
+        eth_cycle <= eth_cycle + 1;
+    end
+
+
+    /* MDIO slave: bits are sampled on MDC rising edges, read data is driven
+     * after the falling edges (TA bit 2 first, then D15..D0) */
+    typedef enum logic [2:0] {MDIO_IDLE, MDIO_START, MDIO_HEADER, MDIO_READ, MDIO_WRITE} mdio_state_t;
+
+    mdio_state_t mdio_state;
+    logic [11:0] mdio_header;     /* OP[1:0], PHYAD[4:0], REGAD[4:0] */
+    logic [16:0] mdio_shift;
+    logic [4:0]  mdio_count;
+    logic        mdc_prev, mdio_oe, mdio_out;
+
+    assign smi_mdio_io = mdio_oe ? mdio_out : 1'bz;
+
+    always_ff @(posedge clk) begin
+        mdc_prev <= smi_mdc_o;
+
+        if (!rst_n) begin
+            mdio_state <= MDIO_IDLE;
+            mdio_oe <= 1'b0;
+            eth_slow <= 1'b0;
+        end else if (smi_mdc_o & !mdc_prev) begin
+            case (mdio_state)
+                /* Preamble is all ones, the first zero is the ST field */
+                MDIO_IDLE: begin
+                    if (!smi_mdio_io) mdio_state <= MDIO_START;
+                end
+
+                MDIO_START: begin
+                    mdio_state <= smi_mdio_io ? MDIO_HEADER : MDIO_IDLE;
+                    mdio_count <= '0;
+                end
+
+                MDIO_HEADER: begin
+                    automatic logic [11:0] header = {mdio_header[10:0], smi_mdio_io};
+                    automatic int unsigned data;
+
+                    mdio_header <= header;
+                    mdio_count <= mdio_count + 1'b1;
+
+                    if (mdio_count == 5'd11) begin
+                        mdio_count <= '0;
+
+                        if (header[9:5] != ETH_PHY_ADDRESS) begin
+                            mdio_state <= MDIO_IDLE;
+                        end else if (header[11:10] == 2'b10) begin
+                            data = zenith_eth_mdio_read({27'b0, header[4:0]});
+
+                            mdio_state <= MDIO_READ;
+                            mdio_shift <= {1'b0, data[15:0]};
+                        end else if (header[11:10] == 2'b01) begin
+                            mdio_state <= MDIO_WRITE;
+                        end else begin
+                            mdio_state <= MDIO_IDLE;
+                        end
+                    end
+                end
+
+                /* Two TA bits then 16 data bits, release after D0 */
+                MDIO_READ: begin
+                    mdio_count <= mdio_count + 1'b1;
+
+                    if (mdio_count == 5'd17) begin
+                        mdio_state <= MDIO_IDLE;
+                        mdio_oe <= 1'b0;
+                    end
+                end
+
+                MDIO_WRITE: begin
+                    mdio_count <= mdio_count + 1'b1;
+                    mdio_shift <= {mdio_shift[15:0], smi_mdio_io};
+
+                    if (mdio_count == 5'd17) begin
+                        mdio_state <= MDIO_IDLE;
+
+                        zenith_eth_mdio_write({27'b0, mdio_header[4:0]}, {16'b0, mdio_shift[14:0], smi_mdio_io});
+                        eth_slow <= zenith_eth_slow_link() != 0;
+                    end
+                end
+
+                default: mdio_state <= MDIO_IDLE;
+            endcase
+        end else if (!smi_mdc_o & mdc_prev) begin
+            if ((mdio_state == MDIO_READ) && (mdio_count != '0)) begin
+                mdio_oe <= 1'b1;
+                mdio_out <= mdio_shift[16];
+                mdio_shift <= mdio_shift << 1;
+            end
+        end
+    end
+
+
+    /* RMII: one dibit per REF_CLK period at 100 Mbps, each dibit held for
+     * 10 periods at 10 Mbps. REF_CLK high here is the MAC shift pulse. */
+    logic [3:0] eth_divider;
+    logic       eth_strobe;
+
+    assign eth_strobe = rmii_refclk_o & (!eth_slow | (eth_divider == 4'd9));
+
+    always_ff @(posedge clk) begin
+        if (!rst_n) begin
+            eth_divider <= '0;
+        end else if (rmii_refclk_o) begin
+            eth_divider <= (eth_divider == 4'd9) ? '0 : (eth_divider + 1'b1);
+        end
+    end
+
+
+    /* TX: bytes are assembled LSB dibit first while TX_EN is high */
+    logic [7:0]  eth_tx_shift;
+    int unsigned eth_tx_dibits;
+
+    always_ff @(posedge clk) begin
+        if (!rst_n) begin
+            eth_tx_dibits <= 0;
+        end else if (eth_strobe) begin
+            if (rmii_txen_o) begin
+                automatic logic [7:0] shift = {rmii_txd_o, eth_tx_shift[7:2]};
+
+                eth_tx_shift <= shift;
+                eth_tx_dibits <= eth_tx_dibits + 1;
+
+                if (eth_tx_dibits[1:0] == 2'd3) begin
+                    zenith_eth_tx_byte({24'b0, shift});
+                end
+            end else if (eth_tx_dibits != 0) begin
+                zenith_eth_tx_end(eth_cycle, eth_tx_dibits);
+                eth_tx_dibits <= 0;
+            end
+        end
+    end
+
+
+    /* RX: the model is polled once per byte slot, CRS_DV follows the frame.
+     * While the PHY is held in reset the MAC drives the strap values. */
+    logic [1:0] eth_rxd;
+    logic [7:0] eth_rx_shift;
+    logic [1:0] eth_rx_dibit;
+    logic       eth_crsdv;
+
+    assign rmii_rxd_io   = rmii_rstn_o ? eth_rxd   : 2'bzz;
+    assign rmii_crsdv_io = rmii_rstn_o ? eth_crsdv : 1'bz;
+
+    always_ff @(posedge clk) begin
+        if (!rst_n | !rmii_rstn_o) begin
+            eth_rxd <= '0;
+            eth_crsdv <= 1'b0;
+            eth_rx_dibit <= '0;
+        end else if (eth_strobe) begin
+            eth_rx_dibit <= eth_rx_dibit + 1'b1;
+
+            if (eth_rx_dibit == '0) begin
+                automatic int next = zenith_eth_rx_byte(eth_cycle);
+
+                eth_crsdv <= next >= 0;
+                eth_rxd <= (next >= 0) ? next[1:0] : 2'b00;
+                eth_rx_shift <= (next >= 0) ? {2'b00, next[7:2]} : '0;
+            end else begin
+                eth_rxd <= eth_rx_shift[1:0];
+                eth_rx_shift <= eth_rx_shift >> 2;
+            end
+        end
+    end
+
+
+
+// ============================================================================
+//      SPI NOR FLASH MODEL (spi_flash.h)
+// ============================================================================
+//
+// W25Q128 stand-in on SPI0 slave 0 (mode 0, MSB first). MOSI is sampled on the
+// SCLK rising edges and MISO shifted after the falling edges; whole bytes go
+// to the C++ model, which answers with the byte of the next slot. Without an
+// answer MISO is the MOSI loopback, as for every other SPI slave.
+//
+// MISO changes one cycle after SCLK falls and the controller synchronizes it
+// with two flops: up to SYSTEM_FREQUENCY / 8 (12.5 MHz) is sampled correctly.
+
+    import "DPI-C" function void zenith_flash_select();
+    import "DPI-C" function int zenith_flash_byte(input int unsigned data, input int unsigned cycle);
+    import "DPI-C" function void zenith_flash_deselect(input int unsigned cycle);
+
+    int unsigned flash_cycle;
+
+    logic       flash_cs_n, flash_cs_prev;
+    logic       flash_sclk, flash_sclk_prev;
+    logic [7:0] flash_in, flash_out, flash_next;
+    logic [2:0] flash_bits;
+    logic       flash_drive, flash_next_valid;
+
+    assign flash_cs_n = spi_cs_n_o[0][0];
+    assign flash_sclk = spi_sclk_o[0];
+
+    assign spi_miso_i[0] = flash_drive ? flash_out[7] : spi_mosi_o[0];
+
+    always_ff @(posedge clk) begin
+        flash_cycle <= flash_cycle + 1;
+        flash_cs_prev <= flash_cs_n;
+        flash_sclk_prev <= flash_sclk;
+
+        if (!rst_n) begin
+            flash_cs_prev <= 1'b1;
+            flash_bits <= '0;
+            flash_drive <= 1'b0;
+            flash_next_valid <= 1'b0;
+        end else if (flash_cs_n) begin
+            if (!flash_cs_prev) begin
+                zenith_flash_deselect(flash_cycle);
+            end
+
+            flash_bits <= '0;
+            flash_drive <= 1'b0;
+            flash_next_valid <= 1'b0;
+        end else begin
+            if (flash_cs_prev) begin
+                zenith_flash_select();
+            end
+
+            if (flash_sclk & !flash_sclk_prev) begin
+                automatic logic [7:0] data = {flash_in[6:0], spi_mosi_o[0]};
+
+                flash_in <= data;
+                flash_bits <= flash_bits + 1'b1;
+
+                if (flash_bits == 3'd7) begin
+                    automatic int next = zenith_flash_byte({24'b0, data}, flash_cycle);
+
+                    flash_next_valid <= next >= 0;
+                    flash_next <= next[7:0];
+                end
+            end else if (!flash_sclk & flash_sclk_prev) begin
+                /* A new byte slot starts after the eighth rising edge */
+                if (flash_bits == '0) begin
+                    flash_drive <= flash_next_valid;
+                    flash_out <= flash_next;
+                    flash_next_valid <= 1'b0;
+                end else begin
+                    flash_out <= {flash_out[6:0], 1'b1};
+                end
+            end
+        end
+    end
+
+
+// ============================================================================
+//      CPI STACK HINTS (+cpi_stack)
+// ============================================================================
+//
+// Cache controller FSM states the harness cannot infer from the retire stream.
+// Sampled every cycle and reported only when at least one is active, so the
+// DPI call costs nothing while the caches hit.
+
+    `define ICTRL dut.ApogeoRV.icache.controller
+    `define DLCTRL dut.ApogeoRV.dcache.load_cache_controller
+    `define DSCTRL dut.ApogeoRV.dcache.store_cache_controller
+
+    import "DPI-C" function void zenith_perf_hint(input int unsigned hints);
+
+    /* Bit positions must match PERF_HINT_* in sim_main.cpp */
+    logic [2:0] perf_hints;
+
+    /* fetch_controller: ALLOCATION_REQ, WAIT_BUNDLE, ALLOCATE */
+    assign perf_hints[0] = `ICTRL.state_CRT >= 3'd3;
+
+    /* load_controller: ALLOCATION_REQ, ALLOCATE, WRITE_BACK */
+    assign perf_hints[1] = `DLCTRL.state_CRT >= 3'd3;
+
+    /* store_controller: WRITE_THROUGH (store miss) */
+    assign perf_hints[2] = `DSCTRL.state_CRT == 3'd4;
+
+    bit cpi_stack_enable;
+
+    initial cpi_stack_enable = $test$plusargs("cpi_stack");
+
+    always_ff @(posedge clk) begin
+        if (rst_n && cpi_stack_enable && (perf_hints != '0)) begin
+            zenith_perf_hint({29'b0, perf_hints});
+        end
+    end
+
+
 // ============================================================================
 //      MANUAL-CONTROL SCAFFOLDING (future feature, not implemented yet)
 // ============================================================================
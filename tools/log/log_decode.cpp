@@ -0,0 +1,63 @@
+// ============================================================================
+// Tokenized log decoder.
+//
+// Expands the LOG() records of a UART capture (or of a live serial port read
+// on stdin) back to text, with the format strings of the firmware ELF. Plain
+// Serial_IO text in the capture is copied unchanged.
+//
+// Usage:
+//   log_decode firmware.elf [capture.bin]
+//   cat /dev/ttyUSB1 | log_decode firmware.elf
+// ============================================================================
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "log_decoder.h"
+
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "usage: " << argv[0] << " firmware.elf [capture.bin]\n"
+                  << "  reads the capture from stdin when no file is given\n";
+        return 2;
+    }
+
+    LogDecoder decoder;
+    std::string error;
+
+    if (!decoder.load(argv[1], error)) {
+        std::cerr << error << "\n";
+        return 2;
+    }
+
+    std::ifstream file;
+    if (argc == 3) {
+        file.open(argv[2], std::ios::binary);
+
+        if (!file) {
+            std::cerr << "cannot open " << argv[2] << "\n";
+            return 2;
+        }
+    }
+
+    std::istream& in = (argc == 3) ? file : std::cin;
+    std::string text;
+    char byte;
+
+    // Line buffered: a live capture shows every record as it arrives
+    while (in.get(byte)) {
+        decoder.feed(static_cast<uint8_t>(byte), text);
+
+        if (!text.empty() && text.back() == '\n') {
+            std::cout << text << std::flush;
+            text.clear();
+        }
+    }
+
+    std::cout << text << std::flush;
+
+    return 0;
+}
@@ -0,0 +1,255 @@
+// ============================================================================
+// Decoder for the tokenized firmware log (sw/lib/Log.h).
+//
+// The firmware sends LOG() records mixed with plain Serial_IO text:
+//
+//   0xFE  header word  argument words...      (little endian)
+//
+// header = argument word count << 24 | offset of the format string in .zlog.
+// The format strings are read from the .zlog section of the firmware ELF, the
+// section is not loaded so they exist only in the file. Bytes outside a
+// record are passed through unchanged, every record becomes one text line.
+//
+// Shared by tools/log/log_decode and the Verilator testbench UART capture.
+// ============================================================================
+
+#ifndef ZENITH_LOG_DECODER_H
+#define ZENITH_LOG_DECODER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class LogDecoder {
+public:
+    static constexpr uint8_t  MARKER = 0xFE;
+    static constexpr uint32_t DROPPED_ID = 0xFFFFFF;
+
+    // Read the .zlog section of a firmware ELF. Returns false (with a
+    // message) when the file is not an ELF32 or has no LOG() strings.
+    bool load(const std::string& elf_path, std::string& error) {
+        std::ifstream file(elf_path, std::ios::binary);
+        if (!file) {
+            error = "cannot open " + elf_path;
+            return false;
+        }
+
+        const std::vector<uint8_t> elf((std::istreambuf_iterator<char>(file)),
+                                       std::istreambuf_iterator<char>());
+
+        if (elf.size() < 52 || std::memcmp(elf.data(), "\x7f" "ELF", 4) != 0 ||
+            elf[4] != 1 || elf[5] != 1) {
+            error = elf_path + " is not a little endian ELF32 file";
+            return false;
+        }
+
+        const uint32_t shoff = read32(elf, 32);
+        const uint32_t shentsize = read16(elf, 46);
+        const uint32_t shnum = read16(elf, 48);
+        const uint32_t shstrndx = read16(elf, 50);
+
+        if (shoff == 0 || shstrndx >= shnum ||
+            uint64_t(shoff) + uint64_t(shnum) * shentsize > elf.size()) {
+            error = elf_path + " has no section headers";
+            return false;
+        }
+
+        const uint32_t names = read32(elf, shoff + shstrndx * shentsize + 16);
+
+        for (uint32_t i = 0; i < shnum; ++i) {
+            const uint32_t header = shoff + i * shentsize;
+            const uint32_t name = names + read32(elf, header);
+
+            if (name >= elf.size() ||
+                std::strncmp(reinterpret_cast<const char*>(&elf[name]), ".zlog", elf.size() - name) != 0)
+                continue;
+
+            const uint32_t addr = read32(elf, header + 12);
+            const uint32_t offset = read32(elf, header + 16);
+            const uint32_t size = read32(elf, header + 20);
+
+            if (uint64_t(offset) + size > elf.size()) {
+                error = elf_path + ": truncated .zlog section";
+                return false;
+            }
+
+            // An orphan (loaded) .zlog works too: the ID is the string
+            // address, the section base is removed modulo 2^24
+            base_ = addr & DROPPED_ID;
+            strings_.assign(elf.begin() + offset, elf.begin() + offset + size);
+            strings_.push_back('\0');
+            return true;
+        }
+
+        error = elf_path + " has no .zlog section (no LOG() call)";
+        return false;
+    }
+
+    bool loaded() const { return !strings_.empty(); }
+
+    // Feed one received byte. Decoded lines and plain text are appended to out.
+    void feed(uint8_t byte, std::string& out) {
+        if (!loaded()) {
+            out.push_back(static_cast<char>(byte));
+            return;
+        }
+
+        switch (state_) {
+            case State::TEXT:
+                if (byte == MARKER) {
+                    state_ = State::HEADER;
+                    bytes_ = 0;
+                    words_.clear();
+                } else {
+                    out.push_back(static_cast<char>(byte));
+                }
+                break;
+
+            case State::HEADER:
+            case State::ARGUMENTS:
+                word_ = (bytes_ == 0) ? byte : (word_ | (uint32_t(byte) << (bytes_ * 8)));
+
+                if (++bytes_ < 4)
+                    break;
+
+                bytes_ = 0;
+
+                if (state_ == State::HEADER) {
+                    header_ = word_;
+                    state_ = State::ARGUMENTS;
+                } else {
+                    words_.push_back(word_);
+                }
+
+                if (words_.size() == (header_ >> 24)) {
+                    out += format(header_ & DROPPED_ID, words_);
+                    out.push_back('\n');
+                    state_ = State::TEXT;
+                }
+                break;
+        }
+    }
+
+    // Expand one record with the Serial_IO::printf format characters.
+    std::string format(uint32_t id, const std::vector<uint32_t>& args) const {
+        if (id == DROPPED_ID)
+            return "[LOG] " + std::to_string(args.empty() ? 0 : args[0]) + " records dropped";
+
+        const uint32_t offset = (id - base_) & DROPPED_ID;
+
+        if (offset >= strings_.size())
+            return "[LOG] unknown string 0x" + hex(id, 6);
+
+        const char* f = &strings_[offset];
+        std::string text;
+        size_t next = 0;
+
+        auto arg32 = [&]() -> uint32_t {
+            return next < args.size() ? args[next++] : 0;
+        };
+        auto arg64 = [&]() -> uint64_t {
+            const uint64_t low = arg32();
+            return low | (uint64_t(arg32()) << 32);
+        };
+
+        for (size_t i = 0; f[i] != '\0'; ++i) {
+            if (f[i] != '%') {
+                text.push_back(f[i]);
+                continue;
+            }
+
+            switch (f[++i]) {
+                case 'd': text += std::to_string(int32_t(arg32())); break;
+                case 'u': text += std::to_string(arg32()); break;
+                case 'l': text += std::to_string(int64_t(arg64())); break;
+                case 'c': text.push_back(static_cast<char>(arg32())); break;
+                case '%': text.push_back('%'); break;
+
+                case 'x':
+                case 'b': {
+                    const bool binary = f[i] == 'b';
+                    unsigned bits = 32;
+
+                    switch (f[i + 1]) {
+                        case 'b': bits = 8; ++i; break;
+                        case 'h': bits = 16; ++i; break;
+                        case 'd': bits = 64; ++i; break;
+                        default: break;
+                    }
+
+                    const uint64_t value = (bits == 64) ? arg64() : arg32();
+                    text += binary ? bin(value, bits) : hex(value, bits / 4);
+                    break;
+                }
+
+                case '.':
+                case 'f': {
+                    unsigned precision = 6;
+
+                    if (f[i] == '.') {
+                        precision = 0;
+                        while (f[i + 1] >= '0' && f[i + 1] <= '9')
+                            precision = precision * 10 + unsigned(f[++i] - '0');
+                        if (f[++i] != 'f')
+                            return text + "[PRINT] FORMAT ERROR!";
+                    }
+
+                    const uint32_t bits = arg32();
+                    float value;
+                    std::memcpy(&value, &bits, 4);
+
+                    char buffer[64];
+                    std::snprintf(buffer, sizeof(buffer), "%.*f", precision, double(value));
+                    text += buffer;
+                    break;
+                }
+
+                default:
+                    return text + "[PRINT] FORMAT ERROR!";
+            }
+        }
+
+        return text;
+    }
+
+private:
+    enum class State { TEXT, HEADER, ARGUMENTS };
+
+    static uint32_t read16(const std::vector<uint8_t>& d, uint32_t at) {
+        return at + 2 <= d.size() ? uint32_t(d[at]) | (uint32_t(d[at + 1]) << 8) : 0;
+    }
+
+    static uint32_t read32(const std::vector<uint8_t>& d, uint32_t at) {
+        return at + 4 <= d.size() ? read16(d, at) | (read16(d, at + 2) << 16) : 0;
+    }
+
+    // Fixed width, upper case, as Serial_IO::writeH()
+    static std::string hex(uint64_t value, unsigned digits) {
+        std::string s(digits, '0');
+        for (unsigned i = 0; i < digits; ++i, value >>= 4)
+            s[digits - 1 - i] = "0123456789ABCDEF"[value & 0xF];
+        return s;
+    }
+
+    static std::string bin(uint64_t value, unsigned bits) {
+        std::string s(bits, '0');
+        for (unsigned i = 0; i < bits; ++i, value >>= 1)
+            s[bits - 1 - i] = (value & 1) ? '1' : '0';
+        return s;
+    }
+
+    std::vector<char>     strings_;
+    uint32_t              base_ = 0;
+
+    State                 state_ = State::TEXT;
+    unsigned              bytes_ = 0;
+    uint32_t              word_ = 0;
+    uint32_t              header_ = 0;
+    std::vector<uint32_t> words_;
+};
+
+#endif
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""Build an SD boot image from an RV32 application ELF.
+
+The layout matches sw/benchmark/CoreMark/bootloader/boot_image.h: a header
+block with the entry point and the load segments, then every PT_LOAD segment
+padded to a block boundary so the bootloader can stream it with CMD18.
+
+With --lz4 the segments are stored as LZ4 blocks (sw/lib/LZ4.h), a segment
+that doesn't shrink is stored as is. With --write the image is written to a
+device or disk image at the boot block.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+BLOCK_SIZE = 512
+
+BOOT_IMAGE_MAGIC = 0x544F425A
+BOOT_IMAGE_VERSION = 2
+BOOT_MAX_SEGMENTS = 24
+BOOT_BLOCK = 0x2000
+
+PT_LOAD = 1
+
+# magic, version, segmentCount, entry, flags
+HEADER_FORMAT = "<IHHII"
+# loadAddress, size, block, storedSize, crc32
+SEGMENT_FORMAT = "<IIIII"
+
+# LZ4 block format limits
+MIN_MATCH = 4
+LAST_LITERALS = 5
+MATCH_LIMIT = 12
+MAX_OFFSET = 65535
+
+
+def read_segments(elf: bytes):
+    """Return the entry point and the (address, data) of every loaded segment."""
+
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("not a little endian ELF32 file")
+
+    entry, phoff = struct.unpack_from("<II", elf, 24)
+    phentsize, phnum = struct.unpack_from("<HH", elf, 42)
+
+    segments = []
+
+    for index in range(phnum):
+        p_type, p_offset, _, p_paddr, p_filesz = struct.unpack_from(
+            "<IIIII", elf, phoff + index * phentsize
+        )
+
+        # BSS only segments are cleared by the application startup code
+        if p_type != PT_LOAD or p_filesz == 0:
+            continue
+
+        segments.append((p_paddr, elf[p_offset : p_offset + p_filesz]))
+
+    return entry, sorted(segments)
+
+
+def lz4_length(value: int) -> bytes:
+    """Extra length bytes after a nibble of 15."""
+
+    return bytes([255] * (value // 255) + [value % 255])
+
+
+def lz4_compress(data: bytes) -> bytes:
+    """Greedy LZ4 block compressor with a single entry hash table."""
+
+    output = bytearray()
+    table = {}
+    anchor = 0
+    position = 0
+    end = len(data)
+
+    def emit(literals_end, offset=0, match_length=0):
+        literals = data[anchor:literals_end]
+        literal_nibble = min(len(literals), 15)
+        match_nibble = min(match_length - MIN_MATCH, 15) if offset else 0
+
+        output.append((literal_nibble << 4) | match_nibble)
+        if literal_nibble == 15:
+            output.extend(lz4_length(len(literals) - 15))
+        output.extend(literals)
+
+        if offset:
+            output.extend(struct.pack("<H", offset))
+            if match_nibble == 15:
+                output.extend(lz4_length(match_length - MIN_MATCH - 15))
+
+    # A match can't start in the last MATCH_LIMIT bytes and must leave
+    # LAST_LITERALS bytes of literals at the end of the block
+    while position + MATCH_LIMIT <= end:
+        key = data[position : position + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = position
+
+        if candidate is None or position - candidate > MAX_OFFSET:
+            position += 1
+            continue
+
+        length = MIN_MATCH
+        limit = end - LAST_LITERALS - position
+        while length < limit and data[candidate + length] == data[position + length]:
+            length += 1
+
+        while position > anchor and candidate > 0 and data[position - 1] == data[candidate - 1]:
+            position -= 1
+            candidate -= 1
+            length += 1
+
+        emit(position, position - candidate, length)
+        position += length
+        anchor = position
+
+    emit(end)
+    return bytes(output)
+
+
+def build_image(entry: int, segments, compress: bool = False) -> bytes:
+    if len(segments) > BOOT_MAX_SEGMENTS:
+        raise ValueError(f"{len(segments)} segments, at most {BOOT_MAX_SEGMENTS} are supported")
+
+    descriptors = b""
+    payload = b""
+    block = 1
+
+    for address, data in segments:
+        if address & 3:
+            raise ValueError(f"segment at 0x{address:08x} is not word aligned")
+
+        stored = data
+        if compress:
+            compressed = lz4_compress(data)
+            if len(compressed) < len(data):
+                stored = compressed
+
+        descriptors += struct.pack(
+            SEGMENT_FORMAT, address, len(data), block, len(stored), zlib.crc32(data)
+        )
+
+        padded = stored + bytes(-len(stored) % BLOCK_SIZE)
+        payload += padded
+        block += len(padded) // BLOCK_SIZE
+
+    descriptors += bytes(struct.calcsize(SEGMENT_FORMAT) * (BOOT_MAX_SEGMENTS - len(segments)))
+
+    header = struct.pack(HEADER_FORMAT, BOOT_IMAGE_MAGIC, BOOT_IMAGE_VERSION, len(segments), entry, 0)
+    header += descriptors
+    header += struct.pack("<I", zlib.crc32(header))
+    header += bytes(BLOCK_SIZE - len(header))
+
+    return header + payload
+
+
+def parse_args(argv=None):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="application ELF")
+    parser.add_argument("image", help="output image file")
+    parser.add_argument("--lz4", action="store_true", help="store the segments LZ4 compressed")
+    parser.add_argument("--write", metavar="DEVICE", help="also write the image to a device or disk image")
+    parser.add_argument("--block", type=lambda value: int(value, 0), default=BOOT_BLOCK,
+                        help="first block on the device (default 0x2000)")
+    return parser.parse_args(argv)
+
+
+def main(argv=None):
+    args = parse_args(argv)
+
+    with open(args.elf, "rb") as file:
+        elf = file.read()
+
+    try:
+        entry, segments = read_segments(elf)
+        image = build_image(entry, segments, args.lz4)
+    except ValueError as error:
+        print(f"ERROR: {args.elf}: {error}", file=sys.stderr)
+        return 1
+
+    with open(args.image, "wb") as file:
+        file.write(image)
+
+    raw_blocks = 1
+
+    for address, data in segments:
+        print(f"  segment 0x{address:08x} {len(data):8d} bytes")
+        raw_blocks += -(-len(data) // BLOCK_SIZE)
+
+    print(f"Wrote {args.image}: entry 0x{entry:08x}, {len(image) // BLOCK_SIZE} blocks "
+          f"({raw_blocks} uncompressed)")
+
+    if args.write:
+        # Same as dd bs=512 seek=BLOCK conv=notrunc
+        with open(args.write, "r+b") as device:
+            device.seek(args.block * BLOCK_SIZE)
+            device.write(image)
+        print(f"Wrote {args.write} at block 0x{args.block:x}")
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,543 @@
+// ============================================================================
+// Trace-driven branch predictor explorer.
+//
+// Replays testbench retire traces and evaluates direction predictors, BTB
+// sizes and return-address-stack depths together, reporting mispredictions
+// per kilo-instruction (MPKI) per trace. Control flow is recovered from the
+// trace itself: a branch is taken when the next retired PC is not PC + 4, and
+// the next PC is its target.
+//
+// A prediction is correct when the fetch unit would have continued at the
+// right PC: for taken branches and jumps this needs a BTB hit with the right
+// target (or the RAS for returns). The current ApogeoRV integration is
+// gshare:512 with a 512-entry BTB (soc_parameters.sv).
+//
+// Usage:
+//   branch_explorer [options] coremark.trace embench_*.trace
+//     --predictor static-nt,static-t,btfn,bimodal:512,gshare:512:9
+//     --btb 64,512,perfect   --ras 0,4,8   --csv file.csv
+// ============================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "retire_trace.h"
+
+
+//====================================================================================
+//      CONTROL-FLOW CLASSIFICATION
+//====================================================================================
+
+enum class Control { NONE, BRANCH, JUMP, CALL, RETURN, INDIRECT };
+
+// Spike disassembler mnemonics, pseudo-instructions included.
+static Control classify(const RetireRecord& r) {
+    static const char* const branches[] = {
+        "beq", "bne", "blt", "bge", "bltu", "bgeu", "beqz", "bnez", "blez",
+        "bgez", "bltz", "bgtz", "bgt", "ble", "bgtu", "bleu"
+    };
+
+    const std::string& m = r.mnemonic;
+
+    if (!m.empty() && m[0] == 'b') {
+        for (const char* b : branches)
+            if (m == b) return Control::BRANCH;
+    }
+
+    if (m == "ret")
+        return Control::RETURN;
+
+    if (m == "j" || m == "jal")
+        return r.rd == 1 ? Control::CALL : Control::JUMP;
+
+    if (m == "jr" || m == "jalr") {
+        if (r.rd == 1)
+            return Control::CALL;
+        if (r.operands == "ra")
+            return Control::RETURN;
+        return Control::INDIRECT;
+    }
+
+    return Control::NONE;
+}
+
+// Static target from "pc + 12" / "pc - 0x10" operands, 0 when absent.
+static uint32_t static_target(const RetireRecord& r) {
+    const size_t at = r.operands.rfind("pc ");
+    if (at == std::string::npos || at + 4 >= r.operands.size())
+        return 0;
+
+    const char sign = r.operands[at + 3];
+    const long offset = std::strtol(r.operands.c_str() + at + 5, nullptr, 0);
+
+    return sign == '-' ? r.pc - static_cast<uint32_t>(offset)
+                       : r.pc + static_cast<uint32_t>(offset);
+}
+
+
+//====================================================================================
+//      DIRECTION PREDICTORS
+//====================================================================================
+
+class DirectionPredictor {
+public:
+    virtual ~DirectionPredictor() = default;
+    virtual bool predict(uint32_t pc, uint32_t target) = 0;
+    virtual void update(uint32_t pc, bool taken) = 0;
+};
+
+class StaticPredictor : public DirectionPredictor {
+public:
+    enum Kind { NOT_TAKEN, TAKEN, BTFN };
+
+    explicit StaticPredictor(Kind kind) : kind_(kind) {}
+
+    bool predict(uint32_t pc, uint32_t target) override {
+        switch (kind_) {
+            case TAKEN: return true;
+            case BTFN:  return target && target < pc;
+            default:    return false;
+        }
+    }
+
+    void update(uint32_t, bool) override {}
+
+private:
+    Kind kind_;
+};
+
+// 2-bit saturating counters indexed by PC, optionally hashed with global
+// history (gshare).
+class CounterPredictor : public DirectionPredictor {
+public:
+    CounterPredictor(uint32_t entries, uint32_t history_bits)
+        : counters_(entries, 1), mask_(entries - 1), history_bits_(history_bits) {}
+
+    bool predict(uint32_t pc, uint32_t) override {
+        return counters_[index(pc)] >= 2;
+    }
+
+    void update(uint32_t pc, bool taken) override {
+        uint8_t& c = counters_[index(pc)];
+
+        if (taken && c < 3) c++;
+        if (!taken && c > 0) c--;
+
+        if (history_bits_)
+            history_ = ((history_ << 1) | taken) & ((1u << history_bits_) - 1);
+    }
+
+private:
+    uint32_t index(uint32_t pc) const {
+        return ((pc >> 2) ^ history_) & mask_;
+    }
+
+    std::vector<uint8_t> counters_;
+    uint32_t mask_;
+    uint32_t history_bits_;
+    uint32_t history_ = 0;
+};
+
+
+//====================================================================================
+//      TARGET PREDICTION
+//====================================================================================
+
+// Direct-mapped, fully tagged. Size 0 means a perfect BTB.
+class Btb {
+public:
+    explicit Btb(uint32_t entries) : entries_(entries), tags_(entries, 0), targets_(entries, 0) {}
+
+    bool perfect() const { return entries_ == 0; }
+
+    bool lookup(uint32_t pc, uint32_t& target) const {
+        if (!entries_)
+            return true;
+
+        const uint32_t i = (pc >> 2) % entries_;
+        if (tags_[i] != pc)
+            return false;
+
+        target = targets_[i];
+        return true;
+    }
+
+    void update(uint32_t pc, uint32_t target) {
+        if (!entries_)
+            return;
+
+        const uint32_t i = (pc >> 2) % entries_;
+        tags_[i] = pc;
+        targets_[i] = target;
+    }
+
+private:
+    uint32_t entries_;
+    std::vector<uint32_t> tags_;
+    std::vector<uint32_t> targets_;
+};
+
+// Circular return address stack: overflow overwrites the oldest entry.
+class Ras {
+public:
+    explicit Ras(uint32_t depth) : stack_(depth) {}
+
+    bool enabled() const { return !stack_.empty(); }
+
+    void push(uint32_t address) {
+        if (stack_.empty())
+            return;
+
+        top_ = (top_ + 1) % stack_.size();
+        stack_[top_] = address;
+        count_ = std::min<size_t>(count_ + 1, stack_.size());
+    }
+
+    bool pop(uint32_t& address) {
+        if (!count_)
+            return false;
+
+        address = stack_[top_];
+        top_ = (top_ + stack_.size() - 1) % stack_.size();
+        count_--;
+        return true;
+    }
+
+private:
+    std::vector<uint32_t> stack_;
+    size_t top_ = 0;
+    size_t count_ = 0;
+};
+
+
+//====================================================================================
+//      CONFIGURATION UNDER TEST
+//====================================================================================
+
+struct Stats {
+    uint64_t branches = 0;
+    uint64_t taken = 0;
+    uint64_t jumps = 0;        // direct, calls, returns, indirect
+    uint64_t miss_direction = 0;
+    uint64_t miss_target = 0;  // taken branch or direct jump without a BTB target
+    uint64_t miss_return = 0;
+    uint64_t miss_indirect = 0;
+
+    uint64_t mispredicts() const {
+        return miss_direction + miss_target + miss_return + miss_indirect;
+    }
+};
+
+class Configuration {
+public:
+    Configuration(std::string predictor, uint32_t btb, uint32_t ras)
+        : btb_(btb), ras_(ras) {
+        std::ostringstream os;
+        os << predictor << " btb:" << (btb ? std::to_string(btb) : "perfect") << " ras:" << ras;
+        name_ = os.str();
+
+        direction_ = make_predictor(predictor);
+    }
+
+    bool valid() const { return direction_ != nullptr; }
+    const std::string& name() const { return name_; }
+    const Stats& stats() const { return stats_; }
+
+    static std::unique_ptr<DirectionPredictor> make_predictor(const std::string& spec) {
+        std::vector<uint32_t> args;
+        std::istringstream in(spec);
+        std::string kind, item;
+
+        std::getline(in, kind, ':');
+        while (std::getline(in, item, ':'))
+            args.push_back(static_cast<uint32_t>(std::stoul(item, nullptr, 0)));
+
+        auto pow2 = [](uint32_t v) { return v && !(v & (v - 1)); };
+
+        if (kind == "static-nt") return std::make_unique<StaticPredictor>(StaticPredictor::NOT_TAKEN);
+        if (kind == "static-t")  return std::make_unique<StaticPredictor>(StaticPredictor::TAKEN);
+        if (kind == "btfn")      return std::make_unique<StaticPredictor>(StaticPredictor::BTFN);
+
+        if (kind == "bimodal" && args.size() == 1 && pow2(args[0]))
+            return std::make_unique<CounterPredictor>(args[0], 0);
+
+        if (kind == "gshare" && !args.empty() && pow2(args[0])) {
+            uint32_t bits = 0;
+            while ((1u << bits) < args[0]) bits++;
+
+            return std::make_unique<CounterPredictor>(args[0], args.size() > 1 ? args[1] : bits);
+        }
+
+        return nullptr;
+    }
+
+    // 'next_pc' is the PC retired right after 'r'.
+    void execute(const RetireRecord& r, Control kind, uint32_t next_pc) {
+        const bool taken = next_pc != r.pc + 4;
+        uint32_t target = 0;
+        const bool btb_hit = btb_.lookup(r.pc, target);
+        const bool perfect_btb = btb_.perfect();
+
+        auto target_ok = [&]() { return btb_hit && (perfect_btb || target == next_pc); };
+
+        switch (kind) {
+            case Control::BRANCH: {
+                stats_.branches++;
+                stats_.taken += taken;
+
+                // Without a BTB target the fetch unit cannot redirect early
+                const bool predicted = direction_->predict(r.pc, static_target(r)) && btb_hit;
+
+                if (predicted != taken)
+                    stats_.miss_direction++;
+                else if (taken && !target_ok())
+                    stats_.miss_target++;
+
+                direction_->update(r.pc, taken);
+            } break;
+
+            case Control::JUMP:
+            case Control::CALL:
+                stats_.jumps++;
+
+                if (!target_ok())
+                    stats_.miss_target++;
+
+                if (kind == Control::CALL)
+                    ras_.push(r.pc + 4);
+            break;
+
+            case Control::RETURN: {
+                stats_.jumps++;
+
+                uint32_t predicted = 0;
+                if (ras_.enabled() ? !(ras_.pop(predicted) && predicted == next_pc) : !target_ok())
+                    stats_.miss_return++;
+            } break;
+
+            case Control::INDIRECT:
+                stats_.jumps++;
+
+                if (!target_ok())
+                    stats_.miss_indirect++;
+            break;
+
+            default: break;
+        }
+
+        if (taken)
+            btb_.update(r.pc, next_pc);
+    }
+
+private:
+    std::string name_;
+    std::unique_ptr<DirectionPredictor> direction_;
+    Btb btb_;
+    Ras ras_;
+    Stats stats_;
+};
+
+
+//====================================================================================
+//      OPTIONS
+//====================================================================================
+
+struct Options {
+    std::vector<std::string> predictors = {"static-nt", "btfn", "bimodal:512",
+                                           "gshare:512", "gshare:2048"};
+    std::vector<uint32_t> btbs = {64, 512, 0};
+    std::vector<uint32_t> ras = {0, 4, 8};
+    std::string csv;
+    std::vector<std::string> traces;
+};
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+
+    while (std::getline(in, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+
+    return items;
+}
+
+static bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        const bool has_value = i + 1 < argc;
+
+        if (arg == "--predictor" && has_value) {
+            opt.predictors = split(argv[++i]);
+        } else if (arg == "--btb" && has_value) {
+            opt.btbs.clear();
+            for (const std::string& item : split(argv[++i]))
+                opt.btbs.push_back(item == "perfect" ? 0 : std::stoul(item, nullptr, 0));
+        } else if (arg == "--ras" && has_value) {
+            opt.ras.clear();
+            for (const std::string& item : split(argv[++i]))
+                opt.ras.push_back(std::stoul(item, nullptr, 0));
+        } else if (arg == "--csv" && has_value) {
+            opt.csv = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            opt.traces.push_back(arg);
+        }
+    }
+
+    return !opt.traces.empty();
+}
+
+
+//====================================================================================
+//      MAIN
+//====================================================================================
+
+static std::string trace_label(const std::string& path) {
+    const size_t slash = path.find_last_of('/');
+    const std::string base = slash == std::string::npos ? path : path.substr(slash + 1);
+    const size_t dot = base.find('.');
+
+    return dot == std::string::npos ? base : base.substr(0, dot);
+}
+
+int main(int argc, char** argv) {
+    Options opt;
+
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0]
+                  << " [--predictor static-nt,static-t,btfn,bimodal:N,gshare:N[:H]]"
+                  << " [--btb N,...,perfect] [--ras N,...] [--csv file] trace.txt [...]\n";
+        return 2;
+    }
+
+    for (const std::string& p : opt.predictors) {
+        if (!Configuration::make_predictor(p)) {
+            std::cerr << "bad predictor '" << p << "' (table sizes must be powers of two)\n";
+            return 2;
+        }
+    }
+
+    std::ofstream csv;
+    if (!opt.csv.empty()) {
+        csv.open(opt.csv, std::ios::out | std::ios::trunc);
+        csv << "trace,config,retired,branches,taken,jumps,miss_direction,miss_target,"
+               "miss_return,miss_indirect,mpki\n";
+    }
+
+    // MPKI of every configuration on every trace, for the summary matrix
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> mpki;
+
+    for (const std::string& path : opt.traces) {
+        RetireTraceReader reader(path);
+
+        if (!reader.is_open()) {
+            std::cerr << "cannot open " << path << "\n";
+            return 2;
+        }
+
+        std::vector<Configuration> configs;
+        for (const std::string& p : opt.predictors)
+            for (uint32_t btb : opt.btbs)
+                for (uint32_t ras : opt.ras)
+                    configs.emplace_back(p, btb, ras);
+
+        RetireRecord current, next;
+        uint64_t retired = 0;
+        bool have_current = false;
+
+        // Each record is evaluated once its successor is known
+        while (reader.next(next)) {
+            if (!next.exception)
+                retired++;
+
+            if (have_current) {
+                const Control kind = classify(current);
+
+                // A trap right after a branch hides where it was going
+                if (kind != Control::NONE && !next.exception) {
+                    for (Configuration& c : configs)
+                        c.execute(current, kind, next.pc);
+                }
+            }
+
+            current = next;
+            have_current = !next.exception;
+        }
+
+        const std::string label = trace_label(path);
+        const Stats& s0 = configs.front().stats();
+
+        std::cout << "### " << label << ": " << retired << " retired, " << s0.branches
+                  << " branches (" << std::fixed << std::setprecision(1)
+                  << (s0.branches ? 100.0 * s0.taken / s0.branches : 0.0) << "% taken), "
+                  << s0.jumps << " jumps\n";
+
+        std::cout << std::left << std::setw(36) << "config" << std::right
+                  << std::setw(10) << "MPKI" << std::setw(10) << "dir"
+                  << std::setw(10) << "target" << std::setw(10) << "return"
+                  << std::setw(10) << "indirect" << "\n";
+
+        names.clear();
+        mpki.emplace_back();
+
+        for (const Configuration& c : configs) {
+            const Stats& s = c.stats();
+            const double value = retired ? 1000.0 * s.mispredicts() / retired : 0.0;
+
+            names.push_back(c.name());
+            mpki.back().push_back(value);
+
+            std::cout << std::left << std::setw(36) << c.name() << std::right
+                      << std::setw(10) << std::setprecision(3) << value
+                      << std::setw(10) << s.miss_direction << std::setw(10) << s.miss_target
+                      << std::setw(10) << s.miss_return << std::setw(10) << s.miss_indirect << "\n";
+
+            if (csv.is_open()) {
+                csv << label << ',' << c.name() << ',' << retired << ',' << s.branches << ','
+                    << s.taken << ',' << s.jumps << ',' << s.miss_direction << ','
+                    << s.miss_target << ',' << s.miss_return << ',' << s.miss_indirect << ','
+                    << value << '\n';
+            }
+        }
+
+        std::cout << std::defaultfloat << "\n";
+    }
+
+    if (opt.traces.size() < 2)
+        return 0;
+
+    // Summary: one row per configuration, one column per trace, plus the mean
+    std::cout << "### MPKI summary\n" << std::left << std::setw(36) << "config" << std::right;
+    for (const std::string& path : opt.traces)
+        std::cout << std::setw(12) << trace_label(path).substr(0, 11);
+    std::cout << std::setw(12) << "mean" << "\n";
+
+    for (size_t c = 0; c < names.size(); c++) {
+        double sum = 0;
+
+        std::cout << std::left << std::setw(36) << names[c] << std::right
+                  << std::fixed << std::setprecision(3);
+
+        for (size_t t = 0; t < mpki.size(); t++) {
+            std::cout << std::setw(12) << mpki[t][c];
+            sum += mpki[t][c];
+        }
+
+        std::cout << std::setw(12) << sum / mpki.size() << "\n";
+    }
+
+    std::cout << std::defaultfloat;
+    return 0;
+}
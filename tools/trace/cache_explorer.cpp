@@ -0,0 +1,581 @@
+// ============================================================================
+// Trace-driven cache design-space explorer.
+//
+// Replays testbench retire traces through many instruction and data cache
+// configurations in a single pass and reports miss ratio, memory traffic and
+// reuse-distance histograms, so that only the best candidates need an RTL run.
+//
+//   I side: one fetch per retired PC (every address in DDR).
+//   D side: every load/store to DDR (0x80000000+); I/O and the boot ROM are
+//           uncached and skipped, like in data_cache_complex.
+//
+// Write policies:
+//   rtl  store hit marks the line dirty, store miss writes through without
+//        allocating (current data_cache_complex behaviour)
+//   wb   write-back, write-allocate
+//   wt   write-through, no write-allocate
+//
+// Usage:
+//   cache_explorer [options] trace.txt [trace2.txt ...]
+//     --size 1K,2K,4K,8K,16K   --ways 1,2,4   --block 16,32,64
+//     --policy rtl,wb,wt       --prefetch 0,1 --top N   --csv file.csv
+// ============================================================================
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "retire_trace.h"
+
+
+static constexpr uint32_t DDR_BASE = 0x80000000u;
+
+
+//====================================================================================
+//      CACHE MODEL
+//====================================================================================
+
+enum class WritePolicy { RTL, WRITE_BACK, WRITE_THROUGH };
+
+static const char* policy_name(WritePolicy p) {
+    switch (p) {
+        case WritePolicy::WRITE_BACK:    return "wb";
+        case WritePolicy::WRITE_THROUGH: return "wt";
+        default:                         return "rtl";
+    }
+}
+
+struct CacheConfig {
+    uint32_t    size;
+    uint32_t    ways;
+    uint32_t    block;
+    WritePolicy policy;
+    bool        prefetch;    // next-line prefetch on every allocating miss
+
+    std::string name() const {
+        std::ostringstream os;
+        os << size / 1024 << "K/" << ways << "w/" << block << "B/"
+           << policy_name(policy) << (prefetch ? "/pf" : "");
+        return os.str();
+    }
+};
+
+struct CacheStats {
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    uint64_t fill_bytes = 0;          // demand + prefetch refills
+    uint64_t writeback_bytes = 0;     // dirty evictions
+    uint64_t writethrough_bytes = 0;  // stores sent straight to memory
+    uint64_t prefetches = 0;
+    uint64_t useful_prefetches = 0;   // prefetched lines hit before eviction
+
+    double miss_ratio() const { return accesses ? double(misses) / accesses : 0.0; }
+    uint64_t traffic() const { return fill_bytes + writeback_bytes + writethrough_bytes; }
+};
+
+// Set-associative cache with true LRU replacement.
+class CacheModel {
+public:
+    explicit CacheModel(const CacheConfig& cfg)
+        : cfg_(cfg),
+          sets_(std::max<uint32_t>(1, cfg.size / (cfg.block * cfg.ways))),
+          lines_(static_cast<size_t>(sets_) * cfg.ways) {}
+
+    const CacheConfig& config() const { return cfg_; }
+    const CacheStats& stats() const { return stats_; }
+
+    void access(uint32_t addr, bool store, uint32_t bytes) {
+        stats_.accesses++;
+        now_++;
+
+        const uint32_t block = addr / cfg_.block;
+
+        if (Line* line = find(block)) {
+            line->lru = now_;
+
+            if (line->prefetched) {
+                line->prefetched = false;
+                stats_.useful_prefetches++;
+            }
+
+            if (store) {
+                if (cfg_.policy == WritePolicy::WRITE_THROUGH)
+                    stats_.writethrough_bytes += bytes;
+                else
+                    line->dirty = true;
+            }
+
+            return;
+        }
+
+        stats_.misses++;
+
+        if (store && cfg_.policy != WritePolicy::WRITE_BACK) {
+            stats_.writethrough_bytes += bytes;
+            return;
+        }
+
+        Line& line = allocate(block);
+        line.dirty = store;
+
+        if (cfg_.prefetch && !find(block + 1)) {
+            allocate(block + 1).prefetched = true;
+            stats_.prefetches++;
+        }
+    }
+
+private:
+    struct Line {
+        uint32_t block = 0;
+        uint64_t lru = 0;
+        bool valid = false;
+        bool dirty = false;
+        bool prefetched = false;
+    };
+
+    Line* find(uint32_t block) {
+        Line* set = &lines_[static_cast<size_t>(block % sets_) * cfg_.ways];
+
+        for (uint32_t w = 0; w < cfg_.ways; w++) {
+            if (set[w].valid && set[w].block == block)
+                return &set[w];
+        }
+
+        return nullptr;
+    }
+
+    Line& allocate(uint32_t block) {
+        Line* set = &lines_[static_cast<size_t>(block % sets_) * cfg_.ways];
+        Line* victim = set;
+
+        for (uint32_t w = 0; w < cfg_.ways; w++) {
+            if (!set[w].valid) {
+                victim = &set[w];
+                break;
+            }
+
+            if (set[w].lru < victim->lru)
+                victim = &set[w];
+        }
+
+        if (victim->valid && victim->dirty)
+            stats_.writeback_bytes += cfg_.block;
+
+        stats_.fill_bytes += cfg_.block;
+
+        *victim = Line{block, now_, true, false, false};
+        return *victim;
+    }
+
+    CacheConfig cfg_;
+    uint32_t sets_;
+    std::vector<Line> lines_;
+    CacheStats stats_;
+    uint64_t now_ = 0;
+};
+
+
+//====================================================================================
+//      REUSE DISTANCE
+//====================================================================================
+
+// LRU stack distance (distinct blocks touched since the previous access to the
+// same block), computed with a Fenwick tree over access timestamps. Bucket k
+// holds distances in [2^(k-1), 2^k), bucket 0 distance 0; cold misses apart.
+//
+// Only the latest timestamp of each block is live, so the timestamps are
+// renumbered 1..n in order whenever the tree is full: the tree stays within
+// twice the distinct blocks instead of growing with the trace.
+class ReuseHistogram {
+public:
+    static constexpr uint32_t BUCKETS = 24;
+
+    explicit ReuseHistogram(uint32_t block) : block_(block) {}
+
+    uint32_t block() const { return block_; }
+
+    void access(uint32_t addr) {
+        const uint32_t block = addr / block_;
+
+        if (clock_ + 1 >= tree_.size())
+            compact();
+
+        const uint32_t now = ++clock_;
+
+        accesses_++;
+
+        auto it = last_.find(block);
+
+        if (it == last_.end()) {
+            cold_++;
+            last_.emplace(block, now);
+        } else {
+            const uint64_t distance = prefix(now - 1) - prefix(it->second);
+            uint32_t bucket = 0;
+
+            while (bucket + 1 < BUCKETS && (1ull << bucket) <= distance)
+                bucket++;
+
+            histogram_[bucket]++;
+            add(it->second, -1);
+            it->second = now;
+        }
+
+        add(now, +1);
+    }
+
+    uint64_t cold() const { return cold_; }
+    uint64_t bucket(uint32_t k) const { return histogram_[k]; }
+    uint64_t total() const { return accesses_; }
+
+    // Misses of a fully associative LRU cache holding 'lines' blocks. Buckets
+    // are power-of-two wide, so 'lines' is effectively rounded to one.
+    uint64_t fa_misses(uint64_t lines) const {
+        uint64_t misses = cold_;
+
+        for (uint32_t k = 0; k < BUCKETS; k++) {
+            const uint64_t lo = k ? (1ull << (k - 1)) : 0;
+            if (lo >= lines)
+                misses += histogram_[k];
+        }
+
+        return misses;
+    }
+
+private:
+    static constexpr size_t MIN_TREE = 1024;
+
+    // Renumber the live timestamps keeping their order and rebuild the tree
+    // with room for as many new accesses (amortized O(log n) per access).
+    void compact() {
+        std::vector<std::pair<uint32_t, uint32_t*>> stamps;
+        stamps.reserve(last_.size());
+
+        for (auto& entry : last_)
+            stamps.emplace_back(entry.second, &entry.second);
+
+        std::sort(stamps.begin(), stamps.end());
+
+        const size_t size = std::max<size_t>(MIN_TREE, 2 * (stamps.size() + 1));
+
+        tree_.assign(size, 0);
+
+        for (size_t i = 0; i < stamps.size(); i++) {
+            *stamps[i].second = static_cast<uint32_t>(i + 1);
+            tree_[i + 1] = 1;
+        }
+
+        for (size_t i = 1; i < size; i++) {
+            const size_t parent = i + (i & (~i + 1));
+            if (parent < size)
+                tree_[parent] += tree_[i];
+        }
+
+        clock_ = static_cast<uint32_t>(stamps.size());
+    }
+
+    void add(uint64_t index, int32_t delta) {
+        for (; index < tree_.size(); index += index & (~index + 1))
+            tree_[index] += delta;
+    }
+
+    uint64_t prefix(uint64_t index) const {
+        int64_t sum = 0;
+
+        for (; index > 0; index -= index & (~index + 1))
+            sum += tree_[index];
+
+        return static_cast<uint64_t>(sum);
+    }
+
+    uint32_t block_;
+    uint32_t clock_ = 0;
+    uint64_t accesses_ = 0;
+    uint64_t cold_ = 0;
+    uint64_t histogram_[BUCKETS] = {};
+    std::vector<int32_t> tree_;
+    std::unordered_map<uint32_t, uint32_t> last_;
+};
+
+
+//====================================================================================
+//      OPTIONS
+//====================================================================================
+
+struct Options {
+    std::vector<uint32_t> sizes     = {1024, 2048, 4096, 8192, 16384};
+    std::vector<uint32_t> ways      = {1, 2, 4};
+    std::vector<uint32_t> blocks    = {16, 32, 64};
+    std::vector<WritePolicy> policies = {WritePolicy::RTL, WritePolicy::WRITE_BACK,
+                                         WritePolicy::WRITE_THROUGH};
+    std::vector<bool> prefetch      = {false, true};
+    size_t top = 15;
+    std::string csv;
+    std::vector<std::string> traces;
+};
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::istringstream in(list);
+    std::string item;
+
+    while (std::getline(in, item, ','))
+        if (!item.empty())
+            items.push_back(item);
+
+    return items;
+}
+
+static uint32_t parse_size(const std::string& text) {
+    size_t end = 0;
+    uint32_t value = static_cast<uint32_t>(std::stoul(text, &end, 0));
+
+    if (end < text.size() && (text[end] == 'K' || text[end] == 'k'))
+        value *= 1024;
+
+    return value;
+}
+
+static bool is_power_of_two(uint32_t v) {
+    return v && !(v & (v - 1));
+}
+
+static bool parse_options(int argc, char** argv, Options& opt) {
+    for (int i = 1; i < argc; i++) {
+        const std::string arg(argv[i]);
+        const bool has_value = i + 1 < argc;
+
+        auto numbers = [&](std::vector<uint32_t>& out) {
+            out.clear();
+            for (const std::string& item : split(argv[++i]))
+                out.push_back(parse_size(item));
+        };
+
+        if (arg == "--size" && has_value) {
+            numbers(opt.sizes);
+        } else if (arg == "--ways" && has_value) {
+            numbers(opt.ways);
+        } else if (arg == "--block" && has_value) {
+            numbers(opt.blocks);
+        } else if (arg == "--policy" && has_value) {
+            opt.policies.clear();
+
+            for (const std::string& item : split(argv[++i])) {
+                if (item == "rtl")
+                    opt.policies.push_back(WritePolicy::RTL);
+                else if (item == "wb")
+                    opt.policies.push_back(WritePolicy::WRITE_BACK);
+                else if (item == "wt")
+                    opt.policies.push_back(WritePolicy::WRITE_THROUGH);
+                else
+                    return false;
+            }
+        } else if (arg == "--prefetch" && has_value) {
+            opt.prefetch.clear();
+            for (const std::string& item : split(argv[++i]))
+                opt.prefetch.push_back(item != "0");
+        } else if (arg == "--top" && has_value) {
+            opt.top = std::stoul(argv[++i]);
+        } else if (arg == "--csv" && has_value) {
+            opt.csv = argv[++i];
+        } else if (arg.rfind("--", 0) == 0) {
+            return false;
+        } else {
+            opt.traces.push_back(arg);
+        }
+    }
+
+    for (uint32_t v : opt.sizes)
+        if (!is_power_of_two(v)) return false;
+    for (uint32_t v : opt.ways)
+        if (!is_power_of_two(v)) return false;
+    for (uint32_t v : opt.blocks)
+        if (!is_power_of_two(v) || v < 4) return false;
+
+    return !opt.traces.empty();
+}
+
+
+//====================================================================================
+//      REPORT
+//====================================================================================
+
+struct Side {
+    const char* name;
+    std::vector<CacheModel> caches;
+    std::vector<ReuseHistogram> reuse;
+};
+
+static void print_side(const std::string& trace, const Side& side, const Options& opt,
+                       std::ofstream& csv) {
+    if (side.caches.empty() || side.caches.front().stats().accesses == 0)
+        return;
+
+    std::vector<const CacheModel*> ranked;
+    for (const CacheModel& c : side.caches)
+        ranked.push_back(&c);
+
+    std::sort(ranked.begin(), ranked.end(), [](const CacheModel* a, const CacheModel* b) {
+        if (a->stats().misses != b->stats().misses)
+            return a->stats().misses < b->stats().misses;
+        return a->stats().traffic() < b->stats().traffic();
+    });
+
+    std::cout << "\n== " << side.name << " side: " << side.caches.front().stats().accesses
+              << " accesses, " << side.caches.size() << " configurations ==\n";
+
+    std::cout << std::left << std::setw(24) << "config" << std::right
+              << std::setw(12) << "misses" << std::setw(10) << "miss%"
+              << std::setw(14) << "fill KB" << std::setw(12) << "wb KB"
+              << std::setw(12) << "wt KB" << std::setw(10) << "pf use%" << "\n";
+
+    for (size_t n = 0; n < ranked.size(); n++) {
+        const CacheModel& c = *ranked[n];
+        const CacheStats& s = c.stats();
+
+        if (n < opt.top) {
+            std::cout << std::left << std::setw(24) << c.config().name() << std::right
+                      << std::setw(12) << s.misses
+                      << std::setw(10) << std::fixed << std::setprecision(3) << 100.0 * s.miss_ratio()
+                      << std::setw(14) << std::setprecision(1) << s.fill_bytes / 1024.0
+                      << std::setw(12) << s.writeback_bytes / 1024.0
+                      << std::setw(12) << s.writethrough_bytes / 1024.0
+                      << std::setw(10) << (s.prefetches ? 100.0 * s.useful_prefetches / s.prefetches : 0.0)
+                      << "\n";
+        }
+
+        if (csv.is_open()) {
+            const CacheConfig& cfg = c.config();
+
+            csv << trace << ',' << side.name << ',' << cfg.size << ',' << cfg.ways << ','
+                << cfg.block << ',' << policy_name(cfg.policy) << ',' << cfg.prefetch << ','
+                << s.accesses << ',' << s.misses << ',' << s.fill_bytes << ','
+                << s.writeback_bytes << ',' << s.writethrough_bytes << ','
+                << s.prefetches << ',' << s.useful_prefetches << '\n';
+        }
+    }
+
+    std::cout << std::defaultfloat;
+
+    for (const ReuseHistogram& h : side.reuse) {
+        std::cout << "\n" << side.name << " reuse distance, " << h.block()
+                  << "B blocks (distinct blocks between reuses):\n";
+        std::cout << "  cold " << std::setw(12) << h.cold() << "\n";
+
+        for (uint32_t k = 0; k < ReuseHistogram::BUCKETS; k++) {
+            if (!h.bucket(k))
+                continue;
+
+            const uint64_t lo = k ? (1ull << (k - 1)) : 0;
+            const uint64_t hi = k ? (1ull << k) - 1 : 0;
+
+            std::cout << "  " << std::setw(6) << lo << "-" << std::left << std::setw(8) << hi
+                      << std::right << std::setw(12) << h.bucket(k) << "\n";
+        }
+
+        std::cout << "  fully associative LRU miss%:";
+        for (uint32_t size : opt.sizes) {
+            std::cout << "  " << size / 1024 << "K=" << std::fixed << std::setprecision(3)
+                      << 100.0 * h.fa_misses(size / h.block()) / std::max<uint64_t>(h.total(), 1);
+        }
+        std::cout << std::defaultfloat << "\n";
+    }
+}
+
+
+//====================================================================================
+//      MAIN
+//====================================================================================
+
+int main(int argc, char** argv) {
+    Options opt;
+
+    if (!parse_options(argc, argv, opt)) {
+        std::cerr << "usage: " << argv[0] << " [--size 1K,2K,...] [--ways 1,2,...]"
+                  << " [--block 16,32,...] [--policy rtl,wb,wt] [--prefetch 0,1]"
+                  << " [--top N] [--csv file] trace.txt [...]\n"
+                  << "  sizes, ways and blocks must be powers of two\n";
+        return 2;
+    }
+
+    std::ofstream csv;
+    if (!opt.csv.empty()) {
+        csv.open(opt.csv, std::ios::out | std::ios::trunc);
+        csv << "trace,side,size,ways,block,policy,prefetch,accesses,misses,"
+               "fill_bytes,writeback_bytes,writethrough_bytes,prefetches,useful_prefetches\n";
+    }
+
+    for (const std::string& path : opt.traces) {
+        RetireTraceReader reader(path);
+
+        if (!reader.is_open()) {
+            std::cerr << "cannot open " << path << "\n";
+            return 2;
+        }
+
+        Side icache{"I", {}, {}};
+        Side dcache{"D", {}, {}};
+
+        for (uint32_t size : opt.sizes) {
+            for (uint32_t ways : opt.ways) {
+                for (uint32_t block : opt.blocks) {
+                    if (block * ways > size)
+                        continue;
+
+                    for (bool pf : opt.prefetch) {
+                        icache.caches.emplace_back(CacheConfig{size, ways, block, WritePolicy::RTL, pf});
+
+                        for (WritePolicy policy : opt.policies)
+                            dcache.caches.emplace_back(CacheConfig{size, ways, block, policy, pf});
+                    }
+                }
+            }
+        }
+
+        for (uint32_t block : opt.blocks) {
+            icache.reuse.emplace_back(block);
+            dcache.reuse.emplace_back(block);
+        }
+
+        RetireRecord r;
+        uint64_t retired = 0;
+
+        while (reader.next(r)) {
+            if (r.exception)
+                continue;
+
+            retired++;
+
+            if (r.pc >= DDR_BASE) {
+                for (CacheModel& c : icache.caches)
+                    c.access(r.pc, false, 4);
+                for (ReuseHistogram& h : icache.reuse)
+                    h.access(r.pc);
+            }
+
+            if (r.mem != MemAccess::NONE && r.mem_addr >= DDR_BASE) {
+                const bool store = r.mem == MemAccess::STORE;
+
+                for (CacheModel& c : dcache.caches)
+                    c.access(r.mem_addr, store, r.mem_bytes);
+                for (ReuseHistogram& h : dcache.reuse)
+                    h.access(r.mem_addr);
+            }
+        }
+
+        std::cout << "### " << path << ": " << retired << " retired instructions\n";
+
+        print_side(path, icache, opt, csv);
+        print_side(path, dcache, opt, csv);
+
+        std::cout << "\n";
+    }
+
+    return 0;
+}
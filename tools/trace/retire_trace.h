@@ -0,0 +1,119 @@
+// ============================================================================
+// Reader for the full-SoC testbench retire trace (tb/verilator out/trace.txt).
+//
+// One retired instruction per line, as printed by Sim::print_event():
+//
+//   0x80000010 : addi    a0,a0,1             x10 <= 0x00000001
+//   0x8000001c : sw      zero,0(t0)          | ST.w @0x80003cc0 data 0x00000000
+//   0x80000040 : <exception vec=2>
+//
+// The trace must be complete (TRACE=1, no TRACE_START / TRACE_FILTER) for the
+// host tools to see every fetch and memory access.
+// ============================================================================
+
+#ifndef ZENITH_RETIRE_TRACE_H
+#define ZENITH_RETIRE_TRACE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+enum class MemAccess : uint8_t { NONE, LOAD, STORE };
+
+struct RetireRecord {
+    uint32_t    pc = 0;
+    bool        exception = false;
+    std::string mnemonic;            // first disassembly token, empty on exceptions
+    std::string operands;            // rest of the disassembly, e.g. "a0, a1, pc + 12"
+    uint32_t    rd = 0;              // 0 when no register is written
+    uint32_t    rd_value = 0;
+    MemAccess   mem = MemAccess::NONE;
+    uint32_t    mem_bytes = 0;       // 1, 2 or 4
+    uint32_t    mem_addr = 0;
+};
+
+// Parse one trace line. Returns false for lines that are not retire records.
+inline bool parse_retire_line(const std::string& line, RetireRecord& r) {
+    r = RetireRecord{};
+
+    if (line.compare(0, 2, "0x") != 0)
+        return false;
+
+    const size_t colon = line.find(" : ", 2);
+    if (colon == std::string::npos)
+        return false;
+
+    r.pc = static_cast<uint32_t>(std::strtoul(line.c_str(), nullptr, 16));
+
+    const size_t text = colon + 3;
+
+    if (line.compare(text, 14, "<exception vec") == 0) {
+        r.exception = true;
+        return true;
+    }
+
+    const size_t end = line.find(' ', text);
+    r.mnemonic = line.substr(text, end == std::string::npos ? std::string::npos : end - text);
+
+    // The disassembly column ends where the register or memory fields start
+    size_t disasm_end = line.size();
+
+    // " x10 <= 0x00000001" follows the fixed-width disassembly column
+    const size_t arrow = line.find(" <= 0x", text);
+    if (arrow != std::string::npos && arrow >= 4 && line[arrow - 3] == 'x') {
+        r.rd = static_cast<uint32_t>(std::strtoul(line.c_str() + arrow - 2, nullptr, 10));
+        r.rd_value = static_cast<uint32_t>(std::strtoul(line.c_str() + arrow + 6, nullptr, 16));
+        disasm_end = arrow - 4;
+    }
+
+    // " | LD.w @0x80003cc0" / " | ST.b @0x... data 0x..."
+    const size_t access = line.find(" | ", text);
+    if (access != std::string::npos)
+        disasm_end = std::min(disasm_end, access);
+
+    if (end != std::string::npos && end < disasm_end) {
+        const size_t first = line.find_first_not_of(' ', end);
+        const size_t last = line.find_last_not_of(' ', disasm_end - 1);
+
+        if (first != std::string::npos && last != std::string::npos && first <= last)
+            r.operands = line.substr(first, last - first + 1);
+    }
+
+    if (access != std::string::npos && line.size() > access + 8) {
+        const char kind = line[access + 3];
+        const char width = line[access + 6];
+
+        r.mem = kind == 'S' ? MemAccess::STORE : MemAccess::LOAD;
+        r.mem_bytes = width == 'b' ? 1 : width == 'h' ? 2 : 4;
+
+        const size_t at = line.find("@0x", access);
+        if (at != std::string::npos)
+            r.mem_addr = static_cast<uint32_t>(std::strtoul(line.c_str() + at + 3, nullptr, 16));
+    }
+
+    return true;
+}
+
+class RetireTraceReader {
+public:
+    explicit RetireTraceReader(const std::string& path) : in_(path) {}
+
+    bool is_open() const { return in_.is_open(); }
+
+    bool next(RetireRecord& r) {
+        while (std::getline(in_, line_)) {
+            if (parse_retire_line(line_, r))
+                return true;
+        }
+
+        return false;
+    }
+
+private:
+    std::ifstream in_;
+    std::string line_;
+};
+
+#endif
@@ -134,17 +134,51 @@ module dut_wrapper (
         .wbm_cti_o ( wbm_cti_o ),
         .wbm_bte_o ( wbm_bte_o ),
 
-        .opt_enable_hs ( '0 )
+        .opt_enable_hs ( 1'b1 )
     );
 
 
+//====================================================================================
+//      HIGH-SPEED OUTPUT TIMING
+//====================================================================================
+
+    /* The PHY model drives its outputs on the falling edge of the SD clock,
+     * after CMD6 selected High-Speed mode a card drives them after the rising
+     * edge: delay them by half a period to check the host sampling point */
+    logic high_speed;
+
+    logic sd_cmd_hs, sd_cmd_t_hs; logic [3:0] sd_dat_hs, sd_dat_t_hs;
+    logic sd_cmd_out, sd_cmd_t_out; logic [3:0] sd_dat_out, sd_dat_t_out;
+
+    assign high_speed = (sd_model.isdl.card_function[3:0] == 4'h1);
+
+    always_ff @(posedge sd_clk_o or negedge rst_n) begin
+        if (!rst_n) begin
+            sd_cmd_hs <= 1'b1;
+            sd_cmd_t_hs <= 1'b1;
+            sd_dat_hs <= 4'hF;
+            sd_dat_t_hs <= 4'hF;
+        end else begin
+            sd_cmd_hs <= sd_cmd_o;
+            sd_cmd_t_hs <= sd_cmd_t;
+            sd_dat_hs <= sd_dat_o;
+            sd_dat_t_hs <= sd_dat_t;
+        end
+    end
+
+    assign sd_cmd_out = high_speed ? sd_cmd_hs : sd_cmd_o;
+    assign sd_cmd_t_out = high_speed ? sd_cmd_t_hs : sd_cmd_t;
+    assign sd_dat_out = high_speed ? sd_dat_hs : sd_dat_o;
+    assign sd_dat_t_out = high_speed ? sd_dat_t_hs : sd_dat_t;
+
+
 //====================================================================================
 //      SD CMD/DAT shared lines with pull-up
 //====================================================================================
 
     /* Card model drives CMD only when enabled */
     assign sd_cmd_io =
-        (sd_cmd_t == 1'b0) ? sd_cmd_o : 1'bz;
+        (sd_cmd_t_out == 1'b0) ? sd_cmd_out : 1'bz;
 
     /* Card model reads the resolved CMD line */
     assign sd_cmd_i = sd_cmd_io;
@@ -156,7 +190,7 @@ module dut_wrapper (
     generate
         for (k = 0; k < 4; k++) begin : sd_dat_connection
             assign sd_data_io[k] =
-                (sd_dat_t[k] == 1'b0) ? sd_dat_o[k] : 1'bz;
+                (sd_dat_t_out[k] == 1'b0) ? sd_dat_out[k] : 1'bz;
         end
     endgenerate
 
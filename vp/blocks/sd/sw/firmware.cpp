@@ -24,6 +24,7 @@ bool checkBlock(uint32_t *origBk, uint32_t *newBk);
 bool checkBurstBlock(uint32_t *origBk, uint32_t *newBk, uint32_t burstLength);
 
 void testInformations(SD& card);
+void testThroughput(SD& card, uint32_t address, uint32_t burstLength, uint32_t *blk);
 
 extern "C" int main() {
     vp_print("[TEST] Start!\n");
@@ -95,7 +96,7 @@ extern "C" int main() {
     vp_print("\n\n");
 
     /* Loop to go through all the configurations */
-    for (int i = 0; i < 4; i++) {
+    for (int i = 0; i < 5; i++) {
         switch (i) {
             case 0:
                 vp_print("[CONFIGURATION] | BUS: Narrow | Speed: 400 KHz |\n");
@@ -156,6 +157,27 @@ extern "C" int main() {
                     TEST_FAIL();
                 }
             break;
+
+            case 4:
+                vp_print("[CONFIGURATION] | BUS: Wide | Speed: 50 MHz |\n");
+
+                card.setBusWidth(SD::BUS_WIDE, error);
+
+                if (error == SD::NO_ERROR) {
+                    card.setHighSpeed(error);
+                }
+
+                if (error == SD::DAT_TIMEOUT || error == SD::CMD_TIMEOUT) {
+                    vp_print("[CONFIGURATION] Timeout!\n");
+                    TEST_FAIL();
+                } else if (error == SD::DAT_CRC_ERR || error == SD::CMD_CRC_ERR) {
+                    vp_print("[CONFIGURATION] CRC Error!\n");
+                    TEST_FAIL();
+                } else if (error == SD::CARD_ERR || card.getClockSpeed() != SD::CLK_50MHZ) {
+                    vp_print("[CONFIGURATION] High-Speed switch refused!\n");
+                    TEST_FAIL();
+                }
+            break;
         }
 
         /* Operations from start address */
@@ -188,8 +210,8 @@ extern "C" int main() {
         /* Operations from the last block tested */
         /* Keep a real multi-block transfer at 400 kHz without spending most
          * of the VP run in MMIO polling; retain the 16-block stress test at
-         * 25 MHz. */
-        const uint32_t testBurstLength = ((i == 1) || (i == 3)) ? 3 : 2;
+         * 25 / 50 MHz. */
+        const uint32_t testBurstLength = ((i == 1) || (i == 3) || (i == 4)) ? 3 : 2;
 
         for (int j = START_ADDRESS + NUMBER_OF_BLOCKS; j < NUMBER_OF_BLOCKS * testBurstLength; j += testBurstLength) {
             vp_print("[TEST] Testing block ");
@@ -214,6 +236,8 @@ extern "C" int main() {
             }
         }
 
+        testThroughput(card, START_ADDRESS, BURST_LENGTH, origBurstBlock);
+
         vp_print("\n\n");
     }
 
@@ -251,6 +275,27 @@ void testInformations(SD& card) {
 };
 
 
+/* Cycles of a burst read, to compare the bus configurations */
+void testThroughput(SD& card, uint32_t address, uint32_t burstLength, uint32_t *blk) {
+    SD::errorType_e error = SD::NO_ERROR;
+    uint32_t start, end;
+
+    asm volatile ("csrr %0, mcycle" : "=r" (start));
+
+    card.readBurst(address, burstLength, blk, nullptr, error);
+
+    asm volatile ("csrr %0, mcycle" : "=r" (end));
+
+    if (error != SD::NO_ERROR) {
+        vp_print("[THROUGHPUT] Read error\n");
+        TEST_FAIL();
+    }
+
+    vp_print("[THROUGHPUT] Blocks: "); vp_print_hex(burstLength);
+    vp_print(" | Cycles: "); vp_println_hex(end - start);
+};
+
+
 void testRead(SD& card, uint32_t address, uint32_t *blk) {
     uint8_t response[6] = {0};
     SD::errorType_e error = SD::NO_ERROR;
@@ -0,0 +1,928 @@
+// ============================================================================
+// Register-level C++ models of the ZenithSoC peripherals for the pure-ISS
+// harness (iss_main.cpp). Each model implements the MMIO map programmed by the
+// drivers in sw/lib/driver/*.h, with the same tie-offs as the full-SoC
+// Verilator testbench: UART and SPI in loopback, GPIO0 driving GPIO1.
+//
+// Register bitfields and addresses come straight from the driver headers and
+// sw/lib/platform.h, so firmware and models share one definition of the map.
+// Time is derived from the retired instruction count (see iss_clock_t), the
+// models are functional and not cycle accurate. Interrupts are latched in the
+// event/pending registers but not delivered to the core.
+// ============================================================================
+
+#ifndef ISS_DEVICES_H
+#define ISS_DEVICES_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "riscv/abstract_device.h"
+
+#include "platform.h"
+#include "driver/UART.h"
+#include "driver/Timer.h"
+#include "driver/GPIO.h"
+#include "driver/SPI.h"
+#include "driver/SD.h"
+
+
+// Cycles elapsed since reset, as seen by the timer model.
+using iss_clock_t = std::function<uint64_t()>;
+
+// Register bitfields are accessed through their first 32-bit word (some driver
+// structs carry padding past bit 31).
+template<typename T> static T iss_fields(uint32_t raw) {
+    static_assert(sizeof(T) >= sizeof(uint32_t), "register bitfield too small");
+
+    T fields = {};
+    std::memcpy(&fields, &raw, sizeof(raw));
+    return fields;
+}
+
+template<typename T> static uint32_t iss_raw(const T& fields) {
+    uint32_t raw = 0;
+    std::memcpy(&raw, &fields, sizeof(raw));
+    return raw;
+}
+
+
+//====================================================================================
+//      32-BIT REGISTER FILE BASE
+//====================================================================================
+
+// Every ZenithSoC peripheral exposes 32-bit registers at a 4-byte stride.
+// Narrow stores only update the addressed byte lanes, as the write strobes do.
+class iss_mmio_device_t : public abstract_device_t {
+
+public:
+    explicit iss_mmio_device_t(reg_t dev_size) : dev_size_(dev_size) {}
+
+    reg_t size() override {
+        return dev_size_;
+    }
+
+    bool load(reg_t addr, size_t len, uint8_t* bytes) override {
+        uint32_t data = read_reg(static_cast<uint32_t>(addr >> 2));
+
+        // Shift data for byte/halfword reads
+        data >>= 8 * (addr & 0x3);
+
+        std::memset(bytes, 0, len);
+        std::memcpy(bytes, &data, std::min(len, sizeof(data)));
+
+        return true;
+    }
+
+    bool store(reg_t addr, size_t len, const uint8_t* bytes) override {
+        uint32_t data = 0;
+        std::memcpy(&data, bytes, std::min(len, sizeof(data)));
+
+        const uint32_t shift = 8 * (addr & 0x3);
+        const uint32_t mask  = (len >= 4) ? 0xFFFFFFFFu : ((1u << (8 * len)) - 1);
+
+        write_reg(static_cast<uint32_t>(addr >> 2), data << shift, mask << shift);
+
+        return true;
+    }
+
+protected:
+    virtual uint32_t read_reg(uint32_t index) = 0;
+    virtual void write_reg(uint32_t index, uint32_t data, uint32_t mask) = 0;
+
+    static uint32_t merge(uint32_t old, uint32_t data, uint32_t mask) {
+        return (old & ~mask) | (data & mask);
+    }
+
+private:
+    reg_t dev_size_;
+};
+
+
+//====================================================================================
+//      UNMODELLED PERIPHERAL
+//====================================================================================
+
+// Ethernet, APU and trace unit: reads return 0 and writes are dropped, with a
+// single warning so a firmware that depends on them is easy to spot.
+class iss_null_device_t : public iss_mmio_device_t {
+
+public:
+    iss_null_device_t(const char* name, reg_t dev_size)
+        : iss_mmio_device_t(dev_size), name_(name) {}
+
+protected:
+    uint32_t read_reg(uint32_t) override {
+        warn();
+        return 0;
+    }
+
+    void write_reg(uint32_t, uint32_t, uint32_t) override {
+        warn();
+    }
+
+private:
+    void warn() {
+        if (!warned_)
+            std::cerr << "[ISS] WARN: " << name_ << " is not modelled (reads as 0)\n";
+
+        warned_ = true;
+    }
+
+    const char* name_;
+    bool warned_ = false;
+};
+
+
+//====================================================================================
+//      UART
+//====================================================================================
+
+class iss_uart_t : public iss_mmio_device_t {
+
+public:
+    /* UART_RX_BUFFER_SIZE in soc_parameters.sv */
+    static constexpr size_t FIFO_DEPTH = 2048;
+
+    enum { STATUS, TX_BUFFER, RX_BUFFER, EVENT };
+
+    explicit iss_uart_t(const std::string& capture_path)
+        : iss_mmio_device_t(DEVICE_INTERLEAVE) {
+
+        capture_.open(capture_path, std::ios::out | std::ios::trunc);
+
+        if (!capture_.is_open())
+            std::cerr << "[ISS] WARN: cannot open " << capture_path << " for UART capture\n";
+    }
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        switch (index) {
+            case STATUS: {
+                UART::uartCtrlStatus_s status = iss_fields<UART::uartCtrlStatus_s>(config_);
+
+                status.emptyRX = rx_.empty();
+                status.fullRX  = rx_.size() >= FIFO_DEPTH;
+
+                /* Transmission is instantaneous */
+                status.emptyTX = 1;
+                status.fullTX  = 0;
+
+                return iss_raw(status);
+            }
+
+            case RX_BUFFER: {
+                if (rx_.empty())
+                    return 0;
+
+                const uint8_t data = rx_.front();
+                rx_.pop_front();
+
+                return data;
+            }
+
+            case EVENT:
+                return event_;
+
+            default:
+                return 0;
+        }
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t mask) override {
+        switch (index) {
+            case STATUS:
+                /* Buffer flags are read only */
+                config_ = merge(config_, data, mask) & ~0xFu;
+            break;
+
+            case TX_BUFFER:
+                if (mask & 0xFF)
+                    transmit(data & 0xFF);
+            break;
+
+            case EVENT:
+                event_ = merge(event_, data, mask) & 0x1F;
+            break;
+        }
+    }
+
+private:
+    void transmit(uint8_t data) {
+        std::putchar(data);
+        std::fflush(stdout);
+
+        if (capture_.is_open())
+            capture_.put(static_cast<char>(data)).flush();
+
+        event_ |= UART::DATA_TX | UART::TX_EMPTY;
+
+        /* Loopback: TX is wired to RX like in zenith_tb_top */
+        if (iss_fields<UART::uartCtrlStatus_s>(config_).enableRX) {
+            if (rx_.size() < FIFO_DEPTH) {
+                rx_.push_back(data);
+                event_ |= UART::DATA_RX;
+            }
+
+            if (rx_.size() >= FIFO_DEPTH)
+                event_ |= UART::RX_FULL;
+        }
+    }
+
+    uint32_t config_ = 0;
+    uint32_t event_ = 0;
+    std::deque<uint8_t> rx_;
+    std::ofstream capture_;
+};
+
+
+//====================================================================================
+//      TIMER
+//====================================================================================
+
+// The counter is evaluated lazily: every access first folds the cycles that
+// elapsed since the previous one into the count (sync()).
+class iss_timer_t : public iss_mmio_device_t {
+
+public:
+    enum {
+        COMPARE_LOW, COMPARE_HIGH, VALUE_LOW, VALUE_HIGH,
+        PWM_TOGGLE_LOW, PWM_TOGGLE_HIGH, CONFIGURATION, INTERRUPT_CONFIG
+    };
+
+    explicit iss_timer_t(iss_clock_t clock)
+        : iss_mmio_device_t(DEVICE_INTERLEAVE), clock_(std::move(clock)) {}
+
+    bool interrupt() {
+        sync();
+        return irq_pending_;
+    }
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        sync();
+
+        switch (index) {
+            case COMPARE_LOW:      return compare_;
+            case COMPARE_HIGH:     return compare_ >> 32;
+            case VALUE_LOW:        return value_;
+            case VALUE_HIGH:       return value_ >> 32;
+            case PWM_TOGGLE_LOW:   return pwm_toggle_;
+            case PWM_TOGGLE_HIGH:  return pwm_toggle_ >> 32;
+            case CONFIGURATION:    return config_ | (stopped_ << 4);
+            case INTERRUPT_CONFIG: return irq_enable_ | (irq_pending_ << 1);
+            default:               return 0;
+        }
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t mask) override {
+        sync();
+
+        switch (index) {
+            case COMPARE_LOW:     write_half(compare_, 0, data, mask);    break;
+            case COMPARE_HIGH:    write_half(compare_, 32, data, mask);   break;
+            case VALUE_LOW:       write_half(value_, 0, data, mask);      break;
+            case VALUE_HIGH:      write_half(value_, 32, data, mask);     break;
+            case PWM_TOGGLE_LOW:  write_half(pwm_toggle_, 0, data, mask); break;
+            case PWM_TOGGLE_HIGH: write_half(pwm_toggle_, 32, data, mask); break;
+
+            case CONFIGURATION: {
+                const uint32_t reg = merge(config_ | (stopped_ << 4), data, mask);
+
+                config_  = reg & 0xF;
+                stopped_ = (reg >> 4) & 1;
+            } break;
+
+            case INTERRUPT_CONFIG:
+                if (mask & 0x1)
+                    irq_enable_ = data & 0x1;
+
+                /* Write 1 to clear */
+                if ((mask & 0x2) && (data & 0x2))
+                    irq_pending_ = false;
+            break;
+        }
+    }
+
+private:
+    static void write_half(uint64_t& reg, uint32_t shift, uint32_t data, uint32_t mask) {
+        const uint32_t half = merge(static_cast<uint32_t>(reg >> shift), data, mask);
+
+        reg = (reg & ~(0xFFFFFFFFull << shift)) | (static_cast<uint64_t>(half) << shift);
+    }
+
+    void sync() {
+        const uint64_t now = clock_();
+        const uint64_t elapsed = now - last_sync_;
+        last_sync_ = now;
+
+        const Timer::timerConfig_s config = iss_fields<Timer::timerConfig_s>(config_);
+
+        if (!config.enableTimer) {
+            stopped_ = true;
+            return;
+        }
+
+        if (stopped_ || elapsed == 0)
+            return;
+
+        /* Cycles needed to reach the compare value from the current count */
+        const bool below = value_ <= compare_;
+        const uint64_t distance = compare_ - value_;
+        bool matched = below && elapsed >= distance;
+
+        switch (config.timerMode) {
+            case Timer::ONE_SHOT:
+                if (matched) {
+                    value_ = compare_;
+                    stopped_ = true;
+                } else {
+                    value_ += elapsed;
+                }
+            break;
+
+            case Timer::WRAP_AROUND:
+                /* Counts 0 ... compare, then restarts from 0 */
+                if (matched && compare_ != UINT64_MAX)
+                    value_ = (elapsed - distance - 1) % (compare_ + 1);
+                else
+                    value_ += elapsed;
+            break;
+
+            default:
+                value_ += elapsed;
+            break;
+        }
+
+        if (matched && irq_enable_)
+            irq_pending_ = true;
+    }
+
+    iss_clock_t clock_;
+    uint64_t last_sync_ = 0;
+
+    uint64_t compare_ = UINT64_MAX;
+    uint64_t pwm_toggle_ = UINT64_MAX;
+    uint64_t value_ = 0;
+
+    uint32_t config_ = 0;
+    uint32_t stopped_ = 1;
+    uint32_t irq_enable_ = 0;
+    uint32_t irq_pending_ = 0;
+};
+
+
+//====================================================================================
+//      GPIO
+//====================================================================================
+
+class iss_gpio_t : public iss_mmio_device_t {
+
+public:
+    enum { VALUE, DIRECTION, INTERRUPT_ENABLE, LEVEL_LOW, LEVEL_HIGH, INTERRUPT_PENDING };
+
+    iss_gpio_t() : iss_mmio_device_t(DEVICE_INTERLEAVE) {}
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        switch (index) {
+            case VALUE:             return pins();
+            case DIRECTION:         return direction_;
+            case INTERRUPT_ENABLE:  return interrupt_enable_;
+            case LEVEL_LOW:         return level_[0];
+            case LEVEL_HIGH:        return level_[1];
+            case INTERRUPT_PENDING: return pending_;
+            default:                return 0;
+        }
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t mask) override {
+        const uint8_t before = pins();
+
+        switch (index) {
+            case VALUE:             output_ = merge(output_, data, mask);                     break;
+            case DIRECTION:         direction_ = merge(direction_, data, mask);               break;
+            case INTERRUPT_ENABLE:  interrupt_enable_ = merge(interrupt_enable_, data, mask); break;
+            case LEVEL_LOW:         level_[0] = merge(level_[0], data, mask);                 break;
+            case LEVEL_HIGH:        level_[1] = merge(level_[1], data, mask);                 break;
+            case INTERRUPT_PENDING: pending_ = merge(pending_, data, mask);                   break;
+        }
+
+        detect(before, pins());
+    }
+
+private:
+    /* Pin levels: outputs drive themselves, pin 1 is wired to pin 0 */
+    uint8_t pins() const {
+        const uint8_t driven = output_ & ~direction_;
+        const uint8_t looped = (driven & 0x1) << 1;
+
+        return driven | (looped & direction_);
+    }
+
+    void detect(uint8_t before, uint8_t after) {
+        for (int i = 0; i < 8; ++i) {
+            if (!((interrupt_enable_ >> i) & 1))
+                continue;
+
+            const bool was = (before >> i) & 1;
+            const bool now = (after >> i) & 1;
+            const uint32_t level = (((level_[1] >> i) & 1) << 1) | ((level_[0] >> i) & 1);
+
+            bool fire = false;
+
+            switch (level) {
+                case GPIO::HIGH:    fire = now;           break;
+                case GPIO::POSEDGE: fire = !was && now;   break;
+                case GPIO::NEGEDGE: fire = was && !now;   break;
+                case GPIO::BOTH:    fire = was != now;    break;
+            }
+
+            if (fire)
+                pending_ |= 1u << i;
+        }
+    }
+
+    uint8_t output_ = 0;
+    uint8_t direction_ = 0;
+    uint8_t interrupt_enable_ = 0;
+    uint8_t level_[2] = {0, 0};
+    uint8_t pending_ = 0;
+};
+
+
+//====================================================================================
+//      PRNG
+//====================================================================================
+
+// Same 64-bit Fibonacci LFSR as prng.sv. The hardware shifts every cycle; the
+// model advances one full word each time the low half is read instead.
+class iss_prng_t : public iss_mmio_device_t {
+
+public:
+    iss_prng_t() : iss_mmio_device_t(DEVICE_INTERLEAVE) {}
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        if (index == 0) {
+            for (int i = 0; i < 64; ++i) {
+                const uint64_t feedback = ((lfsr_ >> 63) ^ (lfsr_ >> 62) ^ (lfsr_ >> 60) ^ (lfsr_ >> 59)) & 1;
+                lfsr_ = (lfsr_ << 1) | feedback;
+            }
+        }
+
+        return static_cast<uint32_t>(lfsr_ >> (index & 1 ? 32 : 0));
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t) override {
+        if (index & 1)
+            lfsr_ = (lfsr_ & 0xFFFFFFFFull) | (static_cast<uint64_t>(data) << 32);
+        else
+            lfsr_ = (lfsr_ & ~0xFFFFFFFFull) | data;
+    }
+
+private:
+    uint64_t lfsr_ = 0;
+};
+
+
+//====================================================================================
+//      SPI
+//====================================================================================
+
+// Each byte written to the TX buffer is exchanged at once. The default slave
+// echoes MOSI on MISO (zenith_tb_top loopback); a slave model can replace it.
+class iss_spi_t : public iss_mmio_device_t {
+
+public:
+    /* SPI_RX_BUFFER_SIZE in soc_parameters.sv */
+    static constexpr size_t FIFO_DEPTH = 512;
+
+    enum { STATUS, TX_BUFFER, RX_BUFFER, EVENT, SLAVE_SELECT };
+
+    using slave_t = std::function<uint8_t(uint32_t slave_select, uint8_t mosi)>;
+
+    iss_spi_t() : iss_mmio_device_t(DEVICE_INTERLEAVE) {}
+
+    void attach(slave_t slave) {
+        slave_ = std::move(slave);
+    }
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        switch (index) {
+            case STATUS: {
+                SPI::spiStatus_s status = iss_fields<SPI::spiStatus_s>(config_);
+
+                status.emptyRX = rx_.empty();
+                status.fullRX  = rx_.size() >= FIFO_DEPTH;
+                status.emptyTX = 1;
+                status.fullTX  = 0;
+                status.idle    = 1;
+
+                return iss_raw(status);
+            }
+
+            case RX_BUFFER: {
+                if (rx_.empty())
+                    return 0;
+
+                const uint8_t data = rx_.front();
+                rx_.pop_front();
+
+                return data;
+            }
+
+            case EVENT:        return event_;
+            case SLAVE_SELECT: return slave_select_;
+            default:           return 0;
+        }
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t mask) override {
+        switch (index) {
+            case STATUS:
+                config_ = merge(config_, data, mask) & ~0x1Fu;
+            break;
+
+            case TX_BUFFER: {
+                const uint8_t mosi = data & 0xFF;
+                const uint8_t miso = slave_ ? slave_(slave_select_, mosi) : mosi;
+
+                if (rx_.size() < FIFO_DEPTH)
+                    rx_.push_back(miso);
+
+                /* Transaction done */
+                event_ = 1;
+            } break;
+
+            case EVENT:
+                event_ = merge(event_, data, mask);
+            break;
+
+            case SLAVE_SELECT:
+                slave_select_ = merge(slave_select_, data, mask);
+            break;
+        }
+    }
+
+private:
+    uint32_t config_ = 0;
+    uint32_t event_ = 0;
+    uint32_t slave_select_ = 0;
+    std::deque<uint8_t> rx_;
+    slave_t slave_;
+};
+
+
+//====================================================================================
+//      SD CONTROLLER + CARD
+//====================================================================================
+
+// Controller and an SDHC card (block addressing) collapsed into one model.
+// Commands complete instantly, but cmdIdle reads low once after each command
+// because SD::sendCommand() waits for the FSM to leave idle. Data words follow
+// the controller byte order: RX words are packed MSB-first (the driver swaps
+// them back), TX words are sent least significant byte first.
+class iss_sd_t : public iss_mmio_device_t {
+
+public:
+    static constexpr uint32_t BLOCK_WORDS = 128;
+    static constexpr uint64_t CARD_BYTES  = 1ull << 30;
+
+    enum {
+        CONTROL, STATUS, COMMAND_NUMBER, COMMAND_ARGUMENT,
+        EVENT, RESPONSE, TX_BUFFER, RX_BUFFER
+    };
+
+    explicit iss_sd_t(std::vector<uint8_t>& disk)
+        : iss_mmio_device_t(DEVICE_INTERLEAVE), disk_(disk) {}
+
+protected:
+    uint32_t read_reg(uint32_t index) override {
+        switch (index) {
+            case CONTROL:
+                return control_;
+
+            case STATUS: {
+                SD::sdStatus_s status = {};
+
+                status.dataIdle        = !(multi_read_ || multi_write_);
+                status.cmdIdle         = !command_busy_;
+                status.cmdResponseType = long_response_ ? SD::R136 : SD::R48;
+                status.respBufferEmpty = response_.empty();
+                status.rxBufferEmpty   = rx_.empty() && !multi_read_;
+                status.txBufferFull    = tx_.size() >= BLOCK_WORDS;
+                status.txBufferEmpty   = tx_.empty();
+                status.dataWaitTX      = multi_write_ && tx_.size() < BLOCK_WORDS;
+                status.cardDetected    = 1;
+
+                command_busy_ = false;
+
+                return iss_raw(status);
+            }
+
+            case COMMAND_NUMBER:   return command_;
+            case COMMAND_ARGUMENT: return argument_;
+            case EVENT:            return event_;
+
+            case RESPONSE: {
+                if (response_.empty())
+                    return 0;
+
+                const uint8_t data = response_.front();
+                response_.pop_front();
+
+                return data;
+            }
+
+            case RX_BUFFER: {
+                /* CMD18 keeps streaming blocks until CMD12 */
+                if (rx_.empty() && multi_read_)
+                    read_block(next_block_++);
+
+                if (rx_.empty())
+                    return 0;
+
+                const uint32_t data = rx_.front();
+                rx_.pop_front();
+
+                return data;
+            }
+
+            default:
+                return 0;
+        }
+    }
+
+    void write_reg(uint32_t index, uint32_t data, uint32_t mask) override {
+        switch (index) {
+            case CONTROL: {
+                SD::sdControl_s control = iss_fields<SD::sdControl_s>(merge(control_, data, mask));
+
+                if (control.flushTX)
+                    tx_.clear();
+
+                const bool send = control.sendCommand;
+
+                /* Self clearing bits */
+                control.sendCommand = 0;
+                control.flushTX = 0;
+                control.resetCard = 0;
+
+                control_ = iss_raw(control);
+
+                if (send)
+                    execute();
+            } break;
+
+            case COMMAND_NUMBER:   command_ = merge(command_, data, mask);   break;
+            case COMMAND_ARGUMENT: argument_ = merge(argument_, data, mask); break;
+            case EVENT:            event_ = merge(event_, data, mask);       break;
+
+            case TX_BUFFER:
+                tx_.push_back(data);
+
+                if (multi_write_ && tx_.size() >= BLOCK_WORDS)
+                    write_block(next_block_++);
+            break;
+        }
+    }
+
+private:
+    enum : uint32_t { EVENT_DATA_DONE = 1u << 2, EVENT_CMD_DONE = 1u << 5 };
+
+    void execute() {
+        const uint32_t cmd = command_ & 0x3F;
+        const bool application = app_command_;
+
+        command_busy_ = true;
+        long_response_ = false;
+        app_command_ = false;
+        event_ |= EVENT_CMD_DONE;
+
+        if (application) {
+            switch (cmd) {
+                /* ACMD41: ready, high capacity, 2.7-3.6 V */
+                case 41: respond(cmd, 0xC0FF8000u); break;
+
+                /* ACMD51: SCR (SD 2.0, 1 and 4 bit bus), raw MSB-first words */
+                case 51:
+                    respond_r1(cmd);
+                    rx_.push_back(0x02358000u);
+                    rx_.push_back(0x00000000u);
+                    event_ |= EVENT_DATA_DONE;
+                break;
+
+                default: respond_r1(cmd); break;
+            }
+
+            return;
+        }
+
+        switch (cmd) {
+            /* GO_IDLE_STATE has no response */
+            case 0: break;
+
+            case 2:
+            case 10: respond_long(cid()); break;
+
+            /* R6: RCA + status bits */
+            case 3: respond(cmd, (RCA << 16) | 0x0500); break;
+
+            /* R7: echo voltage and check pattern */
+            case 8: respond(cmd, argument_ & 0xFFF); break;
+
+            case 9: respond_long(csd()); break;
+
+            /* SWITCH_FUNC: only group 1 function 1 (High-Speed) */
+            case 6:
+                respond_r1(cmd);
+                switch_status(argument_);
+            break;
+
+            case 12:
+                multi_read_ = false;
+                multi_write_ = false;
+                respond_r1(cmd);
+            break;
+
+            case 17:
+                respond_r1(cmd);
+                read_block(argument_);
+            break;
+
+            case 18:
+                respond_r1(cmd);
+                multi_read_ = true;
+                next_block_ = argument_;
+            break;
+
+            case 24:
+                respond_r1(cmd);
+                write_block(argument_);
+            break;
+
+            case 25:
+                respond_r1(cmd);
+                multi_write_ = true;
+                next_block_ = argument_;
+
+                while (tx_.size() >= BLOCK_WORDS)
+                    write_block(next_block_++);
+            break;
+
+            case 55:
+                app_command_ = true;
+                respond_r1(cmd);
+            break;
+
+            default: respond_r1(cmd); break;
+        }
+    }
+
+    /* R1/R3/R6/R7: header, 32-bit payload MSB-first, CRC7 + end bit */
+    void respond(uint32_t cmd, uint32_t payload) {
+        response_.push_back(cmd & 0x3F);
+
+        for (int shift = 24; shift >= 0; shift -= 8)
+            response_.push_back((payload >> shift) & 0xFF);
+
+        response_.push_back(0x01);
+    }
+
+    void respond_r1(uint32_t cmd) {
+        SD::cardStatus_u status = {};
+
+        status.fields.currentState = SD::TRAN;
+        status.fields.readyForData = 1;
+        status.fields.appCmd = app_command_;
+
+        respond(cmd, status.raw);
+    }
+
+    /* R2: header, 128-bit register MSB-first */
+    void respond_long(const std::vector<uint8_t>& reg) {
+        long_response_ = true;
+
+        response_.push_back(0x3F);
+        response_.insert(response_.end(), reg.begin(), reg.end());
+    }
+
+    static std::vector<uint8_t> cid() {
+        return { 0x03, 'Z', 'N', 'I', 'S', 'S', 'S', 'D', 0x10,
+                 0x00, 0x00, 0x00, 0x01, 0x01, 0x8A, 0x01 };
+    }
+
+    /* CSD v2.0: READ_BL_LEN = 9, TRAN_SPEED = 25 MHz, C_SIZE from CARD_BYTES */
+    static std::vector<uint8_t> csd() {
+        const uint64_t c_size = CARD_BYTES / (512 * 1024) - 1;
+
+        const uint64_t high = (1ull << 62) | (0x32ull << 32) | (9ull << 16) | (c_size >> 16);
+        const uint64_t low  = (c_size & 0xFFFF) << 48;
+
+        std::vector<uint8_t> bytes;
+
+        for (int shift = 56; shift >= 0; shift -= 8)
+            bytes.push_back((high >> shift) & 0xFF);
+        for (int shift = 56; shift >= 0; shift -= 8)
+            bytes.push_back((low >> shift) & 0xFF);
+
+        return bytes;
+    }
+
+    /* 512 bit status, raw MSB-first words like ACMD51 */
+    void switch_status(uint32_t argument) {
+        uint8_t status[64] = {};
+
+        /* Maximum current 100 mA, group 1 supports functions 0 and 1 */
+        status[1] = 100;
+        status[12] = 0x80;
+        status[13] = 0x03;
+
+        const uint32_t function = argument & 0xF;
+
+        if (function == 0x1) {
+            status[16] = 0x1;
+
+            if (argument & 0x80000000u)
+                high_speed_ = true;
+        } else {
+            status[16] = (function == 0xF) ? (high_speed_ ? 0x1 : 0x0) : (function == 0x0 ? 0x0 : 0xF);
+        }
+
+        for (uint32_t i = 0; i < 64; i += 4)
+            rx_.push_back((status[i] << 24) | (status[i + 1] << 16) | (status[i + 2] << 8) | status[i + 3]);
+
+        event_ |= EVENT_DATA_DONE;
+    }
+
+    void read_block(uint32_t block) {
+        const uint64_t offset = static_cast<uint64_t>(block) * 512;
+
+        for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+            uint32_t word = 0;
+
+            for (uint32_t b = 0; b < 4; ++b) {
+                const uint64_t address = offset + (4 * i) + b;
+                const uint8_t byte = address < disk_.size() ? disk_[address] : 0xFF;
+
+                word = (word << 8) | byte;
+            }
+
+            rx_.push_back(word);
+        }
+
+        event_ |= EVENT_DATA_DONE;
+    }
+
+    void write_block(uint32_t block) {
+        const uint64_t offset = static_cast<uint64_t>(block) * 512;
+
+        if (offset + 512 > disk_.size())
+            disk_.resize(offset + 512, 0xFF);
+
+        for (uint32_t i = 0; i < BLOCK_WORDS; ++i) {
+            const uint32_t word = tx_.empty() ? 0xFFFFFFFFu : tx_.front();
+
+            if (!tx_.empty())
+                tx_.pop_front();
+
+            for (uint32_t b = 0; b < 4; ++b)
+                disk_[offset + (4 * i) + b] = (word >> (8 * b)) & 0xFF;
+        }
+
+        event_ |= EVENT_DATA_DONE;
+    }
+
+    static constexpr uint32_t RCA = 0x0001;
+
+    std::vector<uint8_t>& disk_;
+
+    uint32_t control_ = 0;
+    uint32_t command_ = 0;
+    uint32_t argument_ = 0;
+    uint32_t event_ = 0;
+
+    bool command_busy_ = false;
+    bool long_response_ = false;
+    bool app_command_ = false;
+    bool high_speed_ = false;
+
+    bool multi_read_ = false;
+    bool multi_write_ = false;
+    uint32_t next_block_ = 0;
+
+    std::deque<uint8_t> response_;
+    std::deque<uint32_t> rx_;
+    std::deque<uint32_t> tx_;
+};
+
+#endif
@@ -0,0 +1,242 @@
+// ============================================================================
+// ZenithSoC pure-ISS harness: runs a whole firmware on Spike alone.
+//
+// There is no RTL in the loop. The peripherals are the register-level models
+// in iss_devices.h, mapped at their platform.h addresses, so the same ELF that
+// runs on tb/verilator runs here unchanged, orders of magnitude faster.
+//
+//   1. Load the firmware ELF into DDR (0x80000000) and set the PC to its entry.
+//      The boot ROM is not modelled, startup.S is the first code executed.
+//   2. Map UART/TIMER/GPIO/SPI/PRNG/SD models and the non-cacheable memory.
+//      Ethernet, APU and the trace unit read as 0.
+//   3. Step Spike in chunks, polling `tohost` between chunks.
+//   4. Stop on a `tohost` write, on +max_insns, or on Ctrl-C.
+//
+// Timing is approximate: the timer counts minstret * CPI cycles. Interrupts are
+// latched in the device registers but never delivered, so firmware that waits
+// for an ISR must poll instead.
+// ============================================================================
+
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "riscv/abstract_device.h"
+#include "riscv/cfg.h"
+#include "riscv/sim.h"
+#include "riscv/mmu.h"
+#include "riscv/processor.h"
+
+#include "elf_loader.h"
+#include "sd_image.h"
+#include "iss_devices.h"
+
+
+// Instructions executed between two tohost/limit checks.
+static constexpr uint64_t STEP_CHUNK = 10000;
+
+static volatile std::sig_atomic_t g_interrupted = 0;
+
+static void signal_handler(int) {
+    g_interrupted = 1;
+}
+
+
+//====================================================================================
+//      MAIN SIM BODY
+//====================================================================================
+
+int main(int argc, char** argv) {
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    std::string fw_path = "out/firmware.elf";
+    std::string sd_path;
+    uint32_t sd_block = 0;
+    uint64_t max_insns = UINT64_MAX;
+    uint64_t cpi = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+
+        if (arg.rfind("+firmware=", 0) == 0) {
+            fw_path = arg.substr(10);
+        } else if (arg.rfind("+sd=", 0) == 0) {
+            sd_path = arg.substr(4);
+        } else if (arg.rfind("+sd_block=", 0) == 0) {
+            sd_block = static_cast<uint32_t>(std::stoul(arg.substr(10), nullptr, 0));
+        } else if (arg.rfind("+max_insns=", 0) == 0) {
+            max_insns = std::stoull(arg.substr(11), nullptr, 0);
+        } else if (arg.rfind("+cpi=", 0) == 0) {
+            cpi = std::max<uint64_t>(1, std::stoull(arg.substr(5), nullptr, 0));
+        } else {
+            std::cerr << "[ISS] usage: " << argv[0]
+                      << " [+firmware=ELF] [+sd=IMG] [+sd_block=N]"
+                         " [+max_insns=N] [+cpi=N]\n";
+            return 2;
+        }
+    }
+
+    ElfImage img;
+
+    if (!load_elf(fw_path, img)) {
+        std::cerr << "[ISS] cannot load ELF: " << fw_path << "\n";
+        return 2;
+    }
+
+    if (!img.tohost) {
+        std::cerr << "[ISS] WARN: no tohost symbol, the run stops only on +max_insns or Ctrl-C\n";
+    }
+
+    std::vector<uint8_t> sd_disk;
+
+    if (!sd_path.empty()) {
+        std::vector<uint8_t> image;
+
+        if (!read_sd_image(sd_path, image) || !place_sd_image(image, sd_block, sd_disk)) {
+            std::cerr << "[ISS] cannot load SD image: " << sd_path << "\n";
+            return 2;
+        }
+
+        std::cout << "[ISS] SD image " << sd_path << " (" << image.size()
+                  << " bytes) at block " << sd_block << "\n";
+    }
+
+
+    // ------------------------------------------------------------------------
+    // Spike
+    // ------------------------------------------------------------------------
+
+    cfg_t cfg;
+    cfg.isa  = "rv32im_zfinx_zba_zbs_zicsr";
+    cfg.priv = "m";
+
+    std::vector<std::pair<reg_t, abstract_mem_t*>> mems;
+    mems.push_back(std::make_pair((reg_t)0x80000000, new mem_t(DDR2_MEMORY_SIZE)));
+    mems.push_back(std::make_pair((reg_t)NC_MEMORY_BASE, new mem_t(NC_MEMORY_SIZE)));
+
+    debug_module_config_t dm_config;
+    std::vector<std::pair<const device_factory_t*, std::vector<std::string>>> plugins;
+    std::vector<std::string> htif_args;
+    htif_args.push_back(fw_path);
+
+    sim_t spike(&cfg, false, mems, plugins, false, htif_args, dm_config,
+                nullptr, false, nullptr, false, nullptr, std::nullopt);
+
+    processor_t* p = spike.get_core(0);
+    state_t* st = p->get_state();
+
+    // Device time: every retired instruction is worth 'cpi' cycles.
+    iss_clock_t clock = [st, cpi]() -> uint64_t {
+        return st->minstret->read() * cpi;
+    };
+
+    auto uart  = std::make_shared<iss_uart_t>("out/stdout.txt");
+    auto timer = std::make_shared<iss_timer_t>(clock);
+    auto gpio  = std::make_shared<iss_gpio_t>();
+    auto spi   = std::make_shared<iss_spi_t>();
+    auto prng  = std::make_shared<iss_prng_t>();
+    auto sd    = std::make_shared<iss_sd_t>(sd_disk);
+
+    auto ethernet = std::make_shared<iss_null_device_t>("ETHERNET", DEVICE_INTERLEAVE);
+    auto apu      = std::make_shared<iss_null_device_t>("APU", DEVICE_INTERLEAVE + (1 << 10));
+    auto trace    = std::make_shared<iss_null_device_t>("TRACE_UNIT", DEVICE_INTERLEAVE);
+
+    bus_t& bus = const_cast<bus_t&>(spike.get_bus());
+
+    bus.add_device(UART_BASE, uart.get());
+    bus.add_device(TIMER_BASE, timer.get());
+    bus.add_device(GPIO_BASE, gpio.get());
+    bus.add_device(SPI_BASE, spi.get());
+    bus.add_device(ETHERNET_BASE, ethernet.get());
+    bus.add_device(PRNG_BASE, prng.get());
+    bus.add_device(APU_BASE, apu.get());
+    bus.add_device(SD_BASE, sd.get());
+    bus.add_device(TRACE_UNIT_BASE, trace.get());
+
+    // htif_t::load_program() is called only by spike.run(); since run() is not
+    // used, preload all ELF words through memif().write().
+    for (const auto& seg : img.words) {
+        uint32_t addr = seg.first, data = seg.second;
+        spike.memif().write(addr, 4, &data);
+    }
+
+    st->pc = img.entry;
+
+    std::cout << "[ISS] ISA=" << cfg.isa << " priv=" << cfg.priv
+              << " entry=0x" << std::hex << img.entry
+              << " tohost=0x" << img.tohost << std::dec
+              << " cpi=" << cpi << "\n";
+
+    std::cout << "[ISS] start (firmware=" << fw_path << ")\n";
+
+
+    // ------------------------------------------------------------------------
+    // Run
+    // ------------------------------------------------------------------------
+
+    const auto wall_start = std::chrono::steady_clock::now();
+
+    uint64_t executed = 0;
+    int rc = 1;
+
+    while (true) {
+        const uint64_t chunk = std::min(STEP_CHUNK, max_insns - executed);
+
+        p->step(chunk);
+        executed += chunk;
+
+        uint32_t tohost = 0;
+
+        if (img.tohost) {
+            spike.memif().read(img.tohost, 4, &tohost);
+        }
+
+        if (tohost) {
+            const uint32_t exit_code = tohost >> 1;
+
+            std::cout << "[ISS] tohost write (value=0x" << std::hex << tohost
+                      << ", exit_code=" << std::dec << exit_code << ")\n";
+
+            if (exit_code == 0) {
+                std::cout << "[ISS] PASS\n";
+                rc = 0;
+            } else {
+                std::cout << "[ISS] FAIL\n";
+                rc = static_cast<int>(exit_code);
+            }
+
+            break;
+        }
+
+        if (executed >= max_insns) {
+            std::cout << "[ISS] TIMEOUT after " << executed << " instructions\n";
+            break;
+        }
+
+        if (g_interrupted) {
+            std::cout << "\n[ISS] interrupted\n";
+            rc = 130;
+            break;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wall_start).count();
+
+    const uint64_t retired = st->minstret->read();
+
+    std::cout << "[ISS] retired " << retired << " instructions in "
+              << seconds << " s ("
+              << (seconds > 0 ? retired / seconds / 1e6 : 0.0) << " MIPS)\n";
+
+    return rc;
+}